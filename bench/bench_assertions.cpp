@@ -0,0 +1,240 @@
+/*
+ *  bench_assertions.cpp
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Micro-benchmark that reports the cost of a passing assertion relative
+ *      to the equivalent hand-written comparison.  An assertion is an early
+ *      exit comparison, so the baseline is a loop that returns on the first
+ *      mismatch.  Each loop is called through a volatile function pointer so
+ *      that the optimizer cannot specialize it for the data or hoist it out
+ *      of the timing loop.  Timings vary from run to run with the load on
+ *      the machine, so in optimized builds each assertion is only checked
+ *      against a generous multiple of the baseline; that is enough to catch
+ *      a passing assertion doing real work (e.g., formatting a message).
+ *
+ *  Portability Issues:
+ *      Results are only meaningful for optimized builds (i.e., with
+ *      CMAKE_BUILD_TYPE set to Release).
+ */
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <terra/stf/stf.h>
+
+namespace
+{
+
+// Number of elements compared by each call
+constexpr std::size_t Element_Count = 1 << 16;
+
+// Number of calls timed in each trial
+constexpr std::size_t Rounds = 500;
+
+// Number of trials, of which the fastest is reported
+constexpr std::size_t Trials = 7;
+
+// Multiple of the bare comparison time a passing assertion may take
+constexpr double Overhead_Limit = 4.0;
+
+// Type of the functions being timed
+using CompareFunction = bool (*)(const std::uint32_t *,
+                                 const std::uint32_t *,
+                                 std::size_t);
+
+bool BareCompare(const std::uint32_t *expected,
+                 const std::uint32_t *actual,
+                 std::size_t count)
+{
+    bool passed = false;
+
+    [&]()
+    {
+        for (std::size_t i = 0; i < count; i++)
+        {
+            if (expected[i] != actual[i]) return;
+        }
+
+        passed = true;
+    }();
+
+    return passed;
+}
+
+bool AssertEqual(const std::uint32_t *expected,
+                 const std::uint32_t *actual,
+                 std::size_t count)
+{
+    bool passed = false;
+
+    [&]()
+    {
+        for (std::size_t i = 0; i < count; i++)
+        {
+            STF_ASSERT_EQ(expected[i], actual[i]);
+        }
+
+        passed = true;
+    }();
+
+    return passed;
+}
+
+bool AssertTrue(const std::uint32_t *expected,
+                const std::uint32_t *actual,
+                std::size_t count)
+{
+    bool passed = false;
+
+    [&]()
+    {
+        for (std::size_t i = 0; i < count; i++)
+        {
+            STF_ASSERT_TRUE(expected[i] == actual[i]);
+        }
+
+        passed = true;
+    }();
+
+    return passed;
+}
+
+bool ExpectEqual(const std::uint32_t *expected,
+                 const std::uint32_t *actual,
+                 std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i++)
+    {
+        STF_EXPECT_EQ(expected[i], actual[i]);
+    }
+
+    return true;
+}
+
+// Time one trial of the given function, returning the time per comparison
+// in nanoseconds or a negative value if any comparison failed
+double TimeTrial(CompareFunction function,
+                 const std::vector<std::uint32_t> &expected,
+                 const std::vector<std::uint32_t> &actual)
+{
+    volatile CompareFunction compare = function;
+    bool passed = true;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (std::size_t round = 0; round < Rounds; round++)
+    {
+        passed &= compare(expected.data(), actual.data(), expected.size());
+    }
+
+    auto end = std::chrono::steady_clock::now();
+
+    if (!passed) return -1.0;
+
+    return std::chrono::duration<double, std::nano>(end - start).count() /
+           static_cast<double>(Rounds * Element_Count);
+}
+
+// Return the fastest time per comparison of each function over all trials;
+// the functions take turns within each trial so that warm-up and changes
+// in clock frequency do not favor whichever function happens to run first
+template<std::size_t N>
+std::array<double, N> TimeComparisons(
+                                const std::array<CompareFunction, N> &functions,
+                                const std::vector<std::uint32_t> &expected,
+                                const std::vector<std::uint32_t> &actual)
+{
+    std::array<double, N> best{};
+
+    // Warm up the caches and branch predictors before timing anything
+    for (CompareFunction function : functions)
+    {
+        TimeTrial(function, expected, actual);
+    }
+
+    for (std::size_t trial = 0; trial < Trials; trial++)
+    {
+        for (std::size_t i = 0; i < N; i++)
+        {
+            double elapsed = TimeTrial(functions[i], expected, actual);
+
+            if (elapsed < 0.0) return {};
+
+            best[i] = (trial == 0) ? elapsed : std::min(best[i], elapsed);
+        }
+    }
+
+    return best;
+}
+
+// Report a timing result
+void Report(const char *label, double nanoseconds)
+{
+    Terra::STF::PendingOutput().Text("  ")
+                               .Text(label)
+                               .Text(": ")
+                               .Float(nanoseconds, 3)
+                               .Text(" ns per comparison")
+                               .NewLine();
+}
+
+// Report a timing result and its cost over the bare comparison
+void Report(const char *label, double nanoseconds, double bare)
+{
+    Terra::STF::PendingOutput().Text("  ")
+                               .Text(label)
+                               .Text(": ")
+                               .Float(nanoseconds, 3)
+                               .Text(" ns per comparison (")
+                               .Float(nanoseconds - bare, 3)
+                               .Text(" ns overhead)")
+                               .NewLine();
+}
+
+} // namespace
+
+STF_TEST(Benchmark, AssertionOverhead)
+{
+    std::vector<std::uint32_t> expected(Element_Count);
+    for (std::size_t i = 0; i < expected.size(); i++)
+    {
+        expected[i] = static_cast<std::uint32_t>(i * 2654435761U);
+    }
+    std::vector<std::uint32_t> actual = expected;
+
+    auto timings = TimeComparisons<4>(
+        {BareCompare, AssertEqual, AssertTrue, ExpectEqual},
+        expected,
+        actual);
+    double bare = timings[0];
+    double assert_eq = timings[1];
+    double assert_true = timings[2];
+    double expect_eq = timings[3];
+
+    STF_ASSERT_GT(bare, 0.0);
+    STF_ASSERT_GT(assert_eq, 0.0);
+    STF_ASSERT_GT(assert_true, 0.0);
+    STF_ASSERT_GT(expect_eq, 0.0);
+
+#if defined(NDEBUG)
+    STF_EXPECT_LE(assert_eq, bare * Overhead_Limit);
+    STF_EXPECT_LE(assert_true, bare * Overhead_Limit);
+    STF_EXPECT_LE(expect_eq, bare * Overhead_Limit);
+#endif
+
+    Terra::STF::PendingOutput().NewLine();
+    Report("bare comparison", bare);
+    Report("STF_ASSERT_EQ  ", assert_eq, bare);
+    Report("STF_ASSERT_TRUE", assert_true, bare);
+    Report("STF_EXPECT_EQ  ", expect_eq, bare);
+}
@@ -0,0 +1,797 @@
+/*
+ *  async.h
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Support for tests written as C++20 coroutines.  A test is defined
+ *      with STF_TEST_ASYNC, and its body is a coroutine returning a
+ *      Terra::STF::Task<>:
+ *
+ *          STF_TEST_ASYNC(Socket, Echo)
+ *          {
+ *              auto reply = co_await EchoAsync("hello");
+ *              STF_CO_ASSERT_EQ(std::string("hello"), reply);
+ *          }
+ *
+ *      The runner starts all such tests together, after all other tests
+ *      have completed, and runs them concurrently on a single thread using
+ *      an EventLoop.  The outcome of each is reported in the order the tests
+ *      are defined.  Any test may await other Tasks, the awaitables returned
+ *      by AsyncSleepFor(), AsyncSleepUntil(), and AsyncYield(), and Events,
+ *      which may be set from any thread to resume the coroutines awaiting
+ *      them on the event loop.
+ *
+ *      Since a coroutine cannot use "return", fatal assertions in a
+ *      coroutine must use the STF_CO_ASSERT_* macros, which end the
+ *      coroutine with "co_return;".  They may therefore be used only in a
+ *      coroutine returning Task<> (such as the test body); in one returning
+ *      a Task<T> with a value, they do not compile, since such a coroutine
+ *      must return a value.  There, use the STF_EXPECT_* macros, which may
+ *      be used unchanged in any coroutine, and return a value as usual, or
+ *      move the fatal assertions into a Task<> that the coroutine awaits.
+ *      An assertion in a coroutine awaited by the test body ends only that
+ *      coroutine, just as an assertion in a function called by a test
+ *      returns only from that function.
+ *
+ *      Each coroutine is resumed with the context of the test that started
+ *      it, so assertions are attributed to the right test even though tests
+ *      share a thread.  A test that needs to block (e.g., on a mutex) should
+ *      do so on a Terra::STF::Thread and signal the test with an Event.
+ *
+ *      Some compilers (e.g., GCC 12) mishandle co_await within the condition
+ *      of an if statement, so assign the result of co_await to a variable
+ *      before passing it to an assertion.
+ *
+ *  Portability Issues:
+ *      Requires C++20 or greater.
+ */
+
+#pragma once
+
+#if !defined(__cpp_impl_coroutine) || (__cpp_impl_coroutine < 201902L)
+#error "async.h requires a compiler supporting C++20 coroutines"
+#endif
+
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <terra/stf/stf.h>
+
+// Macro to define a coroutine test and register the test for execution
+#define STF_TEST_ASYNC(group, test) \
+    STF_TEST_ASYNC_TIMEOUT(group, test, Terra::STF::Default_Timeout)
+
+// Macro to define a coroutine test with a timeout in seconds
+#define STF_TEST_ASYNC_TIMEOUT(group, test, timeout) \
+    Terra::STF::Task<> STF_Test_ ## group ## _ ## test(); \
+    const std::size_t STF_Test_ID_ ## group ## _ ## test = \
+        Terra::STF::RegisterAsyncTest( \
+            #group "::" #test, \
+            [] \
+            { \
+                Terra::STF::StartAsyncTest(STF_Test_ ## group ## _ ## test); \
+            }, \
+            Terra::STF::DriveAsyncTests, \
+            timeout); \
+    Terra::STF::Task<> STF_Test_ ## group ## _ ## test()
+
+// Macro to test for equality
+#define STF_CO_ASSERT_EQ(expected, actual) \
+    STF_INTERNAL_EQ(expected, actual, STF_INTERNAL_CO_FATAL)
+
+// Macro to test for inequality
+#define STF_CO_ASSERT_NE(a, b) \
+    STF_INTERNAL_COMPARE(a, NotEqual, b, STF_INTERNAL_CO_FATAL)
+
+// Macro to test that a > b
+#define STF_CO_ASSERT_GT(a, b) \
+    STF_INTERNAL_COMPARE(a, Greater, b, STF_INTERNAL_CO_FATAL)
+
+// Macro to test that a >= b
+#define STF_CO_ASSERT_GE(a, b) \
+    STF_INTERNAL_COMPARE(a, GreaterEqual, b, STF_INTERNAL_CO_FATAL)
+
+// Macro to test that a < b
+#define STF_CO_ASSERT_LT(a, b) \
+    STF_INTERNAL_COMPARE(a, Less, b, STF_INTERNAL_CO_FATAL)
+
+// Macro to test that a <= b
+#define STF_CO_ASSERT_LE(a, b) \
+    STF_INTERNAL_COMPARE(a, LessEqual, b, STF_INTERNAL_CO_FATAL)
+
+// Macro to test for true
+#define STF_CO_ASSERT_TRUE(a) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertBoolean(__FILE__, __LINE__, bool(a) == true), \
+        STF_INTERNAL_CO_FATAL)
+
+// Macro to test for false
+#define STF_CO_ASSERT_FALSE(a) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertBoolean(__FILE__, __LINE__, bool(a) == false), \
+        STF_INTERNAL_CO_FATAL)
+
+// Macro to test that difference in float or double values are less than epsilon
+#define STF_CO_ASSERT_CLOSE(a, b, epsilon) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertClose(__FILE__, __LINE__, (a), (b), (epsilon)), \
+        STF_INTERNAL_CO_FATAL)
+
+// Macro to test that float or double values are within a combined absolute
+// and relative tolerance
+#define STF_CO_ASSERT_NEAR(a, b, abs_epsilon, rel_epsilon) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertNear(__FILE__, \
+                               __LINE__, \
+                               (a), \
+                               (b), \
+                               (abs_epsilon), \
+                               (rel_epsilon)), \
+        STF_INTERNAL_CO_FATAL)
+
+// Macro to test that float or double values are within a number of ULPs
+#define STF_CO_ASSERT_ULP_EQ(a, b, max_ulps) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertUlpEqual(__FILE__, __LINE__, (a), (b), (max_ulps)), \
+        STF_INTERNAL_CO_FATAL)
+
+// Macro to test that arrays of float or double values are element-wise close
+#define STF_CO_ASSERT_ARRAY_CLOSE(a, b, count, abs_epsilon, rel_epsilon) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertArrayClose(__FILE__, \
+                                     __LINE__, \
+                                     (a), \
+                                     (b), \
+                                     (count), \
+                                     (abs_epsilon), \
+                                     (rel_epsilon)), \
+        STF_INTERNAL_CO_FATAL)
+
+// Macro to test that strided float or double tensors are element-wise close
+#define STF_CO_ASSERT_TENSOR_CLOSE(a, b, abs_epsilon, rel_epsilon) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertTensorClose(__FILE__, \
+                                      __LINE__, \
+                                      (a), \
+                                      (b), \
+                                      (abs_epsilon), \
+                                      (rel_epsilon)), \
+        STF_INTERNAL_CO_FATAL)
+
+// Macro to test memory ranges for equality
+#define STF_CO_ASSERT_MEM_EQ(a, b, size) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertMemoryEqual(__FILE__, __LINE__, (a), (b), (size)), \
+        STF_INTERNAL_CO_FATAL)
+
+// Macro to test memory ranges for inequality
+#define STF_CO_ASSERT_MEM_NE(a, b, size) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertMemoryNotEqual(__FILE__, \
+                                         __LINE__, \
+                                         (a), \
+                                         (b), \
+                                         (size)), \
+        STF_INTERNAL_CO_FATAL)
+
+// Macro to test for exceptions to be thrown on a function call
+#define STF_CO_ASSERT_EXCEPTION(function) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertException(__FILE__, __LINE__, (function)), \
+        STF_INTERNAL_CO_FATAL)
+
+// Macro to test for specific exceptions to be thrown on a function call
+#define STF_CO_ASSERT_EXCEPTION_E(function, exception) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertException<exception>(__FILE__, \
+                                               __LINE__, \
+                                               (function), \
+                                               #exception), \
+        STF_INTERNAL_CO_FATAL)
+
+// Failure action for assertions that end a coroutine returning Task<>
+#define STF_INTERNAL_CO_FATAL \
+    { \
+        Terra::STF::RecordFailure(); \
+        co_return; \
+    }
+
+namespace Terra::STF
+{
+
+template<typename T = void>
+class Task;
+
+/*
+ *  TaskPromiseBase
+ *
+ *  Description:
+ *      State common to the promises of all Task types: the coroutine to
+ *      resume when the task completes and any exception the task threw.
+ *
+ *  Comments:
+ *      A Task does not start until it is awaited, and on completion it
+ *      resumes the awaiting coroutine directly (symmetric transfer), so
+ *      chains of awaited tasks do not consume stack.
+ */
+class TaskPromiseBase
+{
+    public:
+        struct FinalAwaiter
+        {
+            bool await_ready() const noexcept { return false; }
+
+            template<typename Promise>
+            std::coroutine_handle<> await_suspend(
+                std::coroutine_handle<Promise> handle) noexcept
+            {
+                std::coroutine_handle<> continuation =
+                    handle.promise().continuation;
+
+                return continuation ? continuation : std::noop_coroutine();
+            }
+
+            void await_resume() const noexcept {}
+        };
+
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        FinalAwaiter final_suspend() const noexcept { return {}; }
+        void unhandled_exception() noexcept
+        {
+            exception = std::current_exception();
+        }
+
+        std::coroutine_handle<> continuation;
+        std::exception_ptr exception;
+};
+
+// Promise for tasks producing a value
+template<typename T>
+class TaskPromise : public TaskPromiseBase
+{
+    public:
+        template<typename U>
+        void return_value(U &&result)
+        {
+            value.emplace(std::forward<U>(result));
+        }
+
+        T Result()
+        {
+            if (exception) std::rethrow_exception(exception);
+
+            return std::move(*value);
+        }
+
+    protected:
+        std::optional<T> value;
+};
+
+// Promise for tasks producing no value
+template<>
+class TaskPromise<void> : public TaskPromiseBase
+{
+    public:
+        void return_void() const noexcept {}
+
+        void Result()
+        {
+            if (exception) std::rethrow_exception(exception);
+        }
+};
+
+/*
+ *  Task
+ *
+ *  Description:
+ *      The return type of a coroutine that produces a value of type T (or
+ *      nothing, if T is void).  The coroutine does not run until the task is
+ *      awaited, and awaiting it yields the value or rethrows the exception
+ *      the coroutine threw.
+ *
+ *  Comments:
+ *      A task may be awaited only once.
+ */
+template<typename T>
+class Task
+{
+    public:
+        class promise_type : public TaskPromise<T>
+        {
+            public:
+                Task get_return_object() noexcept
+                {
+                    return Task(
+                        std::coroutine_handle<promise_type>::from_promise(
+                            *this));
+                }
+        };
+
+        Task() noexcept = default;
+        Task(const Task &) = delete;
+        Task(Task &&other) noexcept :
+            handle{std::exchange(other.handle, {})}
+        {
+            // Nothing to do
+        }
+        ~Task()
+        {
+            if (handle) handle.destroy();
+        }
+
+        Task &operator=(const Task &) = delete;
+        Task &operator=(Task &&other) noexcept
+        {
+            if (this != &other)
+            {
+                if (handle) handle.destroy();
+                handle = std::exchange(other.handle, {});
+            }
+            return *this;
+        }
+
+        bool await_ready() const noexcept { return !handle || handle.done(); }
+        std::coroutine_handle<> await_suspend(
+            std::coroutine_handle<> awaiting) noexcept
+        {
+            handle.promise().continuation = awaiting;
+            return handle;
+        }
+        T await_resume() { return handle.promise().Result(); }
+
+    protected:
+        explicit Task(std::coroutine_handle<promise_type> handle) noexcept :
+            handle{handle}
+        {
+            // Nothing to do
+        }
+
+        std::coroutine_handle<promise_type> handle;
+};
+
+/*
+ *  EventLoop
+ *
+ *  Description:
+ *      A single-threaded event loop that runs any number of Tasks
+ *      concurrently.  Coroutines run until they await something that is not
+ *      ready, after which the loop resumes other coroutines that are ready,
+ *      whose timers have expired, or whose Events have been set.
+ *
+ *  Comments:
+ *      Apart from Post(), member functions must be called on the thread
+ *      running the loop.  Timers use std::chrono::steady_clock.
+ */
+class EventLoop
+{
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        EventLoop() = default;
+        EventLoop(const EventLoop &) = delete;
+        ~EventLoop()
+        {
+            // Destroy tasks that did not complete, along with the tasks
+            // they were awaiting
+            for (auto &[id, handle] : roots) handle.destroy();
+        }
+
+        EventLoop &operator=(const EventLoop &) = delete;
+
+        static EventLoop *Current() noexcept { return CurrentLoop(); }
+
+        void Spawn(Task<> task, TestContext *context = CurrentContext())
+        {
+            std::size_t id = next_root++;
+            std::coroutine_handle<> handle =
+                Drive(this, std::move(task), context, id).handle;
+
+            roots.emplace(id, handle);
+            ready.push_back({handle, context});
+        }
+
+        bool Run(Clock::time_point deadline = Clock::time_point::max())
+        {
+            EventLoop *previous = std::exchange(CurrentLoop(), this);
+
+            bool completed = RunUntil(deadline);
+
+            CurrentLoop() = previous;
+
+            return completed;
+        }
+
+        void Resume(std::coroutine_handle<> handle,
+                    TestContext *context = CurrentContext())
+        {
+            ready.push_back({handle, context});
+        }
+
+        void ResumeAt(Clock::time_point time,
+                      std::coroutine_handle<> handle,
+                      TestContext *context = CurrentContext())
+        {
+            timers.emplace(time, Ready{handle, context});
+        }
+
+        void Post(std::function<void()> callback)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                posted.push_back(std::move(callback));
+            }
+            wakeup.notify_one();
+        }
+
+        std::size_t Tasks() const noexcept { return roots.size(); }
+
+    protected:
+        // A coroutine ready to run and the context with which to run it
+        struct Ready
+        {
+            std::coroutine_handle<> handle;
+            TestContext *context;
+        };
+
+        // Coroutine that drives a spawned task to completion
+        struct Detached
+        {
+            struct promise_type
+            {
+                Detached get_return_object() noexcept
+                {
+                    return {std::coroutine_handle<promise_type>::from_promise(
+                        *this)};
+                }
+                std::suspend_always initial_suspend() const noexcept
+                {
+                    return {};
+                }
+                std::suspend_never final_suspend() const noexcept
+                {
+                    return {};
+                }
+                void return_void() const noexcept {}
+                void unhandled_exception() const noexcept { std::terminate(); }
+            };
+
+            std::coroutine_handle<promise_type> handle;
+        };
+
+        static EventLoop *&CurrentLoop() noexcept
+        {
+            thread_local EventLoop *loop{};
+            return loop;
+        }
+
+        static Detached Drive(EventLoop *loop,
+                              Task<> task,
+                              TestContext *context,
+                              std::size_t id)
+        {
+            try
+            {
+                co_await task;
+            }
+            catch (...)
+            {
+                ReportUnexpectedException();
+            }
+
+            // Move any remaining output into the test output buffer
+            CommitOutput();
+
+            if (context != nullptr) context->Complete();
+
+            loop->roots.erase(id);
+        }
+
+        bool RunUntil(Clock::time_point deadline)
+        {
+            while (!roots.empty())
+            {
+                // Run callbacks posted from any thread
+                std::vector<std::function<void()>> callbacks;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    callbacks.swap(posted);
+                }
+                for (auto &callback : callbacks) callback();
+
+                // Make coroutines whose timers have expired ready
+                auto now = Clock::now();
+                while (!timers.empty() && (timers.begin()->first <= now))
+                {
+                    ready.push_back(timers.begin()->second);
+                    timers.erase(timers.begin());
+                }
+
+                if (!ready.empty())
+                {
+                    Ready next = ready.front();
+                    ready.pop_front();
+
+                    ContextScope scope(next.context);
+                    next.handle.resume();
+
+                    continue;
+                }
+
+                if (now >= deadline) return false;
+
+                // Wait for the next timer or for a callback to be posted
+                Clock::time_point wake = deadline;
+                if (!timers.empty() && (timers.begin()->first < wake))
+                {
+                    wake = timers.begin()->first;
+                }
+
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeup.wait_until(lock, wake, [&] { return !posted.empty(); });
+            }
+
+            return true;
+        }
+
+        std::deque<Ready> ready;
+        std::multimap<Clock::time_point, Ready> timers;
+        std::map<std::size_t, std::coroutine_handle<>> roots;
+        std::size_t next_root{};
+        std::mutex mutex;
+        std::condition_variable wakeup;
+        std::vector<std::function<void()>> posted;
+};
+
+/*
+ *  Event
+ *
+ *  Description:
+ *      An awaitable that completes once Set() is called.  Coroutines awaiting
+ *      the event are resumed on the event loop on which they were running,
+ *      so Set() may be called from any thread, such as one on which a
+ *      blocking operation was performed.
+ *
+ *  Comments:
+ *      Once set, an event remains set.
+ */
+class Event
+{
+    public:
+        Event() = default;
+        Event(const Event &) = delete;
+        ~Event() = default;
+
+        Event &operator=(const Event &) = delete;
+
+        void Set()
+        {
+            std::vector<Waiter> resume;
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                set = true;
+                resume.swap(waiters);
+            }
+
+            for (const auto &waiter : resume)
+            {
+                EventLoop *loop = waiter.loop;
+                loop->Post([waiter] { waiter.loop->Resume(waiter.handle,
+                                                          waiter.context); });
+            }
+        }
+
+        bool IsSet() const
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return set;
+        }
+
+        bool await_ready() const { return IsSet(); }
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (set) return false;
+
+            waiters.push_back({EventLoop::Current(), handle, CurrentContext()});
+
+            return true;
+        }
+        void await_resume() const noexcept {}
+
+    protected:
+        struct Waiter
+        {
+            EventLoop *loop;
+            std::coroutine_handle<> handle;
+            TestContext *context;
+        };
+
+        mutable std::mutex mutex;
+        bool set{};
+        std::vector<Waiter> waiters;
+};
+
+// Awaitable that resumes the awaiting coroutine at a given time
+class SleepAwaiter
+{
+    public:
+        explicit SleepAwaiter(EventLoop::Clock::time_point time) : time{time}
+        {
+            // Nothing to do
+        }
+
+        bool await_ready() const noexcept
+        {
+            return time <= EventLoop::Clock::now();
+        }
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            EventLoop::Current()->ResumeAt(time, handle);
+        }
+        void await_resume() const noexcept {}
+
+    protected:
+        EventLoop::Clock::time_point time;
+};
+
+// Awaitable that lets other ready coroutines run before resuming
+class YieldAwaiter
+{
+    public:
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            EventLoop::Current()->Resume(handle);
+        }
+        void await_resume() const noexcept {}
+};
+
+/*
+ *  AsyncSleepUntil()
+ *
+ *  Description:
+ *      Return an awaitable that suspends the awaiting coroutine until the
+ *      given time, allowing other coroutines to run in the meantime.
+ *
+ *  Parameters:
+ *      time [in]
+ *          The time at which to resume.
+ *
+ *  Returns:
+ *      The awaitable.
+ *
+ *  Comments:
+ *      Must be awaited by a coroutine running on an EventLoop.
+ */
+inline SleepAwaiter AsyncSleepUntil(EventLoop::Clock::time_point time)
+{
+    return SleepAwaiter(time);
+}
+
+/*
+ *  AsyncSleepFor()
+ *
+ *  Description:
+ *      Return an awaitable that suspends the awaiting coroutine for the given
+ *      duration, allowing other coroutines to run in the meantime.
+ *
+ *  Parameters:
+ *      duration [in]
+ *          The length of time to sleep.
+ *
+ *  Returns:
+ *      The awaitable.
+ *
+ *  Comments:
+ *      Must be awaited by a coroutine running on an EventLoop.
+ */
+template<typename Rep, typename Period>
+SleepAwaiter AsyncSleepFor(const std::chrono::duration<Rep, Period> &duration)
+{
+    return SleepAwaiter(
+        EventLoop::Clock::now() +
+        std::chrono::ceil<EventLoop::Clock::duration>(duration));
+}
+
+/*
+ *  AsyncYield()
+ *
+ *  Description:
+ *      Return an awaitable that suspends the awaiting coroutine and resumes
+ *      it after other coroutines that are ready have run.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The awaitable.
+ *
+ *  Comments:
+ *      Must be awaited by a coroutine running on an EventLoop.
+ */
+inline YieldAwaiter AsyncYield() noexcept { return {}; }
+
+/*
+ *  AsyncTestLoop()
+ *
+ *  Description:
+ *      Return the event loop on which the calling thread runs the tests
+ *      defined with STF_TEST_ASYNC.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The calling thread's event loop for asynchronous tests.
+ *
+ *  Comments:
+ *      None.
+ */
+inline EventLoop &AsyncTestLoop()
+{
+    thread_local EventLoop loop;
+    return loop;
+}
+
+/*
+ *  StartAsyncTest()
+ *
+ *  Description:
+ *      Start a test defined with STF_TEST_ASYNC on the calling thread's
+ *      event loop, reporting to the calling thread's current context.
+ *
+ *  Parameters:
+ *      test [in]
+ *          The coroutine function implementing the test.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+inline void StartAsyncTest(Task<> (*test)())
+{
+    AsyncTestLoop().Spawn(test());
+}
+
+/*
+ *  DriveAsyncTests()
+ *
+ *  Description:
+ *      Run the calling thread's event loop for asynchronous tests until all
+ *      tests started on it complete or the given time is reached.
+ *
+ *  Parameters:
+ *      deadline [in]
+ *          The time at which to stop running the tests.
+ *
+ *  Returns:
+ *      True if all of the tests completed, false otherwise.
+ *
+ *  Comments:
+ *      None.
+ */
+inline bool DriveAsyncTests(std::chrono::steady_clock::time_point deadline)
+{
+    return AsyncTestLoop().Run(deadline);
+}
+
+} // namespace Terra::STF
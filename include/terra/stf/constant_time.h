@@ -0,0 +1,286 @@
+/*
+ *  constant_time.h
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Support for detecting timing that depends on secret data, following
+ *      the approach of dudect.  STF_ASSERT_CONSTANT_TIME calls a function
+ *      with inputs of two classes, a fixed input and random inputs, in a
+ *      random interleaved order, timing each call, and asserts that the
+ *      timings of the two classes cannot be told apart:
+ *
+ *          STF_TEST(HMAC, VerifyIsConstantTime)
+ *          {
+ *              STF_ASSERT_CONSTANT_TIME(
+ *                  [&](const Tag &tag) { return Verify(expected, tag); },
+ *                  expected,
+ *                  [](Terra::STF::PropertyRandom &random)
+ *                  {
+ *                      Tag tag;
+ *                      for (auto &octet : tag) octet = random.Next() & 0xff;
+ *                      return tag;
+ *                  });
+ *          }
+ *
+ *      The third argument produces a random input from the given random
+ *      number generator (see property.h).  Random inputs must be the same
+ *      size as the fixed input, or the size itself will show in the timing.
+ *
+ *      Calls are timed with the CPU's cycle counter on a thread pinned to
+ *      one processor, after a batch of warm-up calls.  The timings are
+ *      compared with Welch's t-test, computed online, over all timings and
+ *      over the timings below each of Constant_Time_Percentiles percentiles
+ *      (which removes the long tail of timings disturbed by interrupts and
+ *      the like).  The assertion fails if the largest |t| of the tests
+ *      exceeds Constant_Time_Threshold.  Up to Constant_Time_Samples calls
+ *      are timed, stopping early after Constant_Time_Seconds seconds or as
+ *      the test nears its timeout, and |t| and the number of calls timed
+ *      are noted on the line reporting the test whether or not it passes.
+ *      The assertion also fails if too few calls of either class were timed
+ *      in that time to be compared.
+ *
+ *      A passing test shows only that no difference was detected: a larger
+ *      number of samples, or another choice of fixed input, may reveal one.
+ *
+ *  Portability Issues:
+ *      Requires C++17 or greater.  The cycle counter is read on x86 and
+ *      ARM64 processors; elsewhere, a steady clock is used, whose resolution
+ *      may be too coarse to detect small differences.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <vector>
+#include <terra/stf/stf.h>
+#include <terra/stf/property.h>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define STF_USE_RDTSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define STF_USE_RDTSC
+#endif
+
+// Macro to assert that the timing of a function does not depend on its input
+#define STF_ASSERT_CONSTANT_TIME(function, fixed, random) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertConstantTime(__FILE__, \
+                                       __LINE__, \
+                                       (function), \
+                                       (fixed), \
+                                       (random)), \
+        STF_INTERNAL_FATAL)
+
+// Non-fatal macro to test that the timing of a function does not depend on
+// its input
+#define STF_EXPECT_CONSTANT_TIME(function, fixed, random) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertConstantTime(__FILE__, \
+                                       __LINE__, \
+                                       (function), \
+                                       (fixed), \
+                                       (random)), \
+        STF_INTERNAL_NONFATAL)
+
+namespace Terra::STF
+{
+
+// Limits on the calls timed by STF_ASSERT_CONSTANT_TIME
+constexpr std::size_t Constant_Time_Samples = 1000000;
+constexpr unsigned Constant_Time_Seconds = 5;
+
+// Number of calls prepared and timed at once
+constexpr std::size_t Constant_Time_Batch = 10000;
+
+// Number of percentiles below which timings are also compared
+constexpr std::size_t Constant_Time_Percentiles = 100;
+
+// Largest |t| taken to show that timings do not differ
+constexpr double Constant_Time_Threshold = 10.0;
+
+// Function that prepares and times a batch of calls, choosing the class of
+// each (0 for the fixed input, 1 for random) and storing the time of each
+using ConstantTimeBatch = std::function<void(std::uint8_t *classes,
+                                             std::uint64_t *times,
+                                             std::size_t count)>;
+
+/*
+ *  CycleCount()
+ *
+ *  Description:
+ *      Return the value of the CPU's cycle counter.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The cycle count, or a time in nanoseconds where no cycle counter is
+ *      available.
+ *
+ *  Comments:
+ *      On x86, the counter is read between fences so that the timed code
+ *      does not execute outside of the readings.
+ */
+inline std::uint64_t CycleCount() noexcept
+{
+#if defined(STF_USE_RDTSC)
+    _mm_lfence();
+    std::uint64_t count = __rdtsc();
+    _mm_lfence();
+    return count;
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+    std::uint64_t count;
+    asm volatile("isb; mrs %0, cntvct_el0" : "=r"(count) : : "memory");
+    return count;
+#else
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+/*
+ *  KeepValue()
+ *
+ *  Description:
+ *      Prevent the compiler from discarding the computation of a value.
+ *
+ *  Parameters:
+ *      value [in]
+ *          The value to keep.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename T>
+inline void KeepValue(const T &value) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void *sink;
+    sink = &value;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+/*
+ *  CheckConstantTime()
+ *
+ *  Description:
+ *      Time batches of calls on a pinned thread and compare the timings of
+ *      the two classes of input, as done by STF_ASSERT_CONSTANT_TIME.
+ *
+ *  Parameters:
+ *      file [in]
+ *          The file containing the assertion.
+ *
+ *      line [in]
+ *          The line of the assertion.
+ *
+ *      batch [in]
+ *          The function that prepares and times a batch of calls.
+ *
+ *  Returns:
+ *      True if the largest |t| does not exceed Constant_Time_Threshold and
+ *      enough calls of each class were timed.
+ *
+ *  Comments:
+ *      The first batch warms up, the second sets the percentiles, and
+ *      neither is compared.  No batch is started after the stop time.
+ */
+bool CheckConstantTime(const char *file,
+                       const std::size_t line,
+                       const ConstantTimeBatch &batch);
+
+/*
+ *  AssertConstantTime()
+ *
+ *  Description:
+ *      Assert that the time taken by a function does not depend on whether
+ *      it is called with a fixed input or random inputs.
+ *
+ *  Parameters:
+ *      file [in]
+ *          The file containing the assertion.
+ *
+ *      line [in]
+ *          The line of the assertion.
+ *
+ *      function [in]
+ *          The function to time, called with one input.
+ *
+ *      fixed [in]
+ *          The fixed input.
+ *
+ *      random [in]
+ *          The function that returns a random input, called with a
+ *          PropertyRandom.
+ *
+ *  Returns:
+ *      True if the assertion is true, else false.
+ *
+ *  Comments:
+ *      Inputs are prepared before a batch is timed, so producing them is not
+ *      timed.  The result of the function, if any, is kept so that the call
+ *      is not optimized away.
+ */
+template<typename Function, typename Input, typename Random>
+bool AssertConstantTime(const char *file,
+                        const std::size_t line,
+                        Function function,
+                        const Input &fixed,
+                        Random random)
+{
+    using Output = std::invoke_result_t<Function &, const Input &>;
+
+    PropertyRandom generator(NewPropertySeed(), 0);
+    std::vector<Input> inputs(Constant_Time_Batch, fixed);
+
+    return CheckConstantTime(
+        file,
+        line,
+        [&](std::uint8_t *classes, std::uint64_t *times, std::size_t count)
+        {
+            for (std::size_t i = 0; i < count; i++)
+            {
+                classes[i] = static_cast<std::uint8_t>(generator.Next() & 1);
+                inputs[i] = (classes[i] == 0) ? fixed : random(generator);
+            }
+
+            for (std::size_t i = 0; i < count; i++)
+            {
+                if constexpr (std::is_void_v<Output>)
+                {
+                    const std::uint64_t start = CycleCount();
+                    function(inputs[i]);
+                    times[i] = CycleCount() - start;
+                }
+                else
+                {
+                    const std::uint64_t start = CycleCount();
+                    const Output result = function(inputs[i]);
+                    times[i] = CycleCount() - start;
+                    KeepValue(result);
+                }
+            }
+        });
+}
+
+} // namespace Terra::STF
@@ -0,0 +1,608 @@
+/*
+ *  differential.h
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Support for differential testing of an optimized implementation
+ *      against a reference implementation.  STF_ASSERT_EQUIVALENT calls both
+ *      implementations with many inputs produced by the given generators
+ *      (see property.h) and asserts that they always produce the same
+ *      output:
+ *
+ *          STF_TEST(Base64, Differential)
+ *          {
+ *              STF_ASSERT_EQUIVALENT(EncodeScalar,
+ *                                    EncodeAVX2,
+ *                                    Terra::STF::Bytes(4096));
+ *          }
+ *
+ *      Outputs are compared with ==, except that floating point values (and
+ *      containers of them) compared with STF_ASSERT_EQUIVALENT_NEAR need only
+ *      be within the same combined absolute and relative tolerance as
+ *      STF_ASSERT_NEAR.  NaN is equivalent to NaN.
+ *
+ *      Inputs are produced in batches on a number of worker threads (see
+ *      WorkerThreads()), and each implementation is timed over each batch,
+ *      the implementation run first alternating from batch to batch so that
+ *      neither always runs with caches warmed by the other.
+ *      Up to Differential_Cases cases are run, stopping early after
+ *      Differential_Seconds seconds or as the test nears its timeout.  The
+ *      throughput of both implementations and the speedup of the optimized
+ *      implementation are noted on the line reporting the test, in octets
+ *      per second if the inputs are arithmetic values or containers of them,
+ *      else in cases per second.  The throughput is per worker thread and
+ *      counts only batches in which the implementations agree.
+ *
+ *      If the implementations produce different outputs (or either throws),
+ *      the inputs are shrunk to the simplest inputs that still produce
+ *      different outputs, and both outputs are reported along with the
+ *      inputs and the seed with which the cases may be repeated.
+ *
+ *  Portability Issues:
+ *      Requires C++17 or greater.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <terra/stf/stf.h>
+#include <terra/stf/property.h>
+
+// Macro to assert that two implementations produce the same outputs
+#define STF_ASSERT_EQUIVALENT(reference, optimized, ...) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertEquivalent(__FILE__, \
+                                     __LINE__, \
+                                     0.0, \
+                                     0.0, \
+                                     (reference), \
+                                     (optimized), \
+                                     __VA_ARGS__), \
+        STF_INTERNAL_FATAL)
+
+// Macro to assert that two implementations produce the same outputs, with
+// floating point values within a combined absolute and relative tolerance
+#define STF_ASSERT_EQUIVALENT_NEAR(reference, \
+                                   optimized, \
+                                   abs_epsilon, \
+                                   rel_epsilon, \
+                                   ...) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertEquivalent(__FILE__, \
+                                     __LINE__, \
+                                     (abs_epsilon), \
+                                     (rel_epsilon), \
+                                     (reference), \
+                                     (optimized), \
+                                     __VA_ARGS__), \
+        STF_INTERNAL_FATAL)
+
+// Non-fatal macro to test that two implementations produce the same outputs
+#define STF_EXPECT_EQUIVALENT(reference, optimized, ...) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertEquivalent(__FILE__, \
+                                     __LINE__, \
+                                     0.0, \
+                                     0.0, \
+                                     (reference), \
+                                     (optimized), \
+                                     __VA_ARGS__), \
+        STF_INTERNAL_NONFATAL)
+
+// Non-fatal macro to test that two implementations produce the same outputs,
+// with floating point values within a combined absolute and relative
+// tolerance
+#define STF_EXPECT_EQUIVALENT_NEAR(reference, \
+                                   optimized, \
+                                   abs_epsilon, \
+                                   rel_epsilon, \
+                                   ...) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertEquivalent(__FILE__, \
+                                     __LINE__, \
+                                     (abs_epsilon), \
+                                     (rel_epsilon), \
+                                     (reference), \
+                                     (optimized), \
+                                     __VA_ARGS__), \
+        STF_INTERNAL_NONFATAL)
+
+namespace Terra::STF
+{
+
+// Limits on the cases run by STF_ASSERT_EQUIVALENT
+constexpr std::size_t Differential_Cases = 100000;
+constexpr unsigned Differential_Seconds = 10;
+
+// Number of cases each worker produces and times at once
+constexpr std::size_t Differential_Batch = 64;
+
+/*
+ *  IsEquivalent()
+ *
+ *  Description:
+ *      Determine whether two outputs are equivalent, as done for
+ *      STF_ASSERT_EQUIVALENT.
+ *
+ *  Parameters:
+ *      a [in]
+ *          The output of the reference implementation.
+ *
+ *      b [in]
+ *          The output of the optimized implementation.
+ *
+ *      abs_epsilon [in]
+ *          The absolute tolerance for floating point values.
+ *
+ *      rel_epsilon [in]
+ *          The relative tolerance for floating point values.
+ *
+ *  Returns:
+ *      True if the outputs are equivalent, false otherwise.
+ *
+ *  Comments:
+ *      Ranges whose elements are floating point values or ranges are
+ *      compared element by element; other values are compared with ==.
+ */
+template<typename T>
+bool IsEquivalent(const T &a,
+                  const T &b,
+                  long double abs_epsilon,
+                  long double rel_epsilon)
+{
+    if constexpr (std::is_floating_point<T>::value)
+    {
+        if (std::isnan(a) || std::isnan(b))
+        {
+            return std::isnan(a) && std::isnan(b);
+        }
+        if (a == b) return true;
+
+        long double x = a;
+        long double y = b;
+        long double difference = std::fabs(x - y);
+        long double magnitude = std::max(std::fabs(x), std::fabs(y));
+
+        return difference <= std::max(abs_epsilon, rel_epsilon * magnitude);
+    }
+    else if constexpr (IsRange<T>::value)
+    {
+        using Element = std::decay_t<decltype(*std::begin(a))>;
+
+        if constexpr (std::is_floating_point<Element>::value ||
+                      IsRange<Element>::value)
+        {
+            return std::equal(std::begin(a),
+                              std::end(a),
+                              std::begin(b),
+                              std::end(b),
+                              [&](const Element &x, const Element &y)
+                              {
+                                  return IsEquivalent(x,
+                                                      y,
+                                                      abs_epsilon,
+                                                      rel_epsilon);
+                              });
+        }
+        else
+        {
+            return a == b;
+        }
+    }
+    else
+    {
+        return a == b;
+    }
+}
+
+/*
+ *  PrintDivergence()
+ *
+ *  Description:
+ *      Print the outputs of two implementations that are not equivalent.
+ *
+ *  Parameters:
+ *      a [in]
+ *          The output of the reference implementation.
+ *
+ *      b [in]
+ *          The output of the optimized implementation.
+ *
+ *      abs_epsilon [in]
+ *          The absolute tolerance for floating point values.
+ *
+ *      rel_epsilon [in]
+ *          The relative tolerance for floating point values.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      For ranges, the index of the first element that differs is printed.
+ */
+template<typename T>
+void PrintDivergence(const T &a,
+                     const T &b,
+                     long double abs_epsilon,
+                     long double rel_epsilon)
+{
+    PrintArgument("  reference: ", a);
+    PrintArgument("  optimized: ", b);
+
+    if constexpr (IsRange<T>::value)
+    {
+        auto x = std::begin(a);
+        auto y = std::begin(b);
+        std::size_t index = 0;
+
+        while ((x != std::end(a)) && (y != std::end(b)) &&
+               IsEquivalent(*x, *y, abs_epsilon, rel_epsilon))
+        {
+            ++x;
+            ++y;
+            index++;
+        }
+
+        PendingOutput().Text("  first difference at index ")
+                       .Decimal(index)
+                       .NewLine();
+    }
+}
+
+/*
+ *  InputOctets()
+ *
+ *  Description:
+ *      Return the number of octets in a case's inputs, used to report the
+ *      throughput of the implementations.
+ *
+ *  Parameters:
+ *      args [in]
+ *          The inputs.
+ *
+ *  Returns:
+ *      The number of octets in the inputs that are arithmetic values or
+ *      containers of them.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename... T>
+std::size_t InputOctets(const std::tuple<T...> &args)
+{
+    auto octets = [](const auto &input) -> std::size_t
+    {
+        using Type = std::decay_t<decltype(input)>;
+
+        if constexpr (std::is_arithmetic<Type>::value)
+        {
+            return sizeof(Type);
+        }
+        else if constexpr (IsRange<Type>::value)
+        {
+            using Element = std::decay_t<decltype(*std::begin(input))>;
+
+            if constexpr (std::is_arithmetic<Element>::value)
+            {
+                return sizeof(Element) *
+                       static_cast<std::size_t>(
+                           std::distance(std::begin(input), std::end(input)));
+            }
+            else
+            {
+                return 0;
+            }
+        }
+        else
+        {
+            return 0;
+        }
+    };
+
+    return std::apply([&](const auto &...inputs)
+                      { return (std::size_t(0) + ... + octets(inputs)); },
+                      args);
+}
+
+/*
+ *  AssertEquivalent()
+ *
+ *  Description:
+ *      Test that two implementations produce equivalent outputs for inputs
+ *      produced by the given generators, as done by STF_ASSERT_EQUIVALENT.
+ *
+ *  Parameters:
+ *      file [in]
+ *          The name of the file where the test exists.
+ *
+ *      line [in]
+ *          The line number where the test failed.
+ *
+ *      abs_epsilon [in]
+ *          The absolute tolerance for floating point values.
+ *
+ *      rel_epsilon [in]
+ *          The relative tolerance for floating point values.
+ *
+ *      reference [in]
+ *          The reference implementation.
+ *
+ *      optimized [in]
+ *          The optimized implementation.
+ *
+ *      generators [in]
+ *          The generators of the inputs, one for each argument of the
+ *          implementations.
+ *
+ *  Returns:
+ *      True if the assertion is true, else false.
+ *
+ *  Comments:
+ *      The throughput of both implementations is noted on the line reporting
+ *      the test, and is also reported on failure.
+ */
+template<typename Reference, typename Optimized, typename... Generators>
+bool AssertEquivalent(const char *file,
+                      const std::size_t line,
+                      long double abs_epsilon,
+                      long double rel_epsilon,
+                      Reference reference,
+                      Optimized optimized,
+                      const Generators &...generators)
+{
+    using Args = std::tuple<typename Generators::Value...>;
+    using Output = std::decay_t<
+        std::invoke_result_t<Reference &,
+                             const typename Generators::Value &...>>;
+    using OptimizedOutput = std::decay_t<
+        std::invoke_result_t<Optimized &,
+                             const typename Generators::Value &...>>;
+
+    static_assert(std::is_same<Output, OptimizedOutput>::value,
+                  "Both implementations must return the same type");
+
+    struct Failure
+    {
+        std::size_t index;
+        Args args;
+        std::string output;
+    };
+
+    // Run both implementations on a case, recording a failure if their
+    // outputs differ
+    auto compare = [&](const Args &args)
+    {
+        const Output expected = std::apply(reference, args);
+        const Output actual = std::apply(optimized, args);
+
+        if (IsEquivalent(expected, actual, abs_epsilon, rel_epsilon)) return;
+
+        PrintDivergence(expected, actual, abs_epsilon, rel_epsilon);
+        RecordFailure();
+    };
+
+    TestContext *parent = CurrentContext();
+    const std::uint64_t seed = NewPropertySeed();
+    const auto deadline = WorkDeadline();
+    const auto stop_time =
+        std::min(deadline,
+                 std::chrono::steady_clock::now() +
+                     std::chrono::seconds(Differential_Seconds));
+
+    std::atomic<std::size_t> next_index{};
+    std::atomic<std::size_t> compared{};
+    std::atomic<std::size_t> compared_octets{};
+    std::atomic<std::int64_t> reference_time{};
+    std::atomic<std::int64_t> optimized_time{};
+    std::atomic<bool> failed{};
+    std::mutex failure_mutex;
+    std::optional<Failure> failure;
+
+    auto note_failure = [&](std::size_t index, Args args, std::string output)
+    {
+        std::lock_guard<std::mutex> lock(failure_mutex);
+        if (!failure || (index < failure->index))
+        {
+            failure = Failure{index, std::move(args), std::move(output)};
+        }
+        failed = true;
+    };
+
+    auto worker = [&]()
+    {
+        std::vector<Args> inputs;
+        std::vector<Output> expected;
+        std::vector<Output> actual;
+
+        inputs.reserve(Differential_Batch);
+        expected.reserve(Differential_Batch);
+        actual.reserve(Differential_Batch);
+
+        while (!failed.load(std::memory_order_relaxed) &&
+               (std::chrono::steady_clock::now() < stop_time))
+        {
+            std::size_t first = next_index.fetch_add(Differential_Batch);
+            if (first >= Differential_Cases) break;
+
+            std::size_t count =
+                std::min(Differential_Batch, Differential_Cases - first);
+            std::size_t octets = 0;
+
+            // Produce the inputs of the batch from each case's stream
+            inputs.clear();
+            for (std::size_t i = 0; i < count; i++)
+            {
+                PropertyRandom random(seed, first + i);
+                std::size_t size = (first + i) % (Max_Property_Size + 1);
+                inputs.push_back(Args{generators.Generate(random, size)...});
+                octets += InputOctets(inputs.back());
+            }
+
+            // Time each implementation over the whole batch, alternating
+            // which runs first
+            const bool reference_first = (first / Differential_Batch) % 2 == 0;
+            std::chrono::nanoseconds batch_reference_time{};
+            std::chrono::nanoseconds batch_optimized_time{};
+            expected.clear();
+            actual.clear();
+            try
+            {
+                auto run_reference = [&]()
+                {
+                    for (const auto &args : inputs)
+                    {
+                        expected.push_back(std::apply(reference, args));
+                    }
+                };
+                auto run_optimized = [&]()
+                {
+                    for (const auto &args : inputs)
+                    {
+                        actual.push_back(std::apply(optimized, args));
+                    }
+                };
+
+                auto time = [](auto &run) -> std::chrono::nanoseconds
+                {
+                    auto start = std::chrono::steady_clock::now();
+                    run();
+                    return std::chrono::steady_clock::now() - start;
+                };
+
+                if (reference_first)
+                {
+                    batch_reference_time = time(run_reference);
+                    batch_optimized_time = time(run_optimized);
+                }
+                else
+                {
+                    batch_optimized_time = time(run_optimized);
+                    batch_reference_time = time(run_reference);
+                }
+            }
+            catch (...)
+            {
+                // Find the first case that throws, reporting it as a failure
+                for (std::size_t i = 0; i < count; i++)
+                {
+                    std::string output;
+
+                    if (PropertyCaseFails(compare, inputs[i], parent, output))
+                    {
+                        note_failure(first + i,
+                                     std::move(inputs[i]),
+                                     std::move(output));
+                        break;
+                    }
+                }
+                continue;
+            }
+
+            bool diverged = false;
+            for (std::size_t i = 0; i < count; i++)
+            {
+                if (IsEquivalent(expected[i],
+                                 actual[i],
+                                 abs_epsilon,
+                                 rel_epsilon))
+                {
+                    continue;
+                }
+
+                // Capture the output produced when comparing the case alone
+                std::string output;
+                PropertyCaseFails(compare, inputs[i], parent, output);
+                note_failure(first + i, std::move(inputs[i]), output);
+                diverged = true;
+                break;
+            }
+
+            // Count only batches of equivalent cases in the throughput
+            if (diverged) continue;
+
+            compared += count;
+            compared_octets += octets;
+            reference_time += batch_reference_time.count();
+            optimized_time += batch_optimized_time.count();
+        }
+    };
+
+    // Run the cases on the workers, including the calling thread
+    RunOnWorkers(WorkerThreads(), worker);
+
+    // Note the throughput of both implementations and the speedup
+    auto print_throughput = [&]()
+    {
+        PendingOutput().Text("reference: ");
+        PrintThroughput(compared,
+                        compared_octets,
+                        std::chrono::nanoseconds(reference_time.load()));
+        PendingOutput().Text(", optimized: ");
+        PrintThroughput(compared,
+                        compared_octets,
+                        std::chrono::nanoseconds(optimized_time.load()));
+        PendingOutput().Text(", speedup: ")
+                       .Float(static_cast<double>(reference_time.load()) /
+                                  std::max(optimized_time.load(),
+                                           std::int64_t(1)),
+                              3)
+                       .Character('x');
+    };
+
+    if (!failure)
+    {
+        PendingOutput().Text(" [").Decimal(compared.load()).Text(" cases; ");
+        print_throughput();
+        PendingOutput().Character(']');
+        CommitOutput();
+        return true;
+    }
+
+    // Replace the inputs with simpler inputs while the outputs still differ
+    std::size_t shrinks = MinimizeCase(compare,
+                                       std::tie(generators...),
+                                       failure->args,
+                                       parent,
+                                       failure->output,
+                                       deadline);
+
+    // Report the outputs for the simplest diverging case and its inputs
+    if (!PrintAssertFailed(file, line)) return false;
+    PendingOutput().Text(failure->output)
+                   .Text("Implementations differ on case ")
+                   .Decimal(failure->index + 1)
+                   .Text(" after ")
+                   .Decimal(shrinks)
+                   .Text(" shrink(s); inputs:")
+                   .NewLine();
+    PrintCaseInputs(failure->args, seed);
+    PendingOutput().Text("Throughput over ")
+                   .Decimal(compared.load())
+                   .Text(" equivalent case(s): ");
+    print_throughput();
+    PendingOutput().NewLine();
+
+    return false;
+}
+
+} // namespace Terra::STF
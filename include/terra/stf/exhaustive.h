@@ -0,0 +1,217 @@
+/*
+ *  exhaustive.h
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Support for tests run with every value of a 32-bit (or 16-bit)
+ *      input.  A test defined with STF_EXHAUSTIVE_U32 is called with each of
+ *      the 2^32 values, available in the test body as "value":
+ *
+ *          STF_EXHAUSTIVE_U32(Math, Sqrt)
+ *          {
+ *              float x;
+ *              std::memcpy(&x, &value, sizeof(x));
+ *              STF_ASSERT_EQ(std::sqrt(x), FastSqrt(x));
+ *          }
+ *
+ *      The domain is split into 4096 chunks that are run on a number of
+ *      worker threads (see WorkerThreads()), each thread taking chunks from
+ *      its own queue and stealing from others when its queue is empty.
+ *      Progress is written to stderr periodically, and the number of values
+ *      tested and the aggregate throughput are noted on the line reporting
+ *      the test.  A failed assertion stops the test, which reports the
+ *      smallest failing value found.
+ *
+ *      If the environment variable STF_CHECKPOINT_DIR names a directory,
+ *      each completed chunk is recorded in a checkpoint file there, named
+ *      for the test, and a run that was killed or stopped resumes with the
+ *      chunks that were not completed.  The checkpoint file is removed once
+ *      all chunks pass.
+ *
+ *      If the environment variable STF_SHARD is set to "i/n" (e.g., "0/4"),
+ *      only shard i of n shards of the domain (every nth chunk, starting
+ *      with the ith) is tested, so the domain may be split across machines
+ *      or processes.  The test's timeout, which covers the whole domain, is
+ *      divided by n.
+ *
+ *  Portability Issues:
+ *      Requires C++17 or greater.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <string>
+#include <terra/stf/stf.h>
+
+// Macro to define a test called with every 32-bit value
+#define STF_EXHAUSTIVE_U32(group, test) \
+    STF_EXHAUSTIVE_U32_TIMEOUT(group, test, Terra::STF::Exhaustive_Timeout)
+
+// Macro to define an exhaustive 32-bit test with a timeout in seconds
+#define STF_EXHAUSTIVE_U32_TIMEOUT(group, test, timeout) \
+    STF_INTERNAL_EXHAUSTIVE(group, test, std::uint32_t, timeout)
+
+// Macro to define a test called with every 16-bit value
+#define STF_EXHAUSTIVE_U16(group, test) \
+    STF_INTERNAL_EXHAUSTIVE(group, test, std::uint16_t, \
+                            Terra::STF::Default_Timeout)
+
+#define STF_INTERNAL_EXHAUSTIVE(group, test, type, timeout) \
+    void STF_Exhaustive_ ## group ## _ ## test(type value); \
+    STF_TEST_TIMEOUT(group, test, Terra::STF::ShardTimeout(timeout)) \
+    { \
+        Terra::STF::RunExhaustive<type>( \
+            Terra::STF::ExhaustiveDefaults(#group "::" #test, \
+                                           std::numeric_limits<type>::digits), \
+            [](type value) { STF_Exhaustive_ ## group ## _ ## test(value); }); \
+    } \
+    void STF_Exhaustive_ ## group ## _ ## test(type value)
+
+namespace Terra::STF
+{
+
+// Default timeout for STF_EXHAUSTIVE_U32 tests, covering the whole domain
+constexpr unsigned Exhaustive_Timeout = 3600;
+
+// Base-2 logarithm of the number of chunks into which a domain is split
+constexpr unsigned Exhaustive_Chunk_Bits = 12;
+
+// Settings for an exhaustive test
+struct ExhaustiveOptions
+{
+    unsigned bits;                      // Number of bits in the input
+    std::size_t shard_index;            // Index of the shard to test
+    std::size_t shard_count;            // Number of shards
+    std::string checkpoint;             // Checkpoint file; empty for none
+};
+
+// Function that tests the values in a chunk, returning the first value at
+// which a failure was recorded, or the end of the chunk if none
+using ExhaustiveChunk =
+    std::function<std::uint64_t(std::uint64_t first, std::uint64_t last)>;
+
+/*
+ *  ShardTimeout()
+ *
+ *  Description:
+ *      Return the timeout for an exhaustive test, scaled for the number of
+ *      shards given by the STF_SHARD environment variable.
+ *
+ *  Parameters:
+ *      timeout [in]
+ *          The timeout in seconds for testing the whole domain.
+ *
+ *  Returns:
+ *      The timeout in seconds for testing one shard.
+ *
+ *  Comments:
+ *      None.
+ */
+unsigned ShardTimeout(unsigned timeout);
+
+/*
+ *  ExhaustiveDefaults()
+ *
+ *  Description:
+ *      Return the settings for an exhaustive test as given by the
+ *      STF_SHARD and STF_CHECKPOINT_DIR environment variables.
+ *
+ *  Parameters:
+ *      name [in]
+ *          The name of the test, used to name the checkpoint file.
+ *
+ *      bits [in]
+ *          The number of bits in the input.
+ *
+ *  Returns:
+ *      The settings.
+ *
+ *  Comments:
+ *      None.
+ */
+ExhaustiveOptions ExhaustiveDefaults(const std::string &name, unsigned bits);
+
+/*
+ *  RunChunks()
+ *
+ *  Description:
+ *      Run the chunks of an exhaustive test's domain on a pool of worker
+ *      threads, resuming from and recording completed chunks in the
+ *      checkpoint file, and report the outcome to the calling thread's
+ *      current context.
+ *
+ *  Parameters:
+ *      options [in]
+ *          The settings for the test.
+ *
+ *      chunk [in]
+ *          The function that tests the values in a chunk.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      Each chunk is run in a context of its own.  This is used by tests
+ *      defined with STF_EXHAUSTIVE_U32.
+ */
+void RunChunks(const ExhaustiveOptions &options, const ExhaustiveChunk &chunk);
+
+/*
+ *  RunExhaustive()
+ *
+ *  Description:
+ *      Call the given function with every value of an input of the given
+ *      type, as done for tests defined with STF_EXHAUSTIVE_U32.
+ *
+ *  Parameters:
+ *      options [in]
+ *          The settings for the test.
+ *
+ *      function [in]
+ *          The function to call with each value.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      The function is called directly in the loop over each chunk so that
+ *      it may be inlined.
+ */
+template<typename T, typename Function>
+void RunExhaustive(const ExhaustiveOptions &options, Function function)
+{
+    RunChunks(options,
+              [&](std::uint64_t first, std::uint64_t last) -> std::uint64_t
+              {
+                  TestContext *context = CurrentContext();
+                  std::uint64_t value = first;
+
+                  try
+                  {
+                      for (; value < last; value++)
+                      {
+                          function(static_cast<T>(value));
+                          if (context->Failed()) return value;
+                      }
+                  }
+                  catch (...)
+                  {
+                      ReportUnexpectedException();
+                  }
+
+                  return value;
+              });
+}
+
+} // namespace Terra::STF
@@ -0,0 +1,145 @@
+/*
+ *  fuzz.h
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Support for fuzz targets that are also run as ordinary tests.  A fuzz
+ *      target is defined with STF_FUZZ, followed by the parameters and body
+ *      of a libFuzzer-style function:
+ *
+ *          STF_FUZZ(Parser, Packet)(const std::uint8_t *data, std::size_t size)
+ *          {
+ *              Packet packet;
+ *              if (!packet.Parse(data, size)) return;
+ *              STF_ASSERT_EQ(size, packet.Serialize().size());
+ *          }
+ *
+ *      This registers a test that replays every file in the target's corpus
+ *      directory, so a corpus accumulated by a fuzzer can be replayed on any
+ *      machine with no fuzzer runtime.  The corpus directory is named by the
+ *      group and test (e.g., "Parser/Packet"), or given explicitly with
+ *      STF_FUZZ_CORPUS.  A relative directory is relative to the directory
+ *      named by the environment variable STF_CORPUS_DIR, if set, else to the
+ *      current directory.  If the directory does not exist, the test passes
+ *      and notes that there was no corpus.
+ *
+ *      Each file is memory-mapped and passed to the function as an instance
+ *      of the test (see parameterized.h), so files are replayed in parallel
+ *      and each failing file is reported by name.
+ *
+ *      When STF_FUZZER is defined, both for this file and for the STF
+ *      library (e.g., by configuring with stf_FUZZER=ON), the STF main()
+ *      function is omitted and STF_FUZZ also defines LLVMFuzzerTestOneInput()
+ *      to call the function, so the same source may be linked into a fuzzer
+ *      built with "-fsanitize=fuzzer".  A failed assertion then prints its
+ *      output and aborts so the fuzzer records the input as a crash.  Only
+ *      one STF_FUZZ target may appear in such a program.
+ *
+ *  Portability Issues:
+ *      Requires C++17 or greater.  Files are memory-mapped on POSIX systems
+ *      and read into memory elsewhere.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <terra/stf/stf.h>
+
+// Macro to define a fuzz target replaying the corpus in "Group/Test"
+#define STF_FUZZ(group, test) STF_FUZZ_CORPUS(group, test, #group "/" #test)
+
+// Macro to define a fuzz target replaying the corpus in the given directory
+#define STF_FUZZ_CORPUS(group, test, directory) \
+    void STF_Fuzz_ ## group ## _ ## test(const std::uint8_t *, std::size_t); \
+    STF_TEST(group, test) \
+    { \
+        Terra::STF::ReplayCorpus(directory, STF_Fuzz_ ## group ## _ ## test); \
+    } \
+    STF_INTERNAL_FUZZ_ENTRY(group, test) \
+    void STF_Fuzz_ ## group ## _ ## test
+
+#if defined(STF_FUZZER)
+#define STF_INTERNAL_FUZZ_ENTRY(group, test) \
+    extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data, \
+                                          std::size_t size) \
+    { \
+        return Terra::STF::RunFuzzInput(#group "::" #test, \
+                                        STF_Fuzz_ ## group ## _ ## test, \
+                                        data, \
+                                        size); \
+    }
+#else
+#define STF_INTERNAL_FUZZ_ENTRY(group, test)
+#endif
+
+namespace Terra::STF
+{
+
+// Function called with each input to a fuzz target
+using FuzzFunction = void (*)(const std::uint8_t *data, std::size_t size);
+
+/*
+ *  ReplayCorpus()
+ *
+ *  Description:
+ *      Call a fuzz target's function with the contents of each file in the
+ *      given corpus directory, as done for tests defined with STF_FUZZ.
+ *
+ *  Parameters:
+ *      directory [in]
+ *          The corpus directory, which is searched recursively.
+ *
+ *      function [in]
+ *          The fuzz target's function.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      Files are replayed as the instances of a parameterized test, ordered
+ *      by path.  A file that cannot be read is a failure.
+ */
+void ReplayCorpus(const std::string &directory, FuzzFunction function);
+
+/*
+ *  RunFuzzInput()
+ *
+ *  Description:
+ *      Call a fuzz target's function with one input provided by a fuzzer,
+ *      as done by the LLVMFuzzerTestOneInput() function defined by STF_FUZZ
+ *      when STF_FUZZER is defined.
+ *
+ *  Parameters:
+ *      name [in]
+ *          The name of the fuzz target.
+ *
+ *      function [in]
+ *          The fuzz target's function.
+ *
+ *      data [in]
+ *          The input.
+ *
+ *      size [in]
+ *          The length of the input in octets.
+ *
+ *  Returns:
+ *      Zero, as libFuzzer requires.
+ *
+ *  Comments:
+ *      If an assertion fails or an exception is thrown, the output is
+ *      written to stderr and the program is aborted.
+ */
+int RunFuzzInput(const char *name,
+                 FuzzFunction function,
+                 const std::uint8_t *data,
+                 std::size_t size);
+
+} // namespace Terra::STF
@@ -0,0 +1,359 @@
+/*
+ *  guarded_buffer.h
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Support for testing vectorized kernels at the ends of buffers and at
+ *      every alignment.  A GuardedBuffer is placed next to an inaccessible
+ *      guard page, either after its end or before its start, so a kernel
+ *      that reads or writes past that end touches the guard page.
+ *      RunGuarded() calls a function and, rather than letting the program
+ *      crash, reports the address at which a guard page was touched.
+ *
+ *      SweepAlignments() calls a kernel and a reference implementation for
+ *      every alignment of the input (modulo Guard_Alignment octets) and
+ *      every length of input up to the size of a source vector, with the
+ *      guard page after and then before the input, and reports each
+ *      (alignment, length) pair for which the kernel touched a guard page
+ *      or returned a result different from the reference:
+ *
+ *          STF_TEST(Checksum, Sweep)
+ *          {
+ *              std::vector<std::uint8_t> data(1024);
+ *              std::iota(data.begin(), data.end(), 0);
+ *
+ *              Terra::STF::SweepAlignments(data, ChecksumAVX2,
+ *                                          ChecksumScalar);
+ *          }
+ *
+ *      SweepTransform() does the same for kernels that write an output of
+ *      the same length as the input, with both the input and the output
+ *      guarded.  The pairs are run as the instances of a parameterized test
+ *      (see parameterized.h), so they are run in parallel and the failing
+ *      pairs are reported in order.
+ *
+ *      A buffer starts at the requested alignment and, with the guard page
+ *      after it, ends as close to the guard page as that alignment allows;
+ *      octets between the buffer and the guard page hold a known pattern so
+ *      that writes to them are detected.  Since guard pages are aligned,
+ *      every length is tested flush against the guard page at one alignment
+ *      in each sweep, and one-octet over-reads are caught there.
+ *
+ *  Portability Issues:
+ *      Requires C++17 or greater.  Guard pages are used on POSIX systems;
+ *      elsewhere, only writes outside of a buffer are detected.  A kernel
+ *      that touches a guard page is abandoned without unwinding, so any
+ *      resources it acquired are leaked.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <terra/stf/stf.h>
+#include <terra/stf/parameterized.h>
+
+namespace Terra::STF
+{
+
+// Alignments from zero up to this number of octets are swept
+constexpr std::size_t Guard_Alignment = 64;
+
+// Side of a buffer on which the guard page is placed
+enum class GuardSide
+{
+    After,
+    Before
+};
+
+/*
+ *  GuardedBuffer
+ *
+ *  Description:
+ *      A buffer of a given size at a given alignment placed next to an
+ *      inaccessible guard page.
+ *
+ *  Comments:
+ *      The contents of the buffer are initially zero.
+ */
+class GuardedBuffer
+{
+    public:
+        GuardedBuffer(std::size_t size,
+                      std::size_t alignment = 0,
+                      GuardSide side = GuardSide::After);
+        ~GuardedBuffer();
+
+        GuardedBuffer(const GuardedBuffer &) = delete;
+        GuardedBuffer &operator=(const GuardedBuffer &) = delete;
+
+        std::uint8_t *Data() noexcept { return data; }
+        const std::uint8_t *Data() const noexcept { return data; }
+        std::size_t Size() const noexcept { return size; }
+
+        bool Intact() const noexcept;
+        std::string Locate(std::uintptr_t address) const;
+
+    protected:
+        std::uint8_t *region;
+        std::size_t region_size;
+        std::uint8_t *accessible;
+        std::size_t accessible_size;
+        std::uint8_t *data;
+        std::size_t size;
+        std::vector<std::uint8_t> storage;
+};
+
+/*
+ *  RunGuarded()
+ *
+ *  Description:
+ *      Call the given function, stopping it if it touches a guard page.
+ *
+ *  Parameters:
+ *      function [in]
+ *          The function to call.
+ *
+ *  Returns:
+ *      The faulting address if the function touched a guard page or
+ *      otherwise faulted, else nothing.
+ *
+ *  Comments:
+ *      A function that faults is abandoned without unwinding its stack.
+ *      Where guard pages are not used, the function is simply called.
+ */
+std::optional<std::uintptr_t> RunGuarded(
+    const std::function<void()> &function);
+
+/*
+ *  PrintGuardFault()
+ *
+ *  Description:
+ *      Print the location at which a guard page was touched relative to the
+ *      buffers of a sweep.
+ *
+ *  Parameters:
+ *      address [in]
+ *          The address that was touched.
+ *
+ *      buffers [in]
+ *          The names and buffers of the sweep.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+// Names and buffers among which a fault is located
+using GuardedBuffers =
+    std::vector<std::pair<const char *, const GuardedBuffer *>>;
+void PrintGuardFault(std::uintptr_t address, const GuardedBuffers &buffers);
+
+/*
+ *  RunSweep()
+ *
+ *  Description:
+ *      Run the cases of an alignment sweep as the instances of a
+ *      parameterized test, as done by SweepAlignments() and SweepTransform().
+ *
+ *  Parameters:
+ *      max_length [in]
+ *          The largest length to test.
+ *
+ *      element_size [in]
+ *          The size of an element; alignments are multiples of it.
+ *
+ *      run [in]
+ *          The function that runs the case with the given guard side,
+ *          alignment in octets, and length in elements.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void RunSweep(
+    std::size_t max_length,
+    std::size_t element_size,
+    const std::function<void(GuardSide, std::size_t, std::size_t)> &run);
+
+/*
+ *  SweepAlignments()
+ *
+ *  Description:
+ *      Compare a kernel with a reference implementation for every alignment
+ *      and length of input, reporting each pair for which the kernel touches
+ *      a guard page or returns a different result.
+ *
+ *  Parameters:
+ *      source [in]
+ *          The input, of which the first "length" elements are passed for
+ *          each length from zero to the size of the source.
+ *
+ *      kernel [in]
+ *          The kernel, called as kernel(data, length).
+ *
+ *      reference [in]
+ *          The reference implementation, called the same way.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      Alignments are multiples of the size of T.
+ */
+template<typename T, typename Kernel, typename Reference>
+void SweepAlignments(const std::vector<T> &source,
+                     Kernel kernel,
+                     Reference reference)
+{
+    RunSweep(
+        source.size(),
+        sizeof(T),
+        [&](GuardSide side, std::size_t alignment, std::size_t length)
+        {
+            GuardedBuffer input(length * sizeof(T), alignment, side);
+            if (length > 0)
+            {
+                std::memcpy(input.Data(), source.data(), length * sizeof(T));
+            }
+            const T *data = reinterpret_cast<const T *>(input.Data());
+
+            const auto expected = reference(source.data(), length);
+            std::optional<std::decay_t<decltype(expected)>> actual;
+
+            auto fault = RunGuarded(
+                [&] { actual.emplace(kernel(data, length)); });
+            if (fault)
+            {
+                PrintGuardFault(*fault, {{"input", &input}});
+                RecordFailure();
+                return;
+            }
+
+            if (!input.Intact())
+            {
+                PendingOutput().NewLine()
+                               .Text("Octets next to the input were modified")
+                               .NewLine();
+                RecordFailure();
+            }
+
+            if (!(expected == *actual))
+            {
+                PendingOutput().NewLine()
+                               .Text("Result differs from the reference")
+                               .NewLine();
+                PrintValue("  expected: ", expected);
+                PrintValue("    actual: ", *actual);
+                RecordFailure();
+            }
+        });
+}
+
+/*
+ *  SweepTransform()
+ *
+ *  Description:
+ *      Compare a kernel that writes an output of the same length as its
+ *      input with a reference implementation for every alignment and length
+ *      of input, reporting each pair for which the kernel touches a guard
+ *      page, writes outside of the output, or writes a different output.
+ *
+ *  Parameters:
+ *      source [in]
+ *          The input, of which the first "length" elements are passed for
+ *          each length from zero to the size of the source.
+ *
+ *      kernel [in]
+ *          The kernel, called as kernel(input, output, length).
+ *
+ *      reference [in]
+ *          The reference implementation, called the same way.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      The input and output have the same alignment.  Alignments are
+ *      multiples of the size of T.
+ */
+template<typename T, typename Kernel, typename Reference>
+void SweepTransform(const std::vector<T> &source,
+                    Kernel kernel,
+                    Reference reference)
+{
+    RunSweep(
+        source.size(),
+        sizeof(T),
+        [&](GuardSide side, std::size_t alignment, std::size_t length)
+        {
+            GuardedBuffer input(length * sizeof(T), alignment, side);
+            GuardedBuffer output(length * sizeof(T), alignment, side);
+            std::vector<T> expected(length);
+            if (length > 0)
+            {
+                std::memcpy(input.Data(), source.data(), length * sizeof(T));
+            }
+            const T *in = reinterpret_cast<const T *>(input.Data());
+            T *out = reinterpret_cast<T *>(output.Data());
+
+            reference(source.data(), expected.data(), length);
+
+            auto fault = RunGuarded([&] { kernel(in, out, length); });
+            if (fault)
+            {
+                PrintGuardFault(*fault,
+                                {{"input", &input}, {"output", &output}});
+                RecordFailure();
+                return;
+            }
+
+            if (!input.Intact() || !output.Intact())
+            {
+                PendingOutput().NewLine()
+                               .Text("Octets next to the ")
+                               .Text(input.Intact() ? "output" : "input")
+                               .Text(" were modified")
+                               .NewLine();
+                RecordFailure();
+            }
+
+            if ((length > 0) && (std::memcmp(expected.data(),
+                                             output.Data(),
+                                             length * sizeof(T)) != 0))
+            {
+                std::size_t index = 0;
+                while (std::memcmp(&expected[index],
+                                   output.Data() + index * sizeof(T),
+                                   sizeof(T)) == 0)
+                {
+                    index++;
+                }
+
+                PendingOutput().NewLine()
+                               .Text("Output differs from the reference at "
+                                     "element ")
+                               .Decimal(index)
+                               .NewLine();
+                RecordFailure();
+            }
+        });
+}
+
+} // namespace Terra::STF
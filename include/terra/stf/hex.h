@@ -0,0 +1,146 @@
+/*
+ *  hex.h
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Functions to turn a string of hexadecimal digits into an std::array of
+ *      octets at compile time, so that known-answer data written as hex in a
+ *      test costs nothing at run time:
+ *
+ *          constexpr auto key = Terra::STF::HexArray(
+ *              "000102030405060708090a0b0c0d0e0f");
+ *
+ *      With C++20, the same is written with the user-defined literal _hex,
+ *      which is always evaluated at compile time:
+ *
+ *          using namespace Terra::STF::Literals;
+ *
+ *          auto key = "000102030405060708090a0b0c0d0e0f"_hex;
+ *
+ *      A string with an odd number of digits does not compile.  A character
+ *      that is not a hexadecimal digit is a compile error only when the array
+ *      is evaluated at compile time (i.e., it is constexpr or made with _hex);
+ *      otherwise, HexArray() throws std::invalid_argument at run time.  Long
+ *      values may be split over several adjacent string literals.  The
+ *      resulting arrays are printed as hex when an assertion fails if
+ *      adapters/integral_array.h is included.
+ *
+ *  Portability Issues:
+ *      Requires C++17 or greater.  The _hex literal requires C++20.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+namespace Terra::STF
+{
+
+// Tables used by HexArray() and in decoding known-answer files; not part of
+// the public interface
+namespace detail
+{
+
+// Marks characters that are not hexadecimal digits
+inline constexpr std::uint8_t Not_Hex = 0xff;
+
+// Table mapping characters to the values of hexadecimal digits
+inline constexpr std::array<std::uint8_t, 256> Hex_Values = []()
+{
+    std::array<std::uint8_t, 256> values{};
+
+    for (auto &value : values) value = Not_Hex;
+    for (unsigned i = 0; i < 10; i++) values['0' + i] = i;
+    for (unsigned i = 0; i < 6; i++)
+    {
+        values['a' + i] = 10 + i;
+        values['A' + i] = 10 + i;
+    }
+
+    return values;
+}();
+
+} // namespace detail
+
+/*
+ *  HexArray()
+ *
+ *  Description:
+ *      Convert a string literal of hexadecimal digits into octets.
+ *
+ *  Parameters:
+ *      text [in]
+ *          The hexadecimal digits, two per octet, in either case.
+ *
+ *  Returns:
+ *      The octets.
+ *
+ *  Comments:
+ *      Throws std::invalid_argument if a character is not a hexadecimal
+ *      digit, which is a compile error when evaluated at compile time.
+ */
+template<std::size_t N>
+constexpr std::array<std::uint8_t, N / 2> HexArray(const char (&text)[N])
+{
+    static_assert(N % 2 == 1, "Hex strings need two digits per octet");
+
+    std::array<std::uint8_t, N / 2> octets{};
+
+    for (std::size_t i = 0; i < octets.size(); i++)
+    {
+        const std::uint8_t high =
+            detail::Hex_Values[static_cast<unsigned char>(text[2 * i])];
+        const std::uint8_t low =
+            detail::Hex_Values[static_cast<unsigned char>(text[2 * i + 1])];
+
+        if ((high | low) == detail::Not_Hex)
+        {
+            throw std::invalid_argument("Invalid hexadecimal digit");
+        }
+
+        octets[i] = static_cast<std::uint8_t>((high << 4) | low);
+    }
+
+    return octets;
+}
+
+#if defined(__cpp_nontype_template_args) && \
+    (__cpp_nontype_template_args >= 201911L) && \
+    defined(__cpp_consteval) && (__cpp_consteval >= 201811L)
+
+// String literal usable as a template argument by the _hex literal
+template<std::size_t N>
+struct HexLiteral
+{
+    constexpr HexLiteral(const char (&literal)[N])
+    {
+        for (std::size_t i = 0; i < N; i++) text[i] = literal[i];
+    }
+
+    char text[N]{};
+};
+
+namespace Literals
+{
+
+// Literal producing the octets of a string of hexadecimal digits
+template<HexLiteral literal>
+consteval auto operator""_hex()
+{
+    return HexArray(literal.text);
+}
+
+} // namespace Literals
+
+#endif
+
+} // namespace Terra::STF
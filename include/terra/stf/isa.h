@@ -0,0 +1,227 @@
+/*
+ *  isa.h
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Support for testing code that selects kernels at run time according
+ *      to the instruction set extensions of the CPU.  A test defined with
+ *      STF_TEST_ISA is run for each ISA level supported by the host, from
+ *      ISALevel::Scalar up to the best level available:
+ *
+ *          STF_TEST_ISA(Checksum, Compute)
+ *          {
+ *              STF_ASSERT_EQ(0x1234, Checksum(data, sizeof(data)));
+ *          }
+ *
+ *      While each level runs, ISALimit() returns that level.  A library's
+ *      dispatcher consults ISAEnabled() (in test builds) before choosing a
+ *      kernel, so that the fallback paths are exercised:
+ *
+ *          if (Terra::STF::ISAEnabled(Terra::STF::ISALevel::AVX2) &&
+ *              CPUHasAVX2())
+ *          {
+ *              return ChecksumAVX2;
+ *          }
+ *
+ *      The dispatcher must make this choice on each call (or each time the
+ *      limit changes), rather than caching its first choice.  Each level is
+ *      reported to a context of its own, named by appending "/" and the
+ *      name of the level to the test's name (e.g., "Checksum::Compute/avx2"),
+ *      and every level is run even if some fail.  The body is run once at
+ *      each level, and the time at each level and the speedup over the
+ *      scalar level are noted on the line reporting the test.
+ *
+ *      A test defined with STF_TEST_ISA_TIMED instead runs each level up to
+ *      ISA_Timing_Runs times, the first run warming caches and branch
+ *      predictors, and notes the shortest time, so that the speedup is not
+ *      skewed by the cold first run.  Its body must give the same result
+ *      when run more than once.
+ *
+ *      If the environment variable STF_ISA names a level (e.g., "sse4"), no
+ *      level above it is used by any test, so a whole run may be made as if
+ *      on an older CPU.
+ *
+ *  Portability Issues:
+ *      Requires C++17 or greater.  ISA levels above Scalar are detected for
+ *      x86 processors when compiling with GCC or Clang; elsewhere, only the
+ *      scalar level is reported as available.  Tests run one at a time, so
+ *      the limit applies to all threads of the running test.
+ */
+
+#pragma once
+
+#include <functional>
+#include <terra/stf/stf.h>
+
+// Macro to define a test run once per ISA level available on the host
+#define STF_TEST_ISA(group, test) \
+    void STF_ISA_ ## group ## _ ## test(); \
+    STF_TEST(group, test) \
+    { \
+        Terra::STF::RunISALevels(STF_ISA_ ## group ## _ ## test); \
+    } \
+    void STF_ISA_ ## group ## _ ## test()
+
+// Macro to define a test run once per ISA level, timing the best of several
+// runs at each level
+#define STF_TEST_ISA_TIMED(group, test) \
+    void STF_ISA_ ## group ## _ ## test(); \
+    STF_TEST(group, test) \
+    { \
+        Terra::STF::RunISALevels(STF_ISA_ ## group ## _ ## test, \
+                                 Terra::STF::ISA_Timing_Runs); \
+    } \
+    void STF_ISA_ ## group ## _ ## test()
+
+namespace Terra::STF
+{
+
+// Number of times each ISA level of an STF_TEST_ISA_TIMED test is run, the
+// shortest time being reported
+constexpr unsigned ISA_Timing_Runs = 3;
+
+// Levels of instruction set extensions, in increasing order of capability
+enum class ISALevel : unsigned
+{
+    Scalar,                             // No vector extensions
+    SSE4,                               // SSE4.2
+    AVX2,                               // AVX2
+    AVX512                              // AVX-512 F and BW
+};
+
+/*
+ *  ISAName()
+ *
+ *  Description:
+ *      Return the name of the given ISA level.
+ *
+ *  Parameters:
+ *      level [in]
+ *          The ISA level.
+ *
+ *  Returns:
+ *      The name of the level (e.g., "avx2"), as used in test names and in
+ *      the STF_ISA environment variable.
+ *
+ *  Comments:
+ *      None.
+ */
+const char *ISAName(ISALevel level);
+
+/*
+ *  HostISALevel()
+ *
+ *  Description:
+ *      Return the best ISA level the host supports, limited by the STF_ISA
+ *      environment variable if it is set.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The best ISA level available.
+ *
+ *  Comments:
+ *      None.
+ */
+ISALevel HostISALevel();
+
+/*
+ *  ISALimit()
+ *
+ *  Description:
+ *      Return the best ISA level that code under test may use.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The level set by the innermost ISALimitScope, else HostISALevel().
+ *
+ *  Comments:
+ *      This is the hook a library's dispatcher consults to have a given
+ *      level used.
+ */
+ISALevel ISALimit();
+
+/*
+ *  ISAEnabled()
+ *
+ *  Description:
+ *      Determine whether code under test may use the given ISA level.
+ *
+ *  Parameters:
+ *      level [in]
+ *          The ISA level a kernel requires.
+ *
+ *  Returns:
+ *      True if the level is no greater than ISALimit().
+ *
+ *  Comments:
+ *      None.
+ */
+inline bool ISAEnabled(ISALevel level)
+{
+    return level <= ISALimit();
+}
+
+/*
+ *  ISALimitScope
+ *
+ *  Description:
+ *      Limits the ISA level that code under test may use to the given level
+ *      for the lifetime of this object, after which the previous limit is
+ *      restored.
+ *
+ *  Comments:
+ *      The limit is shared by all threads.  This is used by tests defined
+ *      with STF_TEST_ISA.
+ */
+class ISALimitScope
+{
+    public:
+        explicit ISALimitScope(ISALevel level) noexcept;
+        ISALimitScope(const ISALimitScope &) = delete;
+        ~ISALimitScope();
+
+        ISALimitScope &operator=(const ISALimitScope &) = delete;
+
+    protected:
+        int previous;
+};
+
+/*
+ *  RunISALevels()
+ *
+ *  Description:
+ *      Run the given function for each ISA level up to HostISALevel(), each
+ *      level limited with ISALimitScope and reporting to a context of its
+ *      own, and report the time taken at each level and the levels that
+ *      fail to the calling thread's current context.
+ *
+ *  Parameters:
+ *      function [in]
+ *          The function to run.
+ *
+ *      runs [in]
+ *          The number of times the function is run at each level.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      Levels are run one after another so that their times are comparable.
+ *      When runs is greater than one, the shortest time is reported, so that
+ *      the first, cold run does not skew the speedup; a level stops being
+ *      run once it fails or the test nears its timeout.  This is used by
+ *      tests defined with STF_TEST_ISA and STF_TEST_ISA_TIMED.
+ */
+void RunISALevels(const std::function<void()> &function, unsigned runs = 1);
+
+} // namespace Terra::STF
@@ -0,0 +1,196 @@
+/*
+ *  kat.h
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Support for known-answer tests read from files in the format of the
+ *      NIST CAVP response (.rsp) and request (.req) files, rather than
+ *      transcribed into source code.  A test defined with STF_TEST_KAT is
+ *      run once for each vector in the file, with the vector available in
+ *      the test body as "param":
+ *
+ *          STF_TEST_KAT(AES, ECBVarKey, "aes/ECBVarKey128.rsp")
+ *          {
+ *              auto key = param.Hex("KEY");
+ *              STF_ASSERT_EQ(param.Hex("CIPHERTEXT"),
+ *                            Encrypt(key, param.Hex("PLAINTEXT")));
+ *          }
+ *
+ *      A vector is a block of "name = value" lines ended by a blank line,
+ *      such as:
+ *
+ *          [ENCRYPT]
+ *
+ *          COUNT = 0
+ *          KEY = 80000000000000000000000000000000
+ *          PLAINTEXT = 00000000000000000000000000000000
+ *          CIPHERTEXT = 0edd33d3c621e546455bd8ba1418bec8
+ *
+ *      Lines in square brackets (e.g., "[ENCRYPT]" or "[L = 20]") are
+ *      headers that apply to the vectors that follow, up to the next
+ *      headers.  Lines beginning with "#" are comments.  Names are matched
+ *      without regard to case.
+ *
+ *      The file is memory-mapped and tokenized in place, so the values of a
+ *      vector refer to the mapped file rather than copies.  The vectors are
+ *      run in parallel as the instances of a parameterized test (see
+ *      parameterized.h), and each failing vector is reported with its file,
+ *      line, headers, and COUNT.  Relative paths are taken relative to the
+ *      directory named by the STF_KAT_DIR environment variable, if set.  A
+ *      file that cannot be read causes the test to fail.
+ *
+ *  Portability Issues:
+ *      Requires C++17 or greater.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <terra/stf/stf.h>
+#include <terra/stf/parameterized.h>
+
+// Macro to define a test run once for each vector in a known-answer file
+#define STF_TEST_KAT(group, test, path) \
+    STF_TEST_P(group, test, Terra::STF::LoadKnownAnswers(path))
+
+namespace Terra::STF
+{
+
+// A file from which known answers were read (defined in kat.cpp)
+struct KnownAnswerSource;
+
+// A "name = value" line of a known-answer file
+struct KnownAnswerField
+{
+    std::string_view name;              // Name, without surrounding spaces
+    std::string_view value;             // Value, without surrounding spaces
+    std::size_t line;                   // Line number in the file
+};
+
+/*
+ *  KnownAnswer
+ *
+ *  Description:
+ *      A vector read from a known-answer file, with the headers in effect
+ *      where it appears.
+ *
+ *  Comments:
+ *      Names are matched without regard to case.  Functions that look up a
+ *      field throw std::invalid_argument, naming the file and line, if the
+ *      field is missing or its value is malformed.  Hex() decodes a field
+ *      once and keeps the octets with the vector, so a vector must not be
+ *      used by more than one thread at a time (as is the case for tests
+ *      defined with STF_TEST_KAT).
+ */
+class KnownAnswer
+{
+    public:
+        KnownAnswer(std::shared_ptr<const KnownAnswerSource> source,
+                    std::vector<KnownAnswerField> headers,
+                    std::vector<KnownAnswerField> fields);
+
+        const std::string &File() const;
+        std::size_t Line() const;
+
+        const std::vector<KnownAnswerField> &Headers() const noexcept
+        {
+            return headers;
+        }
+        const std::vector<KnownAnswerField> &Fields() const noexcept
+        {
+            return fields;
+        }
+
+        bool Has(std::string_view name) const;
+        bool HasHeader(std::string_view name) const;
+        std::string_view Text(std::string_view name) const;
+        std::string_view Header(std::string_view name) const;
+        std::uint64_t Number(std::string_view name) const;
+        const std::vector<std::uint8_t> &Hex(std::string_view name) const;
+
+    protected:
+        const KnownAnswerField &Find(std::string_view name) const;
+
+        std::shared_ptr<const KnownAnswerSource> source;
+        std::vector<KnownAnswerField> headers;
+        std::vector<KnownAnswerField> fields;
+        mutable std::vector<std::optional<std::vector<std::uint8_t>>> decoded;
+};
+
+/*
+ *  operator<<()
+ *
+ *  Description:
+ *      Print the location of a known-answer vector, as in
+ *      "aes.rsp:12 [ENCRYPT] COUNT = 0".
+ *
+ *  Parameters:
+ *      stream [in]
+ *          The stream to which to print.
+ *
+ *      vector [in]
+ *          The vector to print.
+ *
+ *  Returns:
+ *      The stream.
+ *
+ *  Comments:
+ *      This identifies a failing vector in a test's output.
+ */
+std::ostream &operator<<(std::ostream &stream, const KnownAnswer &vector);
+
+/*
+ *  LoadKnownAnswers()
+ *
+ *  Description:
+ *      Read the vectors in the given known-answer file.
+ *
+ *  Parameters:
+ *      path [in]
+ *          The path of the file, relative to STF_KAT_DIR if that is set.
+ *
+ *  Returns:
+ *      The vectors, in the order they appear in the file.
+ *
+ *  Comments:
+ *      Throws std::runtime_error if the file cannot be read.  This is used
+ *      by tests defined with STF_TEST_KAT.
+ */
+std::vector<KnownAnswer> LoadKnownAnswers(const std::string &path);
+
+/*
+ *  DecodeHex()
+ *
+ *  Description:
+ *      Decode a string of hexadecimal digits into octets.
+ *
+ *  Parameters:
+ *      text [in]
+ *          The hexadecimal digits, two per octet, in either case.
+ *
+ *      octets [out]
+ *          The decoded octets, replacing its contents.  Its storage is
+ *          reused, so a buffer decoded into repeatedly is allocated once.
+ *
+ *  Returns:
+ *      True if the text was valid, else false.
+ *
+ *  Comments:
+ *      None.
+ */
+bool DecodeHex(std::string_view text, std::vector<std::uint8_t> &octets);
+
+} // namespace Terra::STF
@@ -0,0 +1,744 @@
+/*
+ *  linearizability.h
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Facilities to verify that a concurrent object behaves as if each
+ *      operation took effect atomically at some instant between its
+ *      invocation and its response (i.e., that it is linearizable).
+ *
+ *      A test records the operations performed on the object under test in
+ *      a History.  Each thread records into its own log, so recording does
+ *      not require locking.  Each invocation and each response is stamped
+ *      from a shared atomic counter, which gives a total order consistent
+ *      with real time:
+ *
+ *          Terra::STF::History<QueueModel> history(threads, capacity);
+ *
+ *          // On thread "t"
+ *          history.Call(t, QueueModel::Push(5),
+ *                       [&] { queue.Push(5); return QueueModel::Result{}; });
+ *
+ *      Once all threads have finished, the history is checked against a
+ *      sequential model of the object:
+ *
+ *          STF_ASSERT_LINEARIZABLE(history);
+ *
+ *      A model is a type providing the following members:
+ *
+ *          using State = ...;       // Copyable and equality comparable
+ *          using Operation = ...;   // Copyable description of an operation
+ *          using Result = ...;      // Copyable result of an operation
+ *
+ *          // Apply the operation to the state, returning false if the
+ *          // result could not have been produced by the operation
+ *          static bool Step(State &state,
+ *                           const Operation &operation,
+ *                           const Result &result);
+ *
+ *      The initial state is a default-constructed State.  An operation that
+ *      was invoked but has not returned (e.g., because its thread is blocked
+ *      or was abandoned) may or may not have taken effect, so it may be
+ *      linearized at any point after its invocation, or not at all.  To
+ *      linearize such an operation, the model must provide the following,
+ *      which applies the operation giving whatever result it would produce;
+ *      otherwise, pending operations are omitted from the check:
+ *
+ *          static bool Step(State &state, const Operation &operation);
+ *
+ *      If the model also provides the following, operations having
+ *      different keys are assumed to be independent (e.g., operations on
+ *      different keys of a map) and each set of operations is checked
+ *      separately (P-compositionality), which greatly reduces the cost of
+ *      checking:
+ *
+ *          static Key Partition(const Operation &operation);
+ *
+ *      The check is a depth-first search for a valid order of operations,
+ *      as described by Wing and Gong, with states already explored being
+ *      remembered so that they are not searched again (as suggested by
+ *      Lowe).  If the history is not linearizable, the operation that could
+ *      not be linearized is identified and the other operations are reduced
+ *      to a minimal subset that still prevents it from being linearized, and
+ *      that subset is reported.  The search is abandoned, and the assertion
+ *      fails, if it does not complete before WorkDeadline(), so that the
+ *      outcome is reported before the test exceeds its timeout.
+ *
+ *      If the Operation and Result types have streaming operators, they
+ *      should be defined before including this file, as for stf.h.
+ *
+ *  Portability Issues:
+ *      Requires C++17 or greater.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <optional>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <terra/stf/stf.h>
+
+// Macro to test that a recorded history is linearizable
+#define STF_ASSERT_LINEARIZABLE(history) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertLinearizable(__FILE__, __LINE__, (history)), \
+        STF_INTERNAL_FATAL)
+
+// Non-fatal macro to test that a recorded history is linearizable
+#define STF_EXPECT_LINEARIZABLE(history) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertLinearizable(__FILE__, __LINE__, (history)), \
+        STF_INTERNAL_NONFATAL)
+
+namespace Terra::STF
+{
+
+// Outcome of checking a history for linearizability
+enum class Linearizability
+{
+    Linearizable,
+    NotLinearizable,
+    TimedOut,
+    Overflowed
+};
+
+/*
+ *  History
+ *
+ *  Description:
+ *      Records the operations performed on a concurrent object by a fixed
+ *      number of threads.  Each thread is identified by an index and has its
+ *      own log with a fixed capacity, so recording an operation requires no
+ *      locking or memory allocation beyond copying the operation.
+ *
+ *  Comments:
+ *      Each thread index must be used by only one thread at a time.  The
+ *      history must not be examined until all recording threads have been
+ *      joined or otherwise synchronized with the examining thread.  If a log
+ *      is full, further operations are not recorded and the history is
+ *      marked as overflowed, which causes the check to fail.
+ */
+template<typename Model>
+class History
+{
+    public:
+        using Operation = typename Model::Operation;
+        using Result = typename Model::Result;
+
+        // Token indicating an operation was not recorded
+        static constexpr std::size_t Not_Recorded =
+            std::numeric_limits<std::size_t>::max();
+
+        // Record of a single operation
+        struct Event
+        {
+            Operation operation;
+            std::optional<Result> result;
+            std::uint64_t invoked;
+            std::uint64_t responded;
+        };
+
+        History(std::size_t threads, std::size_t capacity) :
+            capacity{capacity},
+            logs(threads),
+            clock{},
+            overflowed{}
+        {
+            for (auto &log : logs) log.events.reserve(capacity);
+        }
+        History(const History &) = delete;
+        ~History() = default;
+
+        History &operator=(const History &) = delete;
+
+        std::size_t Invoke(std::size_t thread, const Operation &operation)
+        {
+            std::vector<Event> &events = logs.at(thread).events;
+
+            if (events.size() >= capacity)
+            {
+                overflowed.store(true, std::memory_order_relaxed);
+                return Not_Recorded;
+            }
+
+            events.push_back({operation, std::nullopt, ++clock, 0});
+
+            return events.size() - 1;
+        }
+
+        void Respond(std::size_t thread,
+                     std::size_t token,
+                     const Result &result)
+        {
+            if (token == Not_Recorded) return;
+
+            Event &event = logs.at(thread).events.at(token);
+
+            event.result = result;
+            event.responded = ++clock;
+        }
+
+        template<typename F>
+        Result Call(std::size_t thread, const Operation &operation, F &&perform)
+        {
+            std::size_t token = Invoke(thread, operation);
+            Result result = perform();
+            Respond(thread, token, result);
+
+            return result;
+        }
+
+        void Clear()
+        {
+            for (auto &log : logs) log.events.clear();
+            overflowed = false;
+        }
+
+        std::size_t Threads() const noexcept { return logs.size(); }
+        bool Overflowed() const noexcept { return overflowed; }
+        const std::vector<Event> &Events(std::size_t thread) const
+        {
+            return logs.at(thread).events;
+        }
+
+    protected:
+        // Each log is written by one thread, so keep them on separate lines
+        struct alignas(64) Log
+        {
+            std::vector<Event> events;
+        };
+
+        const std::size_t capacity;
+        std::vector<Log> logs;
+        std::atomic<std::uint64_t> clock;
+        std::atomic<bool> overflowed;
+};
+
+// Determine whether a model can apply an operation whose result is unknown
+template<typename Model, typename = void>
+struct HasPendingStep : std::false_type
+{
+};
+
+template<typename Model>
+struct HasPendingStep<
+    Model,
+    std::void_t<decltype(Model::Step(
+        std::declval<typename Model::State &>(),
+        std::declval<const typename Model::Operation &>()))>> :
+    std::true_type
+{
+};
+
+// Determine whether a model partitions operations into independent sets
+template<typename Model, typename = void>
+struct HasPartition : std::false_type
+{
+};
+
+template<typename Model>
+struct HasPartition<Model,
+                    std::void_t<decltype(Model::Partition(
+                        std::declval<const typename Model::Operation &>()))>> :
+    std::true_type
+{
+};
+
+/*
+ *  LinearizabilityChecker
+ *
+ *  Description:
+ *      Checks whether a History is linearizable with respect to its model
+ *      and, if not, finds a minimal subset of the operations that is not
+ *      linearizable.
+ *
+ *  Comments:
+ *      The history must outlive this object.
+ */
+template<typename Model>
+class LinearizabilityChecker
+{
+    public:
+        using State = typename Model::State;
+        using Operation = typename Model::Operation;
+        using Result = typename Model::Result;
+
+        // Response time given to operations that have not returned
+        static constexpr std::uint64_t Pending =
+            std::numeric_limits<std::uint64_t>::max();
+
+        // An operation taken from the history; the result is null and the
+        // response time is Pending if the operation has not returned
+        struct Record
+        {
+            std::size_t thread;
+            const Operation *operation;
+            const Result *result;
+            std::uint64_t invoked;
+            std::uint64_t responded;
+        };
+
+        LinearizabilityChecker(const History<Model> &history,
+                               State initial,
+                               std::chrono::steady_clock::time_point deadline) :
+            history{history},
+            initial{std::move(initial)},
+            deadline{deadline}
+        {
+            // Nothing to do
+        }
+        ~LinearizabilityChecker() = default;
+
+        Linearizability Check()
+        {
+            violation.clear();
+
+            if (history.Overflowed()) return Linearizability::Overflowed;
+
+            for (auto &records : Partitions())
+            {
+                std::size_t blocked = 0;
+                Linearizability outcome = Search(records, &blocked);
+
+                if (outcome == Linearizability::NotLinearizable)
+                {
+                    violation = Minimize(records, blocked);
+                }
+
+                if (outcome != Linearizability::Linearizable) return outcome;
+            }
+
+            return Linearizability::Linearizable;
+        }
+
+        const std::vector<Record> &Violation() const noexcept
+        {
+            return violation;
+        }
+
+    protected:
+        using Bits = std::vector<std::uint64_t>;
+        using Buckets =
+            std::unordered_map<std::uint64_t, std::vector<std::size_t>>;
+
+        // Gather the operations, split into independent sets; operations
+        // that have not returned are included only if the model can apply
+        // them without a result
+        std::vector<std::vector<Record>> Partitions() const
+        {
+            std::vector<Record> records;
+
+            for (std::size_t thread = 0; thread < history.Threads(); thread++)
+            {
+                for (const auto &event : history.Events(thread))
+                {
+                    if (event.result.has_value())
+                    {
+                        records.push_back({thread,
+                                           &event.operation,
+                                           &*event.result,
+                                           event.invoked,
+                                           event.responded});
+                    }
+                    else if constexpr (HasPendingStep<Model>::value)
+                    {
+                        records.push_back({thread,
+                                           &event.operation,
+                                           nullptr,
+                                           event.invoked,
+                                           Pending});
+                    }
+                }
+            }
+
+            if constexpr (HasPartition<Model>::value)
+            {
+                using Key = std::decay_t<decltype(Model::Partition(
+                    std::declval<const Operation &>()))>;
+
+                std::map<Key, std::vector<Record>> partitions;
+
+                for (const auto &record : records)
+                {
+                    partitions[Model::Partition(*record.operation)].push_back(
+                        record);
+                }
+
+                std::vector<std::vector<Record>> result;
+                for (auto &[key, partition] : partitions)
+                {
+                    result.push_back(std::move(partition));
+                }
+
+                return result;
+            }
+            else
+            {
+                return {std::move(records)};
+            }
+        }
+
+        // Search for a linearization of the given operations; if there is
+        // none, "blocked" (if given) receives the index of the operation that
+        // could not be linearized in the longest partial linearization found
+        Linearizability Search(const std::vector<Record> &records,
+                               std::size_t *blocked = nullptr) const
+        {
+            const std::size_t count = records.size();
+            const std::size_t head = 2 * count;
+
+            // Order the invocations and responses by time; entry 2i is the
+            // invocation of operation i and 2i + 1 is its response.  The
+            // responses of pending operations come after all others.
+            std::vector<std::pair<std::uint64_t, std::size_t>> order;
+            order.reserve(2 * count);
+            for (std::size_t i = 0; i < count; i++)
+            {
+                order.emplace_back(records[i].invoked, 2 * i);
+                order.emplace_back(records[i].responded, 2 * i + 1);
+            }
+            std::sort(order.begin(), order.end());
+
+            // Form a circular doubly-linked list of entries, in time order
+            std::vector<std::size_t> next(2 * count + 1);
+            std::vector<std::size_t> prev(2 * count + 1);
+            std::size_t last = head;
+            for (const auto &[time, entry] : order)
+            {
+                next[last] = entry;
+                prev[entry] = last;
+                last = entry;
+            }
+            next[last] = head;
+            prev[head] = last;
+
+            auto unlink = [&](std::size_t entry)
+            {
+                next[prev[entry]] = next[entry];
+                prev[next[entry]] = prev[entry];
+            };
+            auto relink = [&](std::size_t entry)
+            {
+                next[prev[entry]] = entry;
+                prev[next[entry]] = entry;
+            };
+
+            struct Frame
+            {
+                std::size_t operation;
+                State state;
+            };
+
+            Bits linearized((count + 63) / 64);
+            Buckets buckets;
+            std::vector<std::pair<Bits, State>> explored;
+            std::vector<Frame> stack;
+            State state = initial;
+            std::size_t entry = next[head];
+            std::size_t steps = 0;
+            std::size_t deepest = 0;
+
+            while (next[head] != head)
+            {
+                if (((++steps % 1024) == 0) &&
+                    (std::chrono::steady_clock::now() >= deadline))
+                {
+                    return Linearizability::TimedOut;
+                }
+
+                // Reaching the response of a pending operation means every
+                // operation that returned has been linearized, and the
+                // remaining pending operations are taken not to have occurred
+                if (((entry % 2) == 1) &&
+                    (records[entry / 2].responded == Pending))
+                {
+                    return Linearizability::Linearizable;
+                }
+
+                // Reaching a response means its operation must have been
+                // linearized already, so undo the most recent choice
+                if ((entry % 2) == 1)
+                {
+                    if ((blocked != nullptr) && (stack.size() + 1 > deepest))
+                    {
+                        deepest = stack.size() + 1;
+                        *blocked = entry / 2;
+                    }
+
+                    if (stack.empty()) return Linearizability::NotLinearizable;
+
+                    Frame frame = std::move(stack.back());
+                    stack.pop_back();
+
+                    std::size_t i = frame.operation;
+                    state = std::move(frame.state);
+                    linearized[i / 64] &= ~(std::uint64_t(1) << (i % 64));
+                    relink(2 * i + 1);
+                    relink(2 * i);
+                    entry = next[2 * i];
+
+                    continue;
+                }
+
+                // Try to linearize this operation next
+                std::size_t i = entry / 2;
+                State candidate = state;
+
+                if (Apply(candidate, records[i]))
+                {
+                    linearized[i / 64] |= std::uint64_t(1) << (i % 64);
+
+                    if (Remember(buckets, explored, linearized, candidate))
+                    {
+                        stack.push_back({i, std::move(state)});
+                        state = std::move(candidate);
+                        unlink(2 * i);
+                        unlink(2 * i + 1);
+                        entry = next[head];
+
+                        continue;
+                    }
+
+                    linearized[i / 64] &= ~(std::uint64_t(1) << (i % 64));
+                }
+
+                entry = next[entry];
+            }
+
+            return Linearizability::Linearizable;
+        }
+
+        // Apply an operation to the state, returning false if its result
+        // could not have been produced
+        static bool Apply(State &state, const Record &record)
+        {
+            if constexpr (HasPendingStep<Model>::value)
+            {
+                if (record.result == nullptr)
+                {
+                    return Model::Step(state, *record.operation);
+                }
+            }
+
+            return Model::Step(state, *record.operation, *record.result);
+        }
+
+        // Record that the given configuration has been explored, returning
+        // false if it was explored previously
+        static bool Remember(Buckets &buckets,
+                             std::vector<std::pair<Bits, State>> &explored,
+                             const Bits &linearized,
+                             const State &state)
+        {
+            // FNV-1a over the words of the bitset
+            std::uint64_t hash = 14695981039346656037ULL;
+            for (std::uint64_t word : linearized)
+            {
+                hash = (hash ^ word) * 1099511628211ULL;
+            }
+
+            std::vector<std::size_t> &bucket = buckets[hash];
+
+            for (std::size_t index : bucket)
+            {
+                if ((explored[index].first == linearized) &&
+                    (explored[index].second == state))
+                {
+                    return false;
+                }
+            }
+
+            bucket.push_back(explored.size());
+            explored.emplace_back(linearized, state);
+
+            return true;
+        }
+
+        // Remove operations while the remainder is still not linearizable.
+        // The operation that could not be linearized is always retained, as
+        // otherwise removing (for example) a write could produce a different
+        // violation involving a read that was correct in the full history.
+        std::vector<Record> Minimize(const std::vector<Record> &records,
+                                     std::size_t blocked) const
+        {
+            std::vector<Record> others;
+            others.reserve(records.size() - 1);
+            for (std::size_t i = 0; i < records.size(); i++)
+            {
+                if (i != blocked) others.push_back(records[i]);
+            }
+
+            // The remaining operations must still be unable to linearize the
+            // same operation, not merely be non-linearizable
+            auto violates = [&](std::vector<Record> candidate)
+            {
+                std::size_t stuck = 0;
+                candidate.push_back(records[blocked]);
+                return (Search(candidate, &stuck) ==
+                        Linearizability::NotLinearizable) &&
+                       (stuck == candidate.size() - 1);
+            };
+
+            // Removing one operation may allow another to be removed (e.g., a
+            // write once the read of its value is gone), so single operations
+            // are tried repeatedly until none can be removed
+            std::size_t chunk = std::max<std::size_t>(others.size() / 2, 1);
+            bool removed = true;
+
+            while (!others.empty() && ((chunk > 1) || removed))
+            {
+                removed = false;
+
+                for (std::size_t start = 0; start < others.size();)
+                {
+                    if (std::chrono::steady_clock::now() >= deadline) break;
+
+                    std::size_t end = std::min(start + chunk, others.size());
+                    std::vector<Record> candidate;
+                    candidate.reserve(others.size() - (end - start));
+                    candidate.insert(candidate.end(),
+                                     others.begin(),
+                                     others.begin() + start);
+                    candidate.insert(candidate.end(),
+                                     others.begin() + end,
+                                     others.end());
+
+                    if (violates(candidate))
+                    {
+                        others = std::move(candidate);
+                        removed = true;
+                    }
+                    else
+                    {
+                        start = end;
+                    }
+                }
+
+                if (std::chrono::steady_clock::now() >= deadline) break;
+
+                chunk = std::max<std::size_t>(chunk / 2, 1);
+            }
+
+            // Present the operations in the order they were invoked
+            others.push_back(records[blocked]);
+            std::sort(others.begin(),
+                      others.end(),
+                      [](const Record &a, const Record &b)
+                      {
+                          return a.invoked < b.invoked;
+                      });
+
+            return others;
+        }
+
+        const History<Model> &history;
+        const State initial;
+        const std::chrono::steady_clock::time_point deadline;
+        std::vector<Record> violation;
+};
+
+/*
+ *  AssertLinearizable()
+ *
+ *  Description:
+ *      Test that the given history is linearizable with respect to its
+ *      model, starting from the given initial state.
+ *
+ *  Parameters:
+ *      file [in]
+ *          The name of the file where the test exists.
+ *
+ *      line [in]
+ *          The line number where the test failed.
+ *
+ *      history [in]
+ *          The history of operations to check.
+ *
+ *      initial [in]
+ *          The state of the object before any operations were performed.
+ *
+ *  Returns:
+ *      True if the assertion is true, else false.
+ *
+ *  Comments:
+ *      If the history is not linearizable, a minimal set of operations that
+ *      is not linearizable is reported, giving for each the thread that
+ *      performed it and the times of its invocation and response, or that it
+ *      had not returned.
+ */
+template<typename Model>
+bool AssertLinearizable(const char *file,
+                        const std::size_t line,
+                        const History<Model> &history,
+                        const typename Model::State &initial = {})
+{
+    LinearizabilityChecker<Model> checker(history, initial, WorkDeadline());
+
+    Linearizability outcome = checker.Check();
+
+    if (outcome == Linearizability::Linearizable) return true;
+
+    if (!PrintAssertFailed(file, line)) return false;
+
+    Formatter &output = PendingOutput();
+
+    switch (outcome)
+    {
+        case Linearizability::NotLinearizable:
+            output.Text("  history is not linearizable; minimal violating "
+                        "sub-history of ")
+                  .Decimal(checker.Violation().size())
+                  .Text(" operation(s):")
+                  .NewLine();
+            for (const auto &record : checker.Violation())
+            {
+                PendingOutput().Text("  thread ")
+                               .Decimal(record.thread)
+                               .Text(", time ")
+                               .Decimal(record.invoked);
+                if (record.result == nullptr)
+                {
+                    PendingOutput().Text(", not returned").NewLine();
+                    PrintValue("    operation: ", *record.operation);
+                    continue;
+                }
+                PendingOutput().Text(" to ")
+                               .Decimal(record.responded)
+                               .NewLine();
+                PrintValue("    operation: ", *record.operation);
+                PrintValue("       result: ", *record.result);
+            }
+            break;
+
+        case Linearizability::TimedOut:
+            output.Text("  linearizability check did not complete before "
+                        "the test deadline")
+                  .NewLine();
+            break;
+
+        default:
+            output.Text("  history capacity exceeded; operations were not "
+                        "recorded")
+                  .NewLine();
+            break;
+    }
+
+    return false;
+}
+
+} // namespace Terra::STF
@@ -0,0 +1,486 @@
+/*
+ *  parameterized.h
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Support for value- and type-parameterized tests.  A test defined with
+ *      STF_TEST_P is run once for each value produced by a generator, with
+ *      the value available in the test body as "param":
+ *
+ *          STF_TEST_P(AES, KnownAnswer, LoadVectors("aes.txt"))
+ *          {
+ *              STF_ASSERT_EQ(param.ciphertext, Encrypt(param.key,
+ *                                                      param.plaintext));
+ *          }
+ *
+ *      The generator may be any container or range, or one of the lazy
+ *      generators returned by Range() and Generate(), which produce each
+ *      value only when it is needed:
+ *
+ *          STF_TEST_P(Math, Sqrt, Terra::STF::Range(0, 1000000))
+ *          STF_TEST_P(Math, Squares,
+ *                     Terra::STF::Generate(100, [](std::size_t i)
+ *                                               { return i * i; }))
+ *
+ *      The generator expression is not evaluated until the test runs, so
+ *      defining a test over a very large set of values costs nothing at
+ *      program start.  Each value is an instance of the test, named by
+ *      appending "/" and the index of the value to the test's name (e.g.,
+ *      "AES::KnownAnswer/17").  Instances are run in parallel on a number of
+ *      worker threads, each instance reporting to a context of its own, and
+ *      every instance is run even if some fail.  The failing instances are
+ *      reported in order, with the value of the parameter if it can be
+ *      printed.  The test timeout applies to all instances together.
+ *
+ *      The number of worker threads is the number of hardware threads, or
+ *      the value of the environment variable STF_JOBS if it is set.
+ *      Instances must therefore not depend on one another.
+ *
+ *      Tests to be run for each of several types are defined with
+ *      STF_TEST_TYPED, naming a list of types, with the type available in the
+ *      test body as "TypeParam":
+ *
+ *          STF_TEST_TYPED(Codec, RoundTrip,
+ *                         Terra::STF::Types<std::uint8_t, std::uint16_t>)
+ *          {
+ *              TypeParam value = std::numeric_limits<TypeParam>::max();
+ *              STF_ASSERT_EQ(value, Decode<TypeParam>(Encode(value)));
+ *          }
+ *
+ *      The body is instantiated for each type at compile time and each
+ *      instantiation is registered as a separate test, named by appending
+ *      the name of the type in angle brackets to the test's name (e.g.,
+ *      "Codec::RoundTrip<unsigned char>").
+ *
+ *  Portability Issues:
+ *      Requires C++17 or greater.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <typeinfo>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <terra/stf/stf.h>
+
+// Macro to define a test run once for each value the generator produces
+#define STF_TEST_P(group, test, ...) \
+    STF_TEST_P_TIMEOUT(group, test, Terra::STF::Default_Timeout, __VA_ARGS__)
+
+// Macro to define a parameterized test with a timeout in seconds
+#define STF_TEST_P_TIMEOUT(group, test, timeout, ...) \
+    template<typename Param> \
+    void STF_Test_Param_ ## group ## _ ## test(const Param &param); \
+    STF_TEST_TIMEOUT(group, test, timeout) \
+    { \
+        Terra::STF::RunParameterized( \
+            __VA_ARGS__, \
+            [](const auto &param) \
+            { \
+                STF_Test_Param_ ## group ## _ ## test(param); \
+            }); \
+    } \
+    template<typename Param> \
+    void STF_Test_Param_ ## group ## _ ## test(const Param &param)
+
+// Macro to define a test registered once for each type in a list of types
+#define STF_TEST_TYPED(group, test, ...) \
+    STF_TEST_TYPED_TIMEOUT(group, \
+                           test, \
+                           Terra::STF::Default_Timeout, \
+                           __VA_ARGS__)
+
+// Macro to define a type-parameterized test with a timeout in seconds
+#define STF_TEST_TYPED_TIMEOUT(group, test, timeout, ...) \
+    template<typename TypeParam> \
+    void STF_Test_Typed_ ## group ## _ ## test(); \
+    const std::size_t STF_Test_ID_ ## group ## _ ## test = \
+        Terra::STF::RegisterTypedTests( \
+            #group "::" #test, \
+            [](auto type) \
+            { \
+                return STF_Test_Typed_ ## group ## _ ## test< \
+                    typename decltype(type)::Type>; \
+            }, \
+            __VA_ARGS__{}, \
+            timeout); \
+    template<typename TypeParam> \
+    void STF_Test_Typed_ ## group ## _ ## test()
+
+namespace Terra::STF
+{
+
+/*
+ *  RangeGenerator
+ *
+ *  Description:
+ *      A generator of the integers first, first + step, ... up to but not
+ *      including last.
+ *
+ *  Comments:
+ *      Values are computed as they are requested.  Arithmetic is done in the
+ *      unsigned type corresponding to T, so a range may span all values of
+ *      T.  Throws std::invalid_argument if step is not positive.
+ */
+template<typename T>
+class RangeGenerator
+{
+    public:
+        RangeGenerator(T first, T last, T step) :
+            first{first},
+            count{},
+            step{step}
+        {
+            if (!(step > T(0)))
+            {
+                throw std::invalid_argument("Range step must be positive");
+            }
+
+            if (last > first)
+            {
+                count = static_cast<std::size_t>(
+                    (static_cast<Unsigned>(last) -
+                     static_cast<Unsigned>(first) - 1) /
+                        static_cast<Unsigned>(step) +
+                    1);
+            }
+        }
+
+        std::size_t size() const noexcept { return count; }
+        T operator[](std::size_t index) const
+        {
+            return static_cast<T>(static_cast<Unsigned>(first) +
+                                  static_cast<Unsigned>(index) *
+                                      static_cast<Unsigned>(step));
+        }
+
+    protected:
+        // Unsigned type of T, or unsigned int if T would be promoted
+        using Unsigned =
+            std::common_type_t<std::make_unsigned_t<T>, unsigned>;
+
+        T first;
+        std::size_t count;
+        T step;
+};
+
+/*
+ *  IndexedGenerator
+ *
+ *  Description:
+ *      A generator of a given number of values, each produced by calling a
+ *      function with the index of the value.
+ *
+ *  Comments:
+ *      The function may be called from several threads at once.
+ */
+template<typename Function>
+class IndexedGenerator
+{
+    public:
+        IndexedGenerator(std::size_t count, Function function) :
+            count{count},
+            function(std::move(function))
+        {
+            // Nothing to do
+        }
+
+        std::size_t size() const noexcept { return count; }
+        auto operator[](std::size_t index) const { return function(index); }
+
+    protected:
+        std::size_t count;
+        Function function;
+};
+
+/*
+ *  Range()
+ *
+ *  Description:
+ *      Return a generator of the integers from first up to but not including
+ *      last, incrementing by step.
+ *
+ *  Parameters:
+ *      first [in]
+ *          The first value.
+ *
+ *      last [in]
+ *          The value at which to stop.
+ *
+ *      step [in]
+ *          The positive increment between values.
+ *
+ *  Returns:
+ *      The generator.
+ *
+ *  Comments:
+ *      Throws std::invalid_argument if step is not positive.
+ */
+template<typename T,
+         typename std::enable_if<std::is_integral<T>::value, bool>::type =
+             true>
+RangeGenerator<T> Range(T first, T last, T step = T(1))
+{
+    return RangeGenerator<T>(first, last, step);
+}
+
+/*
+ *  Generate()
+ *
+ *  Description:
+ *      Return a generator of count values, where the value at each index is
+ *      produced by calling the given function with that index.
+ *
+ *  Parameters:
+ *      count [in]
+ *          The number of values to produce.
+ *
+ *      function [in]
+ *          The function producing each value.
+ *
+ *  Returns:
+ *      The generator.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename Function>
+IndexedGenerator<Function> Generate(std::size_t count, Function function)
+{
+    return IndexedGenerator<Function>(count, std::move(function));
+}
+
+/*
+ *  RunInstances()
+ *
+ *  Description:
+ *      Run the given number of instances of a parameterized test on a number
+ *      of worker threads, each instance reporting to a context of its own,
+ *      and report the instances that fail to the calling thread's current
+ *      context.
+ *
+ *  Parameters:
+ *      count [in]
+ *          The number of instances.
+ *
+ *      run [in]
+ *          The function that runs the instance having the given index.
+ *
+ *      describe [in]
+ *          The function that prints the parameter of the instance having the
+ *          given index, called only for instances that fail.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      This is used by tests defined with STF_TEST_P.
+ */
+void RunInstances(std::size_t count,
+                  const std::function<void(std::size_t)> &run,
+                  const std::function<void(std::size_t)> &describe);
+
+// Determine whether values of a generator can be retrieved by index
+template<typename Generator, typename = void>
+struct IsIndexable : std::false_type
+{
+};
+
+template<typename Generator>
+struct IsIndexable<Generator,
+                   decltype(std::declval<const Generator &>().size(),
+                            std::declval<const Generator &>()[std::size_t{}],
+                            void())> : std::true_type
+{
+};
+
+/*
+ *  RunParameterized()
+ *
+ *  Description:
+ *      Run the given function once for each value produced by a generator,
+ *      as done for tests defined with STF_TEST_P.
+ *
+ *  Parameters:
+ *      generator [in]
+ *          A generator, container, or range of values.
+ *
+ *      function [in]
+ *          The function to call with each value.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      Values of generators that cannot be retrieved by index (e.g., those
+ *      of a std::list) are first copied into a vector.
+ */
+template<typename Generator, typename Function>
+void RunParameterized(Generator &&generator, Function function)
+{
+    using Type = std::remove_cv_t<std::remove_reference_t<Generator>>;
+
+    if constexpr (IsIndexable<Type>::value)
+    {
+        const Type &values = generator;
+
+        RunInstances(
+            values.size(),
+            [&](std::size_t index) { function(values[index]); },
+            [&](std::size_t index)
+            {
+                const auto &value = values[index];
+                PrintValue("  parameter: ", value);
+            });
+    }
+    else
+    {
+        using Value = std::decay_t<decltype(*std::begin(generator))>;
+
+        const std::vector<Value> values(std::begin(generator),
+                                        std::end(generator));
+
+        RunParameterized(values, std::move(function));
+    }
+}
+
+// A list of types over which a test defined with STF_TEST_TYPED is run
+template<typename... T>
+struct Types
+{
+};
+
+// Tag identifying a type, used when registering typed tests
+template<typename T>
+struct TypeTag
+{
+    using Type = T;
+};
+
+/*
+ *  TypeName()
+ *
+ *  Description:
+ *      Return the name of the given type as written by the compiler.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The name of the type (e.g., "unsigned int").
+ *
+ *  Comments:
+ *      The name is extracted at compile time from the function signature the
+ *      compiler provides.  Compilers that do not provide one yield the
+ *      implementation-defined name from std::type_info.
+ */
+template<typename T>
+constexpr std::string_view TypeName() noexcept
+{
+#if defined(__clang__) || defined(__GNUC__)
+    constexpr std::string_view signature = __PRETTY_FUNCTION__;
+    constexpr std::string_view prefix = "T = ";
+    constexpr std::size_t start = signature.find(prefix) + prefix.size();
+    constexpr std::size_t end = signature.find_first_of(";]", start);
+
+    return signature.substr(start, end - start);
+#elif defined(_MSC_VER)
+    constexpr std::string_view signature = __FUNCSIG__;
+    constexpr std::string_view prefix = "TypeName<";
+    constexpr std::size_t start = signature.find(prefix) + prefix.size();
+    constexpr std::size_t end = signature.rfind(">(void)");
+
+    return signature.substr(start, end - start);
+#else
+    return {};
+#endif
+}
+
+/*
+ *  RegisterTypedTests()
+ *
+ *  Description:
+ *      Register a test for each type in the given list of types, as done for
+ *      tests defined with STF_TEST_TYPED.
+ *
+ *  Parameters:
+ *      name [in]
+ *          The name of the test, to which the name of each type is appended.
+ *
+ *      instantiate [in]
+ *          A function that, given a TypeTag, returns a pointer to the test
+ *          function instantiated for that type.
+ *
+ *      types [in]
+ *          The list of types.
+ *
+ *      timeout [in]
+ *          Time after which each test will assume to have stalled and the
+ *          test will be aborted.
+ *
+ *  Returns:
+ *      An identifier for the last registered test.  If zero is returned, it
+ *      means one of the tests could not be registered.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename Instantiate, typename... T>
+std::size_t RegisterTypedTests(const char *name,
+                               Instantiate instantiate,
+                               Types<T...>,
+                               unsigned timeout) noexcept
+{
+    std::size_t id = 0;
+    bool registered = true;
+
+    (
+        [&]
+        {
+            try
+            {
+                std::string test_name(name);
+                std::string_view type_name = TypeName<T>();
+
+                test_name += '<';
+                if (type_name.empty())
+                {
+                    test_name += typeid(T).name();
+                }
+                else
+                {
+                    test_name += type_name;
+                }
+                test_name += '>';
+
+                id = RegisterTest(test_name.c_str(),
+                                  instantiate(TypeTag<T>{}),
+                                  timeout);
+            }
+            catch (...)
+            {
+                failed_registrations++;
+                id = 0;
+            }
+
+            if (id == 0) registered = false;
+        }(),
+        ...);
+
+    return registered ? id : 0;
+}
+
+} // namespace Terra::STF
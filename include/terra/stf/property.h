@@ -0,0 +1,1103 @@
+/*
+ *  property.h
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Support for property-based tests.  A test defined with STF_PROPERTY
+ *      states a property that must hold for all inputs and is run with many
+ *      inputs produced at random by the given generators.  The inputs are
+ *      available in the test body as the tuple "args":
+ *
+ *          STF_PROPERTY(Base64, RoundTrip, Terra::STF::Bytes(1024))
+ *          {
+ *              const auto &[data] = args;
+ *              STF_ASSERT_EQ(data, Decode(Encode(data)));
+ *          }
+ *
+ *      Generators are provided for integers and floating point values
+ *      (either unrestricted or within a range), byte buffers, strings, and
+ *      vectors of values from another generator.  Inputs start small and
+ *      grow as more cases are run, and boundary values (e.g., zero, the
+ *      limits of a type, infinities, and NaN) are produced often.
+ *
+ *      Cases are run on a number of worker threads (see WorkerThreads()),
+ *      each in a context of its own, until the given number of cases has
+ *      passed, the given number of seconds has elapsed, or the test is near
+ *      its timeout.  The inputs of each case are produced from a stream of
+ *      random numbers determined by a seed and the case number alone, so a
+ *      run is repeated by reusing the seed, whatever the number of threads.
+ *
+ *      When a case fails, its inputs are repeatedly replaced by simpler
+ *      inputs (e.g., smaller numbers or shorter buffers) that still cause
+ *      the property to fail, and the test fails reporting the output of the
+ *      simplest failing case, its inputs, and the seed.  Setting the
+ *      environment variable STF_PROPERTY_SEED to that seed repeats the run.
+ *
+ *      A generator is any class having a Value type, a member function
+ *      Generate(random, size) producing a value given a PropertyRandom and a
+ *      size between zero and Max_Property_Size, and a member function
+ *      Shrink(value) returning a vector of simpler values to try.
+ *
+ *  Portability Issues:
+ *      Requires C++17 or greater.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <terra/stf/stf.h>
+
+// Macro to define a property checked with inputs from the given generators
+#define STF_PROPERTY(group, test, ...) \
+    STF_PROPERTY_N(group, \
+                   test, \
+                   Terra::STF::Default_Property_Cases, \
+                   Terra::STF::Default_Property_Seconds, \
+                   __VA_ARGS__)
+
+// Macro to define a property checked with up to the given number of cases
+// or for the given number of seconds, whichever ends first
+#define STF_PROPERTY_N(group, test, cases, seconds, ...) \
+    template<typename Args> \
+    void STF_Property_ ## group ## _ ## test(const Args &args); \
+    STF_TEST(group, test) \
+    { \
+        Terra::STF::CheckProperty( \
+            cases, \
+            seconds, \
+            [](const auto &args) \
+            { \
+                STF_Property_ ## group ## _ ## test(args); \
+            }, \
+            __VA_ARGS__); \
+    } \
+    template<typename Args> \
+    void STF_Property_ ## group ## _ ## test(const Args &args)
+
+namespace Terra::STF
+{
+
+// Default number of cases and time budget for STF_PROPERTY tests
+constexpr std::size_t Default_Property_Cases = 1000;
+constexpr unsigned Default_Property_Seconds = 10;
+
+// Largest size passed to generators; sizes cycle from zero to this value
+constexpr std::size_t Max_Property_Size = 100;
+
+// Limit on the number of simpler failing inputs accepted when shrinking
+constexpr std::size_t Max_Property_Shrinks = 1000;
+
+/*
+ *  NewPropertySeed()
+ *
+ *  Description:
+ *      Return the seed from which the inputs of an STF_PROPERTY test are
+ *      produced.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The value of the STF_PROPERTY_SEED environment variable if set, else
+ *      a random seed.
+ *
+ *  Comments:
+ *      None.
+ */
+std::uint64_t NewPropertySeed();
+
+/*
+ *  PropertyRandom
+ *
+ *  Description:
+ *      A small, fast pseudo-random number generator (SplitMix64) from which
+ *      generators produce values.  Each case of a property has a stream of
+ *      its own, determined by the seed and the case number.
+ *
+ *  Comments:
+ *      None.
+ */
+class PropertyRandom
+{
+    public:
+        PropertyRandom(std::uint64_t seed, std::uint64_t stream) noexcept :
+            state{seed + stream * 0x9e3779b97f4a7c15ULL}
+        {
+            // Nothing to do
+        }
+
+        std::uint64_t Next() noexcept
+        {
+            std::uint64_t value = (state += 0x9e3779b97f4a7c15ULL);
+            value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+            return value ^ (value >> 31);
+        }
+        std::uint64_t Below(std::uint64_t bound) noexcept
+        {
+            return (bound == 0) ? 0 : Next() % bound;
+        }
+        bool OneIn(std::uint64_t chances) noexcept
+        {
+            return Below(chances) == 0;
+        }
+        double Unit() noexcept
+        {
+            return static_cast<double>(Next() >> 11) * 0x1.0p-53;
+        }
+
+    protected:
+        std::uint64_t state;
+};
+
+/*
+ *  IntegerGenerator
+ *
+ *  Description:
+ *      Produces integers within a range, with magnitudes growing with the
+ *      size, and often the values at or next to the origin and the ends of
+ *      the range.  Values shrink toward the origin, which is zero unless
+ *      given, or the end of the range nearest to it if it is outside the
+ *      range.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename T>
+class IntegerGenerator
+{
+    public:
+        using Value = T;
+
+        IntegerGenerator(T min, T max) : IntegerGenerator(min, max, T(0))
+        {
+            // Nothing to do
+        }
+
+        IntegerGenerator(T min, T max, T origin) :
+            min{min},
+            max{max},
+            origin{std::clamp(origin, min, max)}
+        {
+            // Nothing to do
+        }
+
+        T Generate(PropertyRandom &random, std::size_t size) const
+        {
+            // Often produce a boundary value
+            if (random.OneIn(8))
+            {
+                const T boundaries[] = {min, max, origin, Step(origin, 1)};
+                return boundaries[random.Below(std::size(boundaries))];
+            }
+
+            // Produce a value near the origin whose magnitude is bounded by
+            // a number of bits that grows with the size
+            std::size_t bits = 1 + (size * (Bits - 1)) / Max_Property_Size;
+            std::uint64_t magnitude = random.Next();
+            if (bits < 64) magnitude &= (std::uint64_t(1) << bits) - 1;
+
+            return Step(origin, random.OneIn(2) ? magnitude : 0 - magnitude);
+        }
+
+        std::vector<T> Shrink(const T &value) const
+        {
+            std::vector<T> candidates;
+
+            if (value == origin) return candidates;
+
+            // Try the origin, the value halfway to it, and the next value
+            // toward it
+            T half = (origin == 0) ? T(value / 2) :
+                                     T(origin + (value - origin) / 2);
+            T next = (value > origin) ? T(value - 1) : T(value + 1);
+
+            candidates.push_back(origin);
+            if ((half != origin) && (half != value)) candidates.push_back(half);
+            if ((next != origin) && (next != half)) candidates.push_back(next);
+
+            return candidates;
+        }
+
+    protected:
+        static constexpr std::size_t Bits = std::numeric_limits<T>::digits +
+                                            std::numeric_limits<T>::is_signed;
+
+        // Return the value offset from the given value by the given amount,
+        // treated as a signed quantity, or a value in range if it would not
+        // be within the range
+        T Step(T value, std::uint64_t offset) const
+        {
+            using Wide = std::conditional_t<std::is_signed<T>::value,
+                                            std::int64_t,
+                                            std::uint64_t>;
+
+            Wide result = static_cast<Wide>(
+                static_cast<std::uint64_t>(static_cast<Wide>(value)) + offset);
+            bool negative = static_cast<std::int64_t>(offset) < 0;
+
+            // Detect wrapping past either end of the wide type
+            if (negative && (result > static_cast<Wide>(value))) return min;
+            if (!negative && (result < static_cast<Wide>(value))) return max;
+
+            if (result < static_cast<Wide>(min)) return min;
+            if (result > static_cast<Wide>(max)) return max;
+
+            return static_cast<T>(result);
+        }
+
+        T min;
+        T max;
+        T origin;
+};
+
+/*
+ *  FloatGenerator
+ *
+ *  Description:
+ *      Produces floating point values, either unrestricted or within a
+ *      range, and often special values such as zero, the limits of the type,
+ *      and, when unrestricted, subnormals, infinities, and NaN.  Values
+ *      shrink toward zero and toward integers.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename T>
+class FloatGenerator
+{
+    public:
+        using Value = T;
+
+        FloatGenerator() :
+            bounded{false},
+            min{std::numeric_limits<T>::lowest()},
+            max{std::numeric_limits<T>::max()}
+        {
+            // Nothing to do
+        }
+        FloatGenerator(T min, T max) : bounded{true}, min{min}, max{max}
+        {
+            // Nothing to do
+        }
+
+        T Generate(PropertyRandom &random, std::size_t size) const
+        {
+            if (random.OneIn(8))
+            {
+                if (bounded)
+                {
+                    const T boundaries[] = {min,
+                                            max,
+                                            std::clamp(T(0), min, max)};
+                    return boundaries[random.Below(std::size(boundaries))];
+                }
+
+                const T specials[] = {
+                    T(0),
+                    -T(0),
+                    T(1),
+                    T(-1),
+                    std::numeric_limits<T>::denorm_min(),
+                    std::numeric_limits<T>::min(),
+                    std::numeric_limits<T>::epsilon(),
+                    std::numeric_limits<T>::max(),
+                    std::numeric_limits<T>::lowest(),
+                    std::numeric_limits<T>::infinity(),
+                    -std::numeric_limits<T>::infinity(),
+                    std::numeric_limits<T>::quiet_NaN()};
+                return specials[random.Below(std::size(specials))];
+            }
+
+            if (bounded)
+            {
+                return std::clamp(
+                    static_cast<T>(min + (max - min) * random.Unit()),
+                    min,
+                    max);
+            }
+
+            // Produce a value whose exponent range grows with the size
+            int limit = 1 + static_cast<int>(
+                                (size * std::numeric_limits<T>::max_exponent) /
+                                Max_Property_Size);
+            int exponent = static_cast<int>(random.Below(2 * limit)) - limit;
+            T value = std::ldexp(static_cast<T>(random.Unit()), exponent);
+
+            return random.OneIn(2) ? value : -value;
+        }
+
+        std::vector<T> Shrink(const T &value) const
+        {
+            std::vector<T> candidates;
+            T zero = std::clamp(T(0), min, max);
+
+            if (value == zero) return candidates;
+
+            candidates.push_back(zero);
+
+            if (std::isnan(value)) return candidates;
+
+            if (std::isinf(value))
+            {
+                candidates.push_back((value > 0) ? max : min);
+                return candidates;
+            }
+
+            T whole = std::trunc(value);
+            if ((whole != value) && (whole >= min) && (whole <= max))
+            {
+                candidates.push_back(whole);
+            }
+
+            T half = value / 2;
+            if ((half != value) && (half != zero) && (half >= min) &&
+                (half <= max))
+            {
+                candidates.push_back(half);
+            }
+
+            return candidates;
+        }
+
+    protected:
+        bool bounded;
+        T min;
+        T max;
+};
+
+/*
+ *  ContainerGenerator
+ *
+ *  Description:
+ *      Produces containers (e.g., std::vector or std::string) of up to a
+ *      given number of elements from an element generator, with the number
+ *      of elements growing with the size.  Containers shrink by removing
+ *      elements and by shrinking individual elements.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename Container, typename ElementGenerator>
+class ContainerGenerator
+{
+    public:
+        using Value = Container;
+
+        ContainerGenerator(ElementGenerator element, std::size_t max_length) :
+            element{std::move(element)},
+            max_length{max_length}
+        {
+            // Nothing to do
+        }
+
+        Container Generate(PropertyRandom &random, std::size_t size) const
+        {
+            // The length is bounded by a limit that grows with the size
+            std::size_t limit = (max_length * size) / Max_Property_Size;
+            if ((size > 0) && (limit == 0) && (max_length > 0)) limit = 1;
+            std::size_t length = random.Below(limit + 1);
+            Container container;
+
+            for (std::size_t i = 0; i < length; i++)
+            {
+                container.insert(container.end(),
+                                 element.Generate(random, size));
+            }
+
+            return container;
+        }
+
+        std::vector<Container> Shrink(const Container &value) const
+        {
+            std::vector<Container> candidates;
+            std::size_t length = value.size();
+
+            if (length == 0) return candidates;
+
+            // Try removing everything, then each half, then single elements
+            candidates.emplace_back();
+            if (length > 1)
+            {
+                auto middle = std::next(value.begin(), length / 2);
+                candidates.emplace_back(value.begin(), middle);
+                candidates.emplace_back(middle, value.end());
+            }
+            for (std::size_t i = 0; i < std::min(length, Max_Removals); i++)
+            {
+                Container shorter;
+                for (std::size_t j = 0; j < length; j++)
+                {
+                    if (j != i)
+                    {
+                        shorter.insert(shorter.end(),
+                                       *std::next(value.begin(), j));
+                    }
+                }
+                candidates.push_back(std::move(shorter));
+            }
+
+            // Try shrinking each element
+            std::size_t position = 0;
+            for (const auto &item : value)
+            {
+                if (position >= Max_Removals) break;
+
+                for (auto &simpler : element.Shrink(item))
+                {
+                    Container changed = value;
+                    *std::next(changed.begin(), position) = std::move(simpler);
+                    candidates.push_back(std::move(changed));
+                }
+                position++;
+            }
+
+            return candidates;
+        }
+
+    protected:
+        // Number of positions at which elements are removed or shrunk
+        static constexpr std::size_t Max_Removals = 32;
+
+        ElementGenerator element;
+        std::size_t max_length;
+};
+
+/*
+ *  Integers()
+ *
+ *  Description:
+ *      Return a generator of integers of the given type within the given
+ *      range, which defaults to all values of the type.
+ *
+ *  Parameters:
+ *      min [in]
+ *          The smallest value to produce.
+ *
+ *      max [in]
+ *          The largest value to produce.
+ *
+ *  Returns:
+ *      The generator.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename T>
+IntegerGenerator<T> Integers(T min = std::numeric_limits<T>::min(),
+                             T max = std::numeric_limits<T>::max())
+{
+    return IntegerGenerator<T>(min, max);
+}
+
+/*
+ *  Floats()
+ *
+ *  Description:
+ *      Return a generator of all floating point values of the given type,
+ *      including subnormals, infinities, and NaN.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The generator.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename T>
+FloatGenerator<T> Floats()
+{
+    return FloatGenerator<T>();
+}
+
+/*
+ *  Floats()
+ *
+ *  Description:
+ *      Return a generator of finite floating point values of the given type
+ *      within the given range.
+ *
+ *  Parameters:
+ *      min [in]
+ *          The smallest value to produce.
+ *
+ *      max [in]
+ *          The largest value to produce.
+ *
+ *  Returns:
+ *      The generator.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename T>
+FloatGenerator<T> Floats(T min, T max)
+{
+    return FloatGenerator<T>(min, max);
+}
+
+/*
+ *  Bytes()
+ *
+ *  Description:
+ *      Return a generator of byte buffers of up to the given length.
+ *
+ *  Parameters:
+ *      max_length [in]
+ *          The maximum number of octets in a buffer.
+ *
+ *  Returns:
+ *      The generator.
+ *
+ *  Comments:
+ *      None.
+ */
+inline ContainerGenerator<std::vector<std::uint8_t>,
+                          IntegerGenerator<std::uint8_t>>
+    Bytes(std::size_t max_length = 256)
+{
+    return {Integers<std::uint8_t>(), max_length};
+}
+
+/*
+ *  Strings()
+ *
+ *  Description:
+ *      Return a generator of strings of printable ASCII characters, from
+ *      space to tilde, of up to the given length.
+ *
+ *  Parameters:
+ *      max_length [in]
+ *          The maximum number of characters in a string.
+ *
+ *  Returns:
+ *      The generator.
+ *
+ *  Comments:
+ *      Characters shrink toward "a".
+ */
+inline ContainerGenerator<std::string, IntegerGenerator<char>> Strings(
+    std::size_t max_length = 64)
+{
+    return {IntegerGenerator<char>(' ', '~', 'a'), max_length};
+}
+
+/*
+ *  VectorsOf()
+ *
+ *  Description:
+ *      Return a generator of vectors of up to the given length, with elements
+ *      produced by the given generator.
+ *
+ *  Parameters:
+ *      element [in]
+ *          The generator of the elements.
+ *
+ *      max_length [in]
+ *          The maximum number of elements in a vector.
+ *
+ *  Returns:
+ *      The generator.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename ElementGenerator>
+ContainerGenerator<std::vector<typename ElementGenerator::Value>,
+                   ElementGenerator>
+    VectorsOf(ElementGenerator element, std::size_t max_length = 64)
+{
+    return {std::move(element), max_length};
+}
+
+// Determine whether a type can be written to an output stream
+template<typename T, typename = void>
+struct IsStreamable : std::false_type
+{
+};
+
+template<typename T>
+struct IsStreamable<T,
+                    decltype(std::declval<std::ostream &>() <<
+                                 std::declval<const T &>(),
+                             void())> : std::true_type
+{
+};
+
+// Determine whether a type can be iterated over with a range-based for loop
+template<typename T, typename = void>
+struct IsRange : std::false_type
+{
+};
+
+template<typename T>
+struct IsRange<T,
+               decltype(std::begin(std::declval<const T &>()),
+                        std::end(std::declval<const T &>()),
+                        void())> : std::true_type
+{
+};
+
+/*
+ *  FormatElement()
+ *
+ *  Description:
+ *      Write an element of a container being printed by PrintArgument() to
+ *      the given stream.
+ *
+ *  Parameters:
+ *      oss [out]
+ *          The stream to which the element is written.
+ *
+ *      item [in]
+ *          The element to write.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      Arithmetic elements are promoted so that characters print as numbers,
+ *      containers are written element by element within braces, and
+ *      elements that can be neither streamed nor iterated are written as
+ *      "?".
+ */
+template<typename T>
+void FormatElement(std::ostringstream &oss, const T &item)
+{
+    if constexpr (std::is_arithmetic<T>::value)
+    {
+        oss << +item;
+    }
+    else if constexpr (IsStreamable<T>::value)
+    {
+        oss << item;
+    }
+    else if constexpr (IsRange<T>::value)
+    {
+        std::size_t count = 0;
+
+        oss << '{';
+        for (const auto &element : item)
+        {
+            if (count++ > 0) oss << ", ";
+            FormatElement(oss, element);
+        }
+        oss << '}';
+    }
+    else
+    {
+        oss << '?';
+    }
+}
+
+/*
+ *  PrintArgument()
+ *
+ *  Description:
+ *      Print an input of a failing property, as PrintValue() does, printing
+ *      containers that cannot be written to an output stream element by
+ *      element.
+ *
+ *  Parameters:
+ *      text [in]
+ *          The text identifying the input.
+ *
+ *      value [in]
+ *          The input to print.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      Buffers of octets are printed in hexadecimal.  Values that can be
+ *      neither streamed nor iterated are printed by PrintValue() as
+ *      unprintable objects.
+ */
+template<typename T>
+void PrintArgument(const std::string &text, const T &value)
+{
+    if constexpr (IsStreamable<T>::value || std::is_arithmetic<T>::value)
+    {
+        PrintValue(text, value);
+    }
+    else if constexpr (std::is_same<T, std::vector<std::uint8_t>>::value)
+    {
+        PendingOutput().Text(text).Decimal(value.size()).Text(" octet(s):");
+        for (std::uint8_t octet : value)
+        {
+            PendingOutput().Character(' ').Hex(+octet, 2);
+        }
+        PendingOutput().NewLine();
+    }
+    else if constexpr (IsRange<T>::value)
+    {
+        std::ostringstream oss;
+
+        FormatElement(oss, value);
+
+        PrintValue(text, oss.str());
+    }
+    else
+    {
+        PrintValue(text, value);
+    }
+}
+
+/*
+ *  PropertyCaseFails()
+ *
+ *  Description:
+ *      Run a case of a property in a context of its own and determine
+ *      whether it failed.
+ *
+ *  Parameters:
+ *      function [in]
+ *          The property, taking a tuple of inputs.
+ *
+ *      args [in]
+ *          The inputs.
+ *
+ *      parent [in]
+ *          The context of the test, from which the deadline and yield point
+ *          seed are taken, or nullptr.
+ *
+ *      output [out]
+ *          The output produced by the case, if it failed.
+ *
+ *  Returns:
+ *      True if the property failed or threw an exception, false otherwise.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename Function, typename Args>
+bool PropertyCaseFails(const Function &function,
+                       const Args &args,
+                       TestContext *parent,
+                       std::string &output)
+{
+    TestContext context("Property");
+
+    RunInChildContext(context, parent, [&]() { function(args); });
+
+    if (!context.Failed()) return false;
+
+    output = context.TakeOutput();
+
+    return true;
+}
+
+/*
+ *  ShrinkProperty()
+ *
+ *  Description:
+ *      Try to replace one input of a failing property with a simpler input
+ *      for which the property still fails.
+ *
+ *  Parameters:
+ *      function [in]
+ *          The property, taking a tuple of inputs.
+ *
+ *      generators [in]
+ *          The generators of the inputs.
+ *
+ *      args [in/out]
+ *          The failing inputs, replaced by simpler inputs if found.
+ *
+ *      parent [in]
+ *          The context of the test, or nullptr.
+ *
+ *      output [out]
+ *          The output produced by the property with the simpler inputs.
+ *
+ *      _ [in]
+ *          The indices of the inputs.
+ *
+ *  Returns:
+ *      True if simpler inputs were found, false otherwise.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename Function,
+         typename Generators,
+         typename Args,
+         std::size_t... Index>
+bool ShrinkProperty(const Function &function,
+                    const Generators &generators,
+                    Args &args,
+                    TestContext *parent,
+                    std::string &output,
+                    std::index_sequence<Index...>)
+{
+    auto shrink_input = [&](auto index)
+    {
+        constexpr std::size_t I = decltype(index)::value;
+
+        auto candidates = std::get<I>(generators).Shrink(std::get<I>(args));
+
+        for (auto &candidate : candidates)
+        {
+            Args trial = args;
+            std::get<I>(trial) = std::move(candidate);
+
+            if (PropertyCaseFails(function, trial, parent, output))
+            {
+                args = std::move(trial);
+                return true;
+            }
+        }
+
+        return false;
+    };
+
+    return (shrink_input(std::integral_constant<std::size_t, Index>{}) || ...);
+}
+
+/*
+ *  MinimizeCase()
+ *
+ *  Description:
+ *      Repeatedly replace the inputs of a failing case with simpler inputs
+ *      for which the property still fails, until no simpler inputs fail.
+ *
+ *  Parameters:
+ *      function [in]
+ *          The property, taking a tuple of inputs.
+ *
+ *      generators [in]
+ *          The generators of the inputs.
+ *
+ *      args [in/out]
+ *          The failing inputs, replaced by the simplest inputs found.
+ *
+ *      parent [in]
+ *          The context of the test, or nullptr.
+ *
+ *      output [in/out]
+ *          The output produced by the property with the failing inputs.
+ *
+ *      deadline [in]
+ *          The time after which no further inputs are tried.
+ *
+ *  Returns:
+ *      The number of times simpler inputs were found.
+ *
+ *  Comments:
+ *      At most Max_Property_Shrinks simpler inputs are accepted.
+ */
+template<typename Function, typename... Generators, typename Args>
+std::size_t MinimizeCase(const Function &function,
+                         const std::tuple<const Generators &...> &generators,
+                         Args &args,
+                         TestContext *parent,
+                         std::string &output,
+                         std::chrono::steady_clock::time_point deadline)
+{
+    std::size_t shrinks = 0;
+
+    while ((shrinks < Max_Property_Shrinks) &&
+           (std::chrono::steady_clock::now() < deadline) &&
+           ShrinkProperty(function,
+                          generators,
+                          args,
+                          parent,
+                          output,
+                          std::index_sequence_for<Generators...>{}))
+    {
+        shrinks++;
+    }
+
+    return shrinks;
+}
+
+/*
+ *  PrintCaseInputs()
+ *
+ *  Description:
+ *      Print the inputs of a failing case and the seed from which the cases
+ *      were produced.
+ *
+ *  Parameters:
+ *      args [in]
+ *          The inputs.
+ *
+ *      seed [in]
+ *          The seed.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename Args>
+void PrintCaseInputs(const Args &args, std::uint64_t seed)
+{
+    std::apply(
+        [&](const auto &...inputs)
+        {
+            std::size_t position = 0;
+            (PrintArgument("  args[" + std::to_string(position++) + "]: ",
+                           inputs),
+             ...);
+        },
+        args);
+    PendingOutput().Text("Property seed: ")
+                   .Decimal(seed)
+                   .Text(" (set STF_PROPERTY_SEED=")
+                   .Decimal(seed)
+                   .Text(" to repeat the cases)")
+                   .NewLine();
+}
+
+/*
+ *  CheckProperty()
+ *
+ *  Description:
+ *      Check that a property holds for inputs produced by the given
+ *      generators, as done for tests defined with STF_PROPERTY.
+ *
+ *  Parameters:
+ *      cases [in]
+ *          The number of cases to run; zero means no limit.
+ *
+ *      seconds [in]
+ *          The time after which no further cases are started; zero means no
+ *          limit.  If both limits are zero, one case is run.
+ *
+ *      function [in]
+ *          The property, taking a tuple of inputs.
+ *
+ *      generators [in]
+ *          The generators of the inputs.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      Cases also stop being started when the current test nears its
+ *      timeout (see WorkDeadline()), and shrinking stops at that time.  If
+ *      the property fails, one failure is recorded in the calling thread's
+ *      current context.
+ */
+template<typename Function, typename... Generators>
+void CheckProperty(std::size_t cases,
+                   unsigned seconds,
+                   Function function,
+                   const Generators &...generators)
+{
+    using Args = std::tuple<typename Generators::Value...>;
+
+    struct Failure
+    {
+        std::size_t index;
+        Args args;
+        std::string output;
+    };
+
+    TestContext *parent = CurrentContext();
+    const std::uint64_t seed = NewPropertySeed();
+    const auto deadline = WorkDeadline();
+    auto stop_time = deadline;
+    if (seconds > 0)
+    {
+        stop_time = std::min(stop_time,
+                             std::chrono::steady_clock::now() +
+                                 std::chrono::seconds(seconds));
+    }
+    if ((cases == 0) && (seconds == 0)) cases = 1;
+
+    std::atomic<std::size_t> next_index{};
+    std::atomic<std::size_t> passed{};
+    std::atomic<bool> failed{};
+    std::mutex failure_mutex;
+    std::optional<Failure> failure;
+
+    auto worker = [&]()
+    {
+        while (!failed.load(std::memory_order_relaxed) &&
+               (std::chrono::steady_clock::now() < stop_time))
+        {
+            std::size_t index = next_index++;
+            if ((cases > 0) && (index >= cases)) break;
+
+            // Produce the inputs from this case's stream
+            PropertyRandom random(seed, index);
+            std::size_t size = index % (Max_Property_Size + 1);
+            Args args{generators.Generate(random, size)...};
+            std::string output;
+
+            if (!PropertyCaseFails(function, args, parent, output))
+            {
+                passed++;
+                continue;
+            }
+
+            std::lock_guard<std::mutex> lock(failure_mutex);
+            if (!failure || (index < failure->index))
+            {
+                failure = Failure{index, std::move(args), std::move(output)};
+            }
+            failed = true;
+        }
+    };
+
+    // Run the cases on the workers, including the calling thread
+    std::size_t workers = WorkerThreads();
+    if (cases > 0) workers = std::min(workers, cases);
+    RunOnWorkers(workers, worker);
+
+    if (!failure)
+    {
+        // Note the number of cases on the line reporting the test
+        PendingOutput().Text(" [").Decimal(passed.load()).Text(" cases]");
+        CommitOutput();
+        return;
+    }
+
+    // Replace the inputs with simpler inputs while the property still fails
+    std::size_t shrinks = MinimizeCase(function,
+                                       std::tie(generators...),
+                                       failure->args,
+                                       parent,
+                                       failure->output,
+                                       deadline);
+
+    // Report the output of the simplest failing case and its inputs
+    PendingOutput().Text(failure->output)
+                   .NewLine()
+                   .Text("Property failed on case ")
+                   .Decimal(failure->index + 1)
+                   .Text(" after ")
+                   .Decimal(shrinks)
+                   .Text(" shrink(s); inputs:")
+                   .NewLine();
+    PrintCaseInputs(failure->args, seed);
+    RecordFailure();
+}
+
+} // namespace Terra::STF
@@ -56,6 +56,8 @@
  *          STF_TEST(GroupName, TestName)   // Define a test function
  *          STF_TEST_TIMEOUT(Grp, Tst, Tme) // Define a test function w/ timeout
  *          STF_TEST_EXCLUDE(Group, Test)   // Specify a test to exclude
+ *          STF_TEST_CONCURRENT(Grp, Tst)   // Define a test run on many threads
+ *          STF_TEST_CONCURRENT_N(G,T,n,r,s) // n threads, r rounds, s secs
  *          STF_ASSERT_EQ(expected, actual) // Assert expected == actual
  *          STF_ASSERT_NE(a, b)             // Assert a != b
  *          STF_ASSERT_GT(a, b)             // Assert a > b
@@ -65,23 +67,51 @@
  *          STF_ASSERT_TRUE(a)              // Assert a is true
  *          STF_ASSERT_FALSE(a)             // Assert a is false
  *          STF_ASSERT_CLOSE(a, b, epsilon) // Assert abs(a - b) < epsilon
+ *          STF_ASSERT_NEAR(a, b, abs, rel) // Assert a, b within tolerance
+ *          STF_ASSERT_ULP_EQ(a, b, ulps)   // Assert a, b within ulps
+ *          STF_ASSERT_ARRAY_CLOSE(a, b, n, abs, rel) // Assert arrays close
+ *          STF_ASSERT_TENSOR_CLOSE(a, b, abs, rel) // Assert tensors close
  *          STF_ASSERT_MEM_EQ(a, b, octets) // Assert equal memory ranges
  *          STF_ASSERT_MEM_NE(a, b, octets) // Assert non-equal memory ranges
  *          STF_ASSERT_EXCEPTION(f)         // Assert f throws any exception
  *          STF_ASSERT_EXCEPTION_E(f, e)    // Assert f throws exception e
+ *          STF_EXPECT_*(...)               // Non-fatal STF_ASSERT_*(...)
+ *
+ *      STF_ASSERT_NEAR considers a and b to be equal if the absolute value of
+ *      their difference is no greater than the larger of the absolute
+ *      tolerance "abs" and the relative tolerance "rel" scaled by the larger
+ *      magnitude of a and b.  STF_ASSERT_ULP_EQ considers a and b equal if
+ *      they are no more than "ulps" representable values apart.
+ *      STF_ASSERT_ARRAY_CLOSE applies the same test as STF_ASSERT_NEAR to
+ *      each of the "n" elements of two float or double arrays and, on
+ *      failure, reports error statistics and the index of the worst element.
+ *
+ *      STF_ASSERT_TENSOR_CLOSE is similar, but compares one, two, or three
+ *      dimensional float or double data described by TensorView objects,
+ *      each of which holds a base pointer, extents, and strides (in elements)
+ *      so that padded rows or interleaved data may be compared directly:
+ *
+ *          Terra::STF::TensorView<float> expected(ref, rows, cols, ref_pitch);
+ *          Terra::STF::TensorView<float> actual(out, rows, cols, out_pitch);
+ *          STF_ASSERT_TENSOR_CLOSE(expected, actual, 1e-6f, 1e-5f);
+ *
+ *      On failure, the number of elements not close, a histogram of errors
+ *      relative to the tolerance, and the coordinates of the worst elements
+ *      are reported.  Large tensors are compared in parallel over rows.
  *
  *      When performing comparisons of user-defined types, it is important that
  *      comparison operators are defined for those types.  Further, if the
  *      comparison fails, this test framework will attempt to output the type
- *      to std::cout.  If a user-defined type does not have a streaming operator
- *      defined, the library will indicate the object is unprintable when
- *      a test fails.  One may define a streaming operator before including
- *      this header file so that the library is aware of the operator's
- *      existence.
+ *      using a streaming operator.  If a user-defined type does not have a
+ *      streaming operator defined, the library will indicate the object is
+ *      unprintable when a test fails.  One may define a streaming operator
+ *      before including this header file so that the library is aware of the
+ *      operator's existence.
  *
  *      To test if a function call throws an exception, one passes the name of
- *      the function to call in the macro.  The macro excepts a type of
- *      std::function<void()>.  While one can pass a std::function object, the
+ *      the function to call in the macro.  The macro accepts any callable
+ *      object taking no arguments (e.g., a lambda, function pointer, or
+ *      std::function), which is invoked directly without being copied.  The
  *      simplest way to test exceptions is by doing the following:
  *
  *          auto test_func = [&] { SomeFunction(arg1, arg2); }
@@ -98,27 +128,121 @@
  *      would pass the test.  Tests should specify the exact exception type
  *      expected.
  *
+ *      Each STF_ASSERT_* macro has an STF_EXPECT_* counterpart (e.g.,
+ *      STF_EXPECT_EQ) that records the failure and allows the test to
+ *      continue rather than returning from the test function.  This is useful
+ *      for table-driven tests where all failing entries should be reported in
+ *      a single run.  To avoid flooding the output when an assertion in a
+ *      loop fails repeatedly, only the first Expect_Report_Limit (default 10)
+ *      failures at each assertion site are printed; the remainder are counted,
+ *      without being formatted, and summarized when the test completes.  The
+ *      limit may be changed by setting the STF_EXPECT_LIMIT environment
+ *      variable.
+ *
+ *      Assertions may be made on any thread a test creates.  Failures are
+ *      recorded in the test's TestContext, with each failure message added to
+ *      the test's output as a whole.  Threads created with Terra::STF::Thread
+ *      inherit the context of the creating thread; threads created directly
+ *      with std::thread report to the test the runner is executing.
+ *
+ *      Tests defined with STF_TEST_CONCURRENT run the test body on several
+ *      threads released at the same moment by a spin barrier, repeating for
+ *      a number of rounds or seconds, to expose races.  Within the body,
+ *      ConcurrentThreadIndex(), ConcurrentThreadCount(), ConcurrentRound(),
+ *      and ConcurrentSync() identify the thread and synchronize the threads.
+ *      The results of such tests may be recorded in a History and checked
+ *      for linearizability using the facilities in linearizability.h.
+ *      Code under test may mark points at which a thread being preempted
+ *      could expose a race with STF_YIELD_POINT(), defined in yield_point.h;
+ *      see that file for details.
+ *
+ *      Time-dependent code may be tested against a virtual clock that only
+ *      advances when the test sleeps or advances it, using the facilities in
+ *      virtual_clock.h.
+ *
+ *      Tests run once for each value produced by a generator are defined
+ *      with STF_TEST_P, defined in parameterized.h.  Instances of such tests
+ *      run in parallel and are reported individually.  Tests instantiated
+ *      for each type in a list are defined with STF_TEST_TYPED, also defined
+ *      in parameterized.h.
+ *
+ *      Properties checked against many generated inputs, with failing inputs
+ *      shrunk to a minimal counterexample, are defined with STF_PROPERTY,
+ *      defined in property.h.
+ *
+ *      An optimized implementation may be checked against a reference
+ *      implementation over generated inputs, with both timed, using
+ *      STF_ASSERT_EQUIVALENT, defined in differential.h.
+ *
+ *      Kernels may be run with every alignment and length of input next to
+ *      guard pages, reporting each pair that faults or differs from a
+ *      reference, using SweepAlignments(), defined in guarded_buffer.h.
+ *
+ *      Incremental interfaces may be checked to produce the same result
+ *      however their input is split into chunks, with their throughput for
+ *      each chunk size noted, using SweepChunks(), defined in streaming.h.
+ *
+ *      Tests run once for each ISA level the host supports, with a hook that
+ *      a library's run-time dispatcher consults to use that level, are
+ *      defined with STF_TEST_ISA or STF_TEST_ISA_TIMED, defined in isa.h.
+ *
+ *      Functions whose timing must not depend on secret inputs may be
+ *      checked with STF_ASSERT_CONSTANT_TIME, defined in constant_time.h.
+ *
+ *      Tests run with every 32-bit input, spread over all cores and
+ *      resumable from a checkpoint, are defined with STF_EXHAUSTIVE_U32,
+ *      defined in exhaustive.h.
+ *
+ *      Fuzz targets whose corpus is replayed as a test, and which may also be
+ *      built into a libFuzzer fuzzer, are defined with STF_FUZZ, defined in
+ *      fuzz.h.
+ *
+ *      Tests run once for each vector in a file of known answers in the
+ *      format of the NIST CAVP response files are defined with STF_TEST_KAT,
+ *      defined in kat.h.
+ *
+ *      Known answers written as hex are converted to an std::array at
+ *      compile time with HexArray() or the _hex literal, defined in hex.h.
+ *
+ *      Tests written as C++20 coroutines are defined with STF_TEST_ASYNC and
+ *      use the STF_CO_ASSERT_* assertions, both defined in async.h.  Such
+ *      tests run concurrently on a single thread after all other tests.
+ *
  *      The STF_TEST_EXCLUDE macro specifies which tests should be excludes
  *      from test runs.  This is useful if there is a known failing test that
  *      needs to be excluded temporarily or when there are some tests that need
  *      to be performed only under certain conditions that can be articulated
  *      at compile time.
  *
+ *      Output produced by failing assertions is formatted without the use of
+ *      iostreams and is buffered for the duration of each test.  The buffered
+ *      output is written to stdout once when the test completes.
+ *
  *  Portability Issues:
- *      Requires C++11 or greater.
+ *      Requires C++17 or greater.
  */
 
 #pragma once
 
-#include <iostream>
+#include <ostream>
 #include <sstream>
-#include <iomanip>
+#include <array>
 #include <functional>
+#include <charconv>
 #include <cstdint>
 #include <cstdlib>
+#include <cstddef>
 #include <type_traits>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <exception>
+#include <terra/stf/yield_point.h>
 
 // Macro to define a test function and register the test for execution
 #define STF_TEST(group, test) \
@@ -137,6 +261,27 @@
                                  timeout); \
     void STF_Test_ ## group ## _ ## test()
 
+// Macro to define a test function that runs on many threads at once
+#define STF_TEST_CONCURRENT(group, test) \
+    STF_TEST_CONCURRENT_N(group, \
+                          test, \
+                          0, \
+                          Terra::STF::Default_Concurrent_Rounds, \
+                          Terra::STF::Default_Concurrent_Seconds)
+
+// Macro to define a test function that runs on the given number of threads
+// at once for the given number of rounds or seconds, whichever ends first
+#define STF_TEST_CONCURRENT_N(group, test, threads, rounds, seconds) \
+    void STF_Test_Concurrent_ ## group ## _ ## test(); \
+    STF_TEST(group, test) \
+    { \
+        Terra::STF::RunConcurrent(STF_Test_Concurrent_ ## group ## _ ## test, \
+                                  threads, \
+                                  rounds, \
+                                  seconds); \
+    } \
+    void STF_Test_Concurrent_ ## group ## _ ## test()
+
 // Macro to specify a test that should be excluded from execution
 #define STF_TEST_EXCLUDE(group, test) \
     const bool STF_Test_ID_ ## group ## _ ## test ## _excluded = \
@@ -144,119 +289,280 @@
 
 // Macro to test for equality
 #define STF_ASSERT_EQ(expected, actual) \
-    if (!((expected) == (actual))) \
-    { \
-        Terra::STF::ExpectFail(__FILE__, __LINE__, (expected), (actual)); \
-        Terra::STF::Test_Failed = true; \
-        return; \
-    }
+    STF_INTERNAL_EQ(expected, actual, STF_INTERNAL_FATAL)
 
 // Macro to test for inequality
 #define STF_ASSERT_NE(a, b) \
-    if (!((a) != (b))) \
-    { \
-        Terra::STF::LhsRhsFail(__FILE__, __LINE__, (a), (b)); \
-        Terra::STF::Test_Failed = true; \
-        return; \
-    }
+    STF_INTERNAL_COMPARE(a, NotEqual, b, STF_INTERNAL_FATAL)
 
 // Macro to test that a > b
 #define STF_ASSERT_GT(a, b) \
-    if (!((a) > (b))) \
-    { \
-        Terra::STF::LhsRhsFail(__FILE__, __LINE__, (a), (b)); \
-        Terra::STF::Test_Failed = true; \
-        return; \
-    }
+    STF_INTERNAL_COMPARE(a, Greater, b, STF_INTERNAL_FATAL)
 
 // Macro to test that a >= b
 #define STF_ASSERT_GE(a, b) \
-    if (!((a) >= (b))) \
-    { \
-        Terra::STF::LhsRhsFail(__FILE__, __LINE__, (a), (b)); \
-        Terra::STF::Test_Failed = true; \
-        return; \
-    }
+    STF_INTERNAL_COMPARE(a, GreaterEqual, b, STF_INTERNAL_FATAL)
 
 // Macro to test that a < b
 #define STF_ASSERT_LT(a, b) \
-    if (!((a) < (b))) \
-    { \
-        Terra::STF::LhsRhsFail(__FILE__, __LINE__, (a), (b)); \
-        Terra::STF::Test_Failed = true; \
-        return; \
-    }
+    STF_INTERNAL_COMPARE(a, Less, b, STF_INTERNAL_FATAL)
 
 // Macro to test that a <= b
 #define STF_ASSERT_LE(a, b) \
-    if (!((a) <= (b))) \
-    { \
-        Terra::STF::LhsRhsFail(__FILE__, __LINE__, (a), (b)); \
-        Terra::STF::Test_Failed = true; \
-        return; \
-    }
+    STF_INTERNAL_COMPARE(a, LessEqual, b, STF_INTERNAL_FATAL)
 
 // Macro to test for true
 #define STF_ASSERT_TRUE(a) \
-    if (!Terra::STF::AssertBoolean(__FILE__, __LINE__, bool(a) == true)) \
-    { \
-        Terra::STF::Test_Failed = true; \
-        return; \
-    }
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertBoolean(__FILE__, __LINE__, bool(a) == true), \
+        STF_INTERNAL_FATAL)
 
 // Macro to test for false
 #define STF_ASSERT_FALSE(a) \
-    if (!Terra::STF::AssertBoolean(__FILE__, __LINE__, bool(a) == false)) \
-    { \
-        Terra::STF::Test_Failed = true; \
-        return; \
-    }
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertBoolean(__FILE__, __LINE__, bool(a) == false), \
+        STF_INTERNAL_FATAL)
 
 // Macro to test that difference in float or double values are less than epsilon
 #define STF_ASSERT_CLOSE(a, b, epsilon) \
-    if (!Terra::STF::AssertClose(__FILE__, __LINE__, (a), (b), (epsilon))) \
-    { \
-        Terra::STF::Test_Failed = true; \
-        return; \
-    }
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertClose(__FILE__, __LINE__, (a), (b), (epsilon)), \
+        STF_INTERNAL_FATAL)
+
+// Macro to test that float or double values are within a combined absolute
+// and relative tolerance
+#define STF_ASSERT_NEAR(a, b, abs_epsilon, rel_epsilon) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertNear(__FILE__, \
+                               __LINE__, \
+                               (a), \
+                               (b), \
+                               (abs_epsilon), \
+                               (rel_epsilon)), \
+        STF_INTERNAL_FATAL)
+
+// Macro to test that float or double values are within a number of ULPs
+#define STF_ASSERT_ULP_EQ(a, b, max_ulps) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertUlpEqual(__FILE__, __LINE__, (a), (b), (max_ulps)), \
+        STF_INTERNAL_FATAL)
+
+// Macro to test that arrays of float or double values are element-wise close
+#define STF_ASSERT_ARRAY_CLOSE(a, b, count, abs_epsilon, rel_epsilon) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertArrayClose(__FILE__, \
+                                     __LINE__, \
+                                     (a), \
+                                     (b), \
+                                     (count), \
+                                     (abs_epsilon), \
+                                     (rel_epsilon)), \
+        STF_INTERNAL_FATAL)
+
+// Macro to test that strided float or double tensors are element-wise close
+#define STF_ASSERT_TENSOR_CLOSE(a, b, abs_epsilon, rel_epsilon) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertTensorClose(__FILE__, \
+                                      __LINE__, \
+                                      (a), \
+                                      (b), \
+                                      (abs_epsilon), \
+                                      (rel_epsilon)), \
+        STF_INTERNAL_FATAL)
 
 // Macro to test memory ranges for equality
 #define STF_ASSERT_MEM_EQ(a, b, size) \
-    if (!Terra::STF::AssertMemoryEqual(__FILE__, __LINE__, (a), (b), (size))) \
-    { \
-        Terra::STF::Test_Failed = true; \
-        return; \
-    }
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertMemoryEqual(__FILE__, __LINE__, (a), (b), (size)), \
+        STF_INTERNAL_FATAL)
 
 // Macro to test memory ranges for inequality
 #define STF_ASSERT_MEM_NE(a, b, size) \
-    if (!Terra::STF::AssertMemoryNotEqual(__FILE__, \
-                                          __LINE__, \
-                                          (a), \
-                                          (b), \
-                                          (size))) \
-    { \
-        Terra::STF::Test_Failed = true; \
-        return; \
-    }
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertMemoryNotEqual(__FILE__, __LINE__, (a), (b), (size)), \
+        STF_INTERNAL_FATAL)
 
 // Macro to test for exceptions to be thrown on a function call
 #define STF_ASSERT_EXCEPTION(function) \
-    if (!Terra::STF::AssertException(__FILE__, __LINE__, (function))) \
-    { \
-        Terra::STF::Test_Failed = true; \
-        return; \
-    }
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertException(__FILE__, __LINE__, (function)), \
+        STF_INTERNAL_FATAL)
 
 // Macro to test for specific exceptions to be thrown on a function call
 #define STF_ASSERT_EXCEPTION_E(function, exception) \
-    if (!Terra::STF::AssertException<exception>(__FILE__, __LINE__, \
-                                                (function), #exception)) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertException<exception>(__FILE__, \
+                                               __LINE__, \
+                                               (function), \
+                                               #exception), \
+        STF_INTERNAL_FATAL)
+
+// The following macros are non-fatal counterparts to the above.  On failure,
+// the failure is recorded and the test continues.  Failure messages are
+// reported for only the first Expect_Report_Limit failures at any one
+// assertion site during a test; further failures are only counted.
+
+// Non-fatal macro to test for equality
+#define STF_EXPECT_EQ(expected, actual) \
+    STF_INTERNAL_EQ(expected, actual, STF_INTERNAL_NONFATAL)
+
+// Non-fatal macro to test for inequality
+#define STF_EXPECT_NE(a, b) \
+    STF_INTERNAL_COMPARE(a, NotEqual, b, STF_INTERNAL_NONFATAL)
+
+// Non-fatal macro to test that a > b
+#define STF_EXPECT_GT(a, b) \
+    STF_INTERNAL_COMPARE(a, Greater, b, STF_INTERNAL_NONFATAL)
+
+// Non-fatal macro to test that a >= b
+#define STF_EXPECT_GE(a, b) \
+    STF_INTERNAL_COMPARE(a, GreaterEqual, b, STF_INTERNAL_NONFATAL)
+
+// Non-fatal macro to test that a < b
+#define STF_EXPECT_LT(a, b) \
+    STF_INTERNAL_COMPARE(a, Less, b, STF_INTERNAL_NONFATAL)
+
+// Non-fatal macro to test that a <= b
+#define STF_EXPECT_LE(a, b) \
+    STF_INTERNAL_COMPARE(a, LessEqual, b, STF_INTERNAL_NONFATAL)
+
+// Non-fatal macro to test for true
+#define STF_EXPECT_TRUE(a) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertBoolean(__FILE__, __LINE__, bool(a) == true), \
+        STF_INTERNAL_NONFATAL)
+
+// Non-fatal macro to test for false
+#define STF_EXPECT_FALSE(a) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertBoolean(__FILE__, __LINE__, bool(a) == false), \
+        STF_INTERNAL_NONFATAL)
+
+// Non-fatal macro to test that difference in float or double values are less than epsilon
+#define STF_EXPECT_CLOSE(a, b, epsilon) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertClose(__FILE__, __LINE__, (a), (b), (epsilon)), \
+        STF_INTERNAL_NONFATAL)
+
+// Non-fatal macro to test that float or double values are within a combined absolute
+// and relative tolerance
+#define STF_EXPECT_NEAR(a, b, abs_epsilon, rel_epsilon) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertNear(__FILE__, \
+                               __LINE__, \
+                               (a), \
+                               (b), \
+                               (abs_epsilon), \
+                               (rel_epsilon)), \
+        STF_INTERNAL_NONFATAL)
+
+// Non-fatal macro to test that float or double values are within a number of ULPs
+#define STF_EXPECT_ULP_EQ(a, b, max_ulps) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertUlpEqual(__FILE__, __LINE__, (a), (b), (max_ulps)), \
+        STF_INTERNAL_NONFATAL)
+
+// Non-fatal macro to test that arrays of float or double values are element-wise close
+#define STF_EXPECT_ARRAY_CLOSE(a, b, count, abs_epsilon, rel_epsilon) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertArrayClose(__FILE__, \
+                                     __LINE__, \
+                                     (a), \
+                                     (b), \
+                                     (count), \
+                                     (abs_epsilon), \
+                                     (rel_epsilon)), \
+        STF_INTERNAL_NONFATAL)
+
+// Non-fatal macro to test that strided float or double tensors are element-wise close
+#define STF_EXPECT_TENSOR_CLOSE(a, b, abs_epsilon, rel_epsilon) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertTensorClose(__FILE__, \
+                                      __LINE__, \
+                                      (a), \
+                                      (b), \
+                                      (abs_epsilon), \
+                                      (rel_epsilon)), \
+        STF_INTERNAL_NONFATAL)
+
+// Non-fatal macro to test memory ranges for equality
+#define STF_EXPECT_MEM_EQ(a, b, size) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertMemoryEqual(__FILE__, __LINE__, (a), (b), (size)), \
+        STF_INTERNAL_NONFATAL)
+
+// Non-fatal macro to test memory ranges for inequality
+#define STF_EXPECT_MEM_NE(a, b, size) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertMemoryNotEqual(__FILE__, __LINE__, (a), (b), (size)), \
+        STF_INTERNAL_NONFATAL)
+
+// Non-fatal macro to test for exceptions to be thrown on a function call
+#define STF_EXPECT_EXCEPTION(function) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertException(__FILE__, __LINE__, (function)), \
+        STF_INTERNAL_NONFATAL)
+
+// Non-fatal macro to test for specific exceptions to be thrown on a function call
+#define STF_EXPECT_EXCEPTION_E(function, exception) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::AssertException<exception>(__FILE__, \
+                                               __LINE__, \
+                                               (function), \
+                                               #exception), \
+        STF_INTERNAL_NONFATAL)
+
+// Macros used internally to implement the above assertion macros
+#define STF_INTERNAL_EQ(expected, actual, on_failure) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::CheckEqual(__FILE__, __LINE__, (expected), (actual)), \
+        on_failure)
+
+#define STF_INTERNAL_COMPARE(a, comparison, b, on_failure) \
+    STF_INTERNAL_CHECK( \
+        Terra::STF::CheckCompare( \
+            __FILE__, \
+            __LINE__, \
+            (a), \
+            (b), \
+            Terra::STF::ComparisonTag< \
+                Terra::STF::Comparison::comparison>{}), \
+        on_failure)
+
+#define STF_INTERNAL_CHECK(assertion, on_failure) \
+    if (!(assertion)) STF_INTERNAL_UNLIKELY on_failure
+
+// Hint that an assertion failure branch is not expected to be taken
+#if (__cplusplus >= 202002L) || \
+    (defined(_MSVC_LANG) && (_MSVC_LANG >= 202002L))
+#define STF_INTERNAL_UNLIKELY [[unlikely]]
+#else
+#define STF_INTERNAL_UNLIKELY
+#endif
+
+// Keep failure reporting functions out of line and away from the hot path
+#if defined(__GNUC__) || defined(__clang__)
+#define STF_INTERNAL_COLD __attribute__((cold, noinline))
+#elif defined(_MSC_VER)
+#define STF_INTERNAL_COLD __declspec(noinline)
+#else
+#define STF_INTERNAL_COLD
+#endif
+
+// Failure action for assertions that end the test
+#define STF_INTERNAL_FATAL \
     { \
-        Terra::STF::Test_Failed = true; \
+        Terra::STF::RecordFailure(); \
         return; \
     }
 
+// Failure action for assertions that allow the test to continue
+#define STF_INTERNAL_NONFATAL \
+    { \
+        static Terra::STF::ExpectSite stf_expect_site(__FILE__, __LINE__); \
+        stf_expect_site.RecordFailure(); \
+    }
+
 //////////////////////////////////////////////////////////////////////////////
 ////////////////////                                   ///////////////////////
 ////////////////////     Internal Functions Follow     ///////////////////////
@@ -269,13 +575,215 @@ namespace Terra::STF
 // Default test timeout in seconds
 constexpr unsigned Default_Timeout = 600;
 
+// Default number of failures reported per STF_EXPECT_* assertion site
+constexpr std::size_t Default_Expect_Report_Limit = 10;
+
+// Default number of rounds and time budget for STF_TEST_CONCURRENT tests
+constexpr std::size_t Default_Concurrent_Rounds = 1000;
+constexpr unsigned Default_Concurrent_Seconds = 5;
+
 // String Constants
 extern std::string ExpectText;
 extern std::string ActualText;
 extern std::string LHSText;
 extern std::string RHSText;
-extern std::atomic<bool> Test_Failed;
 extern unsigned failed_registrations;
+extern std::size_t Expect_Report_Limit;
+
+/*
+ *  Formatter
+ *
+ *  Description:
+ *      This is a small text formatter used to produce test output without
+ *      the use of iostreams.  Numeric values are converted using
+ *      std::to_chars() into a fixed-size scratch buffer on the stack and
+ *      then appended to the formatter's string buffer.
+ *
+ *  Comments:
+ *      None.
+ */
+class Formatter
+{
+    public:
+        Formatter() = default;
+        ~Formatter() = default;
+
+        Formatter &Text(std::string_view text)
+        {
+            buffer.append(text.data(), text.size());
+            return *this;
+        }
+
+        Formatter &Character(char c)
+        {
+            buffer.push_back(c);
+            return *this;
+        }
+
+        Formatter &Boolean(bool value)
+        {
+            return Text(value ? "true" : "false");
+        }
+
+        Formatter &NewLine() { return Character('\n'); }
+
+        template<typename T,
+                 typename std::enable_if<std::is_integral<T>::value,
+                                         bool>::type = true>
+        Formatter &Decimal(T value)
+        {
+            char digits[24];
+            std::to_chars_result result{};
+
+            // Promote to the widest type of the same signedness
+            if constexpr (std::is_signed<T>::value)
+            {
+                result = std::to_chars(digits,
+                                       digits + sizeof(digits),
+                                       static_cast<long long>(value));
+            }
+            else
+            {
+                result = std::to_chars(digits,
+                                       digits + sizeof(digits),
+                                       static_cast<unsigned long long>(value));
+            }
+
+            buffer.append(digits, result.ptr);
+
+            return *this;
+        }
+
+        template<typename T,
+                 typename std::enable_if<std::is_integral<T>::value,
+                                         bool>::type = true>
+        Formatter &Hex(T value, std::size_t width = 0)
+        {
+            char digits[16];
+
+            // Render the two's complement representation of the value
+            auto result = std::to_chars(
+                digits,
+                digits + sizeof(digits),
+                static_cast<unsigned long long>(
+                    static_cast<typename std::make_unsigned<T>::type>(value)),
+                16);
+            std::size_t length = static_cast<std::size_t>(result.ptr - digits);
+
+            // Left-pad with zeros to the requested width
+            if (length < width) buffer.append(width - length, '0');
+
+            buffer.append(digits, length);
+
+            return *this;
+        }
+
+        Formatter &Float(float value, int precision);
+        Formatter &Float(double value, int precision);
+        Formatter &Float(long double value, int precision);
+        Formatter &Address(const void *address);
+
+        bool Empty() const noexcept { return buffer.empty(); }
+        const std::string &String() const noexcept { return buffer; }
+        void Clear() noexcept { buffer.clear(); }
+
+    protected:
+        std::string buffer;
+};
+
+/*
+ *  TensorView
+ *
+ *  Description:
+ *      Describes one, two, or three dimensional numeric data in memory for
+ *      comparison using STF_ASSERT_TENSOR_CLOSE.  Extents are ordered as
+ *      planes, rows, and columns.  Strides are the distance in elements
+ *      between consecutive planes, rows, and columns, respectively, which
+ *      allows for padded rows and interleaved channels.
+ *
+ *  Comments:
+ *      The view does not own the data.
+ */
+template<typename T>
+struct TensorView
+{
+    // One dimensional, contiguous data
+    TensorView(const T *data, std::size_t columns) :
+        data{data},
+        rank{1},
+        extents{1, 1, columns},
+        strides{0, 0, 1}
+    {
+        // Nothing to do
+    }
+
+    // Two dimensional data with row_stride elements between rows
+    TensorView(const T *data,
+               std::size_t rows,
+               std::size_t columns,
+               std::ptrdiff_t row_stride) :
+        data{data},
+        rank{2},
+        extents{1, rows, columns},
+        strides{0, row_stride, 1}
+    {
+        // Nothing to do
+    }
+
+    // Three dimensional data with arbitrary strides
+    TensorView(const T *data,
+               const std::array<std::size_t, 3> &extents,
+               const std::array<std::ptrdiff_t, 3> &strides) :
+        data{data},
+        rank{3},
+        extents{extents},
+        strides{strides}
+    {
+        // Nothing to do
+    }
+
+    const T *data;
+    std::size_t rank;
+    std::array<std::size_t, 3> extents;
+    std::array<std::ptrdiff_t, 3> strides;
+};
+
+/*
+ *  PendingOutput()
+ *
+ *  Description:
+ *      Return the calling thread's formatter into which the message currently
+ *      being constructed is written.  The message is appended to the test
+ *      output buffer by calling CommitOutput().
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      A reference to the calling thread's pending output formatter.
+ *
+ *  Comments:
+ *      None.
+ */
+Formatter &PendingOutput();
+
+/*
+ *  CommitOutput()
+ *
+ *  Description:
+ *      Append the calling thread's pending output to the output buffer of
+ *      the calling thread's current test context.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      The buffered output is written to stdout once when the test completes.
+ */
+void CommitOutput();
 
 /*
  *  RegisterTest()
@@ -305,6 +813,48 @@ std::size_t RegisterTest(const char *name,
                          const std::function<void()> &test,
                          unsigned timeout = Default_Timeout) noexcept;
 
+// Functions through which the runner executes tests defined with
+// STF_TEST_ASYNC (see async.h).  The first starts a test on the calling
+// thread's event loop, and the second runs that event loop until all tests
+// started on it complete or the given time is reached, returning true if
+// all of the tests completed.
+using AsyncTestStart = void (*)();
+using AsyncTestRun = bool (*)(std::chrono::steady_clock::time_point);
+
+/*
+ *  RegisterAsyncTest()
+ *
+ *  Description:
+ *      Function to register a test defined with STF_TEST_ASYNC with the
+ *      Simple Test Framework.
+ *
+ *  Parameters:
+ *      name [in]
+ *          The name of the test.
+ *
+ *      start [in]
+ *          The function that starts the test on the calling thread's event
+ *          loop, reporting to the calling thread's current context.
+ *
+ *      run [in]
+ *          The function that runs the calling thread's event loop.
+ *
+ *      timeout [in]
+ *          Time after which the test will assume to have stalled and the
+ *          test will be aborted.
+ *
+ *  Returns:
+ *      An identifier for the registered test.
+ *
+ *  Comments:
+ *      Asynchronous tests are run after all other tests.  They are all
+ *      started together and run concurrently on a single thread.
+ */
+std::size_t RegisterAsyncTest(const char *name,
+                              AsyncTestStart start,
+                              AsyncTestRun run,
+                              unsigned timeout) noexcept;
+
 /*
  *  ExcludeTest()
  *
@@ -324,18 +874,15 @@ std::size_t RegisterTest(const char *name,
 bool ExcludeTest(const char *name) noexcept;
 
 /*
- *  PrintValue()
+ *  RecordFailure()
  *
  *  Description:
- *      This function will print the expect/actual string (or similar)
- *      along with the value.  This is called by failing tests.
+ *      Record that an assertion failed in the calling thread's current test
+ *      context.  Any pending output describing the failure is appended to
+ *      the test output buffer as a single unit.
  *
  *  Parameters:
- *      text [in]
- *          The text to print (e.g., "expected").
- *
- *      value [in]
- *          The value to print.
+ *      None.
  *
  *  Returns:
  *      Nothing.
@@ -343,135 +890,341 @@ bool ExcludeTest(const char *name) noexcept;
  *  Comments:
  *      None.
  */
-void PrintValue(const std::string &text, bool value);
+STF_INTERNAL_COLD void RecordFailure();
 
 /*
- *  PrintValue()
+ *  ExpectSite
  *
  *  Description:
- *      This function will print the expect/actual string (or similar)
- *      along with the value.  This is called by failing tests.
- *
- *  Parameters:
- *      text [in]
- *          The text to print (e.g., "expected").
+ *      Identifies a single STF_EXPECT_* assertion site so that the number
+ *      of failures at that site within a test can be counted and output
+ *      rate limited.  Only the first Expect_Report_Limit failures at a site
+ *      are reported; further failures are counted and summarized when the
+ *      test completes.
  *
- *      value [in]
- *          The value to print.
+ *  Comments:
+ *      Objects of this type are defined as function-local statics by the
+ *      STF_EXPECT_* macros within the failure branch, so they cost nothing
+ *      when assertions succeed.  The failure counts are held by the
+ *      TestContext of the running test, so a site may be shared by tests
+ *      that run concurrently.
+ */
+class ExpectSite
+{
+    public:
+        constexpr ExpectSite(const char *file, std::size_t line) noexcept :
+            file{file},
+            line{line}
+        {
+            // Nothing to do
+        }
+        ~ExpectSite() = default;
+
+        STF_INTERNAL_COLD void RecordFailure() const;
+        const char *File() const noexcept { return file; }
+        std::size_t Line() const noexcept { return line; }
+
+    protected:
+        const char *file;
+        std::size_t line;
+};
+
+// Scheduler of virtual time, defined in virtual_clock.h
+class VirtualScheduler;
+
+/*
+ *  TestContext
  *
- *  Returns:
- *      Nothing.
+ *  Description:
+ *      Holds the state of a single running test: its name, the number of
+ *      assertion failures, the failure counts for STF_EXPECT_* assertion
+ *      sites, the buffer of output the test has produced, the time at which
+ *      the test will be terminated, the seed that drives STF_YIELD_POINT()
+ *      perturbations, the VirtualScheduler providing the test's virtual
+ *      time, if any, and the time at which the test completed, for tests
+ *      that are not run on a thread of their own.  All member functions
+ *      other than SetDeadline(), SetYieldSeed(), and Complete() may be
+ *      called from any number of threads at once.
  *
  *  Comments:
- *      None.
+ *      Assertions report to the calling thread's current context, which is
+ *      established with ContextScope.  A thread having no current context
+ *      reports to the context of the test the runner is executing, so
+ *      threads created directly with std::thread are attributed to that
+ *      test.  Threads created with Terra::STF::Thread inherit the context
+ *      of the creating thread, which remains correct even if tests are
+ *      executed in parallel.
  */
-void PrintValue(const std::string &text, unsigned char value);
+class TestContext
+{
+    public:
+        explicit TestContext(std::string name);
+        TestContext(const TestContext &) = delete;
+        ~TestContext() = default;
+
+        TestContext &operator=(const TestContext &) = delete;
+
+        const std::string &Name() const noexcept { return name; }
+        std::size_t Failures() const noexcept { return failures; }
+        bool Failed() const noexcept { return failures > 0; }
+        std::chrono::steady_clock::time_point Deadline() const noexcept
+        {
+            return deadline;
+        }
+        void SetDeadline(std::chrono::steady_clock::time_point time) noexcept
+        {
+            deadline = time;
+        }
+        std::uint64_t YieldSeed() const noexcept { return yield_seed; }
+        void SetYieldSeed(std::uint64_t seed) noexcept { yield_seed = seed; }
+        bool YieldPointsReached() const noexcept
+        {
+            return yield_points_reached.load(std::memory_order_relaxed);
+        }
+        void NoteYieldPoint() noexcept
+        {
+            if (!yield_points_reached.load(std::memory_order_relaxed))
+            {
+                yield_points_reached.store(true, std::memory_order_relaxed);
+            }
+        }
+        std::uint64_t Serial() const noexcept { return serial; }
+        std::size_t NewYieldThread() noexcept { return yield_threads++; }
+        VirtualScheduler *Scheduler() const noexcept { return scheduler; }
+        VirtualScheduler *SetScheduler(VirtualScheduler *value) noexcept
+        {
+            return scheduler.exchange(value);
+        }
+        void Complete() noexcept
+        {
+            completion_time = std::chrono::steady_clock::now();
+            completed.store(true, std::memory_order_release);
+        }
+        bool Completed() const noexcept
+        {
+            return completed.load(std::memory_order_acquire);
+        }
+        std::chrono::steady_clock::time_point CompletionTime() const noexcept
+        {
+            return completion_time;
+        }
+
+        void Commit(Formatter &pending);
+        STF_INTERNAL_COLD void RecordFailure(Formatter &pending);
+        STF_INTERNAL_COLD void RecordFailure(Formatter &pending,
+                                             const ExpectSite &site);
+        bool Suppressed(const char *file, std::size_t line) const;
+        std::string TakeOutput();
+        void Summarize(Formatter &summary) const;
+
+    protected:
+        const std::string name;
+        std::atomic<std::size_t> failures;
+        std::chrono::steady_clock::time_point deadline;
+        const std::uint64_t serial;
+        std::uint64_t yield_seed;
+        std::atomic<bool> yield_points_reached;
+        std::atomic<std::size_t> yield_threads;
+        std::atomic<VirtualScheduler *> scheduler;
+        std::chrono::steady_clock::time_point completion_time;
+        std::atomic<bool> completed;
+        mutable std::mutex mutex;
+        std::string output;
+        std::vector<std::pair<const ExpectSite *, std::size_t>> expect_sites;
+};
 
 /*
- *  PrintValue()
+ *  CurrentContext()
  *
  *  Description:
- *      This function will print the expect/actual string (or similar)
- *      along with the value.  This is called by failing tests.
+ *      Return the context to which assertions made by the calling thread
+ *      are reported.
  *
  *  Parameters:
- *      text [in]
- *          The text to print (e.g., "expected").
- *
- *      value [in]
- *          The value to print.
+ *      None.
  *
  *  Returns:
- *      Nothing.
+ *      The calling thread's current context, else the context of the test
+ *      being executed by the runner, else nullptr if no test is running.
  *
  *  Comments:
  *      None.
  */
-void PrintValue(const std::string &text, char value);
+TestContext *CurrentContext() noexcept;
 
 /*
- *  PrintValue()
+ *  WorkDeadline()
  *
  *  Description:
- *      This function will print the expect/actual string (or similar)
- *      along with the value.  This is called by failing tests.
+ *      Return the time by which lengthy work performed by an assertion (such
+ *      as a search) should stop so that its outcome can still be reported
+ *      before the current test exceeds its timeout.
  *
  *  Parameters:
- *      text [in]
- *          The text to print (e.g., "expected").
- *
- *      value [in]
- *          The value to print.
+ *      None.
  *
  *  Returns:
- *      Nothing.
+ *      A time nine tenths of the way from now to the current test's
+ *      deadline, or Default_Timeout seconds from now if there is no current
+ *      test.
  *
  *  Comments:
  *      None.
  */
-void PrintValue(const std::string &text, signed char value);
+std::chrono::steady_clock::time_point WorkDeadline();
 
 /*
- *  PrintValue()
+ *  WorkerThreads()
  *
  *  Description:
- *      This function will print the expect/actual string (or similar)
- *      along with the value.  This is called by failing tests.
+ *      Return the number of worker threads over which work that can be
+ *      divided (such as the instances of a test defined with STF_TEST_P) is
+ *      spread.
  *
  *  Parameters:
- *      text [in]
- *          The text to print (e.g., "expected").
- *
- *      value [in]
- *          The value to print.
+ *      None.
  *
  *  Returns:
- *      Nothing.
+ *      The value of the STF_JOBS environment variable if set to a positive
+ *      number, else the number of hardware threads.
  *
  *  Comments:
  *      None.
  */
-#ifdef __cpp_char8_t
-void PrintValue(const std::string &text, char8_t value);
-#endif
+std::size_t WorkerThreads();
 
 /*
- *  PrintValue()
+ *  PrintThroughput()
  *
  *  Description:
- *      This function will print the expect/actual string (or similar)
- *      along with the value.  This is called by failing tests.
+ *      Print the throughput of the code under test to the pending output.
  *
  *  Parameters:
- *      text [in]
- *          The text to print (e.g., "expected").
+ *      cases [in]
+ *          The number of cases run.
  *
- *      value [in]
- *          The value to print.
+ *      octets [in]
+ *          The number of octets in the inputs of those cases.
+ *
+ *      time [in]
+ *          The time taken to run those cases.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      The throughput is in octets per second if the inputs have a size,
+ *      else in cases per second.
+ */
+void PrintThroughput(std::size_t cases,
+                     std::size_t octets,
+                     std::chrono::nanoseconds time);
+
+/*
+ *  PinToProcessor()
+ *
+ *  Description:
+ *      Pin the calling thread to one of the processors on which it is
+ *      allowed to run, selected in turn by the given index.
+ *
+ *  Parameters:
+ *      index [in]
+ *          The index of the thread, used to select the processor.
  *
  *  Returns:
  *      Nothing.
  *
  *  Comments:
+ *      This is only implemented for Linux.  Failure to pin the thread is not
+ *      an error, as it only affects how the threads are scheduled.
+ */
+void PinToProcessor(std::size_t index);
+
+/*
+ *  PinToCurrentProcessor()
+ *
+ *  Description:
+ *      Pin the calling thread to the processor on which it is running.
+ *
+ *  Parameters:
  *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      The scheduler has already placed the thread, so unlike pinning to a
+ *      fixed processor, threads pinned this way by tests running at the same
+ *      time are spread over the processors.  This is only implemented for
+ *      Linux.  Failure to pin the thread is not an error.
  */
-#ifdef __cpp_unicode_characters
-void PrintValue(const std::string &text, char16_t value);
-#endif
+void PinToCurrentProcessor();
 
 /*
- *  PrintValue()
+ *  ContextScope
  *
  *  Description:
- *      This function will print the expect/actual string (or similar)
- *      along with the value.  This is called by failing tests.
+ *      Makes the given context the calling thread's current context for the
+ *      lifetime of this object.  On destruction, any output pending on the
+ *      calling thread is committed and the previous context is restored.
+ *
+ *  Comments:
+ *      A test may use this with a local TestContext to run code whose
+ *      failures should be examined rather than fail the test, though
+ *      CaptureOutput() is simpler when only the output and failures are
+ *      needed.
+ */
+class ContextScope
+{
+    public:
+        explicit ContextScope(TestContext *context) noexcept;
+        ContextScope(const ContextScope &) = delete;
+        ~ContextScope();
+
+        ContextScope &operator=(const ContextScope &) = delete;
+
+    protected:
+        TestContext *previous;
+};
+
+// The output and failures of code run by CaptureOutput()
+struct CapturedOutput
+{
+    std::string output;                 // Output of the code
+    std::size_t failures;               // Number of failures recorded
+    bool failed;                        // True if any failure was recorded
+};
+
+/*
+ *  CaptureOutput()
+ *
+ *  Description:
+ *      Run a function with a scratch context as the calling thread's current
+ *      context, so that its failures are examined rather than fail the test.
  *
  *  Parameters:
- *      text [in]
- *          The text to print (e.g., "expected").
+ *      function [in]
+ *          The function to run.
  *
- *      value [in]
- *          The value to print.
+ *  Returns:
+ *      The output of the function and the failures it recorded.
+ *
+ *  Comments:
+ *      The scratch context has the deadline and yield seed of the current
+ *      context.  An exception thrown by the function is not caught.
+ */
+CapturedOutput CaptureOutput(const std::function<void()> &function);
+
+/*
+ *  ReportThreadException()
+ *
+ *  Description:
+ *      Record a failure due to an exception escaping a function run on a
+ *      thread created by the test framework.  This must be called from
+ *      within a catch block.
+ *
+ *  Parameters:
+ *      None.
  *
  *  Returns:
  *      Nothing.
@@ -479,23 +1232,18 @@ void PrintValue(const std::string &text, char16_t value);
  *  Comments:
  *      None.
  */
-#ifdef __cpp_unicode_characters
-void PrintValue(const std::string &text, char32_t value);
-#endif
+STF_INTERNAL_COLD void ReportThreadException();
 
 /*
- *  PrintValue()
+ *  ReportUnexpectedException()
  *
  *  Description:
- *      This function will print the expect/actual string (or similar)
- *      along with the value.  This is called by failing tests.
+ *      Record a failure due to an exception escaping a test or a part of a
+ *      test run by the test framework.  This must be called from within a
+ *      catch block.
  *
  *  Parameters:
- *      text [in]
- *          The text to print (e.g., "expected").
- *
- *      value [in]
- *          The value to print.
+ *      None.
  *
  *  Returns:
  *      Nothing.
@@ -503,47 +1251,309 @@ void PrintValue(const std::string &text, char32_t value);
  *  Comments:
  *      None.
  */
-void PrintValue(const std::string &text, wchar_t value);
+STF_INTERNAL_COLD void ReportUnexpectedException();
 
 /*
- *  PrintValue()
+ *  RunInChildContext()
  *
  *  Description:
- *      This function prints the expect/actual string (or similar) along
- *      with the value if it has streaming operator defined. This is called
- *      by failing tests.
+ *      Run a function with the given context as the calling thread's current
+ *      context, reporting an exception escaping the function as a failure in
+ *      that context.
  *
  *  Parameters:
- *      text [in]
- *          The text to print (e.g., "expected").
+ *      context [in/out]
+ *          The context to which the function reports.
  *
- *      value [in]
- *          The value to print.
+ *      parent [in]
+ *          The context from which the deadline and yield point seed are
+ *          taken, or nullptr.
  *
- *      _ [in]
- *          Dummy for function disambiguation.
+ *      function [in]
+ *          The function to run.
  *
  *  Returns:
  *      Nothing.
  *
  *  Comments:
- *      None.
+ *      This is used to run parts of a test, such as parameterized test
+ *      instances or property cases, whose failures are examined separately.
+ *      The previous context is restored on return.
  */
-template<typename T>
-auto PrintValue(const std::string &text, const T &value, int) ->
-                                        decltype(std::cout << value, void())
+template<typename Function>
+void RunInChildContext(TestContext &context,
+                       const TestContext *parent,
+                       Function &&function)
+{
+    if (parent != nullptr)
+    {
+        context.SetDeadline(parent->Deadline());
+        context.SetYieldSeed(parent->YieldSeed());
+    }
+
+    ContextScope scope(&context);
+
+    try
+    {
+        std::forward<Function>(function)();
+    }
+    catch (...)
+    {
+        ReportUnexpectedException();
+    }
+}
+
+/*
+ *  RunOnWorkers()
+ *
+ *  Description:
+ *      Run a function on the given number of threads at once, one of which
+ *      is the calling thread, returning once all have finished.
+ *
+ *  Parameters:
+ *      workers [in]
+ *          The number of threads; the function is run at least once.
+ *
+ *      worker [in]
+ *          The function to run, which takes work from a shared source until
+ *          none remains.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      The other threads do not have a current context.
+ */
+template<typename Function>
+void RunOnWorkers(std::size_t workers, const Function &worker)
 {
-    std::cout << text << value << std::endl;
+    std::vector<std::thread> threads;
+
+    for (std::size_t i = 1; i < workers; i++) threads.emplace_back(worker);
+
+    worker();
+
+    for (auto &thread : threads) thread.join();
 }
 
+/*
+ *  Thread
+ *
+ *  Description:
+ *      A thread that inherits the current context of the thread creating it,
+ *      so that assertions made on the new thread are attributed to the same
+ *      test.  It is otherwise used like std::thread, except that it is
+ *      joined on destruction if it has not been joined already.
+ *
+ *  Comments:
+ *      A fatal STF_ASSERT_* failure returns from the function in which it
+ *      appears, so it ends the thread only if it appears in the thread's
+ *      top-level function.  Exceptions escaping the thread function are
+ *      reported as failures rather than terminating the program.
+ */
+class Thread
+{
+    public:
+        Thread() noexcept = default;
+        template<typename F, typename... Args>
+        explicit Thread(F &&function, Args &&...args) :
+            thread{[context = CurrentContext(),
+                    function = std::forward<F>(function)](
+                       auto &&...arguments) mutable
+                   {
+                       ContextScope scope(context);
+
+                       try
+                       {
+                           function(
+                               std::forward<decltype(arguments)>(arguments)...);
+                       }
+                       catch (...)
+                       {
+                           ReportThreadException();
+                       }
+                   },
+                   std::forward<Args>(args)...}
+        {
+            // Nothing to do
+        }
+        Thread(Thread &&) noexcept = default;
+        ~Thread() { if (thread.joinable()) thread.join(); }
+
+        Thread &operator=(Thread &&other) noexcept
+        {
+            if (thread.joinable()) thread.join();
+            thread = std::move(other.thread);
+            return *this;
+        }
+
+        bool Joinable() const noexcept { return thread.joinable(); }
+        void Join() { thread.join(); }
+        std::thread::id GetID() const noexcept { return thread.get_id(); }
+
+    protected:
+        std::thread thread;
+};
+
+/*
+ *  SpinBarrier
+ *
+ *  Description:
+ *      A reusable barrier for a fixed number of participating threads.
+ *      Threads waiting at the barrier spin rather than block so that all are
+ *      released at very nearly the same moment, which maximizes contention
+ *      in the code that follows.  A participant may drop out, after which
+ *      the barrier waits for one fewer thread.
+ *
+ *  Comments:
+ *      Waiting threads periodically yield so that the barrier remains usable
+ *      when there are more threads than processors.
+ */
+class SpinBarrier
+{
+    public:
+        explicit SpinBarrier(std::size_t participants) noexcept;
+        SpinBarrier(const SpinBarrier &) = delete;
+        ~SpinBarrier() = default;
+
+        SpinBarrier &operator=(const SpinBarrier &) = delete;
+
+        void ArriveAndWait();
+        void ArriveAndDrop();
+        void Reset(std::size_t participants);
+
+    protected:
+        void Release();
+
+        std::mutex mutex;
+        std::size_t participants;
+        std::size_t arrived;
+        std::atomic<std::size_t> generation;
+};
+
+/*
+ *  RunConcurrent()
+ *
+ *  Description:
+ *      Run the given function on the given number of threads at once,
+ *      repeatedly, as done for tests defined with STF_TEST_CONCURRENT.  In
+ *      each round, all threads are released together by a spin barrier and
+ *      the round ends when every thread has returned from the function.
+ *
+ *  Parameters:
+ *      function [in]
+ *          The function to run on each thread.
+ *
+ *      threads [in]
+ *          The number of threads; zero selects the number of hardware
+ *          threads (but at least two).
+ *
+ *      rounds [in]
+ *          The maximum number of rounds to run; zero means no limit.
+ *
+ *      seconds [in]
+ *          The time after which no further rounds are started; zero means
+ *          no limit.  If both limits are zero, one round is run.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      Threads report assertion failures to the calling thread's current
+ *      context.  No further rounds are started once a round has failed, and
+ *      the failing round is reported numbered from zero, as returned by
+ *      ConcurrentRound().  On Linux, the threads are pinned to the available
+ *      processors in turn.
+ */
+void RunConcurrent(void (*function)(),
+                   std::size_t threads,
+                   std::size_t rounds,
+                   unsigned seconds);
+
+/*
+ *  ConcurrentThreadIndex()
+ *
+ *  Description:
+ *      Return the index of the calling thread within an STF_TEST_CONCURRENT
+ *      test, from zero to ConcurrentThreadCount() - 1.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The index of the calling thread, or zero if not called from within
+ *      an STF_TEST_CONCURRENT test.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t ConcurrentThreadIndex() noexcept;
+
+/*
+ *  ConcurrentThreadCount()
+ *
+ *  Description:
+ *      Return the number of threads running an STF_TEST_CONCURRENT test.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The number of threads, or one if not called from within an
+ *      STF_TEST_CONCURRENT test.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t ConcurrentThreadCount() noexcept;
+
+/*
+ *  ConcurrentRound()
+ *
+ *  Description:
+ *      Return the number of the round of an STF_TEST_CONCURRENT test being
+ *      run by the calling thread, starting from zero.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The round number, or zero if not called from within an
+ *      STF_TEST_CONCURRENT test.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t ConcurrentRound() noexcept;
+
+/*
+ *  ConcurrentSync()
+ *
+ *  Description:
+ *      Wait until every thread running the current round of an
+ *      STF_TEST_CONCURRENT test has called this function or returned from
+ *      the test function.  This allows one thread to prepare shared state
+ *      before the others use it, for example.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      Threads that have returned (for example, due to a failed
+ *      STF_ASSERT_* macro) are not waited for, so this does not deadlock.
+ *      Does nothing if not called from within an STF_TEST_CONCURRENT test.
+ */
+void ConcurrentSync();
+
 /*
  *  PrintValue()
  *
  *  Description:
- *      This function prints the expect/actual string (or similar) along
- *      with a message indicating T is an unprintable object type and memory
- *      address of "value" when a streaming operator is not defined for the
- *      type T. This is called by failing tests.
+ *      This function will print the expect/actual string (or similar)
+ *      along with the value.  This is called by failing tests.
  *
  *  Parameters:
  *      text [in]
@@ -552,25 +1562,13 @@ auto PrintValue(const std::string &text, const T &value, int) ->
  *      value [in]
  *          The value to print.
  *
- *      _ [in]
- *          Dummy for function disambiguation.
- *
  *  Returns:
  *      Nothing.
  *
  *  Comments:
  *      None.
  */
-template<typename T>
-auto PrintValue(const std::string &text, const T &value, long) ->
-                                                            decltype(void())
-{
-    std::cout << text
-              << "[Unprintable object at address 0x"
-              << reinterpret_cast<const void *>(&value)
-              << "]"
-              << std::endl;
-}
+void PrintValue(const std::string &text, bool value);
 
 /*
  *  PrintValue()
@@ -592,15 +1590,7 @@ auto PrintValue(const std::string &text, const T &value, long) ->
  *  Comments:
  *      None.
  */
-template<typename T,
-         typename std::enable_if<!std::is_integral<T>::value &&
-                                 !std::is_floating_point<T>::value &&
-                                 !std::is_array<T>::value &&
-                                 !std::is_pointer<T>::value, bool>::type = true>
-void PrintValue(const std::string &text, const T &value)
-{
-    PrintValue(text, value, 0);
-}
+void PrintValue(const std::string &text, unsigned char value);
 
 /*
  *  PrintValue()
@@ -609,101 +1599,1047 @@ void PrintValue(const std::string &text, const T &value)
  *      This function will print the expect/actual string (or similar)
  *      along with the value.  This is called by failing tests.
  *
- *  Parameters:
- *      text [in]
- *          The text to print (e.g., "expected").
+ *  Parameters:
+ *      text [in]
+ *          The text to print (e.g., "expected").
+ *
+ *      value [in]
+ *          The value to print.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void PrintValue(const std::string &text, char value);
+
+/*
+ *  PrintValue()
+ *
+ *  Description:
+ *      This function will print the expect/actual string (or similar)
+ *      along with the value.  This is called by failing tests.
+ *
+ *  Parameters:
+ *      text [in]
+ *          The text to print (e.g., "expected").
+ *
+ *      value [in]
+ *          The value to print.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void PrintValue(const std::string &text, signed char value);
+
+/*
+ *  PrintValue()
+ *
+ *  Description:
+ *      This function will print the expect/actual string (or similar)
+ *      along with the value.  This is called by failing tests.
+ *
+ *  Parameters:
+ *      text [in]
+ *          The text to print (e.g., "expected").
+ *
+ *      value [in]
+ *          The value to print.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+#ifdef __cpp_char8_t
+void PrintValue(const std::string &text, char8_t value);
+#endif
+
+/*
+ *  PrintValue()
+ *
+ *  Description:
+ *      This function will print the expect/actual string (or similar)
+ *      along with the value.  This is called by failing tests.
+ *
+ *  Parameters:
+ *      text [in]
+ *          The text to print (e.g., "expected").
+ *
+ *      value [in]
+ *          The value to print.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+#ifdef __cpp_unicode_characters
+void PrintValue(const std::string &text, char16_t value);
+#endif
+
+/*
+ *  PrintValue()
+ *
+ *  Description:
+ *      This function will print the expect/actual string (or similar)
+ *      along with the value.  This is called by failing tests.
+ *
+ *  Parameters:
+ *      text [in]
+ *          The text to print (e.g., "expected").
+ *
+ *      value [in]
+ *          The value to print.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+#ifdef __cpp_unicode_characters
+void PrintValue(const std::string &text, char32_t value);
+#endif
+
+/*
+ *  PrintValue()
+ *
+ *  Description:
+ *      This function will print the expect/actual string (or similar)
+ *      along with the value.  This is called by failing tests.
+ *
+ *  Parameters:
+ *      text [in]
+ *          The text to print (e.g., "expected").
+ *
+ *      value [in]
+ *          The value to print.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void PrintValue(const std::string &text, wchar_t value);
+
+/*
+ *  PrintValue()
+ *
+ *  Description:
+ *      This function will print the expect/actual string (or similar)
+ *      along with the value.  This is called by failing tests.
+ *
+ *  Parameters:
+ *      text [in]
+ *          The text to print (e.g., "expected").
+ *
+ *      value [in]
+ *          The value to print.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void PrintValue(const std::string &text, const std::string &value);
+
+/*
+ *  PrintValue()
+ *
+ *  Description:
+ *      This function prints the expect/actual string (or similar) along
+ *      with the value if it has streaming operator defined. This is called
+ *      by failing tests.
+ *
+ *  Parameters:
+ *      text [in]
+ *          The text to print (e.g., "expected").
+ *
+ *      value [in]
+ *          The value to print.
+ *
+ *      _ [in]
+ *          Dummy for function disambiguation.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename T>
+auto PrintValue(const std::string &text, const T &value, int) ->
+    decltype(std::declval<std::ostream &>() << value, void())
+{
+    std::ostringstream oss;
+
+    oss << value;
+
+    PendingOutput().Text(text).Text(oss.str()).NewLine();
+}
+
+/*
+ *  PrintValue()
+ *
+ *  Description:
+ *      This function prints the expect/actual string (or similar) along
+ *      with a message indicating T is an unprintable object type and memory
+ *      address of "value" when a streaming operator is not defined for the
+ *      type T. This is called by failing tests.
+ *
+ *  Parameters:
+ *      text [in]
+ *          The text to print (e.g., "expected").
+ *
+ *      value [in]
+ *          The value to print.
+ *
+ *      _ [in]
+ *          Dummy for function disambiguation.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename T>
+auto PrintValue(const std::string &text, const T &value, long) ->
+                                                            decltype(void())
+{
+    PendingOutput().Text(text)
+                    .Text("[Unprintable object at address ")
+                    .Address(reinterpret_cast<const void *>(&value))
+                    .Character(']')
+                    .NewLine();
+}
+
+/*
+ *  PrintValue()
+ *
+ *  Description:
+ *      This function will print the expect/actual string (or similar)
+ *      along with the value.  This is called by failing tests.
+ *
+ *  Parameters:
+ *      text [in]
+ *          The text to print (e.g., "expected").
+ *
+ *      value [in]
+ *          The value to print.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename T,
+         typename std::enable_if<!std::is_integral<T>::value &&
+                                 !std::is_floating_point<T>::value &&
+                                 !std::is_array<T>::value &&
+                                 !std::is_pointer<T>::value, bool>::type = true>
+void PrintValue(const std::string &text, const T &value)
+{
+    PrintValue(text, value, 0);
+}
+
+/*
+ *  PrintValue()
+ *
+ *  Description:
+ *      This function will print the expect/actual string (or similar)
+ *      along with the value.  This is called by failing tests.
+ *
+ *  Parameters:
+ *      text [in]
+ *          The text to print (e.g., "expected").
+ *
+ *      value [in]
+ *          The value to print.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename T,
+         typename std::enable_if<std::is_array<T>::value ||
+                                 std::is_pointer<T>::value, bool>::type = true>
+void PrintValue(const std::string &text, const T value)
+{
+    PendingOutput().Text(text)
+                    .Address(reinterpret_cast<const void *>(value))
+                    .Text(" (memory address)")
+                    .NewLine();
+}
+
+/*
+ *  PrintValue()
+ *
+ *  Description:
+ *      This function will print the expect/actual string (or similar)
+ *      along with the value.  This is called by failing tests.
+ *
+ *  Parameters:
+ *      text [in]
+ *          The text to print (e.g., "expected").
+ *
+ *      value [in]
+ *          The value to print.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename T,
+         typename std::enable_if<std::is_floating_point<T>::value,
+                                 bool>::type = true>
+void PrintValue(const std::string &text, T value)
+{
+    PendingOutput().Text(text).Float(value, 26).NewLine();
+}
+
+/*
+ *  PrintValue()
+ *
+ *  Description:
+ *      This function will print the expect/actual string (or similar)
+ *      along with the value.  This is called by failing tests.
+ *
+ *  Parameters:
+ *      text [in]
+ *          The text to print (e.g., "expected").
+ *
+ *      value [in]
+ *          The value to print.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename T,
+         typename std::enable_if<std::is_integral<T>::value, bool>::type = true>
+void PrintValue(const std::string &text, T value)
+{
+    PendingOutput().Text(text)
+                    .Decimal(value)
+                    .Text(" (0x")
+                    .Hex(+value, sizeof(T) * 2)
+                    .Character(')')
+                    .NewLine();
+}
+
+/*
+ *  PrintAssertFailed()
+ *
+ *  Description:
+ *      This function will print a message indicating an assertion failed.
+ *
+ *  Parameters:
+ *      file [in]
+ *          The name of the file where the test exists.
+ *
+ *      line [in]
+ *          The line number where the test failed.
+ *
+ *  Returns:
+ *      True if the failure is to be reported, or false if it is at an
+ *      STF_EXPECT_* assertion site whose reporting limit has been reached,
+ *      in which case nothing is printed and the caller need not describe
+ *      the failure.
+ *
+ *  Comments:
+ *      None.
+ */
+STF_INTERNAL_COLD bool PrintAssertFailed(const char *file, std::size_t line);
+
+/*
+ *  ValuePrinter
+ *
+ *  Description:
+ *      Refers to a value of any type along with the function that will print
+ *      it.  This allows the failure reporting functions to be ordinary
+ *      (non-template) functions compiled once in the library, so the code
+ *      generated for each assertion is just the comparison and a call.
+ *
+ *  Comments:
+ *      The referenced value must outlive this object.
+ */
+class ValuePrinter
+{
+    public:
+        template<typename T>
+        constexpr explicit ValuePrinter(const T &value) noexcept :
+            object{static_cast<const void *>(&value)},
+            print{&PrintObject<T>}
+        {
+            // Nothing to do
+        }
+
+        void operator()(const std::string &text) const
+        {
+            print(text, object);
+        }
+
+    protected:
+        template<typename T>
+        static void PrintObject(const std::string &text, const void *object)
+        {
+            PrintValue(text, *static_cast<const T *>(object));
+        }
+
+        const void *object;
+        void (*print)(const std::string &, const void *);
+};
+
+/*
+ *  ReportExpectFailure()
+ *
+ *  Description:
+ *      Report that a value does not agree with an expected value.
+ *
+ *  Parameters:
+ *      file [in]
+ *          The name of the file where the test exists.
+ *
+ *      line [in]
+ *          The line number where the test failed.
+ *
+ *      expected [in]
+ *          Printer for the expected value.
+ *
+ *      actual [in]
+ *          Printer for the actual value.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+STF_INTERNAL_COLD void ReportExpectFailure(const char *file,
+                                           std::size_t line,
+                                           const ValuePrinter &expected,
+                                           const ValuePrinter &actual);
+
+/*
+ *  ReportLhsRhsFailure()
+ *
+ *  Description:
+ *      Report that a lhs value does not compare as expected to a rhs value.
+ *
+ *  Parameters:
+ *      file [in]
+ *          The name of the file where the test exists.
+ *
+ *      line [in]
+ *          The line number where the test failed.
+ *
+ *      lhs [in]
+ *          Printer for the left-hand side value.
+ *
+ *      rhs [in]
+ *          Printer for the right-hand side value.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+STF_INTERNAL_COLD void ReportLhsRhsFailure(const char *file,
+                                           std::size_t line,
+                                           const ValuePrinter &lhs,
+                                           const ValuePrinter &rhs);
+
+/*
+ *  ExpectFail()
+ *
+ *  Description:
+ *      Handle the failure case when a value does not agree with an expected
+ *      value.
+ *
+ *  Parameters:
+ *      file [in]
+ *          The name of the file where the test exists.
+ *
+ *      line [in]
+ *          The line number where the test failed.
+ *
+ *      expected [in]
+ *          The expected value.
+ *
+ *      actual [in]
+ *          The actual value.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename T, typename U>
+void ExpectFail(const char *file,
+                const std::size_t line,
+                const T &expected,
+                const U &actual)
+{
+    ReportExpectFailure(file,
+                        line,
+                        ValuePrinter(expected),
+                        ValuePrinter(actual));
+}
+
+/*
+ *  LhsRhsFail()
+ *
+ *  Description:
+ *      Handle the failure cases when a lhs value does not compare as
+ *      expected to a rhs value.
+ *
+ *  Parameters:
+ *      file [in]
+ *          The name of the file where the test exists.
+ *
+ *      line [in]
+ *          The line number where the test failed.
+ *
+ *      lhs [in]
+ *          The left-hand side value to compare.
+ *
+ *      rhs [in]
+ *          The right-hand side value to compare.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename T, typename U>
+void LhsRhsFail(const char *file,
+                const std::size_t line,
+                const T &lhs,
+                const U &rhs)
+{
+    ReportLhsRhsFailure(file, line, ValuePrinter(lhs), ValuePrinter(rhs));
+}
+
+// Relational comparisons performed by the comparison assertion macros
+enum class Comparison
+{
+    Equal,
+    NotEqual,
+    Greater,
+    GreaterEqual,
+    Less,
+    LessEqual
+};
+
+// Tag type conveying a comparison to CheckCompare()
+template<Comparison comparison>
+using ComparisonTag = std::integral_constant<Comparison, comparison>;
+
+// Determine whether a type is an integer type that std::cmp_equal() and the
+// related functions accept (i.e., not bool or a character type)
+template<typename T>
+struct IsComparableInteger :
+    std::integral_constant<
+        bool,
+        std::is_integral<T>::value &&
+            !std::is_same<std::remove_cv_t<T>, bool>::value &&
+            !std::is_same<std::remove_cv_t<T>, char>::value &&
+            !std::is_same<std::remove_cv_t<T>, wchar_t>::value &&
+#if defined(__cpp_char8_t)
+            !std::is_same<std::remove_cv_t<T>, char8_t>::value &&
+#endif
+            !std::is_same<std::remove_cv_t<T>, char16_t>::value &&
+            !std::is_same<std::remove_cv_t<T>, char32_t>::value>
+{
+};
+
+// Determine whether a type is an std::atomic, whose value is compared
+template<typename T>
+struct IsAtomic : std::false_type
+{
+};
+
+template<typename T>
+struct IsAtomic<std::atomic<T>> : std::true_type
+{
+};
+
+// Determine whether an equality comparison is between an integer, such as a
+// literal 0 or NULL, and a pointer
+template<Comparison comparison, typename T, typename U>
+struct IsNullPointerComparison :
+    std::integral_constant<
+        bool,
+        ((comparison == Comparison::Equal) ||
+         (comparison == Comparison::NotEqual)) &&
+            std::is_integral<T>::value &&
+            (std::is_pointer<U>::value || std::is_member_pointer<U>::value)>
+{
+};
+
+/*
+ *  CompareIntegers()
+ *
+ *  Description:
+ *      Compare two integers of which exactly one is of a signed type, by
+ *      their mathematical values.
+ *
+ *  Parameters:
+ *      lhs [in]
+ *          The left-hand side value to compare.
+ *
+ *      rhs [in]
+ *          The right-hand side value to compare.
+ *
+ *  Returns:
+ *      A negative value, zero, or a positive value as lhs is less than,
+ *      equal to, or greater than rhs.
+ *
+ *  Comments:
+ *      The usual arithmetic conversions would convert a negative value to
+ *      a large unsigned value, so -1 would compare greater than 0u.
+ */
+template<typename T, typename U>
+constexpr int CompareIntegers(T lhs, U rhs) noexcept
+{
+#if defined(__cpp_lib_integer_comparison_functions)
+    return std::cmp_less(lhs, rhs) ? -1 : std::cmp_equal(lhs, rhs) ? 0 : 1;
+#else
+    if constexpr (std::is_signed<T>::value)
+    {
+        if (lhs < 0) return -1;
+    }
+    else
+    {
+        if (rhs < 0) return 1;
+    }
+
+    const auto left = static_cast<std::uintmax_t>(lhs);
+    const auto right = static_cast<std::uintmax_t>(rhs);
+
+    return (left < right) ? -1 : (left == right) ? 0 : 1;
+#endif
+}
+
+/*
+ *  Compare()
+ *
+ *  Description:
+ *      Compare the left-hand side value to the right-hand side value using
+ *      the given relational operator.
+ *
+ *  Parameters:
+ *      lhs [in]
+ *          The left-hand side value to compare.
+ *
+ *      rhs [in]
+ *          The right-hand side value to compare.
+ *
+ *  Returns:
+ *      True if the comparison holds, false otherwise.
+ *
+ *  Comments:
+ *      Integers of which exactly one is signed are compared by value, so that
+ *      a negative value is less than any unsigned value.  An integer compared
+ *      for equality with a pointer, as with STF_ASSERT_EQ(0, p) or
+ *      STF_ASSERT_NE(NULL, p), is treated as the null pointer if it is zero.  The values of
+ *      std::atomic operands are loaded and compared the same way.  Other
+ *      operands are compared as written, with the usual arithmetic
+ *      conversions.
+ */
+template<Comparison comparison, typename T, typename U>
+constexpr bool Compare(const T &lhs, const U &rhs)
+{
+    if constexpr (IsAtomic<T>::value)
+    {
+        return Compare<comparison>(lhs.load(), rhs);
+    }
+    else if constexpr (IsAtomic<U>::value)
+    {
+        return Compare<comparison>(lhs, rhs.load());
+    }
+    else if constexpr (IsComparableInteger<T>::value &&
+                       IsComparableInteger<U>::value &&
+                       (std::is_signed<T>::value != std::is_signed<U>::value))
+    {
+        return Compare<comparison>(CompareIntegers(lhs, rhs), 0);
+    }
+    else if constexpr (IsNullPointerComparison<comparison, T, U>::value)
+    {
+        const bool equal = (lhs == 0) && (rhs == nullptr);
+
+        return (comparison == Comparison::Equal) ? equal : !equal;
+    }
+    else if constexpr (IsNullPointerComparison<comparison, U, T>::value)
+    {
+        return Compare<comparison>(rhs, lhs);
+    }
+    else if constexpr (comparison == Comparison::Equal)
+    {
+        return static_cast<bool>(lhs == rhs);
+    }
+    else if constexpr (comparison == Comparison::NotEqual)
+    {
+        return static_cast<bool>(lhs != rhs);
+    }
+    else if constexpr (comparison == Comparison::Greater)
+    {
+        return static_cast<bool>(lhs > rhs);
+    }
+    else if constexpr (comparison == Comparison::GreaterEqual)
+    {
+        return static_cast<bool>(lhs >= rhs);
+    }
+    else if constexpr (comparison == Comparison::Less)
+    {
+        return static_cast<bool>(lhs < rhs);
+    }
+    else
+    {
+        return static_cast<bool>(lhs <= rhs);
+    }
+}
+
+/*
+ *  CheckEqual()
+ *
+ *  Description:
+ *      Check that the actual value is equal to the expected value, reporting
+ *      both values if it is not.
+ *
+ *  Parameters:
+ *      file [in]
+ *          The name of the file where the test exists.
+ *
+ *      line [in]
+ *          The line number where the test failed.
+ *
+ *      expected [in]
+ *          The expected value.
+ *
+ *      actual [in]
+ *          The actual value.
+ *
+ *  Returns:
+ *      True if the values are equal, false otherwise.
+ *
+ *  Comments:
+ *      Each argument is evaluated exactly once by the caller, so expressions
+ *      having side effects or a high cost may be passed directly.
+ */
+template<typename T, typename U>
+bool CheckEqual(const char *file,
+                const std::size_t line,
+                const T &expected,
+                const U &actual)
+{
+    if (!Compare<Comparison::Equal>(expected, actual)) STF_INTERNAL_UNLIKELY
+    {
+        ExpectFail(file, line, expected, actual);
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ *  CheckCompare()
+ *
+ *  Description:
+ *      Check that the left-hand side value compares to the right-hand side
+ *      value as specified, reporting both values if it does not.
+ *
+ *  Parameters:
+ *      file [in]
+ *          The name of the file where the test exists.
+ *
+ *      line [in]
+ *          The line number where the test failed.
+ *
+ *      lhs [in]
+ *          The left-hand side value to compare.
+ *
+ *      rhs [in]
+ *          The right-hand side value to compare.
+ *
+ *      tag [in]
+ *          The comparison to perform, given as ComparisonTag<comparison>{}.
+ *
+ *  Returns:
+ *      True if the comparison holds, false otherwise.
+ *
+ *  Comments:
+ *      Each argument is evaluated exactly once by the caller, so expressions
+ *      having side effects or a high cost may be passed directly.  The
+ *      comparison is deduced from the tag rather than given as an explicit
+ *      template argument, since GCC warns when NULL is passed to a function
+ *      template whose arguments are not all deduced.
+ */
+template<Comparison comparison, typename T, typename U>
+bool CheckCompare(const char *file,
+                  const std::size_t line,
+                  const T &lhs,
+                  const U &rhs,
+                  ComparisonTag<comparison>)
+{
+    if (!Compare<comparison>(lhs, rhs)) STF_INTERNAL_UNLIKELY
+    {
+        LhsRhsFail(file, line, lhs, rhs);
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ *  AssertBoolean()
+ *
+ *  Description:
+ *      Test that the given value is true.
+ *
+ *  Parameters:
+ *      file [in]
+ *          The name of the file where the test exists.
+ *
+ *      line [in]
+ *          The line number where the test failed.
+ *
+ *      value [in]
+ *          The value to check to be true.
+ *
+ *  Returns:
+ *      Returns the value of "value".
+ *
+ *  Comments:
+ *      None.
+ */
+inline bool AssertBoolean(const char *file, std::size_t line, bool value)
+{
+    if (!value) STF_INTERNAL_UNLIKELY PrintAssertFailed(file, line);
+
+    return value;
+}
+
+/*
+ *  AssertClose()
+ *
+ *  Description:
+ *      Test that the absolute value of the difference between the left-hand
+ *      side value and the right-hand side value is less than epsilon.
+ *
+ *  Parameters:
+ *      file [in]
+ *          The name of the file where the test exists.
+ *
+ *      line [in]
+ *          The line number where the test failed.
+ *
+ *      lhs [in]
+ *          The left-hand side value to compare.
+ *
+ *      rhs [in]
+ *          The right-hand side value to compare.
+ *
+ *      epsilon [in]
+ *          The value of which the absolute value of the difference between
+ *          the left-hand side and right-hand side value can be no greater.
+ *
+ *  Returns:
+ *      True if the assertion is true, else false.
+ *
+ *  Comments:
+ *      None.
+ */
+bool AssertClose(const char *file,
+                 const std::size_t line,
+                 float lhs,
+                 float rhs,
+                 float epsilon);
+
+/*
+ *  AssertClose()
+ *
+ *  Description:
+ *      Test that the absolute value of the difference between the left-hand
+ *      side value and the right-hand side value is less than epsilon.
+ *
+ *  Parameters:
+ *      file [in]
+ *          The name of the file where the test exists.
+ *
+ *      line [in]
+ *          The line number where the test failed.
+ *
+ *      lhs [in]
+ *          The left-hand side value to compare.
+ *
+ *      rhs [in]
+ *          The right-hand side value to compare.
+ *
+ *      epsilon [in]
+ *          The value of which the absolute value of the difference between
+ *          the left-hand side and right-hand side value can be no greater.
+ *
+ *  Returns:
+ *      True if the assertion is true, else false.
+ *
+ *  Comments:
+ *      None.
+ */
+bool AssertClose(const char *file,
+                 const std::size_t line,
+                 double lhs,
+                 double rhs,
+                 double epsilon);
+
+/*
+ *  AssertClose()
+ *
+ *  Description:
+ *      Test that the absolute value of the difference between the left-hand
+ *      side value and the right-hand side value is less than epsilon.
+ *
+ *  Parameters:
+ *      file [in]
+ *          The name of the file where the test exists.
+ *
+ *      line [in]
+ *          The line number where the test failed.
+ *
+ *      lhs [in]
+ *          The left-hand side value to compare.
  *
- *      value [in]
- *          The value to print.
+ *      rhs [in]
+ *          The right-hand side value to compare.
+ *
+ *      epsilon [in]
+ *          The value of which the absolute value of the difference between
+ *          the left-hand side and right-hand side value can be no greater.
  *
  *  Returns:
- *      Nothing.
+ *      True if the assertion is true, else false.
  *
  *  Comments:
  *      None.
  */
-template<typename T,
-         typename std::enable_if<std::is_array<T>::value ||
-                                 std::is_pointer<T>::value, bool>::type = true>
-void PrintValue(const std::string &text, const T value)
-{
-    std::cout << text
-              << reinterpret_cast<const void *>(value)
-              << " (memory address)"
-              << std::endl;
-}
+bool AssertClose(const char *file,
+                 const std::size_t line,
+                 long double lhs,
+                 long double rhs,
+                 long double epsilon);
 
 /*
- *  PrintValue()
+ *  AssertNear()
  *
  *  Description:
- *      This function will print the expect/actual string (or similar)
- *      along with the value.  This is called by failing tests.
+ *      Test that the absolute value of the difference between the left-hand
+ *      side value and the right-hand side value is no greater than the larger
+ *      of the absolute tolerance and the relative tolerance multiplied by the
+ *      larger magnitude of the two values.
  *
  *  Parameters:
- *      text [in]
- *          The text to print (e.g., "expected").
+ *      file [in]
+ *          The name of the file where the test exists.
  *
- *      value [in]
- *          The value to print.
+ *      line [in]
+ *          The line number where the test failed.
+ *
+ *      lhs [in]
+ *          The left-hand side value to compare.
+ *
+ *      rhs [in]
+ *          The right-hand side value to compare.
+ *
+ *      abs_epsilon [in]
+ *          The absolute tolerance, which is useful for values near zero.
+ *
+ *      rel_epsilon [in]
+ *          The relative tolerance (e.g., 1e-6 for agreement to about six
+ *          significant digits).
  *
  *  Returns:
- *      Nothing.
+ *      True if the assertion is true, else false.
  *
  *  Comments:
- *      None.
+ *      NaN values are never considered near any value.
  */
-template<typename T,
-         typename std::enable_if<std::is_floating_point<T>::value,
-                                 bool>::type = true>
-void PrintValue(const std::string &text, T value)
-{
-    std::ostringstream oss;
-
-    oss << text << std::setprecision(26) << value;
-
-    std::cout << oss.str() << std::endl;
-}
+bool AssertNear(const char *file,
+                const std::size_t line,
+                float lhs,
+                float rhs,
+                float abs_epsilon,
+                float rel_epsilon);
 
 /*
- *  PrintValue()
+ *  AssertNear()
  *
  *  Description:
- *      This function will print the expect/actual string (or similar)
- *      along with the value.  This is called by failing tests.
+ *      Test that the absolute value of the difference between the left-hand
+ *      side value and the right-hand side value is no greater than the larger
+ *      of the absolute tolerance and the relative tolerance multiplied by the
+ *      larger magnitude of the two values.
  *
  *  Parameters:
- *      text [in]
- *          The text to print (e.g., "expected").
+ *      file [in]
+ *          The name of the file where the test exists.
  *
- *      value [in]
- *          The value to print.
+ *      line [in]
+ *          The line number where the test failed.
+ *
+ *      lhs [in]
+ *          The left-hand side value to compare.
+ *
+ *      rhs [in]
+ *          The right-hand side value to compare.
+ *
+ *      abs_epsilon [in]
+ *          The absolute tolerance, which is useful for values near zero.
+ *
+ *      rel_epsilon [in]
+ *          The relative tolerance (e.g., 1e-6 for agreement to about six
+ *          significant digits).
  *
  *  Returns:
- *      Nothing.
+ *      True if the assertion is true, else false.
  *
  *  Comments:
- *      None.
+ *      NaN values are never considered near any value.
  */
-template<typename T,
-         typename std::enable_if<std::is_integral<T>::value, bool>::type = true>
-void PrintValue(const std::string &text, T value)
-{
-    std::ostringstream oss;
-
-    oss << std::hex << std::setfill('0');
-
-    oss << text << std::dec << value << " (0x" << std::hex
-        << std::setw(sizeof(T) * 2) << +value << ")";
-
-    std::cout << oss.str() << std::endl;
-}
+bool AssertNear(const char *file,
+                const std::size_t line,
+                double lhs,
+                double rhs,
+                double abs_epsilon,
+                double rel_epsilon);
 
 /*
- *  PrintAssertFailed()
+ *  AssertNear()
  *
  *  Description:
- *      This function will print a message indicating an assertion failed.
+ *      Test that the absolute value of the difference between the left-hand
+ *      side value and the right-hand side value is no greater than the larger
+ *      of the absolute tolerance and the relative tolerance multiplied by the
+ *      larger magnitude of the two values.
  *
  *  Parameters:
  *      file [in]
@@ -712,20 +2648,39 @@ void PrintValue(const std::string &text, T value)
  *      line [in]
  *          The line number where the test failed.
  *
+ *      lhs [in]
+ *          The left-hand side value to compare.
+ *
+ *      rhs [in]
+ *          The right-hand side value to compare.
+ *
+ *      abs_epsilon [in]
+ *          The absolute tolerance, which is useful for values near zero.
+ *
+ *      rel_epsilon [in]
+ *          The relative tolerance (e.g., 1e-6 for agreement to about six
+ *          significant digits).
+ *
  *  Returns:
- *      Nothing.
+ *      True if the assertion is true, else false.
  *
  *  Comments:
- *      None.
+ *      NaN values are never considered near any value.
  */
-void PrintAssertFailed(const std::string &file, std::size_t line);
+bool AssertNear(const char *file,
+                const std::size_t line,
+                long double lhs,
+                long double rhs,
+                long double abs_epsilon,
+                long double rel_epsilon);
 
 /*
- *  ExpectFail()
+ *  AssertUlpEqual()
  *
  *  Description:
- *      Handle the failure case when a value does not agree with an expected
- *      value.
+ *      Test that the left-hand side value and the right-hand side value are
+ *      no more than max_ulps units in the last place (i.e., representable
+ *      values) apart.
  *
  *  Parameters:
  *      file [in]
@@ -734,35 +2689,35 @@ void PrintAssertFailed(const std::string &file, std::size_t line);
  *      line [in]
  *          The line number where the test failed.
  *
- *      expected [in]
- *          The expected value.
+ *      lhs [in]
+ *          The left-hand side value to compare.
  *
- *      actual [in]
- *          The actual value.
+ *      rhs [in]
+ *          The right-hand side value to compare.
+ *
+ *      max_ulps [in]
+ *          The maximum permitted distance in ULPs.
  *
  *  Returns:
- *      Nothing.
+ *      True if the assertion is true, else false.
  *
  *  Comments:
- *      None.
+ *      Positive and negative zero are considered equal.  NaN values are
+ *      never considered equal to any value.
  */
-template<typename T, typename U>
-void ExpectFail(const std::string &file,
-                const std::size_t line,
-                const T &expected,
-                const U &actual)
-{
-    PrintAssertFailed(file, line);
-    PrintValue(ExpectText, expected);
-    PrintValue(ActualText, actual);
-}
+bool AssertUlpEqual(const char *file,
+                    const std::size_t line,
+                    float lhs,
+                    float rhs,
+                    std::uint64_t max_ulps);
 
 /*
- *  LhsRhsFail()
+ *  AssertUlpEqual()
  *
  *  Description:
- *      Handle the failure cases when a lhs value does not compare as
- *      expected to a rhs value.
+ *      Test that the left-hand side value and the right-hand side value are
+ *      no more than max_ulps units in the last place (i.e., representable
+ *      values) apart.
  *
  *  Parameters:
  *      file [in]
@@ -777,28 +2732,29 @@ void ExpectFail(const std::string &file,
  *      rhs [in]
  *          The right-hand side value to compare.
  *
+ *      max_ulps [in]
+ *          The maximum permitted distance in ULPs.
+ *
  *  Returns:
- *      Nothing.
+ *      True if the assertion is true, else false.
  *
  *  Comments:
- *      None.
+ *      Positive and negative zero are considered equal.  NaN values are
+ *      never considered equal to any value.
  */
-template<typename T, typename U>
-void LhsRhsFail(const std::string &file,
-                const std::size_t line,
-                const T &lhs,
-                const U &rhs)
-{
-    PrintAssertFailed(file, line);
-    PrintValue(LHSText, lhs);
-    PrintValue(RHSText, rhs);
-}
+bool AssertUlpEqual(const char *file,
+                    const std::size_t line,
+                    double lhs,
+                    double rhs,
+                    std::uint64_t max_ulps);
 
 /*
- *  AssertBoolean()
+ *  AssertArrayClose()
  *
  *  Description:
- *      Test that the given value is true.
+ *      Test that each element of the expected array is close to the
+ *      corresponding element of the actual array, using the same combined
+ *      absolute and relative tolerance as AssertNear().
  *
  *  Parameters:
  *      file [in]
@@ -807,23 +2763,45 @@ void LhsRhsFail(const std::string &file,
  *      line [in]
  *          The line number where the test failed.
  *
- *      value [in]
- *          The value to check to be true.
+ *      expected [in]
+ *          A pointer to the array of expected values.
+ *
+ *      actual [in]
+ *          A pointer to the array of actual values.
+ *
+ *      count [in]
+ *          The number of elements in each array.
+ *
+ *      abs_epsilon [in]
+ *          The absolute tolerance.
+ *
+ *      rel_epsilon [in]
+ *          The relative tolerance.
  *
  *  Returns:
- *      Returns the value of "value".
+ *      True if the assertion is true, else false.
  *
  *  Comments:
- *      None.
+ *      The comparison is performed using SIMD instructions where available.
+ *      On failure, the number of elements not close, the maximum absolute
+ *      error, the maximum ULP error, the RMS error, and the index and values
+ *      of the worst element are reported.
  */
-bool AssertBoolean(const std::string &file, std::size_t line, bool value);
+bool AssertArrayClose(const char *file,
+                      const std::size_t line,
+                      const float *expected,
+                      const float *actual,
+                      std::size_t count,
+                      float abs_epsilon,
+                      float rel_epsilon);
 
 /*
- *  AssertClose()
+ *  AssertArrayClose()
  *
  *  Description:
- *      Test that the absolute value of the difference between the left-hand
- *      side value and the right-hand side value is less than epsilon.
+ *      Test that each element of the expected array is close to the
+ *      corresponding element of the actual array, using the same combined
+ *      absolute and relative tolerance as AssertNear().
  *
  *  Parameters:
  *      file [in]
@@ -832,34 +2810,45 @@ bool AssertBoolean(const std::string &file, std::size_t line, bool value);
  *      line [in]
  *          The line number where the test failed.
  *
- *      lhs [in]
- *          The left-hand side value to compare.
+ *      expected [in]
+ *          A pointer to the array of expected values.
  *
- *      rhs [in]
- *          The right-hand side value to compare.
+ *      actual [in]
+ *          A pointer to the array of actual values.
  *
- *      epsilon [in]
- *          The value of which the absolute value of the difference between
- *          the left-hand side and right-hand side value can be no greater.
+ *      count [in]
+ *          The number of elements in each array.
+ *
+ *      abs_epsilon [in]
+ *          The absolute tolerance.
+ *
+ *      rel_epsilon [in]
+ *          The relative tolerance.
  *
  *  Returns:
  *      True if the assertion is true, else false.
  *
  *  Comments:
- *      None.
+ *      The comparison is performed using SIMD instructions where available.
+ *      On failure, the number of elements not close, the maximum absolute
+ *      error, the maximum ULP error, the RMS error, and the index and values
+ *      of the worst element are reported.
  */
-bool AssertClose(const std::string &file,
-                 const std::size_t line,
-                 float lhs,
-                 float rhs,
-                 float epsilon);
+bool AssertArrayClose(const char *file,
+                      const std::size_t line,
+                      const double *expected,
+                      const double *actual,
+                      std::size_t count,
+                      double abs_epsilon,
+                      double rel_epsilon);
 
 /*
- *  AssertClose()
+ *  AssertTensorClose()
  *
  *  Description:
- *      Test that the absolute value of the difference between the left-hand
- *      side value and the right-hand side value is less than epsilon.
+ *      Test that each element of the expected tensor is close to the
+ *      corresponding element of the actual tensor, using the same combined
+ *      absolute and relative tolerance as AssertNear().
  *
  *  Parameters:
  *      file [in]
@@ -868,34 +2857,42 @@ bool AssertClose(const std::string &file,
  *      line [in]
  *          The line number where the test failed.
  *
- *      lhs [in]
- *          The left-hand side value to compare.
+ *      expected [in]
+ *          A view of the tensor holding the expected values.
  *
- *      rhs [in]
- *          The right-hand side value to compare.
+ *      actual [in]
+ *          A view of the tensor holding the actual values.
  *
- *      epsilon [in]
- *          The value of which the absolute value of the difference between
- *          the left-hand side and right-hand side value can be no greater.
+ *      abs_epsilon [in]
+ *          The absolute tolerance.
+ *
+ *      rel_epsilon [in]
+ *          The relative tolerance.
  *
  *  Returns:
  *      True if the assertion is true, else false.
  *
  *  Comments:
- *      None.
+ *      The extents of the two tensors must be equal, though strides may
+ *      differ.  Large tensors are compared in parallel over rows.  On failure,
+ *      the number of elements not close, a histogram of error magnitudes
+ *      relative to the tolerance, and the coordinates of the worst elements
+ *      are reported.
  */
-bool AssertClose(const std::string &file,
-                 const std::size_t line,
-                 double lhs,
-                 double rhs,
-                 double epsilon);
+bool AssertTensorClose(const char *file,
+                       const std::size_t line,
+                       const TensorView<float> &expected,
+                       const TensorView<float> &actual,
+                       float abs_epsilon,
+                       float rel_epsilon);
 
 /*
- *  AssertClose()
+ *  AssertTensorClose()
  *
  *  Description:
- *      Test that the absolute value of the difference between the left-hand
- *      side value and the right-hand side value is less than epsilon.
+ *      Test that each element of the expected tensor is close to the
+ *      corresponding element of the actual tensor, using the same combined
+ *      absolute and relative tolerance as AssertNear().
  *
  *  Parameters:
  *      file [in]
@@ -904,27 +2901,34 @@ bool AssertClose(const std::string &file,
  *      line [in]
  *          The line number where the test failed.
  *
- *      lhs [in]
- *          The left-hand side value to compare.
+ *      expected [in]
+ *          A view of the tensor holding the expected values.
  *
- *      rhs [in]
- *          The right-hand side value to compare.
+ *      actual [in]
+ *          A view of the tensor holding the actual values.
  *
- *      epsilon [in]
- *          The value of which the absolute value of the difference between
- *          the left-hand side and right-hand side value can be no greater.
+ *      abs_epsilon [in]
+ *          The absolute tolerance.
+ *
+ *      rel_epsilon [in]
+ *          The relative tolerance.
  *
  *  Returns:
  *      True if the assertion is true, else false.
  *
  *  Comments:
- *      None.
+ *      The extents of the two tensors must be equal, though strides may
+ *      differ.  Large tensors are compared in parallel over rows.  On failure,
+ *      the number of elements not close, a histogram of error magnitudes
+ *      relative to the tolerance, and the coordinates of the worst elements
+ *      are reported.
  */
-bool AssertClose(const std::string &file,
-                 const std::size_t line,
-                 long double lhs,
-                 long double rhs,
-                 long double epsilon);
+bool AssertTensorClose(const char *file,
+                       const std::size_t line,
+                       const TensorView<double> &expected,
+                       const TensorView<double> &actual,
+                       double abs_epsilon,
+                       double rel_epsilon);
 
 /*
  *  AssertMemoryEqual()
@@ -955,7 +2959,7 @@ bool AssertClose(const std::string &file,
  *  Comments:
  *      None.
  */
-bool AssertMemoryEqual(const std::string &file,
+bool AssertMemoryEqual(const char *file,
                        const std::size_t line,
                        const void *expected,
                        const void *actual,
@@ -990,12 +2994,44 @@ bool AssertMemoryEqual(const std::string &file,
  *  Comments:
  *      None.
  */
-bool AssertMemoryNotEqual(const std::string &file,
+bool AssertMemoryNotEqual(const char *file,
                           const std::size_t line,
                           const void *lhs,
                           const void *rhs,
                           std::size_t length);
 
+/*
+ *  ReportExceptionFailure()
+ *
+ *  Description:
+ *      Report that a function did not throw the expected exception.
+ *
+ *  Parameters:
+ *      file [in]
+ *          The name of the file where the test exists.
+ *
+ *      line [in]
+ *          The line number where the test failed.
+ *
+ *      exception_name [in]
+ *          The name of the expected exception or nullptr if any exception
+ *          was expected.
+ *
+ *      exception_thrown [in]
+ *          True if some other exception was thrown, false if the function
+ *          returned normally.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+STF_INTERNAL_COLD void ReportExceptionFailure(const char *file,
+                                              std::size_t line,
+                                              const char *exception_name,
+                                              bool exception_thrown);
+
 /*
  *  AssertException()
  *
@@ -1018,11 +3054,26 @@ bool AssertMemoryNotEqual(const std::string &file,
  *      True if the assertion is true, else false.
  *
  *  Comments:
- *      None.
+ *      Any callable object may be given, including lambdas, function
+ *      pointers, and std::function objects.  It is invoked directly without
+ *      being copied or wrapped.
  */
-bool AssertException(const std::string &file,
-                     const std::size_t line,
-                     const std::function<void()> &function);
+template<typename F>
+bool AssertException(const char *file, const std::size_t line, F &&function)
+{
+    try
+    {
+        function();
+    }
+    catch (...)
+    {
+        return true;
+    }
+
+    ReportExceptionFailure(file, line, nullptr, false);
+
+    return false;
+}
 
 /*
  *  AssertException()
@@ -1050,49 +3101,32 @@ bool AssertException(const std::string &file,
  *  Comments:
  *      Note that if testing generically for something like std::exception,
  *      any exception derived from std::exception will pass.  Tests should
- *      be as specific as necessary to ensure expected results.
+ *      be as specific as necessary to ensure expected results.  As above,
+ *      any callable object may be given and it is invoked directly.
  */
-template<typename T>
-bool AssertException(const std::string &file,
+template<typename T, typename F>
+bool AssertException(const char *file,
                      const std::size_t line,
-                     const std::function<void()> &function,
-                     const std::string exception_name)
+                     F &&function,
+                     const char *exception_name)
 {
-    bool exception_thrown = false;
-    bool expected_exception = false;
-
     try
     {
         function();
     }
     catch (const T &)
     {
-        exception_thrown = true;
-        expected_exception = true;
+        return true;
     }
     catch (...)
     {
-        exception_thrown = true;
-    }
-
-    if (!expected_exception)
-    {
-        PrintAssertFailed(file, line);
-        PrintValue(ExpectText,
-                   std::string("exception of type ") + exception_name);
-        if (exception_thrown)
-        {
-            PrintValue(ActualText, std::string("some other exception thrown"));
-        }
-        else
-        {
-            PrintValue(ActualText, std::string("no exception thrown"));
-        }
-
+        ReportExceptionFailure(file, line, exception_name, true);
         return false;
     }
 
-    return true;
+    ReportExceptionFailure(file, line, exception_name, false);
+
+    return false;
 }
 
 } // Namespace STF
@@ -0,0 +1,190 @@
+/*
+ *  streaming.h
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Support for testing incremental interfaces, such as a hash's Update()
+ *      or a streaming decoder, which must produce the same result however
+ *      their input is split.  SweepChunks() passes a buffer to a function as
+ *      a list of chunks, split in many ways, and reports each split for
+ *      which the result differs from that of passing the buffer in one
+ *      chunk:
+ *
+ *          STF_TEST(SHA256, Chunking)
+ *          {
+ *              std::vector<std::uint8_t> data(4096);
+ *              std::iota(data.begin(), data.end(), 0);
+ *
+ *              Terra::STF::SweepChunks(
+ *                  data,
+ *                  [](const Terra::STF::StreamChunks &chunks)
+ *                  {
+ *                      SHA256 hash;
+ *                      for (auto &chunk : chunks)
+ *                      {
+ *                          hash.Update(chunk.data, chunk.size);
+ *                      }
+ *                      return hash.Final();
+ *                  });
+ *          }
+ *
+ *      The buffer is split into chunks of every size from 1 to a maximum
+ *      (Stream_Chunk_Size by default), and then in Stream_Random_Splits
+ *      random ways mixing small, large, and empty chunks.  The splits are
+ *      run as the instances of a parameterized test (see parameterized.h),
+ *      so they run in parallel and each failing split is reported with the
+ *      sizes of its chunks.  Random splits are repeatable with the seed
+ *      given by STF_PROPERTY_SEED (see property.h).
+ *
+ *      If every split gives the right result, the function is then timed
+ *      for Stream_Timing with the whole buffer and with chunks of each power
+ *      of two up to the maximum, one at a time, and the throughput of each
+ *      is noted on the line reporting the test, so that the overhead of
+ *      small writes is visible.
+ *
+ *  Portability Issues:
+ *      Requires C++17 or greater.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+#include <terra/stf/stf.h>
+#include <terra/stf/parameterized.h>
+
+namespace Terra::STF
+{
+
+// Chunks of every size from one up to this number of octets are tried
+constexpr std::size_t Stream_Chunk_Size = 64;
+
+// Number of random splits tried
+constexpr std::size_t Stream_Random_Splits = 1000;
+
+// Time for which the function is called with each timed chunk size
+constexpr std::chrono::microseconds Stream_Timing{1000};
+
+// A chunk of a buffer passed to an incremental interface
+struct StreamChunk
+{
+    const std::uint8_t *data;           // First octet of the chunk
+    std::size_t size;                   // Number of octets in the chunk
+};
+
+// The chunks into which a buffer is split, in order
+using StreamChunks = std::vector<StreamChunk>;
+
+/*
+ *  RunChunkSweep()
+ *
+ *  Description:
+ *      Run the splits of a chunk sweep as the instances of a parameterized
+ *      test and then time each chunk size, as done by SweepChunks().
+ *
+ *  Parameters:
+ *      data [in]
+ *          The buffer to split.
+ *
+ *      size [in]
+ *          The number of octets in the buffer.
+ *
+ *      max_chunk [in]
+ *          The largest fixed chunk size to try.
+ *
+ *      check [in]
+ *          The function that passes the given chunks to the function under
+ *          test and reports a result that differs, returning true if the
+ *          result was right.
+ *
+ *      call [in]
+ *          The function that passes the given chunks to the function under
+ *          test, used for timing.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void RunChunkSweep(const std::uint8_t *data,
+                   std::size_t size,
+                   std::size_t max_chunk,
+                   const std::function<bool(const StreamChunks &)> &check,
+                   const std::function<void(const StreamChunks &)> &call);
+
+/*
+ *  SweepChunks()
+ *
+ *  Description:
+ *      Pass a buffer to a function split into chunks in many ways, reporting
+ *      each split for which the result differs from that of passing the
+ *      whole buffer as one chunk.
+ *
+ *  Parameters:
+ *      buffer [in]
+ *          The input, a contiguous container of octets (e.g., std::string
+ *          or std::vector<std::uint8_t>).
+ *
+ *      stream [in]
+ *          The function, called as stream(chunks) with StreamChunks and
+ *          returning a result compared with ==.
+ *
+ *      max_chunk [in]
+ *          The largest fixed chunk size to try.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      The function is called concurrently, so it must not share state
+ *      between calls.
+ */
+template<typename Buffer, typename Stream>
+void SweepChunks(const Buffer &buffer,
+                 Stream stream,
+                 std::size_t max_chunk = Stream_Chunk_Size)
+{
+    static_assert(sizeof(*std::data(buffer)) == 1,
+                  "The buffer must hold octets");
+
+    const auto *data = reinterpret_cast<const std::uint8_t *>(
+        std::data(buffer));
+    const std::size_t size = std::size(buffer);
+
+    const auto expected = stream(StreamChunks{{data, size}});
+
+    RunChunkSweep(
+        data,
+        size,
+        max_chunk,
+        [&](const StreamChunks &chunks)
+        {
+            const auto actual = stream(chunks);
+
+            if (expected == actual) return true;
+
+            PendingOutput().NewLine()
+                           .Text("Result differs from that of one chunk")
+                           .NewLine();
+            PrintValue("  expected: ", expected);
+            PrintValue("    actual: ", actual);
+            RecordFailure();
+
+            return false;
+        },
+        [&](const StreamChunks &chunks) { stream(chunks); });
+}
+
+} // namespace Terra::STF
@@ -0,0 +1,220 @@
+/*
+ *  virtual_clock.h
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Facilities that allow code that waits for time to pass (e.g., rate
+ *      limiters, retry logic, and caches with expiry) to be tested without
+ *      actually waiting.
+ *
+ *      VirtualClock meets the requirements of a C++ Clock and may be used in
+ *      place of std::chrono::steady_clock by code written to accept a clock
+ *      type.  SleepFor() and SleepUntil() may be used in place of the
+ *      functions of the same name in std::this_thread:
+ *
+ *          template<typename Clock = std::chrono::steady_clock>
+ *          class RateLimiter { ... Clock::now() ... };
+ *
+ *          RateLimiter<Terra::STF::VirtualClock> limiter;
+ *
+ *      By default, VirtualClock reports the time of std::chrono::steady_clock
+ *      and SleepFor() blocks the calling thread.  When a test creates a
+ *      VirtualScheduler, the test's clock is instead a virtual clock that
+ *      only advances when told to, either directly or by a call to SleepFor()
+ *      or SleepUntil(), which return immediately:
+ *
+ *          Terra::STF::VirtualScheduler scheduler;
+ *
+ *          auto start = Terra::STF::VirtualClock::now();
+ *          Terra::STF::SleepFor(std::chrono::hours(1));
+ *          // VirtualClock::now() - start is exactly one hour
+ *
+ *      The scheduler can also invoke callbacks at given virtual times.  As
+ *      time is advanced, each callback that is due is invoked, in order of
+ *      time and then in the order scheduled, with the clock reading the time
+ *      for which the callback was scheduled.
+ *
+ *      The scheduler applies to the test in which it is created, including
+ *      threads the test creates with Terra::STF::Thread.  If several threads
+ *      sleep, each advances the shared virtual clock; virtual time never
+ *      moves backward.  The test's timeout continues to apply to real time.
+ *
+ *  Portability Issues:
+ *      Requires C++17 or greater.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <terra/stf/stf.h>
+
+namespace Terra::STF
+{
+
+/*
+ *  VirtualClock
+ *
+ *  Description:
+ *      A clock that reports the virtual time of the current test's
+ *      VirtualScheduler, or the time of std::chrono::steady_clock if there
+ *      is none.
+ *
+ *  Comments:
+ *      Time points share the epoch of std::chrono::steady_clock, so a
+ *      scheduler starts at the steady clock's time unless told otherwise.
+ */
+class VirtualClock
+{
+    public:
+        using duration = std::chrono::steady_clock::duration;
+        using rep = duration::rep;
+        using period = duration::period;
+        using time_point = std::chrono::time_point<VirtualClock>;
+        static constexpr bool is_steady = true;
+
+        static time_point now() noexcept;
+};
+
+/*
+ *  VirtualScheduler
+ *
+ *  Description:
+ *      Maintains the virtual time of a test and the callbacks scheduled to
+ *      be invoked at given virtual times.  While this object exists, it is
+ *      the scheduler of the test context that was current when it was
+ *      created.
+ *
+ *  Comments:
+ *      Callbacks are invoked on the thread advancing time and without any
+ *      lock held, so they may schedule further callbacks or sleep.  Member
+ *      functions may be called from any number of threads at once.
+ */
+class VirtualScheduler
+{
+    public:
+        using Callback = std::function<void()>;
+        using TimerID = std::size_t;
+
+        VirtualScheduler();
+        explicit VirtualScheduler(VirtualClock::time_point start);
+        VirtualScheduler(const VirtualScheduler &) = delete;
+        ~VirtualScheduler();
+
+        VirtualScheduler &operator=(const VirtualScheduler &) = delete;
+
+        VirtualClock::time_point Now() const;
+        void Advance(VirtualClock::duration duration);
+        void AdvanceTo(VirtualClock::time_point time);
+        bool RunNext();
+
+        TimerID ScheduleAt(VirtualClock::time_point time, Callback callback);
+        TimerID ScheduleAfter(VirtualClock::duration delay, Callback callback);
+        bool Cancel(TimerID id);
+        std::size_t Pending() const;
+
+    protected:
+        using TimerKey = std::pair<VirtualClock::time_point, TimerID>;
+
+        TestContext *context;
+        VirtualScheduler *previous;
+        mutable std::mutex mutex;
+        VirtualClock::time_point now;
+        TimerID next_id;
+        std::map<TimerKey, Callback> timers;
+        std::unordered_map<TimerID, VirtualClock::time_point> timer_times;
+};
+
+/*
+ *  CurrentScheduler()
+ *
+ *  Description:
+ *      Return the VirtualScheduler of the calling thread's current test.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The current test's scheduler, or nullptr if there is none.
+ *
+ *  Comments:
+ *      None.
+ */
+VirtualScheduler *CurrentScheduler() noexcept;
+
+/*
+ *  SleepUntil()
+ *
+ *  Description:
+ *      Advance the current test's virtual time to the given time, invoking
+ *      any callbacks that become due, or if the test has no scheduler, block
+ *      the calling thread until the steady clock reaches the given time.
+ *
+ *  Parameters:
+ *      time [in]
+ *          The time until which to sleep.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void SleepUntil(VirtualClock::time_point time);
+
+/*
+ *  SleepFor()
+ *
+ *  Description:
+ *      Advance the current test's virtual time by the given duration,
+ *      invoking any callbacks that become due, or if the test has no
+ *      scheduler, block the calling thread for the given duration.
+ *
+ *  Parameters:
+ *      duration [in]
+ *          The length of time to sleep.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void SleepFor(VirtualClock::duration duration);
+
+/*
+ *  SleepFor()
+ *
+ *  Description:
+ *      Advance the current test's virtual time by the given duration,
+ *      invoking any callbacks that become due, or if the test has no
+ *      scheduler, block the calling thread for the given duration.
+ *
+ *  Parameters:
+ *      duration [in]
+ *          The length of time to sleep.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      The duration is rounded up to the resolution of VirtualClock.
+ */
+template<typename Rep, typename Period>
+void SleepFor(const std::chrono::duration<Rep, Period> &duration)
+{
+    SleepFor(std::chrono::ceil<VirtualClock::duration>(duration));
+}
+
+} // namespace Terra::STF
@@ -0,0 +1,90 @@
+/*
+ *  yield_point.h
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Defines the STF_YIELD_POINT() macro, which code under test may place
+ *      at points where a thread being preempted could expose a race (e.g.,
+ *      between loading and compare-exchanging the tail of a queue).  This
+ *      file does not depend on the rest of the framework, so it may be
+ *      included by library code.
+ *
+ *      Unless STF_ENABLE_YIELD_POINTS is defined, STF_YIELD_POINT() expands
+ *      to an expression that does nothing and generates no code.  When it
+ *      is defined (typically only in a test build of the code under test),
+ *      each yield point reached while a test is running may perturb the
+ *      scheduling of the calling thread by yielding, spinning, or sleeping
+ *      briefly.  Which yield points are active and what each does is decided
+ *      pseudo-randomly from a seed chosen for each test, the yield point's
+ *      location, the number of yield points the thread has reached in the
+ *      test, and the thread's index.  Within STF_TEST_CONCURRENT tests, that
+ *      is the index returned by ConcurrentThreadIndex(); other threads are
+ *      numbered in the order in which they first reach a yield point.
+ *
+ *      If a test that reached any yield point fails or times out, the seed
+ *      is reported.  Setting the environment variable STF_YIELD_SEED to that
+ *      value causes every test to use that seed, so the same perturbations
+ *      are applied when the test is run again.
+ *
+ *  Portability Issues:
+ *      Requires C++17 or greater.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace Terra::STF
+{
+
+// Action taken by a thread reaching a yield point
+enum class YieldAction
+{
+    None,                               // Continue at once
+    Yield,                              // Yield the processor
+    Spin,                               // Spin briefly
+    Sleep                               // Sleep briefly
+};
+
+/*
+ *  YieldPoint()
+ *
+ *  Description:
+ *      Perturb the scheduling of the calling thread as decided by the seed
+ *      of the current test.  This is called by STF_YIELD_POINT().
+ *
+ *  Parameters:
+ *      file [in]
+ *          The name of the file containing the yield point.
+ *
+ *      line [in]
+ *          The line number of the yield point.
+ *
+ *  Returns:
+ *      The action taken.
+ *
+ *  Comments:
+ *      This does nothing if no test is running.
+ */
+YieldAction YieldPoint(const char *file, std::size_t line);
+
+} // namespace Terra::STF
+
+#ifdef STF_ENABLE_YIELD_POINTS
+
+// Macro to mark a point at which scheduling may be perturbed
+#define STF_YIELD_POINT() \
+    static_cast<void>(Terra::STF::YieldPoint(__FILE__, __LINE__))
+
+#else
+
+// Yield points generate no code unless enabled
+#define STF_YIELD_POINT() static_cast<void>(0)
+
+#endif
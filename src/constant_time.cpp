@@ -0,0 +1,302 @@
+/*
+ *  constant_time.cpp
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      This module implements the timing and statistical comparison done by
+ *      STF_ASSERT_CONSTANT_TIME.
+ *
+ *  Portability Issues:
+ *      Requires C++17 or greater.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <thread>
+#include <terra/stf/constant_time.h>
+
+namespace Terra::STF
+{
+
+namespace
+{
+
+// Number of timings of each class a test needs to be considered
+constexpr double Constant_Time_Minimum = 10000;
+
+/*
+ *  WelchTest
+ *
+ *  Description:
+ *      Welch's t-test over the timings of two classes, with the mean and
+ *      variance of each class computed online.
+ *
+ *  Comments:
+ *      None.
+ */
+class WelchTest
+{
+    public:
+        WelchTest() = default;
+
+        void Add(unsigned type, double time) noexcept;
+        double T() const noexcept;
+
+        double Count(unsigned type) const noexcept { return count[type]; }
+        double Mean(unsigned type) const noexcept { return mean[type]; }
+
+    protected:
+        double count[2]{};
+        double mean[2]{};
+        double squares[2]{};
+};
+
+/*
+ *  WelchTest::Add()
+ *
+ *  Description:
+ *      Add a timing of the given class.
+ *
+ *  Parameters:
+ *      type [in]
+ *          The class of the input (0 or 1).
+ *
+ *      time [in]
+ *          The time taken.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      The mean and sum of squared differences are updated with Welford's
+ *      method.
+ */
+void WelchTest::Add(unsigned type, double time) noexcept
+{
+    count[type]++;
+
+    double delta = time - mean[type];
+    mean[type] += delta / count[type];
+    squares[type] += delta * (time - mean[type]);
+}
+
+/*
+ *  WelchTest::T()
+ *
+ *  Description:
+ *      Return the t statistic.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The t statistic, or zero if either class has too few timings.
+ *
+ *  Comments:
+ *      None.
+ */
+double WelchTest::T() const noexcept
+{
+    if ((count[0] < 2) || (count[1] < 2)) return 0.0;
+
+    double variance = squares[0] / (count[0] - 1) / count[0] +
+                      squares[1] / (count[1] - 1) / count[1];
+
+    if (variance == 0.0)
+    {
+        return (mean[0] == mean[1]) ? 0.0 :
+                                      std::numeric_limits<double>::infinity();
+    }
+
+    return (mean[0] - mean[1]) / std::sqrt(variance);
+}
+
+} // namespace
+
+/*
+ *  CheckConstantTime()
+ *
+ *  Description:
+ *      Time batches of calls on a pinned thread and compare the timings of
+ *      the two classes of input, as done by STF_ASSERT_CONSTANT_TIME.
+ *
+ *  Parameters:
+ *      file [in]
+ *          The file containing the assertion.
+ *
+ *      line [in]
+ *          The line of the assertion.
+ *
+ *      batch [in]
+ *          The function that prepares and times a batch of calls.
+ *
+ *  Returns:
+ *      True if the largest |t| does not exceed Constant_Time_Threshold and
+ *      enough calls of each class were timed.
+ *
+ *  Comments:
+ *      The first batch warms up, the second sets the percentiles, and
+ *      neither is compared.  No batch is started after the stop time.  The
+ *      sampling thread is pinned to the processor on which it starts.  An
+ *      exception thrown by the function is rethrown on the calling thread.
+ */
+bool CheckConstantTime(const char *file,
+                       const std::size_t line,
+                       const ConstantTimeBatch &batch)
+{
+    TestContext *parent = CurrentContext();
+    const auto stop_time =
+        std::min(WorkDeadline(),
+                 std::chrono::steady_clock::now() +
+                     std::chrono::seconds(Constant_Time_Seconds));
+
+    // Tests over all timings and over those below each percentile
+    std::vector<WelchTest> tests(Constant_Time_Percentiles + 1);
+    std::vector<double> percentiles(Constant_Time_Percentiles);
+    std::size_t samples = 0;
+    std::exception_ptr error;
+
+    // Time the calls on a thread of its own, pinned to one processor
+    std::thread sampler(
+        [&]()
+        {
+            ContextScope scope(parent);
+            std::vector<std::uint8_t> classes(Constant_Time_Batch);
+            std::vector<std::uint64_t> times(Constant_Time_Batch);
+
+            // Stay where the scheduler placed the thread, rather than on a
+            // fixed processor shared with other tests and with interrupts
+            PinToCurrentProcessor();
+
+            try
+            {
+                // Warm up, then set the percentiles, unless out of time
+                for (unsigned i = 0; i < 2; i++)
+                {
+                    if (std::chrono::steady_clock::now() >= stop_time) return;
+
+                    batch(classes.data(), times.data(), Constant_Time_Batch);
+                }
+
+                // Crop at percentiles increasingly close to the maximum
+                std::sort(times.begin(), times.end());
+                for (std::size_t i = 0; i < Constant_Time_Percentiles; i++)
+                {
+                    double fraction =
+                        1.0 - std::pow(0.5,
+                                       10.0 * static_cast<double>(i + 1) /
+                                           Constant_Time_Percentiles);
+                    percentiles[i] = static_cast<double>(
+                        times[static_cast<std::size_t>(
+                            fraction * (Constant_Time_Batch - 1))]);
+                }
+
+                while ((samples < Constant_Time_Samples) &&
+                       (std::chrono::steady_clock::now() < stop_time))
+                {
+                    batch(classes.data(), times.data(), Constant_Time_Batch);
+
+                    for (std::size_t i = 0; i < Constant_Time_Batch; i++)
+                    {
+                        const double time = static_cast<double>(times[i]);
+
+                        tests[0].Add(classes[i], time);
+
+                        // Percentiles ascend, so add to each above the time
+                        auto first = std::upper_bound(percentiles.begin(),
+                                                      percentiles.end(),
+                                                      time);
+                        for (auto j = first; j != percentiles.end(); j++)
+                        {
+                            tests[j - percentiles.begin() + 1].Add(classes[i],
+                                                                   time);
+                        }
+                    }
+
+                    samples += Constant_Time_Batch;
+                }
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+        });
+    sampler.join();
+
+    if (error) std::rethrow_exception(error);
+
+    // Too few timings cannot show that the time does not vary
+    if ((tests[0].Count(0) < Constant_Time_Minimum) ||
+        (tests[0].Count(1) < Constant_Time_Minimum))
+    {
+        if (!PrintAssertFailed(file, line)) return false;
+        PendingOutput().Text("Too few calls timed before the deadline: ")
+                       .Decimal(static_cast<std::size_t>(tests[0].Count(0)))
+                       .Text(" with the fixed input and ")
+                       .Decimal(static_cast<std::size_t>(tests[0].Count(1)))
+                       .Text(" with random inputs, but ")
+                       .Decimal(static_cast<std::size_t>(
+                           Constant_Time_Minimum))
+                       .Text(" of each are needed")
+                       .NewLine();
+
+        return false;
+    }
+
+    // Find the largest |t| among tests having enough timings
+    const WelchTest *worst = &tests[0];
+    double t = std::fabs(tests[0].T());
+    for (const WelchTest &test : tests)
+    {
+        if ((test.Count(0) < Constant_Time_Minimum) ||
+            (test.Count(1) < Constant_Time_Minimum))
+        {
+            continue;
+        }
+
+        if (std::fabs(test.T()) > t)
+        {
+            t = std::fabs(test.T());
+            worst = &test;
+        }
+    }
+
+    if (t <= Constant_Time_Threshold)
+    {
+        PendingOutput().Text(" [|t| = ")
+                       .Float(t, 3)
+                       .Text(" over ")
+                       .Decimal(samples)
+                       .Text(" calls]");
+        CommitOutput();
+        return true;
+    }
+
+    if (!PrintAssertFailed(file, line)) return false;
+    PendingOutput().Text("Timing depends on the input: |t| = ")
+                   .Float(t, 3)
+                   .Text(" exceeds ")
+                   .Float(Constant_Time_Threshold, 3)
+                   .Text(" over ")
+                   .Decimal(samples)
+                   .Text(" calls")
+                   .NewLine()
+                   .Text("  mean time for the fixed input: ")
+                   .Float(worst->Mean(0), 3)
+                   .NewLine()
+                   .Text("  mean time for random inputs: ")
+                   .Float(worst->Mean(1), 3)
+                   .NewLine();
+
+    return false;
+}
+
+} // namespace Terra::STF
@@ -0,0 +1,506 @@
+/*
+ *  exhaustive.cpp
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      This module implements the scheduling, progress reporting, sharding,
+ *      and checkpointing of tests defined with STF_EXHAUSTIVE_U32.
+ *
+ *  Portability Issues:
+ *      Requires C++17 or greater.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <terra/stf/exhaustive.h>
+
+namespace Terra::STF
+{
+
+namespace
+{
+
+// Interval at which progress of an exhaustive test is written to stderr
+constexpr std::chrono::seconds Exhaustive_Progress_Interval(10);
+
+// Chunks waiting to be run by one worker, from which others may steal
+struct WorkQueue
+{
+    std::mutex mutex;
+    std::deque<std::size_t> chunks;
+};
+
+/*
+ *  ParseShard()
+ *
+ *  Description:
+ *      Parse the STF_SHARD environment variable, given as "i/n".
+ *
+ *  Parameters:
+ *      index [out]
+ *          The index of the shard to test.
+ *
+ *      count [out]
+ *          The number of shards.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      If the variable is not set or not valid, there is one shard.
+ */
+void ParseShard(std::size_t &index, std::size_t &count)
+{
+    static const char *shard = std::getenv("STF_SHARD");
+
+    index = 0;
+    count = 1;
+
+    if (shard == nullptr) return;
+
+    char *end = nullptr;
+    std::size_t i = std::strtoull(shard, &end, 10);
+    if ((end == shard) || (*end != '/')) return;
+
+    const char *denominator = end + 1;
+    std::size_t n = std::strtoull(denominator, &end, 10);
+    if ((end == denominator) || (*end != '\0') || (n == 0) || (i >= n)) return;
+
+    index = i;
+    count = n;
+}
+
+/*
+ *  CheckpointHeader()
+ *
+ *  Description:
+ *      Return the first line of a checkpoint file, which identifies the
+ *      domain and shard whose chunks are recorded in it.
+ *
+ *  Parameters:
+ *      options [in]
+ *          The settings for the test.
+ *
+ *  Returns:
+ *      The line, without a line ending.
+ *
+ *  Comments:
+ *      None.
+ */
+std::string CheckpointHeader(const ExhaustiveOptions &options)
+{
+    return "stf-checkpoint " + std::to_string(options.bits) + " " +
+           std::to_string(options.shard_index) + "/" +
+           std::to_string(options.shard_count);
+}
+
+/*
+ *  ReadCheckpoint()
+ *
+ *  Description:
+ *      Read the chunks recorded as completed in a checkpoint file.
+ *
+ *  Parameters:
+ *      options [in]
+ *          The settings for the test.
+ *
+ *      completed [in/out]
+ *          Flags, one per chunk, set for the chunks found in the file.
+ *
+ *  Returns:
+ *      True if the file exists and is for the same domain and shard, false
+ *      otherwise.
+ *
+ *  Comments:
+ *      A partial last line, as left when a run is killed, is ignored.
+ */
+bool ReadCheckpoint(const ExhaustiveOptions &options,
+                    std::vector<bool> &completed)
+{
+    std::ifstream file(options.checkpoint);
+    std::string line;
+
+    if (!std::getline(file, line) || (line != CheckpointHeader(options)))
+    {
+        return false;
+    }
+
+    while (std::getline(file, line))
+    {
+        if (file.eof()) break;
+        if (line.empty() || !std::isdigit(static_cast<unsigned char>(line[0])))
+        {
+            continue;
+        }
+
+        std::size_t chunk = std::strtoull(line.c_str(), nullptr, 10);
+        if (chunk < completed.size()) completed[chunk] = true;
+    }
+
+    return true;
+}
+
+} // namespace
+
+/*
+ *  ShardTimeout()
+ *
+ *  Description:
+ *      Return the timeout for an exhaustive test, scaled for the number of
+ *      shards given by the STF_SHARD environment variable.
+ *
+ *  Parameters:
+ *      timeout [in]
+ *          The timeout in seconds for testing the whole domain.
+ *
+ *  Returns:
+ *      The timeout in seconds for testing one shard.
+ *
+ *  Comments:
+ *      None.
+ */
+unsigned ShardTimeout(unsigned timeout)
+{
+    std::size_t index;
+    std::size_t count;
+
+    ParseShard(index, count);
+
+    return static_cast<unsigned>(std::max<std::size_t>(
+        1,
+        (timeout + count - 1) / count));
+}
+
+/*
+ *  ExhaustiveDefaults()
+ *
+ *  Description:
+ *      Return the settings for an exhaustive test as given by the
+ *      STF_SHARD and STF_CHECKPOINT_DIR environment variables.
+ *
+ *  Parameters:
+ *      name [in]
+ *          The name of the test, used to name the checkpoint file.
+ *
+ *      bits [in]
+ *          The number of bits in the input.
+ *
+ *  Returns:
+ *      The settings.
+ *
+ *  Comments:
+ *      None.
+ */
+ExhaustiveOptions ExhaustiveDefaults(const std::string &name, unsigned bits)
+{
+    static const char *checkpoint_dir = std::getenv("STF_CHECKPOINT_DIR");
+    ExhaustiveOptions options{bits, 0, 1, {}};
+
+    ParseShard(options.shard_index, options.shard_count);
+
+    if ((checkpoint_dir != nullptr) && (*checkpoint_dir != '\0'))
+    {
+        // Name the file for the test, replacing characters such as ':'
+        std::string file_name;
+        for (char c : name)
+        {
+            file_name += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+        }
+        if (options.shard_count > 1)
+        {
+            file_name += ".shard" + std::to_string(options.shard_index) +
+                         "of" + std::to_string(options.shard_count);
+        }
+        file_name += ".checkpoint";
+
+        options.checkpoint =
+            (std::filesystem::path(checkpoint_dir) / file_name).string();
+    }
+
+    return options;
+}
+
+/*
+ *  RunChunks()
+ *
+ *  Description:
+ *      Run the chunks of an exhaustive test's domain on a pool of worker
+ *      threads, resuming from and recording completed chunks in the
+ *      checkpoint file, and report the outcome to the calling thread's
+ *      current context.
+ *
+ *  Parameters:
+ *      options [in]
+ *          The settings for the test.
+ *
+ *      chunk [in]
+ *          The function that tests the values in a chunk.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      Each chunk is run in a context of its own.  This is used by tests
+ *      defined with STF_EXHAUSTIVE_U32.
+ */
+void RunChunks(const ExhaustiveOptions &options, const ExhaustiveChunk &chunk)
+{
+    TestContext *parent = CurrentContext();
+    const std::string name = (parent != nullptr) ? parent->Name() : "";
+    const unsigned chunk_bits = std::min(options.bits, Exhaustive_Chunk_Bits);
+    const std::size_t chunk_count = std::size_t(1) << chunk_bits;
+    const std::uint64_t chunk_size = std::uint64_t(1)
+                                     << (options.bits - chunk_bits);
+    const auto deadline = WorkDeadline();
+    const auto start_time = std::chrono::steady_clock::now();
+
+    // Determine which of this shard's chunks remain to be run
+    std::vector<bool> completed(chunk_count);
+    bool resumed = false;
+    if (!options.checkpoint.empty())
+    {
+        resumed = ReadCheckpoint(options, completed);
+    }
+
+    std::vector<std::size_t> pending;
+    std::size_t shard_chunks = 0;
+    for (std::size_t i = options.shard_index;
+         i < chunk_count;
+         i += options.shard_count)
+    {
+        shard_chunks++;
+        if (!completed[i]) pending.push_back(i);
+    }
+    const std::size_t previously_completed = shard_chunks - pending.size();
+
+    // Start a new checkpoint file unless resuming from one
+    std::FILE *checkpoint = nullptr;
+    if (!options.checkpoint.empty())
+    {
+        checkpoint = std::fopen(options.checkpoint.c_str(),
+                                resumed ? "a" : "w");
+        if ((checkpoint != nullptr) && !resumed)
+        {
+            std::fprintf(checkpoint, "%s\n", CheckpointHeader(options).c_str());
+            std::fflush(checkpoint);
+        }
+    }
+
+    // Give each worker a contiguous share of the pending chunks
+    const std::size_t workers =
+        std::max<std::size_t>(1, std::min(WorkerThreads(), pending.size()));
+    std::vector<WorkQueue> queues(workers);
+    for (std::size_t i = 0; i < pending.size(); i++)
+    {
+        queues[i * workers / pending.size()].chunks.push_back(pending[i]);
+    }
+
+    std::atomic<std::size_t> chunks_done{};
+    std::atomic<bool> stop{};
+    std::mutex state_mutex;
+    std::condition_variable finished_cv;
+    std::size_t workers_running = workers;
+    bool failed = false;
+    std::uint64_t failed_value = 0;
+    std::string failed_output;
+
+    // Take the next chunk from the worker's own queue, else steal one from
+    // the back of another worker's queue
+    auto next_chunk = [&](std::size_t worker, std::size_t &index) -> bool
+    {
+        for (std::size_t i = 0; i < workers; i++)
+        {
+            WorkQueue &queue = queues[(worker + i) % workers];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+
+            if (queue.chunks.empty()) continue;
+
+            if (i == 0)
+            {
+                index = queue.chunks.front();
+                queue.chunks.pop_front();
+            }
+            else
+            {
+                index = queue.chunks.back();
+                queue.chunks.pop_back();
+            }
+
+            return true;
+        }
+
+        return false;
+    };
+
+    auto worker_main = [&](std::size_t worker)
+    {
+        std::size_t index{};
+
+        while (!stop && next_chunk(worker, index))
+        {
+            // Leave the remaining chunks if the test is near its timeout
+            if (std::chrono::steady_clock::now() >= deadline)
+            {
+                stop = true;
+                break;
+            }
+
+            const std::uint64_t first = index * chunk_size;
+            const std::uint64_t last = first + chunk_size;
+            TestContext context(name + "/" + std::to_string(index));
+            std::uint64_t reached = first;
+
+            RunInChildContext(context,
+                              parent,
+                              [&]() { reached = chunk(first, last); });
+
+            if (context.Failed())
+            {
+                std::lock_guard<std::mutex> lock(state_mutex);
+                if (!failed || (reached < failed_value))
+                {
+                    failed = true;
+                    failed_value = reached;
+                    failed_output = context.TakeOutput();
+                }
+                stop = true;
+                break;
+            }
+
+            chunks_done++;
+
+            // Record the completed chunk
+            if (checkpoint != nullptr)
+            {
+                std::lock_guard<std::mutex> lock(state_mutex);
+                std::fprintf(checkpoint, "%zu\n", index);
+                std::fflush(checkpoint);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(state_mutex);
+        workers_running--;
+        finished_cv.notify_all();
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < workers; i++)
+    {
+        threads.emplace_back(worker_main, i);
+    }
+
+    // Report progress periodically until the workers finish, starting on a
+    // new line after the line reporting the test
+    {
+        std::unique_lock<std::mutex> lock(state_mutex);
+        const char *separator = "\n";
+
+        while (!finished_cv.wait_for(lock,
+                                     Exhaustive_Progress_Interval,
+                                     [&] { return workers_running == 0; }))
+        {
+            std::chrono::duration<double> elapsed =
+                std::chrono::steady_clock::now() - start_time;
+            std::size_t done = chunks_done;
+
+            std::fprintf(stderr,
+                         "%s[%s] %zu of %zu chunks (%.1f%%), %.4g values/s\n",
+                         separator,
+                         name.c_str(),
+                         previously_completed + done,
+                         shard_chunks,
+                         100.0 * (previously_completed + done) /
+                             std::max<std::size_t>(shard_chunks, 1),
+                         done * chunk_size / elapsed.count());
+            separator = "";
+        }
+    }
+
+    for (auto &thread : threads) thread.join();
+
+    if (checkpoint != nullptr) std::fclose(checkpoint);
+
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start_time;
+    const std::uint64_t values = chunks_done * chunk_size;
+    const std::size_t total_done = previously_completed + chunks_done;
+
+    // Note the values tested and the throughput on the test's line
+    PendingOutput().Text(" [");
+    if (options.shard_count > 1)
+    {
+        PendingOutput().Text("shard ")
+                       .Decimal(options.shard_index)
+                       .Character('/')
+                       .Decimal(options.shard_count)
+                       .Text(": ");
+    }
+    PendingOutput().Decimal(values).Text(" values, ");
+    if (elapsed.count() > 0)
+    {
+        PendingOutput().Float(values / elapsed.count(), 4).Text(" values/s");
+    }
+    if (previously_completed > 0)
+    {
+        PendingOutput().Text(", resumed after ")
+                       .Decimal(previously_completed)
+                       .Text(" chunks");
+    }
+    PendingOutput().Character(']');
+    CommitOutput();
+
+    if (failed)
+    {
+        PendingOutput().Text(failed_output)
+                       .NewLine()
+                       .Text("Failed for value ")
+                       .Decimal(failed_value)
+                       .Text(" (0x")
+                       .Hex(failed_value, (options.bits + 3) / 4)
+                       .Text(")")
+                       .NewLine();
+        RecordFailure();
+    }
+    else if (total_done < shard_chunks)
+    {
+        PendingOutput().NewLine()
+                       .Text("Stopped near the timeout after ")
+                       .Decimal(total_done)
+                       .Text(" of ")
+                       .Decimal(shard_chunks)
+                       .Text(" chunks");
+        if (checkpoint != nullptr)
+        {
+            PendingOutput().Text("; run again to resume from ")
+                           .Text(options.checkpoint);
+        }
+        PendingOutput().NewLine();
+        RecordFailure();
+    }
+    else if (!options.checkpoint.empty())
+    {
+        // Every chunk passed, so the next run starts over
+        std::error_code error;
+        std::filesystem::remove(options.checkpoint, error);
+    }
+}
+
+} // namespace Terra::STF
@@ -0,0 +1,196 @@
+/*
+ *  fuzz.cpp
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      This module implements the replay of fuzzing corpora by tests defined
+ *      with STF_FUZZ and the entry point through which a fuzzer calls them.
+ *
+ *  Portability Issues:
+ *      Requires C++17 or greater.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <vector>
+#include <terra/stf/fuzz.h>
+#include <terra/stf/parameterized.h>
+#include "mapped_file.h"
+#include "stf_internal.h"
+
+namespace Terra::STF
+{
+
+namespace
+{
+
+/*
+ *  CorpusFiles()
+ *
+ *  Description:
+ *      Return the paths of the regular files in the given directory and its
+ *      subdirectories, in order.
+ *
+ *  Parameters:
+ *      directory [in]
+ *          The directory to search.
+ *
+ *  Returns:
+ *      The paths of the files.
+ *
+ *  Comments:
+ *      Hidden files (e.g., ".gitignore") are not inputs and are skipped.
+ */
+std::vector<std::filesystem::path> CorpusFiles(
+    const std::filesystem::path &directory)
+{
+    std::vector<std::filesystem::path> files;
+
+    for (const auto &entry :
+         std::filesystem::recursive_directory_iterator(directory))
+    {
+        if (!entry.is_regular_file()) continue;
+        if (entry.path().filename().string().front() == '.') continue;
+
+        files.push_back(entry.path());
+    }
+
+    std::sort(files.begin(), files.end());
+
+    return files;
+}
+
+} // namespace
+
+/*
+ *  ReplayCorpus()
+ *
+ *  Description:
+ *      Call a fuzz target's function with the contents of each file in the
+ *      given corpus directory, as done for tests defined with STF_FUZZ.
+ *
+ *  Parameters:
+ *      directory [in]
+ *          The corpus directory, which is searched recursively.
+ *
+ *      function [in]
+ *          The fuzz target's function.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      Files are replayed as the instances of a parameterized test, ordered
+ *      by path.  A file that cannot be read is a failure.
+ */
+void ReplayCorpus(const std::string &directory, FuzzFunction function)
+{
+    static const char *corpus_root = std::getenv("STF_CORPUS_DIR");
+    std::filesystem::path path(directory);
+    std::error_code error;
+
+    if (path.is_relative() && (corpus_root != nullptr))
+    {
+        path = std::filesystem::path(corpus_root) / path;
+    }
+
+    if (!std::filesystem::is_directory(path, error))
+    {
+        PendingOutput().Text(" [no corpus at ")
+                       .Text(path.string())
+                       .Character(']');
+        CommitOutput();
+        return;
+    }
+
+    const std::vector<std::filesystem::path> files = CorpusFiles(path);
+
+    RunInstances(
+        files.size(),
+        [&](std::size_t index)
+        {
+            MappedFile file(files[index]);
+
+            if (!file.IsOpen())
+            {
+                PendingOutput().NewLine()
+                               .Text("Unable to read corpus file")
+                               .NewLine();
+                RecordFailure();
+                return;
+            }
+
+            function(file.Data(), file.Size());
+        },
+        [&](std::size_t index)
+        {
+            PendingOutput().Text("  corpus file: ")
+                           .Text(files[index].string())
+                           .NewLine();
+        });
+}
+
+/*
+ *  RunFuzzInput()
+ *
+ *  Description:
+ *      Call a fuzz target's function with one input provided by a fuzzer,
+ *      as done by the LLVMFuzzerTestOneInput() function defined by STF_FUZZ
+ *      when STF_FUZZER is defined.
+ *
+ *  Parameters:
+ *      name [in]
+ *          The name of the fuzz target.
+ *
+ *      function [in]
+ *          The fuzz target's function.
+ *
+ *      data [in]
+ *          The input.
+ *
+ *      size [in]
+ *          The length of the input in octets.
+ *
+ *  Returns:
+ *      Zero, as libFuzzer requires.
+ *
+ *  Comments:
+ *      If an assertion fails or an exception is thrown, the output is
+ *      written to stderr and the program is aborted.
+ */
+int RunFuzzInput(const char *name,
+                 FuzzFunction function,
+                 const std::uint8_t *data,
+                 std::size_t size)
+{
+    static std::once_flag assigned;
+    TestContext context(name);
+
+    // There is no main() to assign the message strings in a fuzzer
+    std::call_once(assigned, AssignMessageStrings);
+
+    RunInChildContext(context, nullptr, [&]() { function(data, size); });
+
+    if (!context.Failed()) return 0;
+
+    Formatter report;
+    report.Text(context.TakeOutput());
+    context.Summarize(report);
+    std::fwrite(report.String().data(), 1, report.String().size(), stderr);
+    std::abort();
+}
+
+} // namespace Terra::STF
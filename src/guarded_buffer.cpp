@@ -0,0 +1,504 @@
+/*
+ *  guarded_buffer.cpp
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      This module implements buffers placed next to guard pages and the
+ *      alignment sweeps that use them.
+ *
+ *  Portability Issues:
+ *      Requires C++17 or greater.  Guard pages are created with mmap() and
+ *      mprotect() on POSIX systems, and faults are caught with a SIGSEGV and
+ *      SIGBUS handler that jumps out of the faulting function.  Elsewhere,
+ *      buffers are surrounded by octets holding a known pattern instead.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <tuple>
+#include <terra/stf/guarded_buffer.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <csetjmp>
+#include <csignal>
+#include <sys/mman.h>
+#include <unistd.h>
+#define STF_USE_GUARD_PAGES
+#endif
+
+namespace Terra::STF
+{
+
+namespace
+{
+
+// Value of the octets between a buffer and its guard page
+constexpr std::uint8_t Canary = 0xa5;
+
+#if defined(STF_USE_GUARD_PAGES)
+
+// Where to jump when the function called by RunGuarded() faults
+thread_local sigjmp_buf *guard_jump = nullptr;
+
+// The address at which the function called by RunGuarded() faulted
+thread_local std::uintptr_t guard_fault = 0;
+
+// Handlers in place before the guard handler was installed
+struct sigaction previous_segv{};
+struct sigaction previous_bus{};
+
+/*
+ *  GuardHandler()
+ *
+ *  Description:
+ *      Handle a SIGSEGV or SIGBUS signal, jumping back to RunGuarded() if the
+ *      fault occurred within the function it called.
+ *
+ *  Parameters:
+ *      signal [in]
+ *          The signal number.
+ *
+ *      info [in]
+ *          Information about the signal, including the faulting address.
+ *
+ *      context [in]
+ *          The interrupted context (unused).
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      Other faults restore the previous handler and return, so that the
+ *      faulting instruction is retried and the fault handled as it would be
+ *      otherwise.
+ */
+void GuardHandler(int signal, siginfo_t *info, void *)
+{
+    if (guard_jump != nullptr)
+    {
+        guard_fault = reinterpret_cast<std::uintptr_t>(info->si_addr);
+        siglongjmp(*guard_jump, 1);
+    }
+
+    ::sigaction(signal,
+                (signal == SIGSEGV) ? &previous_segv : &previous_bus,
+                nullptr);
+}
+
+/*
+ *  InstallGuardHandler()
+ *
+ *  Description:
+ *      Install the guard handler for SIGSEGV and SIGBUS, once.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void InstallGuardHandler()
+{
+    static std::once_flag installed;
+
+    std::call_once(installed,
+                   []()
+                   {
+                       struct sigaction action{};
+                       action.sa_sigaction = GuardHandler;
+                       action.sa_flags = SA_SIGINFO;
+                       sigemptyset(&action.sa_mask);
+                       ::sigaction(SIGSEGV, &action, &previous_segv);
+                       ::sigaction(SIGBUS, &action, &previous_bus);
+                   });
+}
+
+/*
+ *  PageSize()
+ *
+ *  Description:
+ *      Return the size of a memory page.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The size of a page in octets.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t PageSize()
+{
+    static const std::size_t page_size =
+        static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+
+    return page_size;
+}
+
+/*
+ *  RoundUp()
+ *
+ *  Description:
+ *      Round the given size up to a multiple of the page size.
+ *
+ *  Parameters:
+ *      size [in]
+ *          The size to round.
+ *
+ *  Returns:
+ *      The rounded size.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t RoundUp(std::size_t size)
+{
+    return (size + PageSize() - 1) / PageSize() * PageSize();
+}
+
+#endif
+
+} // namespace
+
+/*
+ *  GuardedBuffer::GuardedBuffer()
+ *
+ *  Description:
+ *      Allocate a buffer next to a guard page.
+ *
+ *  Parameters:
+ *      size [in]
+ *          The size of the buffer in octets.
+ *
+ *      alignment [in]
+ *          The offset of the start of the buffer from a multiple of
+ *          Guard_Alignment, taken modulo Guard_Alignment.
+ *
+ *      side [in]
+ *          The side of the buffer on which to place the guard page.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      With the guard page after the buffer, the buffer ends as close to the
+ *      guard page as the alignment allows; with it before, the buffer starts
+ *      "alignment" octets after the guard page.  Throws std::bad_alloc if
+ *      the memory cannot be allocated.
+ */
+GuardedBuffer::GuardedBuffer(std::size_t size,
+                             std::size_t alignment,
+                             GuardSide side) :
+    region{nullptr},
+    region_size{0},
+    accessible{nullptr},
+    accessible_size{0},
+    data{nullptr},
+    size{size}
+{
+    alignment %= Guard_Alignment;
+
+#if defined(STF_USE_GUARD_PAGES)
+    // Octets between the end of the buffer and an aligned guard page
+    const std::size_t gap =
+        (Guard_Alignment - (alignment + size) % Guard_Alignment) %
+        Guard_Alignment;
+
+    accessible_size = (side == GuardSide::After) ? RoundUp(size + gap) :
+                                                   RoundUp(alignment + size);
+    region_size = accessible_size + PageSize();
+
+    void *mapping = ::mmap(nullptr,
+                           region_size,
+                           PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS,
+                           -1,
+                           0);
+    if (mapping == MAP_FAILED) throw std::bad_alloc();
+    region = static_cast<std::uint8_t *>(mapping);
+
+    if (side == GuardSide::After)
+    {
+        accessible = region;
+        data = region + accessible_size - gap - size;
+        ::mprotect(region + accessible_size, PageSize(), PROT_NONE);
+    }
+    else
+    {
+        accessible = region + PageSize();
+        data = accessible + alignment;
+        ::mprotect(region, PageSize(), PROT_NONE);
+    }
+#else
+    // Without guard pages, surround the buffer with octets to check
+    storage.resize(3 * Guard_Alignment + size);
+    accessible = storage.data();
+    accessible_size = storage.size();
+    data = accessible + Guard_Alignment + alignment -
+           reinterpret_cast<std::uintptr_t>(accessible) % Guard_Alignment;
+#endif
+
+    std::memset(accessible, Canary, accessible_size);
+    if (size > 0) std::memset(data, 0, size);
+}
+
+/*
+ *  GuardedBuffer::~GuardedBuffer()
+ *
+ *  Description:
+ *      Free the buffer and its guard page.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+GuardedBuffer::~GuardedBuffer()
+{
+#if defined(STF_USE_GUARD_PAGES)
+    if (region != nullptr) ::munmap(region, region_size);
+#endif
+}
+
+/*
+ *  GuardedBuffer::Intact()
+ *
+ *  Description:
+ *      Check that the octets between the buffer and its guard page (or, where
+ *      guard pages are not used, around the buffer) were not modified.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      True if the octets outside of the buffer are unmodified.
+ *
+ *  Comments:
+ *      None.
+ */
+bool GuardedBuffer::Intact() const noexcept
+{
+    auto is_canary = [](std::uint8_t octet) { return octet == Canary; };
+
+    return std::all_of(accessible, data, is_canary) &&
+           std::all_of(data + size, accessible + accessible_size, is_canary);
+}
+
+/*
+ *  GuardedBuffer::Locate()
+ *
+ *  Description:
+ *      Describe the given address relative to the buffer.
+ *
+ *  Parameters:
+ *      address [in]
+ *          The address to describe.
+ *
+ *  Returns:
+ *      A description such as "1 octet(s) past the end", or an empty string
+ *      if the address is not within the buffer's allocation.
+ *
+ *  Comments:
+ *      None.
+ */
+std::string GuardedBuffer::Locate(std::uintptr_t address) const
+{
+    const auto first = reinterpret_cast<std::uintptr_t>(data);
+    const auto last = first + size;
+    const auto base = reinterpret_cast<std::uintptr_t>(
+        (region != nullptr) ? region : accessible);
+    const auto limit = base + ((region != nullptr) ? region_size :
+                                                     accessible_size);
+
+    if ((address < base) || (address >= limit)) return {};
+
+    if (address >= last)
+    {
+        return std::to_string(address - last + 1) + " octet(s) past the end";
+    }
+
+    if (address < first)
+    {
+        return std::to_string(first - address) + " octet(s) before the start";
+    }
+
+    return "at offset " + std::to_string(address - first);
+}
+
+/*
+ *  RunGuarded()
+ *
+ *  Description:
+ *      Call the given function, stopping it if it touches a guard page.
+ *
+ *  Parameters:
+ *      function [in]
+ *          The function to call.
+ *
+ *  Returns:
+ *      The faulting address if the function touched a guard page or
+ *      otherwise faulted, else nothing.
+ *
+ *  Comments:
+ *      A function that faults is abandoned without unwinding its stack.
+ *      Where guard pages are not used, the function is simply called.
+ */
+std::optional<std::uintptr_t> RunGuarded(
+    const std::function<void()> &function)
+{
+#if defined(STF_USE_GUARD_PAGES)
+    sigjmp_buf jump;
+
+    InstallGuardHandler();
+
+    // Save the signal mask so that it is restored if the function faults
+    if (sigsetjmp(jump, 1) != 0)
+    {
+        guard_jump = nullptr;
+        return guard_fault;
+    }
+
+    guard_jump = &jump;
+
+    try
+    {
+        function();
+    }
+    catch (...)
+    {
+        guard_jump = nullptr;
+        throw;
+    }
+
+    guard_jump = nullptr;
+#else
+    function();
+#endif
+
+    return std::nullopt;
+}
+
+/*
+ *  PrintGuardFault()
+ *
+ *  Description:
+ *      Print the location at which a guard page was touched relative to the
+ *      buffers of a sweep.
+ *
+ *  Parameters:
+ *      address [in]
+ *          The address that was touched.
+ *
+ *      buffers [in]
+ *          The names and buffers of the sweep.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void PrintGuardFault(std::uintptr_t address, const GuardedBuffers &buffers)
+{
+    for (const auto &[name, buffer] : buffers)
+    {
+        std::string location = buffer->Locate(address);
+        if (location.empty()) continue;
+
+        PendingOutput().NewLine()
+                       .Text("Guard page touched ")
+                       .Text(location)
+                       .Text(" of the ")
+                       .Text(name)
+                       .NewLine();
+        return;
+    }
+
+    PendingOutput().NewLine()
+                   .Text("Fault at address ")
+                   .Address(reinterpret_cast<const void *>(address))
+                   .NewLine();
+}
+
+/*
+ *  RunSweep()
+ *
+ *  Description:
+ *      Run the cases of an alignment sweep as the instances of a
+ *      parameterized test, as done by SweepAlignments() and SweepTransform().
+ *
+ *  Parameters:
+ *      max_length [in]
+ *          The largest length to test.
+ *
+ *      element_size [in]
+ *          The size of an element; alignments are multiples of it.
+ *
+ *      run [in]
+ *          The function that runs the case with the given guard side,
+ *          alignment in octets, and length in elements.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      Instances are ordered by guard side, then alignment, then length.
+ */
+void RunSweep(
+    std::size_t max_length,
+    std::size_t element_size,
+    const std::function<void(GuardSide, std::size_t, std::size_t)> &run)
+{
+    const std::size_t lengths = max_length + 1;
+    const std::size_t alignments =
+        std::max<std::size_t>(1, Guard_Alignment / std::max<std::size_t>(
+                                                      1, element_size));
+
+    // Return the guard side, alignment, and length of the given instance
+    auto decode = [&](std::size_t index)
+    {
+        return std::make_tuple(
+            (index / lengths / alignments == 0) ? GuardSide::After :
+                                                  GuardSide::Before,
+            index / lengths % alignments * element_size,
+            index % lengths);
+    };
+
+    RunInstances(
+        2 * alignments * lengths,
+        [&](std::size_t index)
+        {
+            auto [side, alignment, length] = decode(index);
+            run(side, alignment, length);
+        },
+        [&](std::size_t index)
+        {
+            auto [side, alignment, length] = decode(index);
+            PendingOutput().Text("  guard page: ")
+                           .Text((side == GuardSide::After) ? "after" :
+                                                              "before")
+                           .Text(", alignment: ")
+                           .Decimal(alignment)
+                           .Text(", length: ")
+                           .Decimal(length)
+                           .NewLine();
+        });
+}
+
+} // namespace Terra::STF
@@ -0,0 +1,321 @@
+/*
+ *  isa.cpp
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      This module implements the detection of the host's ISA level, the
+ *      limit on the level that code under test may use, and the running of
+ *      tests defined with STF_TEST_ISA at each level.
+ *
+ *  Portability Issues:
+ *      Requires C++17 or greater.  Levels above Scalar are detected only for
+ *      x86 processors when compiling with GCC or Clang.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <terra/stf/isa.h>
+#include "stf_internal.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define STF_USE_CPU_SUPPORTS
+#endif
+
+namespace Terra::STF
+{
+
+namespace
+{
+
+// Names of the ISA levels, in order
+constexpr const char *ISA_Names[] = {"scalar", "sse4", "avx2", "avx512"};
+constexpr unsigned ISA_Levels = sizeof(ISA_Names) / sizeof(ISA_Names[0]);
+
+// Level set by the innermost ISALimitScope, or -1 if there is none
+std::atomic<int> isa_limit{-1};
+
+/*
+ *  DetectISALevel()
+ *
+ *  Description:
+ *      Return the best ISA level the CPU supports.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The best ISA level supported.
+ *
+ *  Comments:
+ *      None.
+ */
+ISALevel DetectISALevel()
+{
+#if defined(STF_USE_CPU_SUPPORTS)
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+    {
+        return ISALevel::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) return ISALevel::AVX2;
+    if (__builtin_cpu_supports("sse4.2")) return ISALevel::SSE4;
+#endif
+
+    return ISALevel::Scalar;
+}
+
+} // namespace
+
+/*
+ *  ISAName()
+ *
+ *  Description:
+ *      Return the name of the given ISA level.
+ *
+ *  Parameters:
+ *      level [in]
+ *          The ISA level.
+ *
+ *  Returns:
+ *      The name of the level (e.g., "avx2"), as used in test names and in
+ *      the STF_ISA environment variable.
+ *
+ *  Comments:
+ *      None.
+ */
+const char *ISAName(ISALevel level)
+{
+    const auto index = static_cast<unsigned>(level);
+
+    return (index < ISA_Levels) ? ISA_Names[index] : "unknown";
+}
+
+/*
+ *  HostISALevel()
+ *
+ *  Description:
+ *      Return the best ISA level the host supports, limited by the STF_ISA
+ *      environment variable if it is set.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The best ISA level available.
+ *
+ *  Comments:
+ *      An STF_ISA value that does not name a level is ignored.
+ */
+ISALevel HostISALevel()
+{
+    static const ISALevel host_level = []()
+    {
+        ISALevel level = DetectISALevel();
+        const char *name = std::getenv("STF_ISA");
+
+        if (name == nullptr) return level;
+
+        for (unsigned i = 0; i < ISA_Levels; i++)
+        {
+            if (std::strcmp(name, ISA_Names[i]) == 0)
+            {
+                return std::min(level, static_cast<ISALevel>(i));
+            }
+        }
+
+        return level;
+    }();
+
+    return host_level;
+}
+
+/*
+ *  ISALimit()
+ *
+ *  Description:
+ *      Return the best ISA level that code under test may use.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The level set by the innermost ISALimitScope, else HostISALevel().
+ *
+ *  Comments:
+ *      This is the hook a library's dispatcher consults to have a given
+ *      level used.
+ */
+ISALevel ISALimit()
+{
+    const int limit = isa_limit.load();
+
+    return (limit < 0) ? HostISALevel() : static_cast<ISALevel>(limit);
+}
+
+/*
+ *  ISALimitScope::ISALimitScope()
+ *
+ *  Description:
+ *      Limit the ISA level that code under test may use.
+ *
+ *  Parameters:
+ *      level [in]
+ *          The best ISA level that may be used.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+ISALimitScope::ISALimitScope(ISALevel level) noexcept :
+    previous{isa_limit.exchange(static_cast<int>(level))}
+{
+    // Nothing to do
+}
+
+/*
+ *  ISALimitScope::~ISALimitScope()
+ *
+ *  Description:
+ *      Restore the previous limit on the ISA level.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+ISALimitScope::~ISALimitScope()
+{
+    isa_limit.store(previous);
+}
+
+/*
+ *  RunISALevels()
+ *
+ *  Description:
+ *      Run the given function for each ISA level up to HostISALevel(), each
+ *      level limited with ISALimitScope and reporting to a context of its
+ *      own, and report the time taken at each level and the levels that
+ *      fail to the calling thread's current context.
+ *
+ *  Parameters:
+ *      function [in]
+ *          The function to run.
+ *
+ *      runs [in]
+ *          The number of times the function is run at each level.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      Levels are run one after another so that their times are comparable.
+ *      When runs is greater than one, the shortest time is reported, so that
+ *      the first, cold run does not skew the speedup; a level stops being
+ *      run once it fails or the test nears its timeout.  This is used by
+ *      tests defined with STF_TEST_ISA and STF_TEST_ISA_TIMED.
+ */
+void RunISALevels(const std::function<void()> &function, unsigned runs)
+{
+    TestContext *parent = CurrentContext();
+    const std::string name = (parent != nullptr) ? parent->Name() : "";
+    const auto levels = static_cast<unsigned>(HostISALevel()) + 1;
+    const auto deadline = WorkDeadline();
+    std::vector<std::chrono::nanoseconds> durations;
+    std::vector<std::string> failed;
+
+    for (unsigned i = 0; i < levels; i++)
+    {
+        const auto level = static_cast<ISALevel>(i);
+        TestContext context(name + "/" + ISAName(level));
+
+        // Keep the shortest of the runs, the first of which warms caches and
+        // branch predictors
+        std::chrono::nanoseconds best = std::chrono::nanoseconds::max();
+        for (unsigned run = 0; run < std::max(runs, 1U); run++)
+        {
+            auto start = std::chrono::steady_clock::now();
+
+            RunInChildContext(context,
+                              parent,
+                              [&]()
+                              {
+                                  ISALimitScope limit(level);
+                                  function();
+                              });
+
+            auto end = std::chrono::steady_clock::now();
+            best = std::min<std::chrono::nanoseconds>(best, end - start);
+
+            if (context.Failed() || (end >= deadline)) break;
+        }
+        durations.push_back(best);
+
+        if (!context.Failed()) continue;
+
+        // Summarize the level's failures
+        Formatter report;
+        report.Text(context.TakeOutput())
+              .Text("  ISA level: ")
+              .Text(ISAName(level))
+              .NewLine();
+        context.Summarize(report);
+        failed.push_back(report.String());
+    }
+
+    // Note the time taken at each level and the speedup over scalar code
+    PendingOutput().Text(" [");
+    for (unsigned i = 0; i < levels; i++)
+    {
+        if (i > 0) PendingOutput().Text(", ");
+        PendingOutput().Text(ISAName(static_cast<ISALevel>(i)))
+                       .Text(": ")
+                       .Text(FriendlyDuration(durations[i]));
+        if (i == 0) continue;
+        PendingOutput().Text(" (")
+                       .Float(static_cast<double>(durations[0].count()) /
+                                  std::max(durations[i].count(),
+                                           std::int64_t(1)),
+                              3)
+                       .Text("x)");
+    }
+    PendingOutput().Character(']');
+    CommitOutput();
+
+    if (failed.empty()) return;
+
+    for (const std::string &report : failed)
+    {
+        PendingOutput().Text(report);
+        RecordFailure();
+    }
+
+    PendingOutput().NewLine()
+                   .Decimal(failed.size())
+                   .Text(" of ")
+                   .Decimal(levels)
+                   .Text(" ISA level(s) failed")
+                   .NewLine();
+    CommitOutput();
+}
+
+} // namespace Terra::STF
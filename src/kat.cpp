@@ -0,0 +1,630 @@
+/*
+ *  kat.cpp
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      This module implements the reading of known-answer files for tests
+ *      defined with STF_TEST_KAT.
+ *
+ *  Portability Issues:
+ *      Requires C++17 or greater.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <terra/stf/hex.h>
+#include <terra/stf/kat.h>
+#include "mapped_file.h"
+
+namespace Terra::STF
+{
+
+// A file from which known answers were read
+struct KnownAnswerSource
+{
+    explicit KnownAnswerSource(const std::filesystem::path &path) :
+        path{path.string()},
+        file{path}
+    {
+        // Nothing to do
+    }
+
+    const std::string path;
+    const MappedFile file;
+};
+
+namespace
+{
+
+/*
+ *  Trim()
+ *
+ *  Description:
+ *      Remove spaces, tabs, and carriage returns from both ends of a string.
+ *
+ *  Parameters:
+ *      text [in]
+ *          The string to trim.
+ *
+ *  Returns:
+ *      The trimmed string.
+ *
+ *  Comments:
+ *      None.
+ */
+std::string_view Trim(std::string_view text)
+{
+    constexpr std::string_view Spaces = " \t\r";
+
+    std::size_t first = text.find_first_not_of(Spaces);
+    if (first == std::string_view::npos) return {};
+
+    std::size_t last = text.find_last_not_of(Spaces);
+
+    return text.substr(first, last - first + 1);
+}
+
+/*
+ *  SameName()
+ *
+ *  Description:
+ *      Compare two names without regard to case.
+ *
+ *  Parameters:
+ *      a [in]
+ *          The first name.
+ *
+ *      b [in]
+ *          The second name.
+ *
+ *  Returns:
+ *      True if the names are the same, else false.
+ *
+ *  Comments:
+ *      None.
+ */
+bool SameName(std::string_view a, std::string_view b)
+{
+    return std::equal(a.begin(),
+                      a.end(),
+                      b.begin(),
+                      b.end(),
+                      [](char x, char y)
+                      {
+                          return std::tolower(static_cast<unsigned char>(x)) ==
+                                 std::tolower(static_cast<unsigned char>(y));
+                      });
+}
+
+/*
+ *  SplitField()
+ *
+ *  Description:
+ *      Split a "name = value" line into a field.
+ *
+ *  Parameters:
+ *      text [in]
+ *          The text of the line, trimmed.
+ *
+ *      line [in]
+ *          The line number.
+ *
+ *  Returns:
+ *      The field, having an empty value if there is no "=".
+ *
+ *  Comments:
+ *      None.
+ */
+KnownAnswerField SplitField(std::string_view text, std::size_t line)
+{
+    std::size_t equals = text.find('=');
+
+    if (equals == std::string_view::npos) return {text, {}, line};
+
+    return {Trim(text.substr(0, equals)), Trim(text.substr(equals + 1)), line};
+}
+
+/*
+ *  ParseKnownAnswers()
+ *
+ *  Description:
+ *      Tokenize the contents of a known-answer file in place.
+ *
+ *  Parameters:
+ *      source [in]
+ *          The file to tokenize.
+ *
+ *  Returns:
+ *      The vectors in the file, in order.
+ *
+ *  Comments:
+ *      Headers that follow a vector replace those in effect; consecutive
+ *      headers accumulate.
+ */
+std::vector<KnownAnswer> ParseKnownAnswers(
+    const std::shared_ptr<const KnownAnswerSource> &source)
+{
+    const std::string_view contents(
+        reinterpret_cast<const char *>(source->file.Data()),
+        source->file.Size());
+    std::vector<KnownAnswer> vectors;
+    std::vector<KnownAnswerField> headers;
+    std::vector<KnownAnswerField> fields;
+    bool headers_closed = false;
+    std::size_t line = 0;
+
+    // Complete the vector being read, if any
+    auto finish = [&]()
+    {
+        if (fields.empty()) return;
+
+        vectors.emplace_back(source, headers, std::move(fields));
+        fields.clear();
+        headers_closed = true;
+    };
+
+    for (std::size_t position = 0; position < contents.size();)
+    {
+        std::size_t end = contents.find('\n', position);
+        if (end == std::string_view::npos) end = contents.size();
+
+        std::string_view text = Trim(contents.substr(position, end - position));
+        position = end + 1;
+        line++;
+
+        if (text.empty())
+        {
+            finish();
+            continue;
+        }
+
+        if (text.front() == '#') continue;
+
+        if ((text.front() == '[') && (text.back() == ']'))
+        {
+            finish();
+            if (headers_closed)
+            {
+                headers.clear();
+                headers_closed = false;
+            }
+            headers.push_back(
+                SplitField(Trim(text.substr(1, text.size() - 2)), line));
+            continue;
+        }
+
+        fields.push_back(SplitField(text, line));
+    }
+
+    finish();
+
+    return vectors;
+}
+
+/*
+ *  FieldError()
+ *
+ *  Description:
+ *      Return an exception describing a problem with a known-answer field.
+ *
+ *  Parameters:
+ *      file [in]
+ *          The file containing the vector.
+ *
+ *      line [in]
+ *          The line of the field or vector.
+ *
+ *      message [in]
+ *          The description of the problem.
+ *
+ *      name [in]
+ *          The name of the field.
+ *
+ *  Returns:
+ *      The exception to throw.
+ *
+ *  Comments:
+ *      None.
+ */
+std::invalid_argument FieldError(const std::string &file,
+                                 std::size_t line,
+                                 const char *message,
+                                 std::string_view name)
+{
+    return std::invalid_argument(file + ":" + std::to_string(line) + ": " +
+                                 message + " \"" + std::string(name) + "\"");
+}
+
+} // namespace
+
+/*
+ *  KnownAnswer::KnownAnswer()
+ *
+ *  Description:
+ *      Construct a known-answer vector.
+ *
+ *  Parameters:
+ *      source [in]
+ *          The file containing the vector, which its fields refer to.
+ *
+ *      headers [in]
+ *          The headers in effect for the vector.
+ *
+ *      fields [in]
+ *          The fields of the vector, of which there is at least one.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+KnownAnswer::KnownAnswer(std::shared_ptr<const KnownAnswerSource> source,
+                         std::vector<KnownAnswerField> headers,
+                         std::vector<KnownAnswerField> fields) :
+    source{std::move(source)},
+    headers{std::move(headers)},
+    fields{std::move(fields)},
+    decoded(this->fields.size())
+{
+    // Nothing to do
+}
+
+/*
+ *  KnownAnswer::File()
+ *
+ *  Description:
+ *      Return the path of the file containing the vector.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The path of the file.
+ *
+ *  Comments:
+ *      None.
+ */
+const std::string &KnownAnswer::File() const
+{
+    return source->path;
+}
+
+/*
+ *  KnownAnswer::Line()
+ *
+ *  Description:
+ *      Return the line on which the vector begins.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The line number of the vector's first field.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t KnownAnswer::Line() const
+{
+    return fields.front().line;
+}
+
+/*
+ *  KnownAnswer::Has()
+ *
+ *  Description:
+ *      Determine whether the vector has the named field.
+ *
+ *  Parameters:
+ *      name [in]
+ *          The name of the field.
+ *
+ *  Returns:
+ *      True if the field is present, else false.
+ *
+ *  Comments:
+ *      None.
+ */
+bool KnownAnswer::Has(std::string_view name) const
+{
+    return std::any_of(fields.begin(),
+                       fields.end(),
+                       [&](const KnownAnswerField &field)
+                       {
+                           return SameName(field.name, name);
+                       });
+}
+
+/*
+ *  KnownAnswer::HasHeader()
+ *
+ *  Description:
+ *      Determine whether the named header is in effect for the vector.
+ *
+ *  Parameters:
+ *      name [in]
+ *          The name of the header (e.g., "ENCRYPT" or "L").
+ *
+ *  Returns:
+ *      True if the header is in effect, else false.
+ *
+ *  Comments:
+ *      None.
+ */
+bool KnownAnswer::HasHeader(std::string_view name) const
+{
+    return std::any_of(headers.begin(),
+                       headers.end(),
+                       [&](const KnownAnswerField &header)
+                       {
+                           return SameName(header.name, name);
+                       });
+}
+
+/*
+ *  KnownAnswer::Text()
+ *
+ *  Description:
+ *      Return the value of the named field as text.
+ *
+ *  Parameters:
+ *      name [in]
+ *          The name of the field.
+ *
+ *  Returns:
+ *      The value, which refers to the file's contents.
+ *
+ *  Comments:
+ *      None.
+ */
+std::string_view KnownAnswer::Text(std::string_view name) const
+{
+    return Find(name).value;
+}
+
+/*
+ *  KnownAnswer::Header()
+ *
+ *  Description:
+ *      Return the value of the named header, as for "[L = 20]".
+ *
+ *  Parameters:
+ *      name [in]
+ *          The name of the header.
+ *
+ *  Returns:
+ *      The value, which is empty for a header such as "[ENCRYPT]".
+ *
+ *  Comments:
+ *      None.
+ */
+std::string_view KnownAnswer::Header(std::string_view name) const
+{
+    for (const KnownAnswerField &header : headers)
+    {
+        if (SameName(header.name, name)) return header.value;
+    }
+
+    throw FieldError(File(), Line(), "No header", name);
+}
+
+/*
+ *  KnownAnswer::Number()
+ *
+ *  Description:
+ *      Return the value of the named field as a decimal number.
+ *
+ *  Parameters:
+ *      name [in]
+ *          The name of the field (e.g., "COUNT" or "Len").
+ *
+ *  Returns:
+ *      The number.
+ *
+ *  Comments:
+ *      None.
+ */
+std::uint64_t KnownAnswer::Number(std::string_view name) const
+{
+    const KnownAnswerField &field = Find(name);
+    std::uint64_t number = 0;
+
+    auto [end, error] = std::from_chars(field.value.data(),
+                                        field.value.data() + field.value.size(),
+                                        number);
+    if ((error != std::errc()) ||
+        (end != field.value.data() + field.value.size()))
+    {
+        throw FieldError(File(), field.line, "Malformed number in", name);
+    }
+
+    return number;
+}
+
+/*
+ *  KnownAnswer::Hex()
+ *
+ *  Description:
+ *      Return the value of the named field decoded from hexadecimal.
+ *
+ *  Parameters:
+ *      name [in]
+ *          The name of the field.
+ *
+ *  Returns:
+ *      The decoded octets.
+ *
+ *  Comments:
+ *      The octets are decoded on first use into storage that the vector
+ *      holds for each of its fields, so the reference remains valid for
+ *      the lifetime of the vector.
+ */
+const std::vector<std::uint8_t> &KnownAnswer::Hex(std::string_view name) const
+{
+    const KnownAnswerField &field = Find(name);
+    auto &octets = decoded[static_cast<std::size_t>(&field - fields.data())];
+
+    if (octets) return *octets;
+
+    std::vector<std::uint8_t> value;
+    if (!DecodeHex(field.value, value))
+    {
+        throw FieldError(File(), field.line, "Malformed hex in", name);
+    }
+
+    return octets.emplace(std::move(value));
+}
+
+/*
+ *  KnownAnswer::Find()
+ *
+ *  Description:
+ *      Return the named field.
+ *
+ *  Parameters:
+ *      name [in]
+ *          The name of the field.
+ *
+ *  Returns:
+ *      The field.
+ *
+ *  Comments:
+ *      Throws std::invalid_argument if the field is missing.
+ */
+const KnownAnswerField &KnownAnswer::Find(std::string_view name) const
+{
+    for (const KnownAnswerField &field : fields)
+    {
+        if (SameName(field.name, name)) return field;
+    }
+
+    throw FieldError(File(), Line(), "No field", name);
+}
+
+/*
+ *  operator<<()
+ *
+ *  Description:
+ *      Print the location of a known-answer vector, as in
+ *      "aes.rsp:12 [ENCRYPT] COUNT = 0".
+ *
+ *  Parameters:
+ *      stream [in]
+ *          The stream to which to print.
+ *
+ *      vector [in]
+ *          The vector to print.
+ *
+ *  Returns:
+ *      The stream.
+ *
+ *  Comments:
+ *      This identifies a failing vector in a test's output.
+ */
+std::ostream &operator<<(std::ostream &stream, const KnownAnswer &vector)
+{
+    stream << vector.File() << ':' << vector.Line();
+
+    for (const KnownAnswerField &header : vector.Headers())
+    {
+        stream << " [" << header.name;
+        if (!header.value.empty()) stream << " = " << header.value;
+        stream << ']';
+    }
+
+    if (vector.Has("COUNT")) stream << " COUNT = " << vector.Text("COUNT");
+
+    return stream;
+}
+
+/*
+ *  LoadKnownAnswers()
+ *
+ *  Description:
+ *      Read the vectors in the given known-answer file.
+ *
+ *  Parameters:
+ *      path [in]
+ *          The path of the file, relative to STF_KAT_DIR if that is set.
+ *
+ *  Returns:
+ *      The vectors, in the order they appear in the file.
+ *
+ *  Comments:
+ *      Throws std::runtime_error if the file cannot be read.  This is used
+ *      by tests defined with STF_TEST_KAT.
+ */
+std::vector<KnownAnswer> LoadKnownAnswers(const std::string &path)
+{
+    static const char *kat_root = std::getenv("STF_KAT_DIR");
+    std::filesystem::path file(path);
+
+    if (file.is_relative() && (kat_root != nullptr))
+    {
+        file = std::filesystem::path(kat_root) / file;
+    }
+
+    auto source = std::make_shared<const KnownAnswerSource>(file);
+    if (!source->file.IsOpen())
+    {
+        throw std::runtime_error("Unable to read known-answer file " +
+                                 file.string());
+    }
+
+    return ParseKnownAnswers(source);
+}
+
+/*
+ *  DecodeHex()
+ *
+ *  Description:
+ *      Decode a string of hexadecimal digits into octets.
+ *
+ *  Parameters:
+ *      text [in]
+ *          The hexadecimal digits, two per octet, in either case.
+ *
+ *      octets [out]
+ *          The decoded octets, replacing its contents.  Its storage is
+ *          reused, so a buffer decoded into repeatedly is allocated once.
+ *
+ *  Returns:
+ *      True if the text was valid, else false.
+ *
+ *  Comments:
+ *      None.
+ */
+bool DecodeHex(std::string_view text, std::vector<std::uint8_t> &octets)
+{
+    octets.resize(text.size() / 2);
+
+    if (text.size() % 2 != 0) return false;
+
+    for (std::size_t i = 0; i < octets.size(); i++)
+    {
+        const std::uint8_t high =
+            detail::Hex_Values[static_cast<unsigned char>(text[2 * i])];
+        const std::uint8_t low =
+            detail::Hex_Values[static_cast<unsigned char>(text[2 * i + 1])];
+
+        if ((high | low) == detail::Not_Hex) return false;
+
+        octets[i] = static_cast<std::uint8_t>((high << 4) | low);
+    }
+
+    return true;
+}
+
+} // namespace Terra::STF
@@ -0,0 +1,120 @@
+/*
+ *  mapped_file.cpp
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      This module implements the MappedFile object.
+ *
+ *  Portability Issues:
+ *      Requires C++17 or greater.  Files are memory-mapped on POSIX systems
+ *      and read into memory elsewhere.
+ */
+
+#include <fstream>
+#include <iterator>
+#include "mapped_file.h"
+
+#if defined(STF_USE_MMAP)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Terra::STF
+{
+
+/*
+ *  MappedFile::MappedFile()
+ *
+ *  Description:
+ *      Map the given file into memory.
+ *
+ *  Parameters:
+ *      path [in]
+ *          The path of the file.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      IsOpen() indicates whether the file could be read.
+ */
+MappedFile::MappedFile(const std::filesystem::path &path) :
+    open{false},
+    data{nullptr},
+    size{0}
+{
+#if defined(STF_USE_MMAP)
+    int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) return;
+
+    struct stat status{};
+    if (::fstat(descriptor, &status) == 0)
+    {
+        size = static_cast<std::size_t>(status.st_size);
+
+        // Empty files cannot be mapped, but are valid inputs
+        if (size == 0)
+        {
+            open = true;
+        }
+        else
+        {
+            void *mapping =
+                ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if (mapping != MAP_FAILED)
+            {
+                data = static_cast<const std::uint8_t *>(mapping);
+                open = true;
+            }
+        }
+    }
+
+    ::close(descriptor);
+#else
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return;
+
+    contents.assign(std::istreambuf_iterator<char>(file),
+                    std::istreambuf_iterator<char>());
+    if (file.bad()) return;
+
+    data = contents.data();
+    size = contents.size();
+    open = true;
+#endif
+}
+
+/*
+ *  MappedFile::~MappedFile()
+ *
+ *  Description:
+ *      Unmap the file.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+MappedFile::~MappedFile()
+{
+#if defined(STF_USE_MMAP)
+    if (data != nullptr)
+    {
+        ::munmap(const_cast<std::uint8_t *>(data), size);
+    }
+#endif
+}
+
+} // namespace Terra::STF
@@ -0,0 +1,66 @@
+/*
+ *  mapped_file.h
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      This file defines the MappedFile object used internally to read
+ *      corpus and known-answer files without copying them.
+ *
+ *  Portability Issues:
+ *      Requires C++17 or greater.  Files are memory-mapped on POSIX systems
+ *      and read into memory elsewhere.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define STF_USE_MMAP
+#endif
+
+namespace Terra::STF
+{
+
+/*
+ *  MappedFile
+ *
+ *  Description:
+ *      The contents of a file, memory-mapped where supported and otherwise
+ *      read into memory.
+ *
+ *  Comments:
+ *      None.
+ */
+class MappedFile
+{
+    public:
+        explicit MappedFile(const std::filesystem::path &path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        bool IsOpen() const noexcept { return open; }
+        const std::uint8_t *Data() const noexcept { return data; }
+        std::size_t Size() const noexcept { return size; }
+
+    protected:
+        bool open;
+        const std::uint8_t *data;
+        std::size_t size;
+#if !defined(STF_USE_MMAP)
+        std::vector<std::uint8_t> contents;
+#endif
+};
+
+} // namespace Terra::STF
@@ -0,0 +1,140 @@
+/*
+ *  parameterized.cpp
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      This module implements the running of the instances of a
+ *      parameterized test (see STF_TEST_P) on a number of worker threads.
+ *
+ *  Portability Issues:
+ *      Requires C++17 or greater.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include <terra/stf/parameterized.h>
+
+namespace Terra::STF
+{
+
+namespace
+{
+
+// Number of failing instances of an STF_TEST_P test that are reported
+constexpr std::size_t Instance_Report_Limit = 10;
+
+} // namespace
+
+/*
+ *  RunInstances()
+ *
+ *  Description:
+ *      Run the given number of instances of a parameterized test on a number
+ *      of worker threads, each instance reporting to a context of its own,
+ *      and report the instances that fail to the calling thread's current
+ *      context.
+ *
+ *  Parameters:
+ *      count [in]
+ *          The number of instances.
+ *
+ *      run [in]
+ *          The function that runs the instance having the given index.
+ *
+ *      describe [in]
+ *          The function that prints the parameter of the instance having the
+ *          given index, called only for instances that fail.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      Instances are taken in order by whichever worker is free, and every
+ *      instance is run even if others fail.  The output of the first
+ *      Instance_Report_Limit failing instances is reported in order of index,
+ *      each counting as one failure of the test.
+ */
+void RunInstances(std::size_t count,
+                  const std::function<void(std::size_t)> &run,
+                  const std::function<void(std::size_t)> &describe)
+{
+    TestContext *parent = CurrentContext();
+    const std::string name = (parent != nullptr) ? parent->Name() : "";
+    std::atomic<std::size_t> next_index{};
+    std::mutex failed_mutex;
+    std::vector<std::pair<std::size_t, std::string>> failed;
+
+    // Note the number of instances on the line reporting the test
+    PendingOutput().Text(" [").Decimal(count).Text(" instances]");
+    CommitOutput();
+
+    auto worker = [&]()
+    {
+        for (std::size_t index = next_index++;
+             index < count;
+             index = next_index++)
+        {
+            TestContext context(name + "/" + std::to_string(index));
+
+            RunInChildContext(context, parent, [&]() { run(index); });
+
+            if (!context.Failed()) continue;
+
+            // Describe the parameter and summarize the instance's failures
+            {
+                ContextScope scope(&context);
+                describe(index);
+                CommitOutput();
+            }
+            Formatter report;
+            report.Text(context.TakeOutput());
+            context.Summarize(report);
+
+            std::lock_guard<std::mutex> lock(failed_mutex);
+            failed.emplace_back(index, report.String());
+        }
+    };
+
+    // Run the instances on the workers, including the calling thread
+    RunOnWorkers(std::min(WorkerThreads(), count), worker);
+
+    if (failed.empty()) return;
+
+    // Report the failing instances in order
+    std::sort(failed.begin(),
+              failed.end(),
+              [](const auto &a, const auto &b) { return a.first < b.first; });
+    for (std::size_t i = 0; i < failed.size(); i++)
+    {
+        if (i < Instance_Report_Limit) PendingOutput().Text(failed[i].second);
+        RecordFailure();
+    }
+
+    PendingOutput().NewLine()
+                   .Decimal(failed.size())
+                   .Text(" of ")
+                   .Decimal(count)
+                   .Text(" instance(s) failed");
+    if (failed.size() > Instance_Report_Limit)
+    {
+        PendingOutput().Text("; ")
+                       .Decimal(failed.size() - Instance_Report_Limit)
+                       .Text(" not shown");
+    }
+    PendingOutput().NewLine();
+    CommitOutput();
+}
+
+} // namespace Terra::STF
@@ -0,0 +1,59 @@
+/*
+ *  property.cpp
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      This module implements the parts of STF_PROPERTY tests that do not
+ *      depend on the types of the generated values.
+ *
+ *  Portability Issues:
+ *      Requires C++17 or greater.
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <terra/stf/property.h>
+
+namespace Terra::STF
+{
+
+/*
+ *  NewPropertySeed()
+ *
+ *  Description:
+ *      Return the seed from which the inputs of an STF_PROPERTY test are
+ *      produced.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The value of the STF_PROPERTY_SEED environment variable if set, else
+ *      a random seed.
+ *
+ *  Comments:
+ *      This may be called by several tests at once.  The environment is read
+ *      on each call, so a test may set the variable to repeat a run.
+ */
+std::uint64_t NewPropertySeed()
+{
+    static std::mutex random_mutex;
+    static std::random_device random_device;
+
+    const char *fixed_seed = std::getenv("STF_PROPERTY_SEED");
+    if (fixed_seed != nullptr) return std::strtoull(fixed_seed, nullptr, 10);
+
+    std::lock_guard<std::mutex> lock(random_mutex);
+
+    return (std::uint64_t(random_device()) << 32) ^ random_device();
+}
+
+} // namespace Terra::STF
@@ -15,16 +15,25 @@
  *
  *      This file also includes the main() function that iterates over the
  *      vector of registered unit tests, invokes each test function, and prints
- *      timing information.
+ *      timing information.  The main() function is omitted when STF_FUZZER
+ *      is defined, as a fuzzer then provides it (see fuzz.h).
+ *
+ *      Output is produced without the use of iostreams.  Messages produced
+ *      by a test are collected into a buffer that is written to stdout once
+ *      when the test completes, rather than flushing stdout on every line.
  *
  *  Portability Issues:
- *      Requires C++11 or greater.
+ *      Requires C++17 or greater.
  */
 
 #include <tuple>
 #include <vector>
 #include <cctype>
 #include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <stdexcept>
 #include <chrono>
@@ -33,7 +42,19 @@
 #include <mutex>
 #include <cstdlib>
 #include <typeinfo>
+#include <random>
 #include <terra/stf/stf.h>
+#include "stf_internal.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define STF_USE_SSE2
+#endif
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
 
 namespace Terra::STF
 {
@@ -44,12 +65,12 @@ std::string ActualText;
 std::string LHSText;
 std::string RHSText;
 
-// Global used to indicate a test failed
-std::atomic<bool> Test_Failed{};
-
 // Count of tests that failed to register
 unsigned failed_registrations{};
 
+// Number of failures reported per STF_EXPECT_* assertion site
+std::size_t Expect_Report_Limit = Default_Expect_Report_Limit;
+
 // Define a vector to hold unit test functions to execute
 using UnitTests = std::vector<std::tuple<std::string,
                               std::function<void()>,
@@ -58,6 +79,16 @@ using UnitTests = std::vector<std::tuple<std::string,
 // Define a vector to hold unit test names to exclude from running
 using UnitTestExclusions = std::vector<std::string>;
 
+// Define a vector to hold tests defined with STF_TEST_ASYNC
+struct AsyncUnitTest
+{
+    std::string name;
+    AsyncTestStart start;
+    AsyncTestRun run;
+    unsigned timeout;
+};
+using AsyncUnitTests = std::vector<AsyncUnitTest>;
+
 namespace
 {
 
@@ -67,416 +98,2959 @@ std::unique_ptr<UnitTests> Unit_Tests;
 // Define a pointer for tests that should be excluded
 std::unique_ptr<UnitTestExclusions> Unit_Test_Exclusions;
 
+// Define a pointer for the aforementioned AsyncUnitTests
+std::unique_ptr<AsyncUnitTests> Async_Unit_Tests;
+
+// Context of the test being executed by the runner
+std::atomic<TestContext *> Active_Context{};
+
+// Context to which each thread's assertions are reported, if not the above
+thread_local TestContext *Thread_Context{};
+
+// Message being constructed by each thread
+thread_local Formatter Pending_Output;
+
+// State shared by the threads running a round of an STF_TEST_CONCURRENT test
+struct ConcurrentRun
+{
+    explicit ConcurrentRun(std::size_t threads) :
+        threads{threads},
+        sync{threads}
+    {
+        // Nothing to do
+    }
+
+    const std::size_t threads;
+    std::atomic<std::size_t> round{};
+    SpinBarrier sync;
+};
+
+// The STF_TEST_CONCURRENT run in which each thread participates, if any
+thread_local ConcurrentRun *Concurrent_Run{};
+thread_local std::size_t Concurrent_Index{};
+
+// Number of spins a thread waiting at a SpinBarrier makes before yielding
+constexpr std::size_t Spins_Before_Yield = 64;
+
+// Number of the most recently constructed TestContext
+std::atomic<std::uint64_t> Context_Serial{};
+
+// Serial number of the context in which each thread last reached a yield
+// point, the thread's index within that context, and the number of yield
+// points it has reached there
+thread_local std::uint64_t Yield_Context{};
+thread_local std::uint64_t Yield_Thread{};
+thread_local std::uint64_t Yield_Visits{};
+
+// Added to the indices of threads not in an STF_TEST_CONCURRENT test so that
+// they differ from those of threads that are
+constexpr std::uint64_t Plain_Yield_Thread = std::uint64_t(1) << 31;
+
+// Longest spin and sleep performed at a yield point
+constexpr std::uint64_t Max_Yield_Spins = 4096;
+constexpr std::uint64_t Max_Yield_Sleep_Microseconds = 200;
+
 /*
- *  AssignMessageStrings()
+ *  Mix()
  *
  *  Description:
- *      Assign global message string values.
+ *      Scramble the bits of the given value (the SplitMix64 finalizer) so
+ *      that every input bit affects every output bit.
  *
  *  Parameters:
- *      None.
+ *      value [in]
+ *          The value to scramble.
  *
  *  Returns:
- *      Nothing.
+ *      The scrambled value.
  *
  *  Comments:
  *      None.
  */
-void AssignMessageStrings()
+constexpr std::uint64_t Mix(std::uint64_t value) noexcept
 {
-    ExpectText = "  expected: ";
-    ActualText = "    actual: ";
-    LHSText = "  lhs: ";
-    RHSText = "  rhs: ";
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+
+    return value ^ (value >> 31);
 }
 
 /*
- *  GetMemoryHex()
+ *  PrintYieldSeed()
  *
  *  Description:
- *      Creates a string containing hex values from a block of memory.
+ *      Print the seed that drove STF_YIELD_POINT() perturbations in a test
+ *      and how to use it again.
  *
  *  Parameters:
- *      memory [in]
- *          A pointer into memory.
+ *      output [out]
+ *          The formatter into which the text is written.
  *
- *      length [in]
- *          The number of octets to read from memory and convert into a hex
- *          string.
+ *      seed [in]
+ *          The seed used by the test.
  *
  *  Returns:
- *      The hex string produced by this routine.
+ *      Nothing.
  *
  *  Comments:
  *      None.
  */
-std::string GetMemoryHex(const std::uint8_t *memory, std::size_t length)
+void PrintYieldSeed(Formatter &output, std::uint64_t seed)
 {
-    std::ostringstream oss;
-
-    oss << std::hex << std::setfill('0');
-
-    for (std::size_t i = 0; i < length; i++)
-    {
-        if (i > 0) oss << " ";
-        oss << std::setw(2) << +memory[i];
-    }
-
-    return oss.str();
+    output.Text("Yield point seed: ")
+          .Decimal(seed)
+          .Text(" (set STF_YIELD_SEED=")
+          .Decimal(seed)
+          .Text(" to apply the same perturbations)")
+          .NewLine();
 }
 
 /*
- *  FriendlyDuration()
+ *  WriteStdout()
  *
  *  Description:
- *      Return a human-friendly duration string that uses seconds, milliseconds,
- *      microseconds, or nanoseconds depending on the value of the duration.
+ *      Write the given text to stdout without flushing.
  *
  *  Parameters:
- *      duration [in]
- *          The duration to print.
+ *      text [in]
+ *          The text to write.
  *
  *  Returns:
- *      Human-friendly duration string.
+ *      Nothing.
  *
  *  Comments:
  *      None.
  */
-std::string FriendlyDuration(std::chrono::nanoseconds &duration)
+void WriteStdout(std::string_view text)
 {
-    std::ostringstream oss;
-
-    // Should we produce seconds?
-    if (duration >= std::chrono::seconds(1))
-    {
-        // Convert to microseconds to get fractional output
-        oss << static_cast<double>(
-                   std::chrono::duration_cast<std::chrono::milliseconds>(
-                       duration).count()) / 1000.0
-            << " s";
-        return oss.str();
-    }
-
-    // Should we produce milliseconds?
-    if (duration >= std::chrono::milliseconds(1))
-    {
-        // Convert to microseconds to get fractional output
-        oss << static_cast<double>(
-                   std::chrono::duration_cast<std::chrono::microseconds>(
-                       duration).count()) / 1000.0
-            << " ms";
-        return oss.str();
-    }
-
-    // Produce fractional microsecond output
-    oss << static_cast<double>(
-               std::chrono::duration_cast<std::chrono::nanoseconds>(duration)
-                   .count()) / 1000.0
-        << " us";
-
-    return oss.str();
+    if (!text.empty()) std::fwrite(text.data(), 1, text.size(), stdout);
 }
 
-} // namespace
-
 /*
- *  RegisterTest()
+ *  GetMemoryHex()
  *
  *  Description:
- *      Function to register a unit test with the Simple Test Framework.
+ *      Creates a string containing hex values from a block of memory.
  *
  *  Parameters:
- *      name [in]
- *          The name of the test.
- *
- *      test [in]
- *          The test routine to register.
+ *      memory [in]
+ *          A pointer into memory.
  *
- *      timeout [in]
- *          Time after which the test will assume to have stalled and the
- *          test will be aborted.  This parameter is optional.  The default
- *          value is Default_Timeout.
+ *      length [in]
+ *          The number of octets to read from memory and convert into a hex
+ *          string.
  *
  *  Returns:
- *      An identifier for the registered test.  If zero is returned, it means
- *      the test could not be registered.
+ *      The hex string produced by this routine.
  *
  *  Comments:
  *      None.
  */
-std::size_t RegisterTest(const char *name,
-                         const std::function<void()> &test,
-                         unsigned timeout) noexcept
+std::string GetMemoryHex(const std::uint8_t *memory, std::size_t length)
 {
-    try
-    {
-        // If this is the first test, allocate storage
-        if (!Unit_Tests) Unit_Tests = std::make_unique<UnitTests>();
+    static constexpr char Hex_Digits[] = "0123456789abcdef";
+    std::string hex;
 
-        // Store this test in the unit test vector
-        Unit_Tests->emplace_back(name, test, timeout);
-    }
-    catch (...)
+    if (length == 0) return hex;
+
+    // Each octet produces two hex digits and all but the last a space
+    hex.resize((length * 3) - 1, ' ');
+
+    for (std::size_t i = 0, j = 0; i < length; i++, j += 3)
     {
-        failed_registrations++;
-        return 0;
+        hex[j] = Hex_Digits[memory[i] >> 4];
+        hex[j + 1] = Hex_Digits[memory[i] & 0x0f];
     }
 
-    return Unit_Tests->size();
+    return hex;
 }
 
 /*
- *  ExcludeTest()
+ *  OrderedBits()
  *
  *  Description:
- *      Function to specify what tests should be excluded from test runs.
+ *      Map the bit pattern of a floating point value onto an unsigned integer
+ *      such that the integers are ordered in the same way as the floating
+ *      point values they represent.  Adjacent representable values map to
+ *      adjacent integers and both positive and negative zero map to the
+ *      same integer.
  *
  *  Parameters:
- *      name [in]
- *          The name of the test.
+ *      value [in]
+ *          The floating point value to map.
  *
  *  Returns:
- *      True to indicate test is recorded for exclusion.
+ *      The ordered integer representation of the value.
  *
  *  Comments:
- *      None.
+ *      The value must not be NaN.
  */
-bool ExcludeTest(const char *name) noexcept
+template<typename U, typename F>
+U OrderedBits(F value)
 {
-    try
-    {
-        // If this is the first test exclusion, allocate storage
-        if (!Unit_Test_Exclusions)
-        {
-            Unit_Test_Exclusions = std::make_unique<UnitTestExclusions>();
-        }
+    static_assert(sizeof(U) == sizeof(F), "Integer and float sizes differ");
 
-        // Store this test in the unit test vector
-        Unit_Test_Exclusions->emplace_back(name);
-    }
-    catch (...)
-    {
-        failed_registrations++;
-        return false;
-    }
+    constexpr U Sign_Bit = U(1) << (sizeof(U) * 8 - 1);
+    U bits;
 
-    return true;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    // Negative values are stored as sign and magnitude
+    if (bits & Sign_Bit) return Sign_Bit - (bits & ~Sign_Bit);
+
+    return Sign_Bit + bits;
 }
 
 /*
- *  PrintValue()
+ *  UlpDistance()
  *
  *  Description:
- *      This function will print the expect/actual string (or similar)
- *      along with the value.  This is called by failing tests.
+ *      Compute the number of units in the last place between two floating
+ *      point values.
  *
  *  Parameters:
- *      text [in]
- *          The text to print (e.g., "expected").
+ *      lhs [in]
+ *          The left-hand side value.
  *
- *      value [in]
- *          The value to print.
+ *      rhs [in]
+ *          The right-hand side value.
  *
  *  Returns:
- *      Nothing.
+ *      The distance between the two values in ULPs.
  *
  *  Comments:
- *      None.
+ *      Neither value may be NaN.
  */
-void PrintValue(const std::string &text, bool value)
+std::uint64_t UlpDistance(float lhs, float rhs)
 {
-    std::ostringstream oss;
-
-    oss << text << std::boolalpha << value;
+    std::uint32_t a = OrderedBits<std::uint32_t>(lhs);
+    std::uint32_t b = OrderedBits<std::uint32_t>(rhs);
 
-    std::cout << oss.str() << std::endl;
+    return (a > b) ? a - b : b - a;
 }
 
 /*
- *  PrintValue()
+ *  UlpDistance()
  *
  *  Description:
- *      This function will print the expect/actual string (or similar)
- *      along with the value.  This is called by failing tests.
+ *      Compute the number of units in the last place between two floating
+ *      point values.
  *
  *  Parameters:
- *      text [in]
- *          The text to print (e.g., "expected").
+ *      lhs [in]
+ *          The left-hand side value.
  *
- *      value [in]
- *          The value to print.
+ *      rhs [in]
+ *          The right-hand side value.
  *
  *  Returns:
- *      Nothing.
+ *      The distance between the two values in ULPs.
  *
  *  Comments:
- *      None.
+ *      Neither value may be NaN.
  */
-void PrintValue(const std::string &text, unsigned char value)
+std::uint64_t UlpDistance(double lhs, double rhs)
 {
-    std::ostringstream oss;
-    oss << std::hex << std::setfill('0');
+    std::uint64_t a = OrderedBits<std::uint64_t>(lhs);
+    std::uint64_t b = OrderedBits<std::uint64_t>(rhs);
 
-    oss << text;
-    if (std::isprint(value) != 0) oss << "'" << value << "' ";
-    oss << "(unsigned char 0x" << std::setw(2) << +value << ")";
-
-    std::cout << oss.str() << std::endl;
+    return (a > b) ? a - b : b - a;
 }
 
 /*
- *  PrintValue()
+ *  IsNear()
  *
  *  Description:
- *      This function will print the expect/actual string (or similar)
- *      along with the value.  This is called by failing tests.
+ *      Determine whether two values are within the larger of the absolute
+ *      tolerance and the relative tolerance scaled by the larger magnitude
+ *      of the two values.
  *
  *  Parameters:
- *      text [in]
- *          The text to print (e.g., "expected").
+ *      lhs [in]
+ *          The left-hand side value.
  *
- *      value [in]
- *          The value to print.
+ *      rhs [in]
+ *          The right-hand side value.
+ *
+ *      abs_epsilon [in]
+ *          The absolute tolerance.
+ *
+ *      rel_epsilon [in]
+ *          The relative tolerance.
  *
  *  Returns:
- *      Nothing.
+ *      True if the values are near one another, false otherwise.
  *
  *  Comments:
- *      None.
+ *      Equal values (including equal infinities) are always near.  NaN
+ *      values are never near any value.
  */
-void PrintValue(const std::string &text, char value)
+template<typename T>
+bool IsNear(T lhs, T rhs, T abs_epsilon, T rel_epsilon)
 {
-    std::ostringstream oss;
-    oss << std::hex << std::setfill('0');
+    if (lhs == rhs) return true;
+
+    T difference = std::fabs(lhs - rhs);
 
-    oss << text;
-    if (std::isprint(value) != 0) oss << "'" << value << "' ";
-    oss << "(char 0x"
-        << std::setw(2)
-        << +static_cast<unsigned char>(value)
-        << ")";
+    // An infinite (or NaN) difference is never near
+    if (!(difference < std::numeric_limits<T>::infinity())) return false;
 
-    std::cout << oss.str() << std::endl;
+    T magnitude = std::max(std::fabs(lhs), std::fabs(rhs));
+
+    return difference <= std::max(abs_epsilon, rel_epsilon * magnitude);
 }
 
 /*
- *  PrintValue()
+ *  CountNotClose()
  *
  *  Description:
- *      This function will print the expect/actual string (or similar)
- *      along with the value.  This is called by failing tests.
+ *      Count the number of elements in two arrays that are not near one
+ *      another as determined by IsNear().  This is the hot path for
+ *      STF_ASSERT_ARRAY_CLOSE and uses SSE2 where available.
  *
  *  Parameters:
- *      text [in]
- *          The text to print (e.g., "expected").
+ *      expected [in]
+ *          The array of expected values.
  *
- *      value [in]
- *          The value to print.
+ *      actual [in]
+ *          The array of actual values.
+ *
+ *      count [in]
+ *          The number of elements in each array.
+ *
+ *      abs_epsilon [in]
+ *          The absolute tolerance.
+ *
+ *      rel_epsilon [in]
+ *          The relative tolerance.
  *
  *  Returns:
- *      Nothing.
+ *      The number of elements that are not close.
  *
  *  Comments:
  *      None.
  */
-void PrintValue(const std::string &text, signed char value)
+std::size_t CountNotClose(const float *expected,
+                          const float *actual,
+                          std::size_t count,
+                          float abs_epsilon,
+                          float rel_epsilon)
 {
-    std::ostringstream oss;
-    oss << std::hex << std::setfill('0');
+    std::size_t failures = 0;
+    std::size_t i = 0;
+
+#ifdef STF_USE_SSE2
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 infinity =
+        _mm_set1_ps(std::numeric_limits<float>::infinity());
+    const __m128 abs_tolerance = _mm_set1_ps(abs_epsilon);
+    const __m128 rel_tolerance = _mm_set1_ps(rel_epsilon);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 e = _mm_loadu_ps(expected + i);
+        __m128 a = _mm_loadu_ps(actual + i);
+        __m128 difference = _mm_and_ps(_mm_sub_ps(e, a), abs_mask);
+        __m128 magnitude = _mm_max_ps(_mm_and_ps(e, abs_mask),
+                                      _mm_and_ps(a, abs_mask));
+        __m128 tolerance =
+            _mm_max_ps(abs_tolerance, _mm_mul_ps(rel_tolerance, magnitude));
 
-    oss << text;
-    if (std::isprint(value) != 0) oss << "'" << value << "' ";
-    oss << "(signed char 0x"
-        << std::setw(2)
-        << +static_cast<unsigned char>(value)
-        << ")";
+        // Comparisons involving NaN are false, so NaN is never close
+        __m128 close = _mm_or_ps(
+            _mm_cmpeq_ps(e, a),
+            _mm_and_ps(_mm_cmple_ps(difference, tolerance),
+                       _mm_cmplt_ps(difference, infinity)));
 
-    std::cout << oss.str() << std::endl;
+        int mask = _mm_movemask_ps(close) ^ 0x0f;
+        failures += static_cast<std::size_t>((mask & 1) + ((mask >> 1) & 1) +
+                                             ((mask >> 2) & 1) + (mask >> 3));
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        failures += !IsNear(expected[i], actual[i], abs_epsilon, rel_epsilon);
+    }
+
+    return failures;
 }
 
 /*
- *  PrintValue()
+ *  CountNotClose()
  *
  *  Description:
- *      This function will print the expect/actual string (or similar)
- *      along with the value.  This is called by failing tests.
+ *      Count the number of elements in two arrays that are not near one
+ *      another as determined by IsNear().  This is the hot path for
+ *      STF_ASSERT_ARRAY_CLOSE and uses SSE2 where available.
  *
  *  Parameters:
- *      text [in]
- *          The text to print (e.g., "expected").
+ *      expected [in]
+ *          The array of expected values.
  *
- *      value [in]
- *          The value to print.
+ *      actual [in]
+ *          The array of actual values.
+ *
+ *      count [in]
+ *          The number of elements in each array.
+ *
+ *      abs_epsilon [in]
+ *          The absolute tolerance.
+ *
+ *      rel_epsilon [in]
+ *          The relative tolerance.
  *
  *  Returns:
- *      Nothing.
+ *      The number of elements that are not close.
  *
  *  Comments:
  *      None.
  */
-#ifdef __cpp_char8_t
-void PrintValue(const std::string &text, char8_t value)
+std::size_t CountNotClose(const double *expected,
+                          const double *actual,
+                          std::size_t count,
+                          double abs_epsilon,
+                          double rel_epsilon)
 {
-    std::ostringstream oss;
-    oss << std::hex << std::setfill('0');
+    std::size_t failures = 0;
+    std::size_t i = 0;
 
-    oss << text;
-    if (std::isprint(value) != 0)
+#ifdef STF_USE_SSE2
+    const __m128d abs_mask =
+        _mm_castsi128_pd(_mm_set1_epi64x(0x7fffffffffffffffLL));
+    const __m128d infinity =
+        _mm_set1_pd(std::numeric_limits<double>::infinity());
+    const __m128d abs_tolerance = _mm_set1_pd(abs_epsilon);
+    const __m128d rel_tolerance = _mm_set1_pd(rel_epsilon);
+
+    for (; i + 2 <= count; i += 2)
+    {
+        __m128d e = _mm_loadu_pd(expected + i);
+        __m128d a = _mm_loadu_pd(actual + i);
+        __m128d difference = _mm_and_pd(_mm_sub_pd(e, a), abs_mask);
+        __m128d magnitude = _mm_max_pd(_mm_and_pd(e, abs_mask),
+                                       _mm_and_pd(a, abs_mask));
+        __m128d tolerance =
+            _mm_max_pd(abs_tolerance, _mm_mul_pd(rel_tolerance, magnitude));
+
+        // Comparisons involving NaN are false, so NaN is never close
+        __m128d close = _mm_or_pd(
+            _mm_cmpeq_pd(e, a),
+            _mm_and_pd(_mm_cmple_pd(difference, tolerance),
+                       _mm_cmplt_pd(difference, infinity)));
+
+        int mask = _mm_movemask_pd(close) ^ 0x03;
+        failures += static_cast<std::size_t>((mask & 1) + (mask >> 1));
+    }
+#endif
+
+    for (; i < count; i++)
     {
-        oss << "'" << static_cast<char>(value) << "' ";
+        failures += !IsNear(expected[i], actual[i], abs_epsilon, rel_epsilon);
     }
-    oss << "(char8_t 0x" << std::setw(2) << +value << ")";
 
-    std::cout << oss.str() << std::endl;
+    return failures;
 }
-#endif
 
 /*
- *  PrintValue()
+ *  ReportArrayNotClose()
  *
  *  Description:
- *      This function will print the expect/actual string (or similar)
- *      along with the value.  This is called by failing tests.
+ *      Compute and print error statistics for two arrays that were found
+ *      not to be close to one another.
  *
  *  Parameters:
- *      text [in]
- *          The text to print (e.g., "expected").
+ *      file [in]
+ *          The name of the file where the test exists.
  *
- *      value [in]
- *          The value to print.
+ *      line [in]
+ *          The line number where the test failed.
+ *
+ *      expected [in]
+ *          The array of expected values.
+ *
+ *      actual [in]
+ *          The array of actual values.
+ *
+ *      count [in]
+ *          The number of elements in each array.
+ *
+ *      abs_epsilon [in]
+ *          The absolute tolerance.
+ *
+ *      rel_epsilon [in]
+ *          The relative tolerance.
+ *
+ *      failures [in]
+ *          The number of elements found not to be close.
  *
  *  Returns:
  *      Nothing.
  *
  *  Comments:
- *      None.
+ *      This is only called on failure, so statistics are computed with a
+ *      straightforward scalar loop.
  */
-#ifdef __cpp_unicode_characters
-void PrintValue(const std::string &text, char16_t value)
+template<typename T>
+void ReportArrayNotClose(const char *file,
+                         const std::size_t line,
+                         const T *expected,
+                         const T *actual,
+                         std::size_t count,
+                         T abs_epsilon,
+                         T rel_epsilon,
+                         std::size_t failures)
 {
-    std::ostringstream oss;
-    oss << std::hex << std::setfill('0');
+    if (!PrintAssertFailed(file, line)) return;
 
-    oss << text << "char16_t 0x" << std::setw(4)
-        << +static_cast<std::uint16_t>(value);
+    T max_error{};
+    std::size_t max_error_index{};
+    std::uint64_t max_ulps{};
+    std::size_t max_ulps_index{};
+    std::size_t worst_index{};
+    T worst_error{-1};
+    double sum_squares{};
+    std::size_t finite_errors{};
 
-    std::cout << oss.str() << std::endl;
-}
-#endif
+    for (std::size_t i = 0; i < count; i++)
+    {
+        bool nan = std::isnan(expected[i]) || std::isnan(actual[i]);
+        T error = (expected[i] == actual[i]) ?
+                      T{} :
+                      std::fabs(expected[i] - actual[i]);
 
-/*
+        // Treat NaN as the largest possible error
+        if (nan) error = std::numeric_limits<T>::infinity();
+
+        if (error > max_error)
+        {
+            max_error = error;
+            max_error_index = i;
+        }
+
+        if (!nan)
+        {
+            std::uint64_t ulps = UlpDistance(expected[i], actual[i]);
+            if (ulps > max_ulps)
+            {
+                max_ulps = ulps;
+                max_ulps_index = i;
+            }
+        }
+
+        if (error < std::numeric_limits<T>::infinity())
+        {
+            sum_squares += static_cast<double>(error) *
+                           static_cast<double>(error);
+            finite_errors++;
+        }
+
+        // The worst element is the failing element with the largest error
+        if ((error > worst_error) &&
+            !IsNear(expected[i], actual[i], abs_epsilon, rel_epsilon))
+        {
+            worst_error = error;
+            worst_index = i;
+        }
+    }
+
+    PendingOutput().Text("  elements not close: ")
+                   .Decimal(failures)
+                   .Text(" of ")
+                   .Decimal(count)
+                   .NewLine()
+                   .Text("  max abs error: ")
+                   .Float(max_error, 26)
+                   .Text(" (index ")
+                   .Decimal(max_error_index)
+                   .Character(')')
+                   .NewLine()
+                   .Text("  max ulp error: ")
+                   .Decimal(max_ulps)
+                   .Text(" (index ")
+                   .Decimal(max_ulps_index)
+                   .Character(')')
+                   .NewLine()
+                   .Text("  rms error: ")
+                   .Float(finite_errors ?
+                              std::sqrt(sum_squares /
+                                        static_cast<double>(finite_errors)) :
+                              0.0,
+                          26)
+                   .NewLine()
+                   .Text("  worst element: index ")
+                   .Decimal(worst_index)
+                   .NewLine();
+    PrintValue(ExpectText, expected[worst_index]);
+    PrintValue(ActualText, actual[worst_index]);
+}
+
+// Number of worst tensor elements to report on failure
+constexpr std::size_t Tensor_Worst_Elements = 5;
+
+// Upper bounds of the error histogram buckets (error relative to tolerance)
+constexpr std::array<double, 4> Tensor_Histogram_Bounds = {1, 10, 100, 1000};
+
+// Minimum number of tensor elements before comparing in parallel
+constexpr std::size_t Tensor_Parallel_Elements = std::size_t(1) << 18;
+
+// Holds information about a single tensor element that is not close
+template<typename T>
+struct TensorElementError
+{
+    std::array<std::size_t, 3> index;
+    T expected;
+    T actual;
+    T error;
+};
+
+// Error statistics accumulated over some or all rows of a tensor
+template<typename T>
+struct TensorErrorStatistics
+{
+    std::size_t not_close{};
+    std::array<std::size_t, Tensor_Histogram_Bounds.size() + 2> histogram{};
+    std::vector<TensorElementError<T>> worst;
+};
+
+/*
+ *  RecordWorstElement()
+ *
+ *  Description:
+ *      Record an element that is not close in the list of worst elements if
+ *      its error is among the largest seen.  The list is kept sorted in
+ *      order of decreasing error.
+ *
+ *  Parameters:
+ *      worst [in/out]
+ *          The list of worst elements.
+ *
+ *      element [in]
+ *          The element to consider.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      NaN errors are recorded as infinite errors.
+ */
+template<typename T>
+void RecordWorstElement(std::vector<TensorElementError<T>> &worst,
+                        const TensorElementError<T> &element)
+{
+    if ((worst.size() == Tensor_Worst_Elements) &&
+        !(element.error > worst.back().error))
+    {
+        return;
+    }
+
+    auto position = std::find_if(worst.begin(),
+                                 worst.end(),
+                                 [&](const TensorElementError<T> &other)
+                                 {
+                                     return element.error > other.error;
+                                 });
+    worst.insert(position, element);
+
+    if (worst.size() > Tensor_Worst_Elements) worst.pop_back();
+}
+
+/*
+ *  CompareTensorRows()
+ *
+ *  Description:
+ *      Compare a range of rows of two tensors, accumulating error statistics.
+ *      Rows are numbered across all planes, so row r refers to row
+ *      (r % rows) of plane (r / rows).
+ *
+ *  Parameters:
+ *      expected [in]
+ *          The tensor holding the expected values.
+ *
+ *      actual [in]
+ *          The tensor holding the actual values.
+ *
+ *      abs_epsilon [in]
+ *          The absolute tolerance.
+ *
+ *      rel_epsilon [in]
+ *          The relative tolerance.
+ *
+ *      first_row [in]
+ *          The first row to compare.
+ *
+ *      last_row [in]
+ *          One past the last row to compare.
+ *
+ *      statistics [out]
+ *          The statistics accumulated for the given rows.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+template<typename T>
+void CompareTensorRows(const TensorView<T> &expected,
+                       const TensorView<T> &actual,
+                       T abs_epsilon,
+                       T rel_epsilon,
+                       std::size_t first_row,
+                       std::size_t last_row,
+                       TensorErrorStatistics<T> &statistics)
+{
+    const std::size_t rows = expected.extents[1];
+    const std::size_t columns = expected.extents[2];
+
+    for (std::size_t r = first_row; r < last_row; r++)
+    {
+        const std::size_t plane = r / rows;
+        const std::size_t row = r % rows;
+        const T *e = expected.data +
+                     static_cast<std::ptrdiff_t>(plane) * expected.strides[0] +
+                     static_cast<std::ptrdiff_t>(row) * expected.strides[1];
+        const T *a = actual.data +
+                     static_cast<std::ptrdiff_t>(plane) * actual.strides[0] +
+                     static_cast<std::ptrdiff_t>(row) * actual.strides[1];
+
+        for (std::size_t column = 0; column < columns; column++)
+        {
+            const T expected_value =
+                e[static_cast<std::ptrdiff_t>(column) * expected.strides[2]];
+            const T actual_value =
+                a[static_cast<std::ptrdiff_t>(column) * actual.strides[2]];
+
+            if (IsNear(expected_value, actual_value, abs_epsilon, rel_epsilon))
+            {
+                statistics.histogram[0]++;
+                continue;
+            }
+
+            statistics.not_close++;
+
+            T error = std::fabs(expected_value - actual_value);
+            T tolerance = std::max(
+                abs_epsilon,
+                rel_epsilon * std::max(std::fabs(expected_value),
+                                       std::fabs(actual_value)));
+
+            // Place the error into the histogram relative to the tolerance
+            if (!(error < std::numeric_limits<T>::infinity()))
+            {
+                error = std::numeric_limits<T>::infinity();
+                statistics.histogram.back()++;
+            }
+            else
+            {
+                std::size_t bucket = 1;
+                while ((bucket < Tensor_Histogram_Bounds.size()) &&
+                       (static_cast<double>(error) >
+                        Tensor_Histogram_Bounds[bucket] *
+                            static_cast<double>(tolerance)))
+                {
+                    bucket++;
+                }
+                statistics.histogram[bucket]++;
+            }
+
+            RecordWorstElement(statistics.worst,
+                               {{plane, row, column},
+                                expected_value,
+                                actual_value,
+                                error});
+        }
+    }
+}
+
+/*
+ *  PrintTensorIndex()
+ *
+ *  Description:
+ *      Print the coordinates of a tensor element using only as many
+ *      dimensions as the tensor has.
+ *
+ *  Parameters:
+ *      output [in/out]
+ *          The formatter to which to print the coordinates.
+ *
+ *      rank [in]
+ *          The number of dimensions of the tensor.
+ *
+ *      index [in]
+ *          The plane, row, and column of the element.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void PrintTensorIndex(Formatter &output,
+                      std::size_t rank,
+                      const std::array<std::size_t, 3> &index)
+{
+    output.Character('[');
+    for (std::size_t i = 3 - std::min<std::size_t>(rank, 3); i < 3; i++)
+    {
+        output.Decimal(index[i]);
+        if (i < 2) output.Text(", ");
+    }
+    output.Character(']');
+}
+
+/*
+ *  CompareTensors()
+ *
+ *  Description:
+ *      Compare two tensors, reporting the error statistics on failure.
+ *
+ *  Parameters:
+ *      file [in]
+ *          The name of the file where the test exists.
+ *
+ *      line [in]
+ *          The line number where the test failed.
+ *
+ *      expected [in]
+ *          The tensor holding the expected values.
+ *
+ *      actual [in]
+ *          The tensor holding the actual values.
+ *
+ *      abs_epsilon [in]
+ *          The absolute tolerance.
+ *
+ *      rel_epsilon [in]
+ *          The relative tolerance.
+ *
+ *  Returns:
+ *      True if all elements are close, else false.
+ *
+ *  Comments:
+ *      Large tensors are divided into contiguous ranges of rows that are
+ *      compared in parallel on up to WorkerThreads() threads, with the
+ *      per-thread statistics merged after.
+ */
+template<typename T>
+bool CompareTensors(const char *file,
+                    const std::size_t line,
+                    const TensorView<T> &expected,
+                    const TensorView<T> &actual,
+                    T abs_epsilon,
+                    T rel_epsilon)
+{
+    if (expected.extents != actual.extents)
+    {
+        if (!PrintAssertFailed(file, line)) return false;
+
+        PendingOutput().Text("  tensor extents differ").NewLine();
+        for (const auto *view : {&expected, &actual})
+        {
+            PendingOutput().Text((view == &expected) ? ExpectText : ActualText)
+                           .Text("extents ");
+            PrintTensorIndex(PendingOutput(), view->rank, view->extents);
+            PendingOutput().NewLine();
+        }
+        return false;
+    }
+
+    const std::size_t total_rows = expected.extents[0] * expected.extents[1];
+    const std::size_t elements = total_rows * expected.extents[2];
+    std::size_t workers = 1;
+
+    // Determine how many threads to use for large tensors
+    if (elements >= Tensor_Parallel_Elements)
+    {
+        workers = std::min(WorkerThreads(), total_rows);
+    }
+
+    std::vector<TensorErrorStatistics<T>> partial(workers);
+
+    if (workers <= 1)
+    {
+        CompareTensorRows(expected,
+                          actual,
+                          abs_epsilon,
+                          rel_epsilon,
+                          0,
+                          total_rows,
+                          partial[0]);
+    }
+    else
+    {
+        std::vector<std::thread> threads;
+        const std::size_t rows_per_worker =
+            (total_rows + workers - 1) / workers;
+
+        for (std::size_t i = 0; i < workers; i++)
+        {
+            const std::size_t first_row = i * rows_per_worker;
+            const std::size_t last_row =
+                std::min(total_rows, first_row + rows_per_worker);
+
+            if (first_row >= last_row) break;
+
+            threads.emplace_back(
+                [&, i, first_row, last_row]()
+                {
+                    CompareTensorRows(expected,
+                                      actual,
+                                      abs_epsilon,
+                                      rel_epsilon,
+                                      first_row,
+                                      last_row,
+                                      partial[i]);
+                });
+        }
+
+        for (auto &thread : threads) thread.join();
+    }
+
+    // Merge the statistics from each worker
+    TensorErrorStatistics<T> statistics;
+    for (const auto &part : partial)
+    {
+        statistics.not_close += part.not_close;
+        for (std::size_t i = 0; i < statistics.histogram.size(); i++)
+        {
+            statistics.histogram[i] += part.histogram[i];
+        }
+        for (const auto &element : part.worst)
+        {
+            RecordWorstElement(statistics.worst, element);
+        }
+    }
+
+    if (statistics.not_close == 0) return true;
+
+    if (!PrintAssertFailed(file, line)) return false;
+
+    Formatter &output = PendingOutput();
+
+    output.Text("  elements not close: ")
+          .Decimal(statistics.not_close)
+          .Text(" of ")
+          .Decimal(elements)
+          .NewLine()
+          .Text("  error histogram (error / tolerance):")
+          .NewLine();
+    for (std::size_t i = 0; i < statistics.histogram.size(); i++)
+    {
+        output.Text("    ");
+        if (i < Tensor_Histogram_Bounds.size())
+        {
+            output.Text("<= ").Float(Tensor_Histogram_Bounds[i], 6);
+        }
+        else if (i == Tensor_Histogram_Bounds.size())
+        {
+            output.Text("> ").Float(Tensor_Histogram_Bounds.back(), 6);
+        }
+        else
+        {
+            output.Text("NaN or infinite");
+        }
+        output.Text(": ").Decimal(statistics.histogram[i]).NewLine();
+    }
+    output.Text("  worst elements:").NewLine();
+    for (const auto &element : statistics.worst)
+    {
+        output.Text("    ");
+        PrintTensorIndex(output, expected.rank, element.index);
+        output.Text(" expected ")
+              .Float(element.expected, 26)
+              .Text(", actual ")
+              .Float(element.actual, 26)
+              .Text(", error ")
+              .Float(element.error, 26)
+              .NewLine();
+    }
+
+    return false;
+}
+
+/*
+ *  ReportException()
+ *
+ *  Description:
+ *      Record a failure due to the exception currently being handled.  This
+ *      must be called from within a catch block.
+ *
+ *  Parameters:
+ *      message [in]
+ *          The message reported, to which the exception's description is
+ *          appended if it is an std::exception.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void ReportException(const char *message)
+{
+    try
+    {
+        throw;
+    }
+    catch (const std::exception &e)
+    {
+        PendingOutput().NewLine()
+                       .Text(message)
+                       .Text(": ")
+                       .Text(e.what())
+                       .NewLine();
+    }
+    catch (...)
+    {
+        PendingOutput().NewLine().Text(message).NewLine();
+    }
+
+    RecordFailure();
+}
+
+} // namespace
+
+/*
+ *  FriendlyDuration()
+ *
+ *  Description:
+ *      Return a human-friendly duration string that uses seconds, milliseconds,
+ *      microseconds, or nanoseconds depending on the value of the duration.
+ *
+ *  Parameters:
+ *      duration [in]
+ *          The duration to print.
+ *
+ *  Returns:
+ *      Human-friendly duration string.
+ *
+ *  Comments:
+ *      None.
+ */
+std::string FriendlyDuration(std::chrono::nanoseconds &duration)
+{
+    Formatter formatter;
+
+    // Should we produce seconds?
+    if (duration >= std::chrono::seconds(1))
+    {
+        // Convert to microseconds to get fractional output
+        formatter.Float(
+            static_cast<double>(
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    duration).count()) / 1000.0,
+            6).Text(" s");
+        return formatter.String();
+    }
+
+    // Should we produce milliseconds?
+    if (duration >= std::chrono::milliseconds(1))
+    {
+        // Convert to microseconds to get fractional output
+        formatter.Float(
+            static_cast<double>(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    duration).count()) / 1000.0,
+            6).Text(" ms");
+        return formatter.String();
+    }
+
+    // Produce fractional microsecond output
+    formatter.Float(
+        static_cast<double>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(duration)
+                .count()) / 1000.0,
+        6).Text(" us");
+
+    return formatter.String();
+}
+
+/*
+ *  AssignMessageStrings()
+ *
+ *  Description:
+ *      Assign global message string values.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void AssignMessageStrings()
+{
+    ExpectText = "  expected: ";
+    ActualText = "    actual: ";
+    LHSText = "  lhs: ";
+    RHSText = "  rhs: ";
+}
+
+/*
+ *  Formatter::Float()
+ *
+ *  Description:
+ *      Append a floating point value to the formatter using the general
+ *      format with the given number of significant digits.
+ *
+ *  Parameters:
+ *      value [in]
+ *          The value to append.
+ *
+ *      precision [in]
+ *          The number of significant digits to produce.
+ *
+ *  Returns:
+ *      A reference to this formatter.
+ *
+ *  Comments:
+ *      None.
+ */
+Formatter &Formatter::Float(float value, int precision)
+{
+    char digits[64];
+
+    auto result = std::to_chars(digits,
+                                digits + sizeof(digits),
+                                value,
+                                std::chars_format::general,
+                                precision);
+    if (result.ec != std::errc()) return Text("[unformattable float]");
+
+    buffer.append(digits, result.ptr);
+
+    return *this;
+}
+
+/*
+ *  Formatter::Float()
+ *
+ *  Description:
+ *      Append a floating point value to the formatter using the general
+ *      format with the given number of significant digits.
+ *
+ *  Parameters:
+ *      value [in]
+ *          The value to append.
+ *
+ *      precision [in]
+ *          The number of significant digits to produce.
+ *
+ *  Returns:
+ *      A reference to this formatter.
+ *
+ *  Comments:
+ *      None.
+ */
+Formatter &Formatter::Float(double value, int precision)
+{
+    char digits[64];
+
+    auto result = std::to_chars(digits,
+                                digits + sizeof(digits),
+                                value,
+                                std::chars_format::general,
+                                precision);
+    if (result.ec != std::errc()) return Text("[unformattable double]");
+
+    buffer.append(digits, result.ptr);
+
+    return *this;
+}
+
+/*
+ *  Formatter::Float()
+ *
+ *  Description:
+ *      Append a floating point value to the formatter using the general
+ *      format with the given number of significant digits.
+ *
+ *  Parameters:
+ *      value [in]
+ *          The value to append.
+ *
+ *      precision [in]
+ *          The number of significant digits to produce.
+ *
+ *  Returns:
+ *      A reference to this formatter.
+ *
+ *  Comments:
+ *      None.
+ */
+Formatter &Formatter::Float(long double value, int precision)
+{
+    char digits[64];
+
+    auto result = std::to_chars(digits,
+                                digits + sizeof(digits),
+                                value,
+                                std::chars_format::general,
+                                precision);
+    if (result.ec != std::errc()) return Text("[unformattable long double]");
+
+    buffer.append(digits, result.ptr);
+
+    return *this;
+}
+
+/*
+ *  Formatter::Address()
+ *
+ *  Description:
+ *      Append a memory address to the formatter as a hex value.
+ *
+ *  Parameters:
+ *      address [in]
+ *          The address to append.
+ *
+ *  Returns:
+ *      A reference to this formatter.
+ *
+ *  Comments:
+ *      None.
+ */
+Formatter &Formatter::Address(const void *address)
+{
+    return Text("0x").Hex(reinterpret_cast<std::uintptr_t>(address));
+}
+
+/*
+ *  PendingOutput()
+ *
+ *  Description:
+ *      Return the calling thread's formatter into which the message currently
+ *      being constructed is written.  The message is appended to the test
+ *      output buffer by calling CommitOutput().
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      A reference to the calling thread's pending output formatter.
+ *
+ *  Comments:
+ *      None.
+ */
+Formatter &PendingOutput()
+{
+    return Pending_Output;
+}
+
+/*
+ *  CommitOutput()
+ *
+ *  Description:
+ *      Append the calling thread's pending output to the output buffer of
+ *      the calling thread's current test context.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      The buffered output is written to stdout once when the test completes.
+ *      If no test is running, the output is written to stdout immediately.
+ */
+void CommitOutput()
+{
+    if (Pending_Output.Empty()) return;
+
+    if (TestContext *context = CurrentContext(); context != nullptr)
+    {
+        context->Commit(Pending_Output);
+        return;
+    }
+
+    WriteStdout(Pending_Output.String());
+    std::fflush(stdout);
+    Pending_Output.Clear();
+}
+
+/*
+ *  RecordFailure()
+ *
+ *  Description:
+ *      Record that an assertion failed in the calling thread's current test
+ *      context.  Any pending output describing the failure is appended to
+ *      the test output buffer as a single unit.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      If no test is running, the failure output is written to stdout.
+ */
+void RecordFailure()
+{
+    if (TestContext *context = CurrentContext(); context != nullptr)
+    {
+        context->RecordFailure(Pending_Output);
+        return;
+    }
+
+    CommitOutput();
+}
+
+/*
+ *  ExpectSite::RecordFailure()
+ *
+ *  Description:
+ *      Record that the non-fatal assertion at this site failed in the
+ *      calling thread's current test context.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void ExpectSite::RecordFailure() const
+{
+    if (TestContext *context = CurrentContext(); context != nullptr)
+    {
+        context->RecordFailure(Pending_Output, *this);
+        return;
+    }
+
+    CommitOutput();
+}
+
+/*
+ *  TestContext::TestContext()
+ *
+ *  Description:
+ *      Constructor for the TestContext object.
+ *
+ *  Parameters:
+ *      name [in]
+ *          The name of the test.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+TestContext::TestContext(std::string name) :
+    name{std::move(name)},
+    failures{},
+    deadline{std::chrono::steady_clock::time_point::max()},
+    serial{++Context_Serial},
+    yield_seed{},
+    yield_points_reached{},
+    yield_threads{},
+    scheduler{},
+    completed{}
+{
+    // Nothing to do
+}
+
+/*
+ *  TestContext::Commit()
+ *
+ *  Description:
+ *      Append the given pending output to this context's output buffer and
+ *      clear the pending output.
+ *
+ *  Parameters:
+ *      pending [in/out]
+ *          The pending output to append.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      The output is appended as a single unit, so messages committed by
+ *      different threads are never interleaved.
+ */
+void TestContext::Commit(Formatter &pending)
+{
+    if (pending.Empty()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        output += pending.String();
+    }
+
+    pending.Clear();
+}
+
+/*
+ *  TestContext::RecordFailure()
+ *
+ *  Description:
+ *      Record an assertion failure, appending the pending output describing
+ *      the failure to this context's output buffer.
+ *
+ *  Parameters:
+ *      pending [in/out]
+ *          The pending output describing the failure.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void TestContext::RecordFailure(Formatter &pending)
+{
+    Commit(pending);
+
+    failures++;
+}
+
+/*
+ *  TestContext::RecordFailure()
+ *
+ *  Description:
+ *      Record a failure of the non-fatal assertion at the given site.  The
+ *      pending output describing the failure is reported only if the number
+ *      of failures at this site has not exceeded Expect_Report_Limit;
+ *      otherwise, it is discarded and the failure is only counted.
+ *
+ *  Parameters:
+ *      pending [in/out]
+ *          The pending output describing the failure.
+ *
+ *      site [in]
+ *          The assertion site that failed.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void TestContext::RecordFailure(Formatter &pending, const ExpectSite &site)
+{
+    std::size_t count{};
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = std::find_if(expect_sites.begin(),
+                               expect_sites.end(),
+                               [&](const auto &entry)
+                               {
+                                   return entry.first == &site;
+                               });
+        if (it == expect_sites.end())
+        {
+            it = expect_sites.emplace(expect_sites.end(), &site, 0);
+        }
+
+        count = ++it->second;
+    }
+
+    if (count > Expect_Report_Limit)
+    {
+        pending.Clear();
+    }
+    else if (count == Expect_Report_Limit)
+    {
+        pending.Text("  (reporting limit of ")
+               .Decimal(Expect_Report_Limit)
+               .Text(" reached; further failures here are counted)")
+               .NewLine();
+    }
+
+    RecordFailure(pending);
+}
+
+/*
+ *  TestContext::Suppressed()
+ *
+ *  Description:
+ *      Determine whether a failure of the STF_EXPECT_* assertion at the given
+ *      file and line would not be reported, as the reporting limit for that
+ *      site has been reached.
+ *
+ *  Parameters:
+ *      file [in]
+ *          The name of the file containing the assertion.
+ *
+ *      line [in]
+ *          The line of the assertion.
+ *
+ *  Returns:
+ *      True if a further failure at the site would not be reported.
+ *
+ *  Comments:
+ *      Failures are only ever added, so a site found to be suppressed
+ *      remains so for the life of the context.
+ */
+bool TestContext::Suppressed(const char *file, std::size_t line) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return std::any_of(expect_sites.begin(),
+                       expect_sites.end(),
+                       [&](const auto &entry)
+                       {
+                           return (entry.second >= Expect_Report_Limit) &&
+                                  (entry.first->Line() == line) &&
+                                  (std::strcmp(entry.first->File(), file) ==
+                                   0);
+                       });
+}
+
+/*
+ *  TestContext::TakeOutput()
+ *
+ *  Description:
+ *      Remove and return the output collected in this context.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The output collected since the last call to this function.
+ *
+ *  Comments:
+ *      None.
+ */
+std::string TestContext::TakeOutput()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return std::exchange(output, std::string());
+}
+
+/*
+ *  TestContext::Summarize()
+ *
+ *  Description:
+ *      Produce a summary of the assertion failures in this context, including
+ *      the number of failures at each STF_EXPECT_* assertion site that were
+ *      not reported due to rate limiting.
+ *
+ *  Parameters:
+ *      summary [out]
+ *          The formatter into which the summary is written.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      Nothing is written if there were no assertion failures.
+ */
+void TestContext::Summarize(Formatter &summary) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (const auto &[site, count] : expect_sites)
+    {
+        if (count > Expect_Report_Limit)
+        {
+            summary.Text(site->File())
+                   .Character(':')
+                   .Decimal(site->Line())
+                   .Text(": ")
+                   .Decimal(count - Expect_Report_Limit)
+                   .Text(" additional failure(s) not shown")
+                   .NewLine();
+        }
+    }
+
+    if (failures > 0)
+    {
+        summary.NewLine()
+               .Text("Test \"")
+               .Text(name)
+               .Text("\" failed with ")
+               .Decimal(failures.load())
+               .Text(" assertion failure(s)")
+               .NewLine();
+
+        if (YieldPointsReached()) PrintYieldSeed(summary, yield_seed);
+    }
+}
+
+/*
+ *  CurrentContext()
+ *
+ *  Description:
+ *      Return the context to which assertions made by the calling thread
+ *      are reported.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The calling thread's current context, else the context of the test
+ *      being executed by the runner, else nullptr if no test is running.
+ *
+ *  Comments:
+ *      None.
+ */
+TestContext *CurrentContext() noexcept
+{
+    if (Thread_Context != nullptr) return Thread_Context;
+
+    return Active_Context.load();
+}
+
+/*
+ *  WorkDeadline()
+ *
+ *  Description:
+ *      Return the time by which lengthy work performed by an assertion (such
+ *      as a search) should stop so that its outcome can still be reported
+ *      before the current test exceeds its timeout.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      A time nine tenths of the way from now to the current test's
+ *      deadline, or Default_Timeout seconds from now if there is no current
+ *      test.
+ *
+ *  Comments:
+ *      None.
+ */
+std::chrono::steady_clock::time_point WorkDeadline()
+{
+    auto now = std::chrono::steady_clock::now();
+    TestContext *context = CurrentContext();
+
+    if ((context == nullptr) ||
+        (context->Deadline() == std::chrono::steady_clock::time_point::max()))
+    {
+        return now + std::chrono::seconds(Default_Timeout);
+    }
+
+    if (context->Deadline() <= now) return now;
+
+    return now + (context->Deadline() - now) * 9 / 10;
+}
+
+/*
+ *  WorkerThreads()
+ *
+ *  Description:
+ *      Return the number of worker threads over which work that can be
+ *      divided (such as the instances of a test defined with STF_TEST_P) is
+ *      spread.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The value of the STF_JOBS environment variable if set to a positive
+ *      number, else the number of hardware threads.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t WorkerThreads()
+{
+    static const char *jobs = std::getenv("STF_JOBS");
+
+    if (jobs != nullptr)
+    {
+        std::size_t workers = std::strtoull(jobs, nullptr, 10);
+        if (workers > 0) return workers;
+    }
+
+    return std::max(1U, std::thread::hardware_concurrency());
+}
+
+/*
+ *  PrintThroughput()
+ *
+ *  Description:
+ *      Print the throughput of the code under test to the pending output.
+ *
+ *  Parameters:
+ *      cases [in]
+ *          The number of cases run.
+ *
+ *      octets [in]
+ *          The number of octets in the inputs of those cases.
+ *
+ *      time [in]
+ *          The time taken to run those cases.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      The throughput is in octets per second if the inputs have a size,
+ *      else in cases per second.
+ */
+void PrintThroughput(std::size_t cases,
+                     std::size_t octets,
+                     std::chrono::nanoseconds time)
+{
+    double seconds = std::max(std::chrono::duration<double>(time).count(),
+                              1e-9);
+
+    if (octets > 0)
+    {
+        PendingOutput().Float(octets / seconds / 1e6, 4).Text(" MB/s");
+    }
+    else
+    {
+        PendingOutput().Float(cases / seconds, 4).Text(" cases/s");
+    }
+}
+
+/*
+ *  PinToProcessor()
+ *
+ *  Description:
+ *      Pin the calling thread to one of the processors on which it is
+ *      allowed to run, selected in turn by the given index.
+ *
+ *  Parameters:
+ *      index [in]
+ *          The index of the thread, used to select the processor.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      This is only implemented for Linux.  Failure to pin the thread is not
+ *      an error, as it only affects how the threads are scheduled.
+ */
+void PinToProcessor([[maybe_unused]] std::size_t index)
+{
+#if defined(__linux__)
+    cpu_set_t allowed;
+
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return;
+
+    int available = CPU_COUNT(&allowed);
+    if (available <= 1) return;
+
+    std::size_t target = index % static_cast<std::size_t>(available);
+
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+    {
+        if (!CPU_ISSET(cpu, &allowed)) continue;
+
+        if (target-- == 0)
+        {
+            cpu_set_t selected;
+
+            CPU_ZERO(&selected);
+            CPU_SET(cpu, &selected);
+            sched_setaffinity(0, sizeof(selected), &selected);
+
+            return;
+        }
+    }
+#endif
+}
+
+/*
+ *  PinToCurrentProcessor()
+ *
+ *  Description:
+ *      Pin the calling thread to the processor on which it is running.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      The scheduler has already placed the thread, so unlike pinning to a
+ *      fixed processor, threads pinned this way by tests running at the same
+ *      time are spread over the processors.  This is only implemented for
+ *      Linux.  Failure to pin the thread is not an error.
+ */
+void PinToCurrentProcessor()
+{
+#if defined(__linux__)
+    int cpu = sched_getcpu();
+    if (cpu < 0) return;
+
+    cpu_set_t selected;
+
+    CPU_ZERO(&selected);
+    CPU_SET(cpu, &selected);
+    sched_setaffinity(0, sizeof(selected), &selected);
+#endif
+}
+
+/*
+ *  ContextScope::ContextScope()
+ *
+ *  Description:
+ *      Make the given context the calling thread's current context.
+ *
+ *  Parameters:
+ *      context [in]
+ *          The context to which assertions will be reported.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      Output already pending on the calling thread is committed to the
+ *      previous context first.
+ */
+ContextScope::ContextScope(TestContext *context) noexcept :
+    previous{Thread_Context}
+{
+    if (!Pending_Output.Empty())
+    {
+        try
+        {
+            CommitOutput();
+        }
+        catch (...)
+        {
+            Pending_Output.Clear();
+        }
+    }
+
+    Thread_Context = context;
+}
+
+/*
+ *  ContextScope::~ContextScope()
+ *
+ *  Description:
+ *      Commit any output pending on the calling thread and restore the
+ *      previous context.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+ContextScope::~ContextScope()
+{
+    try
+    {
+        CommitOutput();
+    }
+    catch (...)
+    {
+        Pending_Output.Clear();
+    }
+
+    Thread_Context = previous;
+}
+
+/*
+ *  CaptureOutput()
+ *
+ *  Description:
+ *      Run a function with a scratch context as the calling thread's current
+ *      context, so that its failures are examined rather than fail the test.
+ *
+ *  Parameters:
+ *      function [in]
+ *          The function to run.
+ *
+ *  Returns:
+ *      The output of the function and the failures it recorded.
+ *
+ *  Comments:
+ *      The scratch context has the deadline and yield seed of the current
+ *      context.  An exception thrown by the function is not caught.
+ */
+CapturedOutput CaptureOutput(const std::function<void()> &function)
+{
+    TestContext *parent = CurrentContext();
+    TestContext context("Scratch");
+
+    if (parent != nullptr)
+    {
+        context.SetDeadline(parent->Deadline());
+        context.SetYieldSeed(parent->YieldSeed());
+    }
+
+    {
+        ContextScope scope(&context);
+
+        function();
+    }
+
+    return {context.TakeOutput(), context.Failures(), context.Failed()};
+}
+
+/*
+ *  ReportThreadException()
+ *
+ *  Description:
+ *      Record a failure due to an exception escaping a function run on a
+ *      thread created by the test framework.  This must be called from
+ *      within a catch block.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void ReportThreadException()
+{
+    ReportException("Unexpected exception thrown in thread");
+}
+
+/*
+ *  ReportUnexpectedException()
+ *
+ *  Description:
+ *      Record a failure due to an exception escaping a test or a part of a
+ *      test run by the test framework.  This must be called from within a
+ *      catch block.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void ReportUnexpectedException()
+{
+    ReportException("Unexpected exception thrown");
+}
+
+/*
+ *  SpinBarrier::SpinBarrier()
+ *
+ *  Description:
+ *      Constructor for the SpinBarrier object.
+ *
+ *  Parameters:
+ *      participants [in]
+ *          The number of threads that must arrive to release the barrier.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+SpinBarrier::SpinBarrier(std::size_t participants) noexcept :
+    participants{participants},
+    arrived{},
+    generation{}
+{
+    // Nothing to do
+}
+
+/*
+ *  SpinBarrier::ArriveAndWait()
+ *
+ *  Description:
+ *      Arrive at the barrier and wait until all participants have arrived.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void SpinBarrier::ArriveAndWait()
+{
+    std::size_t current{};
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        current = generation.load(std::memory_order_relaxed);
+
+        if (++arrived >= participants)
+        {
+            Release();
+            return;
+        }
+    }
+
+    for (std::size_t spins = 1;
+         generation.load(std::memory_order_acquire) == current;
+         spins++)
+    {
+        if ((spins % Spins_Before_Yield) == 0)
+        {
+            std::this_thread::yield();
+        }
+#if defined(STF_USE_SSE2)
+        else
+        {
+            _mm_pause();
+        }
+#endif
+    }
+}
+
+/*
+ *  SpinBarrier::ArriveAndDrop()
+ *
+ *  Description:
+ *      Leave the set of participants, releasing the barrier if all of the
+ *      remaining participants have already arrived.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void SpinBarrier::ArriveAndDrop()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (participants > 0) participants--;
+
+    if ((arrived > 0) && (arrived >= participants)) Release();
+}
+
+/*
+ *  SpinBarrier::Reset()
+ *
+ *  Description:
+ *      Reset the number of participants.  This must only be called when no
+ *      thread is waiting at the barrier.
+ *
+ *  Parameters:
+ *      participants [in]
+ *          The number of threads that must arrive to release the barrier.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void SpinBarrier::Reset(std::size_t participants)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    this->participants = participants;
+    arrived = 0;
+}
+
+/*
+ *  SpinBarrier::Release()
+ *
+ *  Description:
+ *      Release all threads waiting at the barrier.  The mutex must be held.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void SpinBarrier::Release()
+{
+    arrived = 0;
+    generation.fetch_add(1, std::memory_order_release);
+}
+
+/*
+ *  RunConcurrent()
+ *
+ *  Description:
+ *      Run the given function on the given number of threads at once,
+ *      repeatedly, as done for tests defined with STF_TEST_CONCURRENT.  In
+ *      each round, all threads are released together by a spin barrier and
+ *      the round ends when every thread has returned from the function.
+ *
+ *  Parameters:
+ *      function [in]
+ *          The function to run on each thread.
+ *
+ *      threads [in]
+ *          The number of threads; zero selects the number of hardware
+ *          threads (but at least two).
+ *
+ *      rounds [in]
+ *          The maximum number of rounds to run; zero means no limit.
+ *
+ *      seconds [in]
+ *          The time after which no further rounds are started; zero means
+ *          no limit.  If both limits are zero, one round is run.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      Threads report assertion failures to the calling thread's current
+ *      context.  No further rounds are started once a round has failed, and
+ *      the failing round is reported numbered from zero, as returned by
+ *      ConcurrentRound().  On Linux, the threads are pinned to the available
+ *      processors in turn.
+ */
+void RunConcurrent(void (*function)(),
+                   std::size_t threads,
+                   std::size_t rounds,
+                   unsigned seconds)
+{
+    if (threads == 0)
+    {
+        threads = std::max<std::size_t>(std::thread::hardware_concurrency(), 2);
+    }
+    if ((rounds == 0) && (seconds == 0)) rounds = 1;
+
+    TestContext *context = CurrentContext();
+    std::size_t prior_failures = (context != nullptr) ? context->Failures() : 0;
+
+    ConcurrentRun run(threads);
+    SpinBarrier start(threads + 1);
+    SpinBarrier finish(threads + 1);
+    std::atomic<bool> stop{};
+
+    // Create the threads, each of which waits at the start barrier
+    std::vector<Thread> workers;
+    workers.reserve(threads);
+    for (std::size_t i = 0; i < threads; i++)
+    {
+        workers.emplace_back(
+            [&, i]()
+            {
+                PinToProcessor(i);
+
+                Concurrent_Run = &run;
+                Concurrent_Index = i;
+
+                while (true)
+                {
+                    start.ArriveAndWait();
+
+                    if (stop.load()) break;
+
+                    try
+                    {
+                        function();
+                    }
+                    catch (...)
+                    {
+                        ReportThreadException();
+                    }
+
+                    run.sync.ArriveAndDrop();
+                    finish.ArriveAndWait();
+                }
+
+                Concurrent_Run = nullptr;
+            });
+    }
+
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::seconds(seconds);
+    std::size_t completed = 0;
+    bool failed = false;
+
+    // Release the threads for each round until a limit is reached
+    while (true)
+    {
+        failed = (context != nullptr) && (context->Failures() > prior_failures);
+
+        bool done = failed ||
+                    ((rounds > 0) && (completed >= rounds)) ||
+                    ((seconds > 0) && (completed > 0) &&
+                     (std::chrono::steady_clock::now() >= deadline));
+
+        if (!done)
+        {
+            run.sync.Reset(threads);
+            run.round = completed;
+        }
+        stop = done;
+
+        start.ArriveAndWait();
+
+        if (done) break;
+
+        finish.ArriveAndWait();
+
+        completed++;
+    }
+
+    workers.clear();
+
+    // Rounds are numbered from zero, as returned by ConcurrentRound()
+    if (failed)
+    {
+        PendingOutput().NewLine()
+                       .Text("Concurrent test failed in round ")
+                       .Decimal(completed - 1)
+                       .Text(" with ")
+                       .Decimal(threads)
+                       .Text(" threads")
+                       .NewLine();
+        CommitOutput();
+    }
+}
+
+/*
+ *  ConcurrentThreadIndex()
+ *
+ *  Description:
+ *      Return the index of the calling thread within an STF_TEST_CONCURRENT
+ *      test, from zero to ConcurrentThreadCount() - 1.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The index of the calling thread, or zero if not called from within
+ *      an STF_TEST_CONCURRENT test.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t ConcurrentThreadIndex() noexcept
+{
+    return (Concurrent_Run != nullptr) ? Concurrent_Index : 0;
+}
+
+/*
+ *  ConcurrentThreadCount()
+ *
+ *  Description:
+ *      Return the number of threads running an STF_TEST_CONCURRENT test.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The number of threads, or one if not called from within an
+ *      STF_TEST_CONCURRENT test.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t ConcurrentThreadCount() noexcept
+{
+    return (Concurrent_Run != nullptr) ? Concurrent_Run->threads : 1;
+}
+
+/*
+ *  ConcurrentRound()
+ *
+ *  Description:
+ *      Return the number of the round of an STF_TEST_CONCURRENT test being
+ *      run by the calling thread, starting from zero.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The round number, or zero if not called from within an
+ *      STF_TEST_CONCURRENT test.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t ConcurrentRound() noexcept
+{
+    return (Concurrent_Run != nullptr) ? Concurrent_Run->round.load() : 0;
+}
+
+/*
+ *  ConcurrentSync()
+ *
+ *  Description:
+ *      Wait until every thread running the current round of an
+ *      STF_TEST_CONCURRENT test has called this function or returned from
+ *      the test function.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void ConcurrentSync()
+{
+    if (Concurrent_Run != nullptr) Concurrent_Run->sync.ArriveAndWait();
+}
+
+/*
+ *  YieldPoint()
+ *
+ *  Description:
+ *      Perturb the scheduling of the calling thread as decided by the seed
+ *      of the current test.  This is called by STF_YIELD_POINT().
+ *
+ *  Parameters:
+ *      file [in]
+ *          The name of the file containing the yield point.
+ *
+ *      line [in]
+ *          The line number of the yield point.
+ *
+ *  Returns:
+ *      The action taken.
+ *
+ *  Comments:
+ *      For a given seed, about half of the yield points are active.  Each
+ *      time a thread reaches an active yield point, it does nothing, yields,
+ *      spins, or sleeps for up to Max_Yield_Sleep_Microseconds, as decided
+ *      by the seed, the location, the number of yield points the thread has
+ *      reached in the test, and the thread's index.  That is its index in
+ *      an STF_TEST_CONCURRENT test or, for other threads, the order in which
+ *      they first reached a yield point in the test.  The decisions are
+ *      therefore repeated when the seed is reused, though the operating
+ *      system may still schedule threads differently.
+ */
+YieldAction YieldPoint(const char *file, std::size_t line)
+{
+    TestContext *context = CurrentContext();
+
+    if (context == nullptr) return YieldAction::None;
+
+    context->NoteYieldPoint();
+
+    // Number this thread and count its visits afresh in each test
+    if (Yield_Context != context->Serial())
+    {
+        Yield_Context = context->Serial();
+        Yield_Thread = (Concurrent_Run != nullptr) ?
+                           Concurrent_Index :
+                           Plain_Yield_Thread + context->NewYieldThread();
+        Yield_Visits = 0;
+    }
+
+    // Identify the yield point and this visit to it
+    std::uint64_t site = Mix(context->YieldSeed());
+    for (const char *p = file; *p != '\0'; p++)
+    {
+        site = Mix(site ^ static_cast<unsigned char>(*p));
+    }
+    site = Mix(site ^ line);
+
+    std::uint64_t visit = Yield_Visits++;
+
+    if ((site & 1) == 0) return YieldAction::None;
+
+    std::uint64_t decision = Mix(site ^ Mix(visit ^ (Yield_Thread << 32)));
+    std::uint64_t amount = decision >> 8;
+
+    switch (decision % 8)
+    {
+        case 4:
+        case 5:
+            std::this_thread::yield();
+            return YieldAction::Yield;
+
+        case 6:
+            for (std::uint64_t spins = amount % Max_Yield_Spins; spins > 0;
+                 spins--)
+            {
+#if defined(STF_USE_SSE2)
+                _mm_pause();
+#else
+                std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+            }
+            return YieldAction::Spin;
+
+        case 7:
+            std::this_thread::sleep_for(std::chrono::microseconds(
+                1 + amount % Max_Yield_Sleep_Microseconds));
+            return YieldAction::Sleep;
+
+        default:
+            return YieldAction::None;
+    }
+}
+
+/*
+ *  RegisterTest()
+ *
+ *  Description:
+ *      Function to register a unit test with the Simple Test Framework.
+ *
+ *  Parameters:
+ *      name [in]
+ *          The name of the test.
+ *
+ *      test [in]
+ *          The test routine to register.
+ *
+ *      timeout [in]
+ *          Time after which the test will assume to have stalled and the
+ *          test will be aborted.  This parameter is optional.  The default
+ *          value is Default_Timeout.
+ *
+ *  Returns:
+ *      An identifier for the registered test.  If zero is returned, it means
+ *      the test could not be registered.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t RegisterTest(const char *name,
+                         const std::function<void()> &test,
+                         unsigned timeout) noexcept
+{
+    try
+    {
+        // If this is the first test, allocate storage
+        if (!Unit_Tests) Unit_Tests = std::make_unique<UnitTests>();
+
+        // Store this test in the unit test vector
+        Unit_Tests->emplace_back(name, test, timeout);
+    }
+    catch (...)
+    {
+        failed_registrations++;
+        return 0;
+    }
+
+    return Unit_Tests->size();
+}
+
+/*
+ *  RegisterAsyncTest()
+ *
+ *  Description:
+ *      Function to register a test defined with STF_TEST_ASYNC with the
+ *      Simple Test Framework.
+ *
+ *  Parameters:
+ *      name [in]
+ *          The name of the test.
+ *
+ *      start [in]
+ *          The function that starts the test on the calling thread's event
+ *          loop, reporting to the calling thread's current context.
+ *
+ *      run [in]
+ *          The function that runs the calling thread's event loop.
+ *
+ *      timeout [in]
+ *          Time after which the test will assume to have stalled and the
+ *          test will be aborted.
+ *
+ *  Returns:
+ *      An identifier for the registered test.  If zero is returned, it means
+ *      the test could not be registered.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t RegisterAsyncTest(const char *name,
+                              AsyncTestStart start,
+                              AsyncTestRun run,
+                              unsigned timeout) noexcept
+{
+    try
+    {
+        // If this is the first test, allocate storage
+        if (!Async_Unit_Tests)
+        {
+            Async_Unit_Tests = std::make_unique<AsyncUnitTests>();
+        }
+
+        // Store this test in the asynchronous unit test vector
+        Async_Unit_Tests->push_back({name, start, run, timeout});
+    }
+    catch (...)
+    {
+        failed_registrations++;
+        return 0;
+    }
+
+    return Async_Unit_Tests->size();
+}
+
+/*
+ *  ExcludeTest()
+ *
+ *  Description:
+ *      Function to specify what tests should be excluded from test runs.
+ *
+ *  Parameters:
+ *      name [in]
+ *          The name of the test.
+ *
+ *  Returns:
+ *      True to indicate test is recorded for exclusion.
+ *
+ *  Comments:
+ *      None.
+ */
+bool ExcludeTest(const char *name) noexcept
+{
+    try
+    {
+        // If this is the first test exclusion, allocate storage
+        if (!Unit_Test_Exclusions)
+        {
+            Unit_Test_Exclusions = std::make_unique<UnitTestExclusions>();
+        }
+
+        // Store this test in the unit test vector
+        Unit_Test_Exclusions->emplace_back(name);
+    }
+    catch (...)
+    {
+        failed_registrations++;
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ *  PrintValue()
+ *
+ *  Description:
+ *      This function will print the expect/actual string (or similar)
+ *      along with the value.  This is called by failing tests.
+ *
+ *  Parameters:
+ *      text [in]
+ *          The text to print (e.g., "expected").
+ *
+ *      value [in]
+ *          The value to print.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void PrintValue(const std::string &text, bool value)
+{
+    PendingOutput().Text(text).Boolean(value).NewLine();
+}
+
+/*
+ *  PrintValue()
+ *
+ *  Description:
+ *      This function will print the expect/actual string (or similar)
+ *      along with the value.  This is called by failing tests.
+ *
+ *  Parameters:
+ *      text [in]
+ *          The text to print (e.g., "expected").
+ *
+ *      value [in]
+ *          The value to print.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void PrintValue(const std::string &text, const std::string &value)
+{
+    PendingOutput().Text(text).Text(value).NewLine();
+}
+
+/*
+ *  PrintValue()
+ *
+ *  Description:
+ *      This function will print the expect/actual string (or similar)
+ *      along with the value.  This is called by failing tests.
+ *
+ *  Parameters:
+ *      text [in]
+ *          The text to print (e.g., "expected").
+ *
+ *      value [in]
+ *          The value to print.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void PrintValue(const std::string &text, unsigned char value)
+{
+    Formatter &output = PendingOutput();
+
+    output.Text(text);
+    if (std::isprint(value) != 0)
+    {
+        output.Character('\'').Character(static_cast<char>(value)).Text("' ");
+    }
+    output.Text("(unsigned char 0x").Hex(value, 2).Character(')').NewLine();
+}
+
+/*
+ *  PrintValue()
+ *
+ *  Description:
+ *      This function will print the expect/actual string (or similar)
+ *      along with the value.  This is called by failing tests.
+ *
+ *  Parameters:
+ *      text [in]
+ *          The text to print (e.g., "expected").
+ *
+ *      value [in]
+ *          The value to print.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void PrintValue(const std::string &text, char value)
+{
+    Formatter &output = PendingOutput();
+
+    output.Text(text);
+    if (std::isprint(static_cast<unsigned char>(value)) != 0)
+    {
+        output.Character('\'').Character(value).Text("' ");
+    }
+    output.Text("(char 0x").Hex(value, 2).Character(')').NewLine();
+}
+
+/*
+ *  PrintValue()
+ *
+ *  Description:
+ *      This function will print the expect/actual string (or similar)
+ *      along with the value.  This is called by failing tests.
+ *
+ *  Parameters:
+ *      text [in]
+ *          The text to print (e.g., "expected").
+ *
+ *      value [in]
+ *          The value to print.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void PrintValue(const std::string &text, signed char value)
+{
+    Formatter &output = PendingOutput();
+
+    output.Text(text);
+    if (std::isprint(static_cast<unsigned char>(value)) != 0)
+    {
+        output.Character('\'').Character(static_cast<char>(value)).Text("' ");
+    }
+    output.Text("(signed char 0x").Hex(value, 2).Character(')').NewLine();
+}
+
+/*
+ *  PrintValue()
+ *
+ *  Description:
+ *      This function will print the expect/actual string (or similar)
+ *      along with the value.  This is called by failing tests.
+ *
+ *  Parameters:
+ *      text [in]
+ *          The text to print (e.g., "expected").
+ *
+ *      value [in]
+ *          The value to print.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+#ifdef __cpp_char8_t
+void PrintValue(const std::string &text, char8_t value)
+{
+    Formatter &output = PendingOutput();
+
+    output.Text(text);
+    if (std::isprint(value) != 0)
+    {
+        output.Character('\'').Character(static_cast<char>(value)).Text("' ");
+    }
+    output.Text("(char8_t 0x")
+          .Hex(static_cast<unsigned char>(value), 2)
+          .Character(')')
+          .NewLine();
+}
+#endif
+
+/*
+ *  PrintValue()
+ *
+ *  Description:
+ *      This function will print the expect/actual string (or similar)
+ *      along with the value.  This is called by failing tests.
+ *
+ *  Parameters:
+ *      text [in]
+ *          The text to print (e.g., "expected").
+ *
+ *      value [in]
+ *          The value to print.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+#ifdef __cpp_unicode_characters
+void PrintValue(const std::string &text, char16_t value)
+{
+    PendingOutput().Text(text)
+                    .Text("char16_t 0x")
+                    .Hex(static_cast<std::uint16_t>(value), 4)
+                    .NewLine();
+}
+#endif
+
+/*
+ *  PrintValue()
+ *
+ *  Description:
+ *      This function will print the expect/actual string (or similar)
+ *      along with the value.  This is called by failing tests.
+ *
+ *  Parameters:
+ *      text [in]
+ *          The text to print (e.g., "expected").
+ *
+ *      value [in]
+ *          The value to print.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+#ifdef __cpp_unicode_characters
+void PrintValue(const std::string &text, char32_t value)
+{
+    PendingOutput().Text(text)
+                    .Text("char32_t 0x")
+                    .Hex(static_cast<std::uint32_t>(value), 8)
+                    .NewLine();
+}
+#endif
+
+/*
  *  PrintValue()
  *
  *  Description:
- *      This function will print the expect/actual string (or similar)
- *      along with the value.  This is called by failing tests.
+ *      This function will print the expect/actual string (or similar)
+ *      along with the value.  This is called by failing tests.
+ *
+ *  Parameters:
+ *      text [in]
+ *          The text to print (e.g., "expected").
+ *
+ *      value [in]
+ *          The value to print.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void PrintValue(const std::string &text, wchar_t value)
+{
+    Formatter &output = PendingOutput();
+
+    static_assert(sizeof(wchar_t) <= 4, "Unsupported wchar_t size");
+
+    // This type varies in size by platform, either 16 or 32 bits observed
+    if (sizeof(wchar_t) == 2)
+    {
+        output.Text(text)
+              .Text("wchar_t 0x")
+              .Hex(static_cast<std::uint16_t>(value), 4);
+    }
+    else if (sizeof(wchar_t) == 4)
+    {
+        output.Text(text)
+              .Text("wchar_t 0x")
+              .Hex(static_cast<std::uint32_t>(value), 8);
+    }
+
+    output.NewLine();
+}
+
+/*
+ *  PrintAssertFailed()
+ *
+ *  Description:
+ *      This function will print a message indicating an assertion failed.
+ *
+ *  Parameters:
+ *      file [in]
+ *          The name of the file where the test exists.
+ *
+ *      line [in]
+ *          The line number where the test failed.
+ *
+ *  Returns:
+ *      True if the failure is to be reported, or false if it is at an
+ *      STF_EXPECT_* assertion site whose reporting limit has been reached,
+ *      in which case nothing is printed and the caller need not describe
+ *      the failure.
+ *
+ *  Comments:
+ *      None.
+ */
+bool PrintAssertFailed(const char *file, std::size_t line)
+{
+    if (TestContext *context = CurrentContext();
+        (context != nullptr) && context->Suppressed(file, line))
+    {
+        return false;
+    }
+
+    PendingOutput().NewLine()
+                   .Text("Assertion failed at ")
+                   .Text(file)
+                   .Character(':')
+                   .Decimal(line)
+                   .NewLine();
+
+    return true;
+}
+
+/*
+ *  ReportExpectFailure()
+ *
+ *  Description:
+ *      Report that a value does not agree with an expected value.
+ *
+ *  Parameters:
+ *      file [in]
+ *          The name of the file where the test exists.
+ *
+ *      line [in]
+ *          The line number where the test failed.
+ *
+ *      expected [in]
+ *          Printer for the expected value.
+ *
+ *      actual [in]
+ *          Printer for the actual value.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void ReportExpectFailure(const char *file,
+                         std::size_t line,
+                         const ValuePrinter &expected,
+                         const ValuePrinter &actual)
+{
+    if (!PrintAssertFailed(file, line)) return;
+
+    expected(ExpectText);
+    actual(ActualText);
+}
+
+/*
+ *  ReportLhsRhsFailure()
+ *
+ *  Description:
+ *      Report that a lhs value does not compare as expected to a rhs value.
+ *
+ *  Parameters:
+ *      file [in]
+ *          The name of the file where the test exists.
+ *
+ *      line [in]
+ *          The line number where the test failed.
+ *
+ *      lhs [in]
+ *          Printer for the left-hand side value.
+ *
+ *      rhs [in]
+ *          Printer for the right-hand side value.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void ReportLhsRhsFailure(const char *file,
+                         std::size_t line,
+                         const ValuePrinter &lhs,
+                         const ValuePrinter &rhs)
+{
+    if (!PrintAssertFailed(file, line)) return;
+
+    lhs(LHSText);
+    rhs(RHSText);
+}
+
+/*
+ *  AssertClose()
+ *
+ *  Description:
+ *      Test that the absolute value of the difference between the left-hand
+ *      side value and the right-hand side value is less than epsilon.
  *
  *  Parameters:
- *      text [in]
- *          The text to print (e.g., "expected").
+ *      file [in]
+ *          The name of the file where the test exists.
  *
- *      value [in]
- *          The value to print.
+ *      line [in]
+ *          The line number where the test failed.
+ *
+ *      lhs [in]
+ *          The left-hand side value to compare.
+ *
+ *      rhs [in]
+ *          The right-hand side value to compare.
+ *
+ *      epsilon [in]
+ *          The value of which the absolute value of the difference between
+ *          the left-hand side and right-hand side value can be no greater.
  *
  *  Returns:
  *      Nothing.
@@ -484,32 +3058,45 @@ void PrintValue(const std::string &text, char16_t value)
  *  Comments:
  *      None.
  */
-#ifdef __cpp_unicode_characters
-void PrintValue(const std::string &text, char32_t value)
+bool AssertClose(const char *file,
+                 const std::size_t line,
+                 float lhs,
+                 float rhs,
+                 float epsilon)
 {
-    std::ostringstream oss;
-    oss << std::hex << std::setfill('0');
+    if (fabsf(lhs - rhs) < epsilon) return true;
+
+    if (!PrintAssertFailed(file, line)) return false;
 
-    oss << text << "char32_t 0x" << std::setw(8)
-        << +static_cast<std::uint32_t>(value);
+    PrintValue(LHSText, lhs);
+    PrintValue(RHSText, rhs);
 
-    std::cout << oss.str() << std::endl;
+    return false;
 }
-#endif
 
 /*
- *  PrintValue()
+ *  AssertClose()
  *
  *  Description:
- *      This function will print the expect/actual string (or similar)
- *      along with the value.  This is called by failing tests.
+ *      Test that the absolute value of the difference between the left-hand
+ *      side value and the right-hand side value is less than epsilon.
  *
  *  Parameters:
- *      text [in]
- *          The text to print (e.g., "expected").
+ *      file [in]
+ *          The name of the file where the test exists.
  *
- *      value [in]
- *          The value to print.
+ *      line [in]
+ *          The line number where the test failed.
+ *
+ *      lhs [in]
+ *          The left-hand side value to compare.
+ *
+ *      rhs [in]
+ *          The right-hand side value to compare.
+ *
+ *      epsilon [in]
+ *          The value of which the absolute value of the difference between
+ *          the left-hand side and right-hand side value can be no greater.
  *
  *  Returns:
  *      Nothing.
@@ -517,33 +3104,287 @@ void PrintValue(const std::string &text, char32_t value)
  *  Comments:
  *      None.
  */
-void PrintValue(const std::string &text, wchar_t value)
+bool AssertClose(const char *file,
+                 const std::size_t line,
+                 double lhs,
+                 double rhs,
+                 double epsilon)
 {
-    std::ostringstream oss;
-    oss << std::hex << std::setfill('0');
+    if (fabs(lhs - rhs) < epsilon) return true;
 
-    static_assert(sizeof(wchar_t) <= 4, "Unsupported wchar_t size");
+    if (!PrintAssertFailed(file, line)) return false;
 
-    // This type varies in size by platform, either 16 or 32 bits observed
-    if (sizeof(wchar_t) == 2)
+    PrintValue(LHSText, lhs);
+    PrintValue(RHSText, rhs);
+
+    return false;
+}
+
+/*
+ *  AssertClose()
+ *
+ *  Description:
+ *      Test that the absolute value of the difference between the left-hand
+ *      side value and the right-hand side value is less than epsilon.
+ *
+ *  Parameters:
+ *      file [in]
+ *          The name of the file where the test exists.
+ *
+ *      line [in]
+ *          The line number where the test failed.
+ *
+ *      lhs [in]
+ *          The left-hand side value to compare.
+ *
+ *      rhs [in]
+ *          The right-hand side value to compare.
+ *
+ *      epsilon [in]
+ *          The value of which the absolute value of the difference between
+ *          the left-hand side and right-hand side value can be no greater.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+bool AssertClose(const char *file,
+                 const std::size_t line,
+                 long double lhs,
+                 long double rhs,
+                 long double epsilon)
+{
+    if (fabsl(lhs - rhs) < epsilon) return true;
+
+    if (!PrintAssertFailed(file, line)) return false;
+
+    PrintValue(LHSText, lhs);
+    PrintValue(RHSText, rhs);
+
+    return false;
+}
+
+/*
+ *  AssertNear()
+ *
+ *  Description:
+ *      Test that the absolute value of the difference between the left-hand
+ *      side value and the right-hand side value is no greater than the larger
+ *      of the absolute tolerance and the relative tolerance multiplied by the
+ *      larger magnitude of the two values.
+ *
+ *  Parameters:
+ *      file [in]
+ *          The name of the file where the test exists.
+ *
+ *      line [in]
+ *          The line number where the test failed.
+ *
+ *      lhs [in]
+ *          The left-hand side value to compare.
+ *
+ *      rhs [in]
+ *          The right-hand side value to compare.
+ *
+ *      abs_epsilon [in]
+ *          The absolute tolerance, which is useful for values near zero.
+ *
+ *      rel_epsilon [in]
+ *          The relative tolerance.
+ *
+ *  Returns:
+ *      True if the assertion is true, else false.
+ *
+ *  Comments:
+ *      None.
+ */
+bool AssertNear(const char *file,
+                const std::size_t line,
+                float lhs,
+                float rhs,
+                float abs_epsilon,
+                float rel_epsilon)
+{
+    if (IsNear(lhs, rhs, abs_epsilon, rel_epsilon)) return true;
+
+    if (!PrintAssertFailed(file, line)) return false;
+
+    PrintValue(LHSText, lhs);
+    PrintValue(RHSText, rhs);
+
+    return false;
+}
+
+/*
+ *  AssertNear()
+ *
+ *  Description:
+ *      Test that the absolute value of the difference between the left-hand
+ *      side value and the right-hand side value is no greater than the larger
+ *      of the absolute tolerance and the relative tolerance multiplied by the
+ *      larger magnitude of the two values.
+ *
+ *  Parameters:
+ *      file [in]
+ *          The name of the file where the test exists.
+ *
+ *      line [in]
+ *          The line number where the test failed.
+ *
+ *      lhs [in]
+ *          The left-hand side value to compare.
+ *
+ *      rhs [in]
+ *          The right-hand side value to compare.
+ *
+ *      abs_epsilon [in]
+ *          The absolute tolerance, which is useful for values near zero.
+ *
+ *      rel_epsilon [in]
+ *          The relative tolerance.
+ *
+ *  Returns:
+ *      True if the assertion is true, else false.
+ *
+ *  Comments:
+ *      None.
+ */
+bool AssertNear(const char *file,
+                const std::size_t line,
+                double lhs,
+                double rhs,
+                double abs_epsilon,
+                double rel_epsilon)
+{
+    if (IsNear(lhs, rhs, abs_epsilon, rel_epsilon)) return true;
+
+    if (!PrintAssertFailed(file, line)) return false;
+
+    PrintValue(LHSText, lhs);
+    PrintValue(RHSText, rhs);
+
+    return false;
+}
+
+/*
+ *  AssertNear()
+ *
+ *  Description:
+ *      Test that the absolute value of the difference between the left-hand
+ *      side value and the right-hand side value is no greater than the larger
+ *      of the absolute tolerance and the relative tolerance multiplied by the
+ *      larger magnitude of the two values.
+ *
+ *  Parameters:
+ *      file [in]
+ *          The name of the file where the test exists.
+ *
+ *      line [in]
+ *          The line number where the test failed.
+ *
+ *      lhs [in]
+ *          The left-hand side value to compare.
+ *
+ *      rhs [in]
+ *          The right-hand side value to compare.
+ *
+ *      abs_epsilon [in]
+ *          The absolute tolerance, which is useful for values near zero.
+ *
+ *      rel_epsilon [in]
+ *          The relative tolerance.
+ *
+ *  Returns:
+ *      True if the assertion is true, else false.
+ *
+ *  Comments:
+ *      None.
+ */
+bool AssertNear(const char *file,
+                const std::size_t line,
+                long double lhs,
+                long double rhs,
+                long double abs_epsilon,
+                long double rel_epsilon)
+{
+    if (IsNear(lhs, rhs, abs_epsilon, rel_epsilon)) return true;
+
+    if (!PrintAssertFailed(file, line)) return false;
+
+    PrintValue(LHSText, lhs);
+    PrintValue(RHSText, rhs);
+
+    return false;
+}
+
+/*
+ *  AssertUlpEqual()
+ *
+ *  Description:
+ *      Test that the left-hand side value and the right-hand side value are
+ *      no more than max_ulps units in the last place apart.
+ *
+ *  Parameters:
+ *      file [in]
+ *          The name of the file where the test exists.
+ *
+ *      line [in]
+ *          The line number where the test failed.
+ *
+ *      lhs [in]
+ *          The left-hand side value to compare.
+ *
+ *      rhs [in]
+ *          The right-hand side value to compare.
+ *
+ *      max_ulps [in]
+ *          The maximum permitted distance in ULPs.
+ *
+ *  Returns:
+ *      True if the assertion is true, else false.
+ *
+ *  Comments:
+ *      None.
+ */
+bool AssertUlpEqual(const char *file,
+                    const std::size_t line,
+                    float lhs,
+                    float rhs,
+                    std::uint64_t max_ulps)
+{
+    bool nan = std::isnan(lhs) || std::isnan(rhs);
+
+    if (!nan && (UlpDistance(lhs, rhs) <= max_ulps)) return true;
+
+    if (!PrintAssertFailed(file, line)) return false;
+
+    PrintValue(LHSText, lhs);
+    PrintValue(RHSText, rhs);
+    if (nan)
     {
-        oss << text << "wchar_t 0x" << std::setw(4)
-            << +static_cast<std::uint16_t>(value);
+        PendingOutput().Text("  ulps: NaN").NewLine();
     }
-    else if (sizeof(wchar_t) == 4)
+    else
     {
-        oss << text << "wchar_t 0x" << std::setw(8)
-            << +static_cast<std::uint32_t>(value);
+        PendingOutput().Text("  ulps: ")
+                       .Decimal(UlpDistance(lhs, rhs))
+                       .Text(" (maximum ")
+                       .Decimal(max_ulps)
+                       .Character(')')
+                       .NewLine();
     }
 
-    std::cout << oss.str() << std::endl;
+    return false;
 }
 
 /*
- *  PrintAssertFailed()
+ *  AssertUlpEqual()
  *
  *  Description:
- *      This function will print a message indicating an assertion failed.
+ *      Test that the left-hand side value and the right-hand side value are
+ *      no more than max_ulps units in the last place apart.
  *
  *  Parameters:
  *      file [in]
@@ -552,23 +3393,59 @@ void PrintValue(const std::string &text, wchar_t value)
  *      line [in]
  *          The line number where the test failed.
  *
+ *      lhs [in]
+ *          The left-hand side value to compare.
+ *
+ *      rhs [in]
+ *          The right-hand side value to compare.
+ *
+ *      max_ulps [in]
+ *          The maximum permitted distance in ULPs.
+ *
  *  Returns:
- *      Nothing.
+ *      True if the assertion is true, else false.
  *
  *  Comments:
  *      None.
  */
-void PrintAssertFailed(const std::string &file, std::size_t line)
+bool AssertUlpEqual(const char *file,
+                    const std::size_t line,
+                    double lhs,
+                    double rhs,
+                    std::uint64_t max_ulps)
 {
-    std::cout << std::endl;
-    std::cout << "Assertion failed at " << file << ":" << line << std::endl;
+    bool nan = std::isnan(lhs) || std::isnan(rhs);
+
+    if (!nan && (UlpDistance(lhs, rhs) <= max_ulps)) return true;
+
+    if (!PrintAssertFailed(file, line)) return false;
+
+    PrintValue(LHSText, lhs);
+    PrintValue(RHSText, rhs);
+    if (nan)
+    {
+        PendingOutput().Text("  ulps: NaN").NewLine();
+    }
+    else
+    {
+        PendingOutput().Text("  ulps: ")
+                       .Decimal(UlpDistance(lhs, rhs))
+                       .Text(" (maximum ")
+                       .Decimal(max_ulps)
+                       .Character(')')
+                       .NewLine();
+    }
+
+    return false;
 }
 
 /*
- *  AssertBoolean()
+ *  AssertArrayClose()
  *
  *  Description:
- *      Test that the given value is true.
+ *      Test that each element of the expected array is close to the
+ *      corresponding element of the actual array, using the same combined
+ *      absolute and relative tolerance as AssertNear().
  *
  *  Parameters:
  *      file [in]
@@ -577,30 +3454,59 @@ void PrintAssertFailed(const std::string &file, std::size_t line)
  *      line [in]
  *          The line number where the test failed.
  *
- *      value [in]
- *          The value to check to be true.
+ *      expected [in]
+ *          A pointer to the array of expected values.
+ *
+ *      actual [in]
+ *          A pointer to the array of actual values.
+ *
+ *      count [in]
+ *          The number of elements in each array.
+ *
+ *      abs_epsilon [in]
+ *          The absolute tolerance.
+ *
+ *      rel_epsilon [in]
+ *          The relative tolerance.
  *
  *  Returns:
- *      Returns the value of "value".
+ *      True if the assertion is true, else false.
  *
  *  Comments:
  *      None.
  */
-bool AssertBoolean(const std::string &file, std::size_t line, bool value)
+bool AssertArrayClose(const char *file,
+                      const std::size_t line,
+                      const float *expected,
+                      const float *actual,
+                      std::size_t count,
+                      float abs_epsilon,
+                      float rel_epsilon)
 {
-    if (value) return value;
+    std::size_t failures =
+        CountNotClose(expected, actual, count, abs_epsilon, rel_epsilon);
 
-    PrintAssertFailed(file, line);
+    if (failures == 0) return true;
+
+    ReportArrayNotClose(file,
+                        line,
+                        expected,
+                        actual,
+                        count,
+                        abs_epsilon,
+                        rel_epsilon,
+                        failures);
 
     return false;
 }
 
 /*
- *  AssertClose()
+ *  AssertArrayClose()
  *
  *  Description:
- *      Test that the absolute value of the difference between the left-hand
- *      side value and the right-hand side value is less than epsilon.
+ *      Test that each element of the expected array is close to the
+ *      corresponding element of the actual array, using the same combined
+ *      absolute and relative tolerance as AssertNear().
  *
  *  Parameters:
  *      file [in]
@@ -609,43 +3515,59 @@ bool AssertBoolean(const std::string &file, std::size_t line, bool value)
  *      line [in]
  *          The line number where the test failed.
  *
- *      lhs [in]
- *          The left-hand side value to compare.
+ *      expected [in]
+ *          A pointer to the array of expected values.
  *
- *      rhs [in]
- *          The right-hand side value to compare.
+ *      actual [in]
+ *          A pointer to the array of actual values.
  *
- *      epsilon [in]
- *          The value of which the absolute value of the difference between
- *          the left-hand side and right-hand side value can be no greater.
+ *      count [in]
+ *          The number of elements in each array.
+ *
+ *      abs_epsilon [in]
+ *          The absolute tolerance.
+ *
+ *      rel_epsilon [in]
+ *          The relative tolerance.
  *
  *  Returns:
- *      Nothing.
+ *      True if the assertion is true, else false.
  *
  *  Comments:
  *      None.
  */
-bool AssertClose(const std::string &file,
-                 const std::size_t line,
-                 float lhs,
-                 float rhs,
-                 float epsilon)
+bool AssertArrayClose(const char *file,
+                      const std::size_t line,
+                      const double *expected,
+                      const double *actual,
+                      std::size_t count,
+                      double abs_epsilon,
+                      double rel_epsilon)
 {
-    if (fabsf(lhs - rhs) < epsilon) return true;
+    std::size_t failures =
+        CountNotClose(expected, actual, count, abs_epsilon, rel_epsilon);
 
-    PrintAssertFailed(file, line);
-    PrintValue(LHSText, lhs);
-    PrintValue(RHSText, rhs);
+    if (failures == 0) return true;
+
+    ReportArrayNotClose(file,
+                        line,
+                        expected,
+                        actual,
+                        count,
+                        abs_epsilon,
+                        rel_epsilon,
+                        failures);
 
     return false;
 }
 
 /*
- *  AssertClose()
+ *  AssertTensorClose()
  *
  *  Description:
- *      Test that the absolute value of the difference between the left-hand
- *      side value and the right-hand side value is less than epsilon.
+ *      Test that each element of the expected tensor is close to the
+ *      corresponding element of the actual tensor, using the same combined
+ *      absolute and relative tolerance as AssertNear().
  *
  *  Parameters:
  *      file [in]
@@ -654,43 +3576,46 @@ bool AssertClose(const std::string &file,
  *      line [in]
  *          The line number where the test failed.
  *
- *      lhs [in]
- *          The left-hand side value to compare.
+ *      expected [in]
+ *          A view of the tensor holding the expected values.
  *
- *      rhs [in]
- *          The right-hand side value to compare.
+ *      actual [in]
+ *          A view of the tensor holding the actual values.
  *
- *      epsilon [in]
- *          The value of which the absolute value of the difference between
- *          the left-hand side and right-hand side value can be no greater.
+ *      abs_epsilon [in]
+ *          The absolute tolerance.
+ *
+ *      rel_epsilon [in]
+ *          The relative tolerance.
  *
  *  Returns:
- *      Nothing.
+ *      True if the assertion is true, else false.
  *
  *  Comments:
  *      None.
  */
-bool AssertClose(const std::string &file,
-                 const std::size_t line,
-                 double lhs,
-                 double rhs,
-                 double epsilon)
+bool AssertTensorClose(const char *file,
+                       const std::size_t line,
+                       const TensorView<float> &expected,
+                       const TensorView<float> &actual,
+                       float abs_epsilon,
+                       float rel_epsilon)
 {
-    if (fabs(lhs - rhs) < epsilon) return true;
-
-    PrintAssertFailed(file, line);
-    PrintValue(LHSText, lhs);
-    PrintValue(RHSText, rhs);
-
-    return false;
+    return CompareTensors(file,
+                          line,
+                          expected,
+                          actual,
+                          abs_epsilon,
+                          rel_epsilon);
 }
 
 /*
- *  AssertClose()
+ *  AssertTensorClose()
  *
  *  Description:
- *      Test that the absolute value of the difference between the left-hand
- *      side value and the right-hand side value is less than epsilon.
+ *      Test that each element of the expected tensor is close to the
+ *      corresponding element of the actual tensor, using the same combined
+ *      absolute and relative tolerance as AssertNear().
  *
  *  Parameters:
  *      file [in]
@@ -699,35 +3624,37 @@ bool AssertClose(const std::string &file,
  *      line [in]
  *          The line number where the test failed.
  *
- *      lhs [in]
- *          The left-hand side value to compare.
+ *      expected [in]
+ *          A view of the tensor holding the expected values.
  *
- *      rhs [in]
- *          The right-hand side value to compare.
+ *      actual [in]
+ *          A view of the tensor holding the actual values.
  *
- *      epsilon [in]
- *          The value of which the absolute value of the difference between
- *          the left-hand side and right-hand side value can be no greater.
+ *      abs_epsilon [in]
+ *          The absolute tolerance.
+ *
+ *      rel_epsilon [in]
+ *          The relative tolerance.
  *
  *  Returns:
- *      Nothing.
+ *      True if the assertion is true, else false.
  *
  *  Comments:
  *      None.
  */
-bool AssertClose(const std::string &file,
-                 const std::size_t line,
-                 long double lhs,
-                 long double rhs,
-                 long double epsilon)
+bool AssertTensorClose(const char *file,
+                       const std::size_t line,
+                       const TensorView<double> &expected,
+                       const TensorView<double> &actual,
+                       double abs_epsilon,
+                       double rel_epsilon)
 {
-    if (fabsl(lhs - rhs) < epsilon) return true;
-
-    PrintAssertFailed(file, line);
-    PrintValue(LHSText, lhs);
-    PrintValue(RHSText, rhs);
-
-    return false;
+    return CompareTensors(file,
+                          line,
+                          expected,
+                          actual,
+                          abs_epsilon,
+                          rel_epsilon);
 }
 
 /*
@@ -759,7 +3686,7 @@ bool AssertClose(const std::string &file,
  *  Comments:
  *      None.
  */
-bool AssertMemoryEqual(const std::string &file,
+bool AssertMemoryEqual(const char *file,
                        const std::size_t line,
                        const void *expected,
                        const void *actual,
@@ -783,11 +3710,16 @@ bool AssertMemoryEqual(const std::string &file,
 
     if (equal) return true;
 
-    PrintAssertFailed(file, line);
-    std::cout << ExpectText << "0x" << GetMemoryHex(left, length)
-              << std::endl
-              << ActualText << "0x" << GetMemoryHex(right, length)
-              << std::endl;
+    if (!PrintAssertFailed(file, line)) return false;
+
+    PendingOutput().Text(ExpectText)
+                   .Text("0x")
+                   .Text(GetMemoryHex(left, length))
+                   .NewLine()
+                   .Text(ActualText)
+                   .Text("0x")
+                   .Text(GetMemoryHex(right, length))
+                   .NewLine();
 
     return false;
 }
@@ -821,7 +3753,7 @@ bool AssertMemoryEqual(const std::string &file,
  *  Comments:
  *      None.
  */
-bool AssertMemoryNotEqual(const std::string &file,
+bool AssertMemoryNotEqual(const char *file,
                           const std::size_t line,
                           const void *lhs,
                           const void *rhs,
@@ -845,22 +3777,25 @@ bool AssertMemoryNotEqual(const std::string &file,
 
     if (!equal) return true;
 
-    PrintAssertFailed(file, line);
-    std::cout << LHSText << "0x" << GetMemoryHex(left, length)
-              << std::endl
-              << RHSText << "0x" << GetMemoryHex(right, length)
-              << std::endl;
+    if (!PrintAssertFailed(file, line)) return false;
+
+    PendingOutput().Text(LHSText)
+                   .Text("0x")
+                   .Text(GetMemoryHex(left, length))
+                   .NewLine()
+                   .Text(RHSText)
+                   .Text("0x")
+                   .Text(GetMemoryHex(right, length))
+                   .NewLine();
 
     return false;
 }
 
 /*
- *  AssertException()
+ *  ReportExceptionFailure()
  *
  *  Description:
- *      Test that a function throws an exception.  This test will succeed
- *      if an exception is thrown.  That exception will be caught, if so,
- *      and execution will continue as expected.
+ *      Report that a function did not throw the expected exception.
  *
  *  Parameters:
  *      file [in]
@@ -869,8 +3804,13 @@ bool AssertMemoryNotEqual(const std::string &file,
  *      line [in]
  *          The line number where the test failed.
  *
- *      function [in]
- *          A function to invoke to check for exceptions.
+ *      exception_name [in]
+ *          The name of the expected exception or nullptr if any exception
+ *          was expected.
+ *
+ *      exception_thrown [in]
+ *          True if some other exception was thrown, false if the function
+ *          returned normally.
  *
  *  Returns:
  *      Nothing.
@@ -878,25 +3818,284 @@ bool AssertMemoryNotEqual(const std::string &file,
  *  Comments:
  *      None.
  */
-bool AssertException(const std::string &file,
-                     const std::size_t line,
-                     const std::function<void()> &function)
+void ReportExceptionFailure(const char *file,
+                            std::size_t line,
+                            const char *exception_name,
+                            bool exception_thrown)
 {
-    try
+    if (!PrintAssertFailed(file, line)) return;
+
+    if (exception_name == nullptr)
     {
-        function();
+        PrintValue(ExpectText, std::string("any exception thrown"));
     }
-    catch (...)
+    else
     {
-        return true;
+        PrintValue(ExpectText,
+                   std::string("exception of type ") + exception_name);
     }
 
-    PrintAssertFailed(file, line);
-    PrintValue(ExpectText, std::string("any exception thrown"));
-    PrintValue(ActualText, std::string("no exception thrown"));
-    return false;
+    if (exception_thrown)
+    {
+        PrintValue(ActualText, std::string("some other exception thrown"));
+    }
+    else
+    {
+        PrintValue(ActualText, std::string("no exception thrown"));
+    }
+}
+
+} // Namespace Terra::STF
+
+#if !defined(STF_FUZZER)
+
+namespace Terra::STF
+{
+
+namespace
+{
+
+// Interval at which the runner checks whether an async test has completed
+constexpr std::chrono::milliseconds Async_Poll_Interval(10);
+
+/*
+ *  NewYieldSeed()
+ *
+ *  Description:
+ *      Return the seed to be used for STF_YIELD_POINT() perturbations in a
+ *      test.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The value of the STF_YIELD_SEED environment variable if set, else a
+ *      random seed.
+ *
+ *  Comments:
+ *      None.
+ */
+std::uint64_t NewYieldSeed()
+{
+    static const char *fixed_seed = std::getenv("STF_YIELD_SEED");
+    static std::random_device random_device;
+
+    if (fixed_seed != nullptr) return std::strtoull(fixed_seed, nullptr, 10);
+
+    return (std::uint64_t(random_device()) << 32) ^ random_device();
+}
+
+/*
+ *  IsExcluded()
+ *
+ *  Description:
+ *      Determine whether the named test is to be excluded from the test run.
+ *
+ *  Parameters:
+ *      name [in]
+ *          The name of the test.
+ *
+ *  Returns:
+ *      True if the test was named in STF_TEST_EXCLUDE, false otherwise.
+ *
+ *  Comments:
+ *      Excluding a test defined with STF_TEST_TYPED (e.g., "Group::Test")
+ *      excludes the test for every type (e.g., "Group::Test<int>").
+ */
+bool IsExcluded(const std::string &name)
+{
+    if (!Unit_Test_Exclusions) return false;
+
+    std::string base_name = name.substr(0, name.find('<'));
+
+    return std::find_if(Unit_Test_Exclusions->begin(),
+                        Unit_Test_Exclusions->end(),
+                        [&](const std::string &excluded)
+                        {
+                            return (excluded == name) ||
+                                   (excluded == base_name);
+                        }) != Unit_Test_Exclusions->end();
+}
+
+/*
+ *  RunAsyncTests()
+ *
+ *  Description:
+ *      Run all tests defined with STF_TEST_ASYNC concurrently on a single
+ *      thread and report the outcome of each in the order registered.
+ *
+ *  Parameters:
+ *      total_duration [in/out]
+ *          The total duration of all tests, to which the time taken to run
+ *          these tests is added.  Since they run concurrently, this is the
+ *          time until the last completed, not the sum of their durations.
+ *
+ *  Returns:
+ *      True if all of the tests passed, false otherwise.
+ *
+ *  Comments:
+ *      The tests are aborted if they have not all completed within the
+ *      longest of their timeouts.  A test that completes, but took longer
+ *      than its own timeout, is reported as having timed out.
+ */
+bool RunAsyncTests(std::chrono::nanoseconds &total_duration)
+{
+    Formatter output;
+
+    if (!Async_Unit_Tests) return true;
+
+    // Create a context for each test that is to be run
+    std::vector<const AsyncUnitTest *> tests;
+    std::vector<std::unique_ptr<TestContext>> contexts;
+    unsigned timeout = 0;
+    for (const auto &test : *Async_Unit_Tests)
+    {
+        if (IsExcluded(test.name))
+        {
+            output.Text("Excluding test ").Text(test.name).NewLine();
+            continue;
+        }
+
+        tests.push_back(&test);
+        contexts.push_back(std::make_unique<TestContext>(test.name));
+        timeout = std::max(timeout, test.timeout);
+    }
+    WriteStdout(output.String());
+    output.Clear();
+
+    if (tests.empty()) return true;
+
+    std::condition_variable cv;
+    std::mutex test_mutex;
+    bool finished = false;
+    auto start_time = std::chrono::steady_clock::now();
+    auto deadline = start_time + std::chrono::seconds(timeout);
+
+    // Start all of the tests, then run them on a single thread
+    std::thread test_thread = std::thread(
+        [&]()
+        {
+            for (std::size_t i = 0; i < tests.size(); i++)
+            {
+                ContextScope scope(contexts[i].get());
+                contexts[i]->SetDeadline(
+                    start_time + std::chrono::seconds(tests[i]->timeout));
+                contexts[i]->SetYieldSeed(NewYieldSeed());
+
+                try
+                {
+                    tests[i]->start();
+                }
+                catch (...)
+                {
+                    ReportThreadException();
+                    contexts[i]->Complete();
+                }
+            }
+
+            tests.front()->run(deadline);
+
+            std::lock_guard<std::mutex> lock(test_mutex);
+            finished = true;
+            cv.notify_one();
+        });
+
+    // Wait for the test thread, unless it is stalled and must be abandoned
+    auto join = [&]()
+    {
+        {
+            std::lock_guard<std::mutex> lock(test_mutex);
+            if (!finished)
+            {
+                std::fflush(stdout);
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        test_thread.join();
+    };
+
+    // Report each test in the order registered, noting when the last
+    // completed
+    std::chrono::nanoseconds elapsed{};
+    for (std::size_t i = 0; i < tests.size(); i++)
+    {
+        TestContext &context = *contexts[i];
+        const AsyncUnitTest &test = *tests[i];
+
+        output.Text("Running test ").Text(test.name);
+        WriteStdout(output.String());
+        output.Clear();
+
+        // Wait for the test to complete or for its time to expire, checking
+        // periodically since tests complete on the test thread's event loop
+        auto test_deadline = start_time + std::chrono::seconds(test.timeout);
+        {
+            std::unique_lock<std::mutex> lock(test_mutex);
+            while (!finished && !context.Completed() &&
+                   (std::chrono::steady_clock::now() < test_deadline))
+            {
+                cv.wait_until(
+                    lock,
+                    std::min(test_deadline,
+                             std::chrono::steady_clock::now() +
+                                 Async_Poll_Interval));
+            }
+        }
+
+        WriteStdout(context.TakeOutput());
+
+        std::chrono::nanoseconds duration =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                context.CompletionTime() - start_time);
+
+        if (!context.Completed() ||
+            (duration > std::chrono::seconds(test.timeout)))
+        {
+            output.NewLine()
+                  .Text("Test \"")
+                  .Text(test.name)
+                  .Text("\" exceeded ")
+                  .Decimal(test.timeout)
+                  .Text(" second timeout; terminating")
+                  .NewLine();
+            if (context.YieldPointsReached())
+            {
+                PrintYieldSeed(output, context.YieldSeed());
+            }
+            WriteStdout(output.String());
+            std::fflush(stdout);
+
+            join();
+            return false;
+        }
+
+        if (context.Failed())
+        {
+            context.Summarize(output);
+            WriteStdout(output.String());
+            join();
+            return false;
+        }
+
+        output.Text(" (")
+              .Text(FriendlyDuration(duration))
+              .Character(')')
+              .NewLine();
+        WriteStdout(output.String());
+        output.Clear();
+
+        elapsed = std::max(elapsed, duration);
+    }
+
+    join();
+
+    total_duration += elapsed;
+
+    return true;
 }
 
+} // namespace
+
 } // Namespace Terra::STF
 
 /*
@@ -919,27 +4118,51 @@ int main()
     // Total test duration
     std::chrono::nanoseconds total_duration{};
 
+    // Formatter used to produce runner output
+    Terra::STF::Formatter output;
+
     // Check that there are registered unit test
-    if (!Terra::STF::Unit_Tests || Terra::STF::Unit_Tests->empty())
+    if ((!Terra::STF::Unit_Tests || Terra::STF::Unit_Tests->empty()) &&
+        (!Terra::STF::Async_Unit_Tests ||
+         Terra::STF::Async_Unit_Tests->empty()))
     {
-        std::cout << "Error: there are no registered tests" << std::endl;
+        output.Text("Error: there are no registered tests").NewLine();
+        Terra::STF::WriteStdout(output.String());
         return EXIT_FAILURE;
     }
+    if (!Terra::STF::Unit_Tests)
+    {
+        Terra::STF::Unit_Tests = std::make_unique<Terra::STF::UnitTests>();
+    }
 
     // If any tests failed to register, exit with failure
     if (Terra::STF::failed_registrations)
     {
-        std::cout << "Error: " << Terra::STF::failed_registrations
-                  << " tests failed to register to get excluded" << std::endl;
+        output.Text("Error: ")
+              .Decimal(Terra::STF::failed_registrations)
+              .Text(" tests failed to register to get excluded")
+              .NewLine();
+        Terra::STF::WriteStdout(output.String());
         return EXIT_FAILURE;
     }
 
     // Assign the message string values
     Terra::STF::AssignMessageStrings();
 
-    std::cout << "Total numbers of tests: "
-              << Terra::STF::Unit_Tests->size()
-              << std::endl;
+    // Allow the STF_EXPECT_* reporting limit to be overridden
+    if (const char *limit = std::getenv("STF_EXPECT_LIMIT"); limit != nullptr)
+    {
+        Terra::STF::Expect_Report_Limit = std::strtoull(limit, nullptr, 10);
+    }
+
+    output.Text("Total numbers of tests: ")
+          .Decimal(Terra::STF::Unit_Tests->size() +
+                   (Terra::STF::Async_Unit_Tests ?
+                        Terra::STF::Async_Unit_Tests->size() :
+                        0))
+          .NewLine();
+    Terra::STF::WriteStdout(output.String());
+    output.Clear();
 
     try
     {
@@ -957,31 +4180,27 @@ int main()
             // Get the test name, function, and timeout period
             std::tie(name, test, timeout) = unit_test;
 
-            // Check to see if the test is to be excluded
-            if (Terra::STF::Unit_Test_Exclusions)
+            // If excluding the test, indicate such and continue
+            if (Terra::STF::IsExcluded(name))
             {
-                bool exclude_test = false;
-
-                // Iterate over the vector to see if the test is excluded
-                for (const auto &exclusion : *Terra::STF::Unit_Test_Exclusions)
-                {
-                    // If the test name is found, indicate it is excluded
-                    if (exclusion == name)
-                    {
-                        exclude_test = true;
-                        break;
-                    }
-                }
-
-                // If excluding the test, indicate such and continue
-                if (exclude_test)
-                {
-                    std::cout << "Excluding test " << name << std::endl;
-                    continue;
-                }
+                output.Text("Excluding test ").Text(name).NewLine();
+                Terra::STF::WriteStdout(output.String());
+                output.Clear();
+                continue;
             }
 
-            std::cout << "Running test " << name << std::flush;
+            output.Text("Running test ").Text(name);
+            Terra::STF::WriteStdout(output.String());
+            std::fflush(stdout);
+            output.Clear();
+
+            // Create the context that will collect the test's failures and
+            // make it the context for threads not having their own
+            Terra::STF::TestContext context(name);
+            context.SetDeadline(std::chrono::steady_clock::now() +
+                                std::chrono::seconds(timeout));
+            context.SetYieldSeed(Terra::STF::NewYieldSeed());
+            Terra::STF::Active_Context = &context;
 
             // Lock the mutex to ensure proper thread synchronization
             std::unique_lock<std::mutex> lock(test_mutex);
@@ -990,6 +4209,9 @@ int main()
             std::thread test_thread = std::thread(
                 [&]()
                 {
+                    // Report assertions on this thread to the test's context
+                    Terra::STF::ContextScope scope(&context);
+
                     // Get the start time
                     test_start_time = std::chrono::steady_clock::now();
 
@@ -998,25 +4220,17 @@ int main()
                     {
                         test();
                     }
-                    catch (const std::exception &e)
-                    {
-                        std::cout << std::endl
-                                  << "Unexpected exception thrown: "
-                                  << e.what()
-                                  << std::endl;
-                        Terra::STF::Test_Failed = true;
-                    }
                     catch (...)
                     {
-                        std::cout << std::endl
-                                  << "Unexpected exception thrown"
-                                  << std::endl;
-                        Terra::STF::Test_Failed = true;
+                        Terra::STF::ReportUnexpectedException();
                     }
 
                     // Get the end time
                     test_end_time = std::chrono::steady_clock::now();
 
+                    // Move any remaining output into the test output buffer
+                    Terra::STF::CommitOutput();
+
                     // Alert the main thread that the test has completed
                     std::lock_guard<std::mutex> lock(test_mutex);
                     cv.notify_one();
@@ -1026,13 +4240,22 @@ int main()
             if (cv.wait_for(lock, std::chrono::seconds(timeout)) ==
                                                         std::cv_status::timeout)
             {
-                std::cout << std::endl
-                          << "Test \""
-                          << name
-                          << "\" exceeded "
-                          << timeout
-                          << " second timeout; terminating"
-                          << std::endl;
+                // Emit whatever output the test produced before stalling
+                Terra::STF::WriteStdout(context.TakeOutput());
+
+                output.NewLine()
+                      .Text("Test \"")
+                      .Text(name)
+                      .Text("\" exceeded ")
+                      .Decimal(timeout)
+                      .Text(" second timeout; terminating")
+                      .NewLine();
+                if (context.YieldPointsReached())
+                {
+                    Terra::STF::PrintYieldSeed(output, context.YieldSeed());
+                }
+                Terra::STF::WriteStdout(output.String());
+                std::fflush(stdout);
 
                 // We must force termination
                 std::exit(EXIT_FAILURE);
@@ -1040,9 +4263,19 @@ int main()
 
             // Join the test thread
             test_thread.join();
+            Terra::STF::Active_Context = nullptr;
 
-            // If the test failed, exit
-            if (Terra::STF::Test_Failed.load()) return EXIT_FAILURE;
+            // Write the output produced by the test in one operation
+            Terra::STF::WriteStdout(context.TakeOutput());
+            std::fflush(stdout);
+
+            // If the test failed, summarize the failures and exit
+            if (context.Failed())
+            {
+                context.Summarize(output);
+                Terra::STF::WriteStdout(output.String());
+                return EXIT_FAILURE;
+            }
 
             // Compute the duration for this test
             std::chrono::nanoseconds test_duration =
@@ -1050,30 +4283,41 @@ int main()
                     test_end_time - test_start_time);
 
             // Print the time
-            std::cout << " ("
-                      << Terra::STF::FriendlyDuration(test_duration)
-                      << ")"
-                      << std::endl;
+            output.Text(" (")
+                  .Text(Terra::STF::FriendlyDuration(test_duration))
+                  .Character(')')
+                  .NewLine();
+            Terra::STF::WriteStdout(output.String());
+            output.Clear();
 
             // Update the total for all tests
             total_duration += test_duration;
         }
+
+        // Run the asynchronous tests together
+        if (!Terra::STF::RunAsyncTests(total_duration)) return EXIT_FAILURE;
     }
     catch (const std::exception &e)
     {
-        std::cout << std::endl;
-        std::cout << "Unexpected exception thrown: " << e.what() << std::endl;
+        output.NewLine()
+              .Text("Unexpected exception thrown: ")
+              .Text(e.what())
+              .NewLine();
+        Terra::STF::WriteStdout(output.String());
         return EXIT_FAILURE;
     }
     catch (...)
     {
-        std::cout << std::endl;
-        std::cout << "Unexpected exception thrown" << std::endl;
+        output.NewLine().Text("Unexpected exception thrown").NewLine();
+        Terra::STF::WriteStdout(output.String());
         return EXIT_FAILURE;
     }
 
-    std::cout << "All test(s) passed successfully ("
-              << Terra::STF::FriendlyDuration(total_duration)
-              << " total)"
-              << std::endl;
+    output.Text("All test(s) passed successfully (")
+          .Text(Terra::STF::FriendlyDuration(total_duration))
+          .Text(" total)")
+          .NewLine();
+    Terra::STF::WriteStdout(output.String());
 }
+
+#endif
@@ -0,0 +1,64 @@
+/*
+ *  stf_internal.h
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      This file declares functions defined in stf.cpp that are used
+ *      internally by the other modules of the library.
+ *
+ *  Portability Issues:
+ *      Requires C++17 or greater.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <string>
+
+namespace Terra::STF
+{
+
+/*
+ *  AssignMessageStrings()
+ *
+ *  Description:
+ *      Assign global message string values.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      This is called by main(), or by RunFuzzInput() when there is no
+ *      main().
+ */
+void AssignMessageStrings();
+
+/*
+ *  FriendlyDuration()
+ *
+ *  Description:
+ *      Return a human-friendly duration string that uses seconds, milliseconds,
+ *      microseconds, or nanoseconds depending on the value of the duration.
+ *
+ *  Parameters:
+ *      duration [in]
+ *          The duration to print.
+ *
+ *  Returns:
+ *      Human-friendly duration string.
+ *
+ *  Comments:
+ *      None.
+ */
+std::string FriendlyDuration(std::chrono::nanoseconds &duration);
+
+} // namespace Terra::STF
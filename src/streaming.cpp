@@ -0,0 +1,276 @@
+/*
+ *  streaming.cpp
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      This module implements the splitting of buffers into chunks and the
+ *      timing done by SweepChunks().
+ *
+ *  Portability Issues:
+ *      Requires C++17 or greater.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <terra/stf/streaming.h>
+#include <terra/stf/property.h>
+
+namespace Terra::STF
+{
+
+namespace
+{
+
+// Number of chunk sizes printed when describing a failing split
+constexpr std::size_t Stream_Describe_Limit = 64;
+
+/*
+ *  FixedSplit()
+ *
+ *  Description:
+ *      Split a buffer into chunks of the given size, the last of which may be
+ *      shorter.
+ *
+ *  Parameters:
+ *      data [in]
+ *          The buffer to split.
+ *
+ *      size [in]
+ *          The number of octets in the buffer.
+ *
+ *      chunk_size [in]
+ *          The size of each chunk.
+ *
+ *  Returns:
+ *      The chunks.
+ *
+ *  Comments:
+ *      None.
+ */
+StreamChunks FixedSplit(const std::uint8_t *data,
+                        std::size_t size,
+                        std::size_t chunk_size)
+{
+    StreamChunks chunks;
+
+    for (std::size_t offset = 0; offset < size; offset += chunk_size)
+    {
+        chunks.push_back({data + offset, std::min(chunk_size, size - offset)});
+    }
+
+    return chunks;
+}
+
+/*
+ *  RandomSplit()
+ *
+ *  Description:
+ *      Split a buffer into chunks of random sizes.
+ *
+ *  Parameters:
+ *      data [in]
+ *          The buffer to split.
+ *
+ *      size [in]
+ *          The number of octets in the buffer.
+ *
+ *      max_chunk [in]
+ *          The largest fixed chunk size of the sweep.
+ *
+ *      random [in]
+ *          The source of the sizes.
+ *
+ *  Returns:
+ *      The chunks.
+ *
+ *  Comments:
+ *      Chunks are a mix of a few octets, up to max_chunk octets, and up to
+ *      the rest of the buffer, with an occasional empty chunk.
+ */
+StreamChunks RandomSplit(const std::uint8_t *data,
+                         std::size_t size,
+                         std::size_t max_chunk,
+                         PropertyRandom &random)
+{
+    StreamChunks chunks;
+    std::size_t offset = 0;
+
+    while (offset < size)
+    {
+        const std::size_t remaining = size - offset;
+        std::size_t chunk_size = 0;
+
+        if (!random.OneIn(16))
+        {
+            switch (random.Below(3))
+            {
+                case 0:
+                    chunk_size = 1 + random.Below(8);
+                    break;
+
+                case 1:
+                    chunk_size = 1 + random.Below(max_chunk);
+                    break;
+
+                default:
+                    chunk_size = 1 + random.Below(remaining);
+                    break;
+            }
+        }
+
+        chunk_size = std::min(chunk_size, remaining);
+        chunks.push_back({data + offset, chunk_size});
+        offset += chunk_size;
+    }
+
+    if (random.OneIn(16)) chunks.push_back({data + size, 0});
+
+    return chunks;
+}
+
+} // namespace
+
+/*
+ *  RunChunkSweep()
+ *
+ *  Description:
+ *      Run the splits of a chunk sweep as the instances of a parameterized
+ *      test and then time each chunk size, as done by SweepChunks().
+ *
+ *  Parameters:
+ *      data [in]
+ *          The buffer to split.
+ *
+ *      size [in]
+ *          The number of octets in the buffer.
+ *
+ *      max_chunk [in]
+ *          The largest fixed chunk size to try.
+ *
+ *      check [in]
+ *          The function that passes the given chunks to the function under
+ *          test and reports a result that differs, returning true if the
+ *          result was right.
+ *
+ *      call [in]
+ *          The function that passes the given chunks to the function under
+ *          test, used for timing.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      Instances are the fixed chunk sizes in increasing order followed by
+ *      the random splits.  Timing is done on the calling thread so that
+ *      calls do not compete for the processor, and stops as the test nears
+ *      its timeout.  Chunk sizes that are powers of two, and max_chunk, are
+ *      timed.
+ */
+void RunChunkSweep(const std::uint8_t *data,
+                   std::size_t size,
+                   std::size_t max_chunk,
+                   const std::function<bool(const StreamChunks &)> &check,
+                   const std::function<void(const StreamChunks &)> &call)
+{
+    const std::uint64_t seed = NewPropertySeed();
+    std::atomic<std::size_t> passed{};
+
+    max_chunk = std::max<std::size_t>(max_chunk, 1);
+    const std::size_t count = max_chunk + Stream_Random_Splits;
+
+    // Return the chunks of the given instance
+    auto split = [&](std::size_t index)
+    {
+        if (index < max_chunk) return FixedSplit(data, size, index + 1);
+
+        PropertyRandom random(seed, index);
+        return RandomSplit(data, size, max_chunk, random);
+    };
+
+    RunInstances(
+        count,
+        [&](std::size_t index)
+        {
+            if (check(split(index))) passed++;
+        },
+        [&](std::size_t index)
+        {
+            if (index < max_chunk)
+            {
+                PendingOutput().Text("  chunk size: ")
+                               .Decimal(index + 1)
+                               .NewLine();
+                return;
+            }
+
+            const StreamChunks chunks = split(index);
+
+            PendingOutput().Text("  chunk sizes:");
+            for (std::size_t i = 0; i < chunks.size(); i++)
+            {
+                if (i == Stream_Describe_Limit)
+                {
+                    PendingOutput().Text(" ...");
+                    break;
+                }
+                PendingOutput().Character(' ').Decimal(chunks[i].size);
+            }
+            PendingOutput().Text(" (")
+                           .Decimal(chunks.size())
+                           .Text(" chunk(s); set STF_PROPERTY_SEED=")
+                           .Decimal(seed)
+                           .Text(" to repeat)")
+                           .NewLine();
+        });
+
+    if ((passed != count) || (size == 0)) return;
+
+    // Time the function over the whole buffer and with chunk sizes that are
+    // powers of two, and the largest size
+    const auto deadline = WorkDeadline();
+    auto time = [&](const StreamChunks &chunks)
+    {
+        std::size_t calls = 0;
+        auto start = std::chrono::steady_clock::now();
+        auto end = start;
+
+        do
+        {
+            call(chunks);
+            calls++;
+            end = std::chrono::steady_clock::now();
+        } while ((end - start < Stream_Timing) && (end < deadline));
+
+        PrintThroughput(
+            calls,
+            calls * size,
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start));
+    };
+
+    PendingOutput().Text(" [one chunk: ");
+    time(StreamChunks{{data, size}});
+    std::vector<std::size_t> chunk_sizes;
+    for (std::size_t chunk_size = 1; chunk_size < max_chunk; chunk_size *= 2)
+    {
+        chunk_sizes.push_back(chunk_size);
+    }
+    chunk_sizes.push_back(max_chunk);
+
+    for (std::size_t chunk_size : chunk_sizes)
+    {
+        if (std::chrono::steady_clock::now() >= deadline) break;
+
+        PendingOutput().Text(", ").Decimal(chunk_size).Text(": ");
+        time(FixedSplit(data, size, chunk_size));
+    }
+    PendingOutput().Character(']');
+    CommitOutput();
+}
+
+} // namespace Terra::STF
@@ -0,0 +1,458 @@
+/*
+ *  virtual_clock.cpp
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      This module implements the virtual clock and scheduler that allow
+ *      tests of time-dependent code to run without waiting for real time to
+ *      pass.
+ *
+ *  Portability Issues:
+ *      Requires C++17 or greater.
+ */
+
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <utility>
+#include <terra/stf/virtual_clock.h>
+
+namespace Terra::STF
+{
+
+/*
+ *  VirtualClock::now()
+ *
+ *  Description:
+ *      Return the current time.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The virtual time of the current test's scheduler, or the time of the
+ *      steady clock if there is no scheduler.
+ *
+ *  Comments:
+ *      None.
+ */
+VirtualClock::time_point VirtualClock::now() noexcept
+{
+    if (VirtualScheduler *scheduler = CurrentScheduler(); scheduler != nullptr)
+    {
+        try
+        {
+            return scheduler->Now();
+        }
+        catch (...)
+        {
+            // Locking the scheduler failed; fall through to the steady clock
+        }
+    }
+
+    return time_point(std::chrono::steady_clock::now().time_since_epoch());
+}
+
+/*
+ *  VirtualScheduler::VirtualScheduler()
+ *
+ *  Description:
+ *      Create a scheduler whose virtual time starts at the current time of
+ *      the steady clock and make it the scheduler of the current test.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+VirtualScheduler::VirtualScheduler() :
+    VirtualScheduler(VirtualClock::time_point(
+        std::chrono::steady_clock::now().time_since_epoch()))
+{
+    // Nothing to do
+}
+
+/*
+ *  VirtualScheduler::VirtualScheduler()
+ *
+ *  Description:
+ *      Create a scheduler whose virtual time starts at the given time and
+ *      make it the scheduler of the current test.
+ *
+ *  Parameters:
+ *      start [in]
+ *          The initial virtual time.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      If there is no current test, the scheduler may still be used
+ *      directly, but VirtualClock and the sleep functions do not use it.
+ */
+VirtualScheduler::VirtualScheduler(VirtualClock::time_point start) :
+    context{CurrentContext()},
+    previous{},
+    now{start},
+    next_id{}
+{
+    if (context != nullptr) previous = context->SetScheduler(this);
+}
+
+/*
+ *  VirtualScheduler::~VirtualScheduler()
+ *
+ *  Description:
+ *      Restore the scheduler the current test had before this one was
+ *      created.  Callbacks that have not been invoked are discarded.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+VirtualScheduler::~VirtualScheduler()
+{
+    if (context != nullptr) context->SetScheduler(previous);
+}
+
+/*
+ *  VirtualScheduler::Now()
+ *
+ *  Description:
+ *      Return the current virtual time.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The current virtual time.
+ *
+ *  Comments:
+ *      None.
+ */
+VirtualClock::time_point VirtualScheduler::Now() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return now;
+}
+
+/*
+ *  VirtualScheduler::Advance()
+ *
+ *  Description:
+ *      Advance virtual time by the given duration, invoking each callback
+ *      that becomes due.
+ *
+ *  Parameters:
+ *      duration [in]
+ *          The amount by which to advance virtual time.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void VirtualScheduler::Advance(VirtualClock::duration duration)
+{
+    AdvanceTo(Now() + duration);
+}
+
+/*
+ *  VirtualScheduler::AdvanceTo()
+ *
+ *  Description:
+ *      Advance virtual time to the given time, invoking each callback that
+ *      becomes due at the time for which it was scheduled.
+ *
+ *  Parameters:
+ *      time [in]
+ *          The virtual time to which to advance.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      Virtual time does not change if the given time has already passed.
+ *      Callbacks scheduled by other callbacks are also invoked if they
+ *      become due no later than the given time.
+ */
+void VirtualScheduler::AdvanceTo(VirtualClock::time_point time)
+{
+    while (true)
+    {
+        Callback callback;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (timers.empty() || (timers.begin()->first.first > time))
+            {
+                if (time > now) now = time;
+                return;
+            }
+
+            auto timer = timers.begin();
+            if (timer->first.first > now) now = timer->first.first;
+            timer_times.erase(timer->first.second);
+            callback = std::move(timer->second);
+            timers.erase(timer);
+        }
+
+        callback();
+    }
+}
+
+/*
+ *  VirtualScheduler::RunNext()
+ *
+ *  Description:
+ *      Advance virtual time to that of the next scheduled callback and
+ *      invoke it, along with any others due at the same time.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      True if a callback was invoked, false if none were scheduled.
+ *
+ *  Comments:
+ *      None.
+ */
+bool VirtualScheduler::RunNext()
+{
+    VirtualClock::time_point time;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (timers.empty()) return false;
+
+        time = timers.begin()->first.first;
+    }
+
+    AdvanceTo(time);
+
+    return true;
+}
+
+/*
+ *  VirtualScheduler::ScheduleAt()
+ *
+ *  Description:
+ *      Schedule a callback to be invoked when virtual time reaches the given
+ *      time.
+ *
+ *  Parameters:
+ *      time [in]
+ *          The virtual time at which to invoke the callback.
+ *
+ *      callback [in]
+ *          The function to invoke.
+ *
+ *  Returns:
+ *      An identifier that may be passed to Cancel().
+ *
+ *  Comments:
+ *      A callback scheduled for a time that has already passed is invoked
+ *      the next time virtual time is advanced.
+ */
+VirtualScheduler::TimerID VirtualScheduler::ScheduleAt(
+    VirtualClock::time_point time,
+    Callback callback)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    TimerID id = next_id++;
+
+    timers.emplace(TimerKey{time, id}, std::move(callback));
+    timer_times.emplace(id, time);
+
+    return id;
+}
+
+/*
+ *  VirtualScheduler::ScheduleAfter()
+ *
+ *  Description:
+ *      Schedule a callback to be invoked after the given amount of virtual
+ *      time has passed.
+ *
+ *  Parameters:
+ *      delay [in]
+ *          The amount of virtual time to pass before invoking the callback.
+ *
+ *      callback [in]
+ *          The function to invoke.
+ *
+ *  Returns:
+ *      An identifier that may be passed to Cancel().
+ *
+ *  Comments:
+ *      None.
+ */
+VirtualScheduler::TimerID VirtualScheduler::ScheduleAfter(
+    VirtualClock::duration delay,
+    Callback callback)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    TimerID id = next_id++;
+
+    timers.emplace(TimerKey{now + delay, id}, std::move(callback));
+    timer_times.emplace(id, now + delay);
+
+    return id;
+}
+
+/*
+ *  VirtualScheduler::Cancel()
+ *
+ *  Description:
+ *      Cancel a callback that has not yet been invoked.
+ *
+ *  Parameters:
+ *      id [in]
+ *          The identifier returned when the callback was scheduled.
+ *
+ *  Returns:
+ *      True if the callback was cancelled, false if it was already invoked
+ *      or cancelled.
+ *
+ *  Comments:
+ *      None.
+ */
+bool VirtualScheduler::Cancel(TimerID id)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto timer_time = timer_times.find(id);
+
+    if (timer_time == timer_times.end()) return false;
+
+    timers.erase(TimerKey{timer_time->second, id});
+    timer_times.erase(timer_time);
+
+    return true;
+}
+
+/*
+ *  VirtualScheduler::Pending()
+ *
+ *  Description:
+ *      Return the number of callbacks that have not yet been invoked.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The number of scheduled callbacks.
+ *
+ *  Comments:
+ *      None.
+ */
+std::size_t VirtualScheduler::Pending() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return timers.size();
+}
+
+/*
+ *  CurrentScheduler()
+ *
+ *  Description:
+ *      Return the VirtualScheduler of the calling thread's current test.
+ *
+ *  Parameters:
+ *      None.
+ *
+ *  Returns:
+ *      The current test's scheduler, or nullptr if there is none.
+ *
+ *  Comments:
+ *      None.
+ */
+VirtualScheduler *CurrentScheduler() noexcept
+{
+    TestContext *context = CurrentContext();
+
+    return (context != nullptr) ? context->Scheduler() : nullptr;
+}
+
+/*
+ *  SleepUntil()
+ *
+ *  Description:
+ *      Advance the current test's virtual time to the given time, invoking
+ *      any callbacks that become due, or if the test has no scheduler, block
+ *      the calling thread until the steady clock reaches the given time.
+ *
+ *  Parameters:
+ *      time [in]
+ *          The time until which to sleep.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void SleepUntil(VirtualClock::time_point time)
+{
+    if (VirtualScheduler *scheduler = CurrentScheduler(); scheduler != nullptr)
+    {
+        scheduler->AdvanceTo(time);
+        return;
+    }
+
+    std::this_thread::sleep_until(
+        std::chrono::steady_clock::time_point(time.time_since_epoch()));
+}
+
+/*
+ *  SleepFor()
+ *
+ *  Description:
+ *      Advance the current test's virtual time by the given duration,
+ *      invoking any callbacks that become due, or if the test has no
+ *      scheduler, block the calling thread for the given duration.
+ *
+ *  Parameters:
+ *      duration [in]
+ *          The length of time to sleep.
+ *
+ *  Returns:
+ *      Nothing.
+ *
+ *  Comments:
+ *      None.
+ */
+void SleepFor(VirtualClock::duration duration)
+{
+    if (VirtualScheduler *scheduler = CurrentScheduler(); scheduler != nullptr)
+    {
+        scheduler->Advance(duration);
+        return;
+    }
+
+    std::this_thread::sleep_for(duration);
+}
+
+} // namespace Terra::STF
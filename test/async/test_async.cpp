@@ -0,0 +1,192 @@
+/*
+ *  test_async.cpp
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Module to exercise tests written as coroutines.
+ *
+ *  Portability Issues:
+ *      Requires C++20 or greater.
+ */
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <terra/stf/async.h>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+
+// Coroutines used by the tests below
+Terra::STF::Task<int> Square(int value)
+{
+    co_await Terra::STF::AsyncYield();
+    co_return value * value;
+}
+
+Terra::STF::Task<int> SumOfSquares(int a, int b)
+{
+    int sum = co_await Square(a);
+    sum += co_await Square(b);
+    co_return sum;
+}
+
+Terra::STF::Task<std::string> Throws()
+{
+    co_await Terra::STF::AsyncYield();
+    throw std::runtime_error("failed");
+}
+
+Terra::STF::Task<> Record(std::vector<int> &order,
+                          int value,
+                          std::chrono::milliseconds delay)
+{
+    co_await Terra::STF::AsyncSleepFor(delay);
+    order.push_back(value);
+}
+
+Terra::STF::Task<> FailsAssertion(bool &reached_end)
+{
+    STF_CO_ASSERT_EQ(1, 2);
+    reached_end = true;
+    co_return;
+}
+
+// Count of the tests that demonstrate they run concurrently that have started
+int Concurrent_Started = 0;
+
+} // namespace
+
+STF_TEST_ASYNC(Async, Values)
+{
+    int sum = co_await SumOfSquares(3, 4);
+
+    STF_CO_ASSERT_EQ(25, sum);
+}
+
+STF_TEST_ASYNC(Async, Exceptions)
+{
+    bool caught = false;
+
+    try
+    {
+        co_await Throws();
+    }
+    catch (const std::runtime_error &)
+    {
+        caught = true;
+    }
+
+    STF_CO_ASSERT_TRUE(caught);
+}
+
+STF_TEST_ASYNC(Async, Event)
+{
+    Terra::STF::Event event;
+    int value = 0;
+
+    // An event may be set from another thread to resume the test
+    std::thread thread(
+        [&]
+        {
+            std::this_thread::sleep_for(10ms);
+            value = 42;
+            event.Set();
+        });
+
+    co_await event;
+    thread.join();
+
+    STF_CO_ASSERT_TRUE(event.IsSet());
+    STF_CO_ASSERT_EQ(42, value);
+
+    // Awaiting an event that is set does not suspend
+    co_await event;
+}
+
+// Each of the following tests sleeps after noting that it started, so if
+// they run concurrently, all have started by the time any of them wakes
+STF_TEST_ASYNC(Async, Concurrent1)
+{
+    Concurrent_Started++;
+    co_await Terra::STF::AsyncSleepFor(50ms);
+    STF_CO_ASSERT_EQ(3, Concurrent_Started);
+}
+
+STF_TEST_ASYNC(Async, Concurrent2)
+{
+    Concurrent_Started++;
+    co_await Terra::STF::AsyncSleepFor(50ms);
+    STF_CO_ASSERT_EQ(3, Concurrent_Started);
+}
+
+STF_TEST_ASYNC(Async, Concurrent3)
+{
+    Concurrent_Started++;
+    co_await Terra::STF::AsyncSleepFor(50ms);
+    STF_CO_ASSERT_EQ(3, Concurrent_Started);
+}
+
+STF_TEST(Async, SleepOrder)
+{
+    Terra::STF::EventLoop loop;
+    std::vector<int> order;
+
+    loop.Spawn(Record(order, 3, 30ms));
+    loop.Spawn(Record(order, 1, 10ms));
+    loop.Spawn(Record(order, 2, 20ms));
+    STF_ASSERT_EQ(3, loop.Tasks());
+
+    auto start = std::chrono::steady_clock::now();
+    STF_ASSERT_TRUE(loop.Run());
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    STF_ASSERT_EQ((std::vector<int>{1, 2, 3}), order);
+    STF_ASSERT_EQ(0, loop.Tasks());
+    STF_ASSERT_GE(elapsed, 30ms);
+    STF_ASSERT_LT(elapsed, 5s);
+}
+
+STF_TEST(Async, Deadline)
+{
+    Terra::STF::EventLoop loop;
+    std::vector<int> order;
+
+    loop.Spawn(Record(order, 1, 1ms));
+    loop.Spawn(Record(order, 2, 1h));
+
+    // The loop stops when the deadline is reached
+    STF_ASSERT_FALSE(loop.Run(std::chrono::steady_clock::now() + 50ms));
+    STF_ASSERT_EQ((std::vector<int>{1}), order);
+    STF_ASSERT_EQ(1, loop.Tasks());
+}
+
+STF_TEST(Async, AssertionEndsCoroutine)
+{
+    Terra::STF::TestContext context("Scratch");
+    bool reached_end = false;
+    bool completed = false;
+
+    {
+        Terra::STF::ContextScope scope(&context);
+        Terra::STF::EventLoop loop;
+
+        loop.Spawn(FailsAssertion(reached_end));
+        completed = loop.Run();
+    }
+
+    STF_ASSERT_TRUE(completed);
+    STF_ASSERT_FALSE(reached_end);
+    STF_ASSERT_TRUE(context.Failed());
+    STF_ASSERT_TRUE(context.Completed());
+}
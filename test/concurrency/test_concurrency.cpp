@@ -0,0 +1,165 @@
+/*
+ *  test_concurrency.cpp
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Module to exercise tests defined with STF_TEST_CONCURRENT that run
+ *      the same test body on many threads at once.
+ *
+ *  Portability Issues:
+ *      None.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <terra/stf/stf.h>
+
+namespace
+{
+
+// Number of threads used by the tests below
+constexpr std::size_t Thread_Count = 4;
+
+// Shared state used by the tests below
+std::atomic<std::size_t> Counter{};
+std::atomic<std::size_t> Rounds_Run{};
+std::mutex Thread_IDs_Mutex;
+std::set<std::thread::id> Thread_IDs;
+
+// Function that fails on one thread in the second round
+void FailInSecondRound()
+{
+    if ((Terra::STF::ConcurrentRound() == 1) &&
+        (Terra::STF::ConcurrentThreadIndex() == 1))
+    {
+        STF_EXPECT_TRUE(false);
+    }
+}
+
+} // namespace
+
+STF_TEST_CONCURRENT(Concurrency, Defaults)
+{
+    STF_ASSERT_GE(Terra::STF::ConcurrentThreadCount(), 2);
+    STF_ASSERT_LT(Terra::STF::ConcurrentThreadIndex(),
+                  Terra::STF::ConcurrentThreadCount());
+    STF_ASSERT_LT(Terra::STF::ConcurrentRound(),
+                  Terra::STF::Default_Concurrent_Rounds);
+}
+
+STF_TEST_CONCURRENT_N(Concurrency, SharedCounter, Thread_Count, 50, 10)
+{
+    constexpr std::size_t Increments = 1000;
+
+    // One thread prepares the shared state before the others use it
+    if (Terra::STF::ConcurrentThreadIndex() == 0)
+    {
+        Counter = 0;
+        Rounds_Run++;
+    }
+    Terra::STF::ConcurrentSync();
+
+    for (std::size_t i = 0; i < Increments; i++) Counter++;
+
+    // Wait for all threads to finish before checking the result
+    Terra::STF::ConcurrentSync();
+
+    STF_ASSERT_EQ(Thread_Count, Terra::STF::ConcurrentThreadCount());
+    STF_ASSERT_EQ(Thread_Count * Increments, Counter.load());
+
+    // The same threads are used for every round
+    std::lock_guard<std::mutex> lock(Thread_IDs_Mutex);
+    Thread_IDs.insert(std::this_thread::get_id());
+}
+
+STF_TEST(Concurrency, SameThreadsEachRound)
+{
+    // This relies on tests running in the order defined in this file
+    STF_ASSERT_EQ(50, Rounds_Run.load());
+    STF_ASSERT_EQ(Thread_Count, Thread_IDs.size());
+}
+
+STF_TEST_CONCURRENT_N(Concurrency, EarlyReturn, Thread_Count, 20, 10)
+{
+    // Threads returning early (as a failed assertion would) must not cause
+    // threads waiting for the others to deadlock
+    if ((Terra::STF::ConcurrentThreadIndex() % 2) == 0) return;
+
+    Terra::STF::ConcurrentSync();
+    Terra::STF::ConcurrentSync();
+}
+
+STF_TEST(Concurrency, StopsAfterFailedRound)
+{
+    auto captured = Terra::STF::CaptureOutput(
+        []
+        {
+            Terra::STF::RunConcurrent(FailInSecondRound, Thread_Count, 100, 0);
+        });
+
+    STF_ASSERT_EQ(1, captured.failures);
+    STF_ASSERT_NE(std::string::npos,
+                  captured.output.find("Concurrent test failed in round 1 "
+                                       "with 4 threads"));
+}
+
+STF_TEST(Concurrency, TimeBudget)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    // With no round limit, rounds continue until the time budget expires
+    Terra::STF::RunConcurrent([] { Counter++; }, Thread_Count, 0, 1);
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    STF_ASSERT_GE(elapsed, std::chrono::seconds(1));
+    STF_ASSERT_LT(elapsed, std::chrono::seconds(10));
+}
+
+STF_TEST(Concurrency, SpinBarrier)
+{
+    constexpr std::size_t Iterations = 100;
+
+    Terra::STF::SpinBarrier barrier(Thread_Count);
+    std::atomic<std::size_t> arrivals{};
+    std::atomic<bool> ordered{true};
+
+    {
+        std::vector<Terra::STF::Thread> threads;
+
+        for (std::size_t i = 0; i < Thread_Count; i++)
+        {
+            threads.emplace_back(
+                [&]()
+                {
+                    for (std::size_t j = 0; j < Iterations; j++)
+                    {
+                        arrivals++;
+                        barrier.ArriveAndWait();
+
+                        // No thread may pass before all have arrived
+                        if (arrivals.load() < (j + 1) * Thread_Count)
+                        {
+                            ordered = false;
+                        }
+                        barrier.ArriveAndWait();
+                    }
+                });
+        }
+    }
+
+    STF_ASSERT_TRUE(ordered.load());
+    STF_ASSERT_EQ(Thread_Count * Iterations, arrivals.load());
+}
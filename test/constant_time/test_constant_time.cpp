@@ -0,0 +1,155 @@
+/*
+ *  test_constant_time.cpp
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Module to exercise the detection of timing that depends on input.
+ *
+ *  Portability Issues:
+ *      None.
+ */
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <terra/stf/constant_time.h>
+
+namespace
+{
+
+using Tag = std::array<std::uint8_t, 64>;
+
+// The tag against which others are compared
+const Tag Secret = []()
+{
+    Tag tag{};
+    for (std::size_t i = 0; i < tag.size(); i++)
+    {
+        tag[i] = static_cast<std::uint8_t>(i * 37 + 11);
+    }
+    return tag;
+}();
+
+// Return a random tag
+Tag RandomTag(Terra::STF::PropertyRandom &random)
+{
+    Tag tag;
+
+    for (auto &octet : tag) octet = static_cast<std::uint8_t>(random.Next());
+
+    return tag;
+}
+
+// Compare tags, examining every octet
+bool EqualConstantTime(const Tag &tag)
+{
+    std::uint8_t difference = 0;
+
+    for (std::size_t i = 0; i < tag.size(); i++)
+    {
+        difference |= tag[i] ^ Secret[i];
+    }
+
+    return difference == 0;
+}
+
+// Compare tags, stopping at the first difference
+bool EqualEarlyExit(const Tag &tag)
+{
+    for (std::size_t i = 0; i < tag.size(); i++)
+    {
+        // Keep the compiler from combining the comparisons
+        Terra::STF::KeepValue(i);
+        if (tag[i] != Secret[i]) return false;
+    }
+
+    return true;
+}
+
+} // namespace
+
+STF_TEST(ConstantTime, Passes)
+{
+    STF_ASSERT_CONSTANT_TIME(EqualConstantTime, Secret, RandomTag);
+}
+
+STF_TEST(ConstantTime, LeakDetected)
+{
+    bool constant = true;
+    auto captured = Terra::STF::CaptureOutput(
+        [&]
+        {
+            constant = Terra::STF::AssertConstantTime(__FILE__,
+                                                      __LINE__,
+                                                      EqualEarlyExit,
+                                                      Secret,
+                                                      RandomTag);
+        });
+
+    STF_ASSERT_FALSE(constant);
+    STF_ASSERT_NE(std::string::npos,
+                  captured.output.find("Timing depends on the input: |t| = "));
+    STF_ASSERT_NE(std::string::npos,
+                  captured.output.find("mean time for the fixed input: "));
+}
+
+STF_TEST(ConstantTime, TooFewSamples)
+{
+    bool constant = true;
+    auto captured = Terra::STF::CaptureOutput(
+        [&]
+        {
+            // No time remains for even the warm-up calls
+            Terra::STF::CurrentContext()->SetDeadline(
+                std::chrono::steady_clock::now());
+
+            constant = Terra::STF::AssertConstantTime(__FILE__,
+                                                      __LINE__,
+                                                      EqualConstantTime,
+                                                      Secret,
+                                                      RandomTag);
+        });
+
+    STF_ASSERT_FALSE(constant);
+    STF_ASSERT_NE(std::string::npos,
+                  captured.output.find("Too few calls timed before the "
+                                       "deadline: 0 with the fixed input "
+                                       "and 0 with random inputs"));
+    STF_ASSERT_EQ(std::string::npos, captured.output.find("|t| = "));
+}
+
+STF_TEST(ConstantTime, ExceptionPropagated)
+{
+    auto throws = [](const Tag &) -> bool
+    {
+        throw std::runtime_error("failed");
+    };
+
+    STF_ASSERT_EXCEPTION_E(
+        [&]()
+        {
+            Terra::STF::AssertConstantTime(__FILE__,
+                                           __LINE__,
+                                           throws,
+                                           Secret,
+                                           RandomTag);
+        },
+        std::runtime_error);
+}
+
+STF_TEST(ConstantTime, CycleCount)
+{
+    std::uint64_t first = Terra::STF::CycleCount();
+    std::uint64_t second = Terra::STF::CycleCount();
+
+    STF_ASSERT_GE(second, first);
+}
@@ -0,0 +1,327 @@
+/*
+ *  test_differential.cpp
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Module to exercise differential testing of implementations.
+ *
+ *  Portability Issues:
+ *      None.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <terra/stf/differential.h>
+
+namespace
+{
+
+// Implementations of a population count
+unsigned CountBitsReference(std::uint64_t value)
+{
+    unsigned count = 0;
+
+    for (; value != 0; value >>= 1) count += value & 1;
+
+    return count;
+}
+
+unsigned CountBitsOptimized(std::uint64_t value)
+{
+    value = value - ((value >> 1) & 0x5555555555555555ULL);
+    value = (value & 0x3333333333333333ULL) +
+            ((value >> 2) & 0x3333333333333333ULL);
+    value = (value + (value >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+
+    return static_cast<unsigned>((value * 0x0101010101010101ULL) >> 56);
+}
+
+// Implementations of a byte transformation
+std::vector<std::uint8_t> ComplementReference(
+    const std::vector<std::uint8_t> &data)
+{
+    std::vector<std::uint8_t> result;
+
+    for (std::uint8_t octet : data) result.push_back(~octet & 0xff);
+
+    return result;
+}
+
+std::vector<std::uint8_t> ComplementOptimized(
+    const std::vector<std::uint8_t> &data)
+{
+    std::vector<std::uint8_t> result(data);
+    std::size_t i = 0;
+
+    // Complement eight octets at a time, then the remainder
+    for (; i + 8 <= result.size(); i += 8)
+    {
+        std::uint64_t word = 0;
+        for (std::size_t j = 0; j < 8; j++)
+        {
+            word |= std::uint64_t(result[i + j]) << (8 * j);
+        }
+        word = ~word;
+        for (std::size_t j = 0; j < 8; j++)
+        {
+            result[i + j] = static_cast<std::uint8_t>(word >> (8 * j));
+        }
+    }
+    for (; i < result.size(); i++) result[i] = ~result[i] & 0xff;
+
+    return result;
+}
+
+// Implementations of a sum that round differently
+double SumReference(const std::vector<double> &values)
+{
+    double sum = 0.0;
+
+    for (double value : values) sum += value;
+
+    return sum;
+}
+
+double SumPairwise(const std::vector<double> &values)
+{
+    double sums[2] = {};
+
+    for (std::size_t i = 0; i < values.size(); i++) sums[i % 2] += values[i];
+
+    return sums[0] + sums[1];
+}
+
+// A result having equality but no streaming operator
+struct DivMod
+{
+    std::uint32_t quotient;
+    std::uint32_t remainder;
+
+    bool operator==(const DivMod &other) const
+    {
+        return (quotient == other.quotient) && (remainder == other.remainder);
+    }
+};
+
+// Implementations of division by ten
+DivMod DivModReference(std::uint32_t value)
+{
+    return {value / 10, value % 10};
+}
+
+DivMod DivModOptimized(std::uint32_t value)
+{
+    auto quotient =
+        static_cast<std::uint32_t>((std::uint64_t(value) * 0xcccccccdULL) >>
+                                   35);
+
+    return {quotient, value - (quotient * 10)};
+}
+
+// Count the occurrences of a string within another
+std::size_t CountOccurrences(const std::string &text, const std::string &part)
+{
+    std::size_t count = 0;
+
+    for (std::size_t position = text.find(part);
+         position != std::string::npos;
+         position = text.find(part, position + part.size()))
+    {
+        count++;
+    }
+
+    return count;
+}
+
+} // namespace
+
+STF_TEST(Differential, Integers)
+{
+    STF_ASSERT_EQUIVALENT(CountBitsReference,
+                          CountBitsOptimized,
+                          Terra::STF::Integers<std::uint64_t>());
+}
+
+STF_TEST(Differential, Bytes)
+{
+    STF_ASSERT_EQUIVALENT(ComplementReference,
+                          ComplementOptimized,
+                          Terra::STF::Bytes(64));
+}
+
+STF_TEST(Differential, Tolerance)
+{
+    STF_ASSERT_EQUIVALENT_NEAR(
+        SumReference,
+        SumPairwise,
+        1e-9,
+        1e-9,
+        Terra::STF::VectorsOf(Terra::STF::Floats<double>(-1.0, 1.0)));
+}
+
+STF_TEST(Differential, Equivalence)
+{
+    const double NaN = std::numeric_limits<double>::quiet_NaN();
+
+    STF_ASSERT_TRUE(Terra::STF::IsEquivalent(1.0, 1.0 + 1e-12, 0.0, 1e-9));
+    STF_ASSERT_FALSE(Terra::STF::IsEquivalent(1.0, 1.0 + 1e-12, 0.0, 0.0));
+    STF_ASSERT_TRUE(Terra::STF::IsEquivalent(NaN, NaN, 0.0, 0.0));
+    STF_ASSERT_FALSE(Terra::STF::IsEquivalent(
+        std::vector<float>{1.0f, 2.0f},
+        std::vector<float>{1.0f},
+        1.0,
+        1.0));
+    STF_ASSERT_TRUE(Terra::STF::IsEquivalent(std::string("abc"),
+                                             std::string("abc"),
+                                             0.0,
+                                             0.0));
+}
+
+STF_TEST(Differential, DivergenceReported)
+{
+    // The optimized implementation mishandles the octet 0x7f
+    auto broken = [](const std::vector<std::uint8_t> &data)
+    {
+        auto result = ComplementOptimized(data);
+        for (std::size_t i = 0; i < data.size(); i++)
+        {
+            if (data[i] == 0x7f) result[i] = 0;
+        }
+        return result;
+    };
+
+    bool equivalent = true;
+    auto captured = Terra::STF::CaptureOutput(
+        [&]
+        {
+            equivalent =
+                Terra::STF::AssertEquivalent(__FILE__,
+                                             __LINE__,
+                                             0.0,
+                                             0.0,
+                                             ComplementReference,
+                                             broken,
+                                             Terra::STF::Bytes());
+        });
+
+    STF_ASSERT_FALSE(equivalent);
+
+    const std::string &output = captured.output;
+    STF_ASSERT_NE(std::string::npos, output.find("Implementations differ"));
+    STF_ASSERT_NE(std::string::npos,
+                  output.find("reference: 1 octet(s): 80\n"));
+    STF_ASSERT_NE(std::string::npos,
+                  output.find("optimized: 1 octet(s): 00\n"));
+    STF_ASSERT_NE(std::string::npos,
+                  output.find("first difference at index 0"));
+    STF_ASSERT_NE(std::string::npos, output.find("args[0]: 1 octet(s): 7f"));
+    STF_ASSERT_NE(std::string::npos, output.find("speedup: "));
+}
+
+STF_TEST(Differential, DivergingBatchNotTimed)
+{
+    // Every case diverges, so no batch counts towards the throughput
+    auto captured = Terra::STF::CaptureOutput(
+        [&]
+        {
+            Terra::STF::AssertEquivalent(
+                __FILE__,
+                __LINE__,
+                0.0,
+                0.0,
+                [](std::uint32_t value) { return value; },
+                [](std::uint32_t value) { return ~value; },
+                Terra::STF::Integers<std::uint32_t>());
+        });
+
+    STF_ASSERT_NE(std::string::npos,
+                  captured.output.find("Throughput over 0 equivalent case(s)"));
+}
+
+STF_TEST(Differential, ExceptionReported)
+{
+    auto throws = [](std::uint64_t value) -> unsigned
+    {
+        if (value > 1000) throw std::runtime_error("too large");
+        return CountBitsReference(value);
+    };
+
+    bool equivalent = true;
+    auto captured = Terra::STF::CaptureOutput(
+        [&]
+        {
+            equivalent = Terra::STF::AssertEquivalent(
+                __FILE__,
+                __LINE__,
+                0.0,
+                0.0,
+                CountBitsReference,
+                throws,
+                Terra::STF::Integers<std::uint64_t>());
+        });
+
+    STF_ASSERT_FALSE(equivalent);
+
+    const std::string &output = captured.output;
+    STF_ASSERT_NE(std::string::npos, output.find("thrown: too large"));
+    STF_ASSERT_NE(std::string::npos, output.find("args[0]: 1001 "));
+}
+
+STF_TEST(Differential, StructResult)
+{
+    STF_ASSERT_EQUIVALENT(DivModReference,
+                          DivModOptimized,
+                          Terra::STF::Integers<std::uint32_t>());
+
+    // A divergence is reported even though the result cannot be printed
+    bool equivalent = true;
+    auto captured = Terra::STF::CaptureOutput(
+        [&]
+        {
+            equivalent = Terra::STF::AssertEquivalent(
+                __FILE__,
+                __LINE__,
+                0.0,
+                0.0,
+                DivModReference,
+                [](std::uint32_t value) { return DivMod{value, 0}; },
+                Terra::STF::Integers<std::uint32_t>());
+        });
+
+    STF_ASSERT_FALSE(equivalent);
+    STF_ASSERT_NE(std::string::npos,
+                  captured.output.find("reference: [Unprintable object"));
+}
+
+STF_TEST(Differential, ReportingLimit)
+{
+    constexpr std::size_t Extra = 2;
+    const std::size_t limit = Terra::STF::Expect_Report_Limit;
+
+    // Failures beyond the limit at a site are counted but not reported
+    auto captured = Terra::STF::CaptureOutput(
+        [&]
+        {
+            for (std::size_t i = 0; i < limit + Extra; i++)
+            {
+                STF_EXPECT_EQUIVALENT(
+                    [](std::uint32_t value) { return value; },
+                    [](std::uint32_t value) { return ~value; },
+                    Terra::STF::Integers<std::uint32_t>());
+            }
+        });
+
+    STF_ASSERT_EQ(limit + Extra, captured.failures);
+    STF_ASSERT_EQ(limit,
+                  CountOccurrences(captured.output, "Implementations differ"));
+}
@@ -16,7 +16,9 @@
  *      None.
  */
 
+#include <atomic>
 #include <cstdint>
+#include <cstddef>
 #include <terra/stf/stf.h>
 
 STF_TEST(DissimilarTypes, Equal)
@@ -244,3 +246,96 @@ STF_TEST(DissimilarTypes, False)
         STF_ASSERT_FALSE(i == j);
     }
 }
+
+STF_TEST(DissimilarTypes, Literals)
+{
+    // Integer literals are promoted to the wider or unsigned type without
+    // warnings, even though each operand is evaluated only once
+    {
+        std::uint64_t i = 1;
+
+        STF_ASSERT_EQ(1, i);
+        STF_ASSERT_NE(0, i);
+        STF_ASSERT_GT(i, 0);
+        STF_ASSERT_GE(i, 1);
+        STF_ASSERT_LT(0, i);
+        STF_ASSERT_LE(1, i);
+        STF_EXPECT_EQ(1, i);
+        STF_EXPECT_GT(i, 0);
+    }
+
+    {
+        std::size_t i = 3;
+
+        STF_ASSERT_EQ(3, i);
+        STF_ASSERT_LT(i, 4);
+    }
+
+    {
+        std::uint32_t i = 0xffffffff;
+
+        STF_ASSERT_EQ(0xffffffff, i);
+        STF_ASSERT_GT(i, 1);
+    }
+}
+
+STF_TEST(DissimilarTypes, MixedSigns)
+{
+    // Negative values compare less than any unsigned value, rather than
+    // being converted to large unsigned values
+    int negative = -1;
+    std::size_t size = 1;
+    std::uint32_t largest = 0xffffffff;
+    std::int64_t wide = 0x100000000;
+
+    STF_ASSERT_LT(negative, size);
+    STF_ASSERT_LE(negative, size);
+    STF_ASSERT_GT(size, negative);
+    STF_ASSERT_GE(size, negative);
+    STF_ASSERT_NE(negative, largest);
+    STF_ASSERT_NE(largest, negative);
+    STF_ASSERT_LT(-1, 0u);
+    STF_ASSERT_GT(wide, largest);
+    STF_ASSERT_EQ(std::int64_t(0xffffffff), largest);
+    STF_ASSERT_FALSE(Terra::STF::Compare<Terra::STF::Comparison::Equal>(
+        negative,
+        largest));
+    STF_ASSERT_FALSE(Terra::STF::Compare<Terra::STF::Comparison::Greater>(
+        negative,
+        size));
+
+    // The values of atomics are compared the same way
+    std::atomic<unsigned> count{2};
+    STF_ASSERT_EQ(2, count);
+    STF_ASSERT_GT(count, negative);
+}
+
+STF_TEST(DissimilarTypes, SingleEvaluation)
+{
+    unsigned calls = 0;
+    auto next = [&]() -> std::uint64_t { return ++calls; };
+
+    // Each operand is evaluated once when the assertion holds
+    STF_ASSERT_EQ(1, next());
+    STF_ASSERT_EQ(1, calls);
+    STF_ASSERT_LT(1, next());
+    STF_ASSERT_EQ(2, calls);
+
+    // The failure path prints the values already captured rather than
+    // evaluating the operands again; discard the failure message produced
+    // here since this failure is deliberate
+    bool result = Terra::STF::CheckEqual(__FILE__, __LINE__, 5, next());
+    Terra::STF::PendingOutput().Clear();
+    STF_ASSERT_FALSE(result);
+    STF_ASSERT_EQ(3, calls);
+
+    result = Terra::STF::CheckCompare(
+        __FILE__,
+        __LINE__,
+        0,
+        next(),
+        Terra::STF::ComparisonTag<Terra::STF::Comparison::Greater>{});
+    Terra::STF::PendingOutput().Clear();
+    STF_ASSERT_FALSE(result);
+    STF_ASSERT_EQ(4, calls);
+}
@@ -16,7 +16,13 @@
  *      None.
  */
 
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <new>
 #include <stdexcept>
+#include <string>
 #include <terra/stf/stf.h>
 
 class CustomException : public std::runtime_error
@@ -24,6 +30,46 @@ class CustomException : public std::runtime_error
     using std::runtime_error::runtime_error;
 };
 
+// Exception that carries no message and so requires no allocation
+struct PlainException
+{
+    int code;
+};
+
+namespace
+{
+
+// Count of allocations made through the global operator new
+std::atomic<std::size_t> Allocations{};
+
+// Function that throws, to test passing function pointers
+void ThrowCustomException()
+{
+    throw CustomException("");
+}
+
+} // namespace
+
+// Replace the global allocation functions to count allocations
+void *operator new(std::size_t size)
+{
+    Allocations++;
+
+    if (void *p = std::malloc(size == 0 ? 1 : size)) return p;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
 STF_TEST(Exceptions, TestThrowUnnamed)
 {
     auto test_throw_unnamed = [] { throw "Unnamed"; };
@@ -55,3 +101,66 @@ STF_TEST(Exceptions, TestDirectLambdaInsertion2)
 {
     STF_ASSERT_EXCEPTION_E([] { throw CustomException(""); }, CustomException);
 }
+
+STF_TEST(Exceptions, TestFunctionObject)
+{
+    std::function<void()> test_throw = [] { throw CustomException(""); };
+
+    STF_ASSERT_EXCEPTION(test_throw);
+    STF_ASSERT_EXCEPTION_E(test_throw, CustomException);
+}
+
+STF_TEST(Exceptions, TestFunctionPointer)
+{
+    STF_ASSERT_EXCEPTION(ThrowCustomException);
+    STF_ASSERT_EXCEPTION_E(&ThrowCustomException, CustomException);
+}
+
+STF_TEST(Exceptions, TestMutableLambda)
+{
+    unsigned calls = 0;
+    auto test_throw = [calls]() mutable
+    {
+        calls++;
+        throw PlainException{static_cast<int>(calls)};
+    };
+
+    STF_ASSERT_EXCEPTION_E(test_throw, PlainException);
+    STF_EXPECT_EXCEPTION_E(test_throw, PlainException);
+}
+
+STF_TEST(Exceptions, TestNoAllocation)
+{
+    // A capture this large would not fit in std::function's small buffer
+    std::array<std::size_t, 64> values{};
+    values[63] = 42;
+
+    auto test_throw = [values] { throw PlainException{int(values[63])}; };
+    auto test_other = [] { throw CustomException(""); };
+
+    std::size_t allocations = Allocations.load();
+
+    for (std::size_t i = 0; i < 1000; i++)
+    {
+        STF_ASSERT_EXCEPTION(test_throw);
+        STF_ASSERT_EXCEPTION_E(test_throw, PlainException);
+        STF_ASSERT_EXCEPTION_E([values] { throw PlainException{}; },
+                               PlainException);
+    }
+
+    // Invoking the lambda directly requires no memory allocation
+    STF_ASSERT_EQ(allocations, Allocations.load());
+
+    // Other exceptions still fail the assertion for a specific type
+    auto captured = Terra::STF::CaptureOutput(
+        [&]
+        {
+            STF_EXPECT_EXCEPTION_E(test_other, PlainException);
+        });
+
+    STF_ASSERT_EQ(1, captured.failures);
+    STF_ASSERT_NE(std::string::npos,
+                  captured.output.find("exception of type PlainException"));
+    STF_ASSERT_NE(std::string::npos,
+                  captured.output.find("some other exception thrown"));
+}
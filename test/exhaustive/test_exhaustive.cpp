@@ -0,0 +1,163 @@
+/*
+ *  test_exhaustive.cpp
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Module to exercise tests run over every value of an input.
+ *
+ *  Portability Issues:
+ *      None.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <terra/stf/exhaustive.h>
+
+namespace
+{
+
+std::uint16_t SwapOctets(std::uint16_t value)
+{
+    return static_cast<std::uint16_t>((value << 8) | (value >> 8));
+}
+
+// Run over a domain in a scratch context, counting visits to each value
+Terra::STF::CapturedOutput RunScratch(
+    const Terra::STF::ExhaustiveOptions &options,
+    std::vector<std::atomic<unsigned>> &visits,
+    std::uint32_t failing_value = 0xffffffff)
+{
+    return Terra::STF::CaptureOutput(
+        [&]
+        {
+            Terra::STF::RunExhaustive<std::uint32_t>(
+                options,
+                [&](std::uint32_t value)
+                {
+                    visits[value]++;
+                    STF_ASSERT_NE(failing_value, value);
+                });
+        });
+}
+
+// Return the path of a checkpoint file for the tests below
+std::string CheckpointPath()
+{
+    return (std::filesystem::temp_directory_path() /
+            "stf_test_exhaustive.checkpoint")
+        .string();
+}
+
+} // namespace
+
+STF_EXHAUSTIVE_U16(Exhaustive, SwapOctets)
+{
+    STF_ASSERT_EQ(value, SwapOctets(SwapOctets(value)));
+}
+
+STF_TEST(Exhaustive, EveryValueOnce)
+{
+    std::vector<std::atomic<unsigned>> visits(1 << 20);
+
+    auto captured = RunScratch({20, 0, 1, {}}, visits);
+
+    STF_ASSERT_FALSE(captured.failed);
+    STF_ASSERT_EQ(0, captured.output.find(" [1048576 values, "));
+    for (std::size_t i = 0; i < visits.size(); i++)
+    {
+        STF_ASSERT_EQ(1, visits[i]);
+    }
+}
+
+STF_TEST(Exhaustive, Shard)
+{
+    std::vector<std::atomic<unsigned>> visits(1 << 16);
+
+    // Shard 1 of 4 has every fourth 16-value chunk, starting with the second
+    auto captured = RunScratch({16, 1, 4, {}}, visits);
+
+    STF_ASSERT_FALSE(captured.failed);
+    STF_ASSERT_EQ(0, captured.output.find(" [shard 1/4: 16384 values, "));
+    for (std::size_t i = 0; i < visits.size(); i++)
+    {
+        STF_ASSERT_EQ(((i / 16) % 4 == 1) ? 1 : 0, visits[i]);
+    }
+
+    STF_ASSERT_EQ(Terra::STF::Exhaustive_Timeout,
+                  Terra::STF::ShardTimeout(Terra::STF::Exhaustive_Timeout));
+}
+
+STF_TEST(Exhaustive, FailureReported)
+{
+    std::vector<std::atomic<unsigned>> visits(1 << 16);
+
+    auto captured = RunScratch({16, 0, 1, {}}, visits, 12345);
+
+    STF_ASSERT_EQ(1, captured.failures);
+    STF_ASSERT_NE(std::string::npos, captured.output.find("Assertion failed"));
+    STF_ASSERT_NE(std::string::npos,
+                  captured.output.find("Failed for value 12345 (0x3039)"));
+}
+
+STF_TEST(Exhaustive, Checkpoint)
+{
+    const std::string path = CheckpointPath();
+    Terra::STF::ExhaustiveOptions options{16, 0, 1, path};
+
+    // A failing run records the chunks it completed
+    {
+        std::vector<std::atomic<unsigned>> visits(1 << 16);
+
+        std::filesystem::remove(path);
+        auto captured = RunScratch(options, visits, 0x8000);
+
+        STF_ASSERT_TRUE(captured.failed);
+        STF_ASSERT_TRUE(std::filesystem::exists(path));
+
+        std::ifstream file(path);
+        std::string line;
+        STF_ASSERT_TRUE(static_cast<bool>(std::getline(file, line)));
+        STF_ASSERT_EQ(std::string("stf-checkpoint 16 0/1"), line);
+        while (std::getline(file, line))
+        {
+            STF_ASSERT_NE(std::string("2048"), line);
+        }
+    }
+
+    // A resumed run skips chunks recorded in the checkpoint
+    {
+        std::ofstream file(path, std::ios::trunc);
+        file << "stf-checkpoint 16 0/1\n";
+        for (int i = 0; i < 100; i++) file << i << "\n";
+        file << "10";
+    }
+    {
+        std::vector<std::atomic<unsigned>> visits(1 << 16);
+
+        auto captured = RunScratch(options, visits);
+
+        STF_ASSERT_FALSE(captured.failed);
+        STF_ASSERT_NE(std::string::npos,
+                      captured.output.find(" [63936 values, "));
+        STF_ASSERT_NE(std::string::npos,
+                      captured.output.find("resumed after 100 chunks]"));
+        STF_ASSERT_EQ(0, visits[0]);
+        STF_ASSERT_EQ(0, visits[1599]);
+        STF_ASSERT_EQ(1, visits[1600]);
+        STF_ASSERT_EQ(1, visits[65535]);
+
+        // The checkpoint is removed once every chunk has passed
+        STF_ASSERT_FALSE(std::filesystem::exists(path));
+    }
+}
@@ -0,0 +1,193 @@
+/*
+ *  test_expect.cpp
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Module to exercise the non-fatal STF_EXPECT_* assertions.
+ *
+ *  Portability Issues:
+ *      None.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+
+// Number of times a Counted value has been formatted
+std::size_t Counted_Formatted = 0;
+
+// A value that counts the number of times it is formatted
+struct Counted
+{
+    int value;
+
+    bool operator==(const Counted &other) const
+    {
+        return value == other.value;
+    }
+};
+
+std::ostream &operator<<(std::ostream &o, const Counted &counted)
+{
+    Counted_Formatted++;
+
+    return o << counted.value;
+}
+
+// Count the occurrences of a string within some text
+std::size_t CountOccurrences(const std::string &text, std::string_view what)
+{
+    std::size_t count = 0;
+
+    for (std::size_t position = text.find(what);
+         position != std::string::npos;
+         position = text.find(what, position + what.size()))
+    {
+        count++;
+    }
+
+    return count;
+}
+
+} // namespace
+
+#include <terra/stf/stf.h>
+
+STF_TEST(Expect, Comparisons)
+{
+    int a = 1;
+    long b = 2;
+
+    STF_EXPECT_EQ(a, a);
+    STF_EXPECT_NE(a, b);
+    STF_EXPECT_GT(b, a);
+    STF_EXPECT_GE(b, a);
+    STF_EXPECT_GE(a, a);
+    STF_EXPECT_LT(a, b);
+    STF_EXPECT_LE(a, b);
+    STF_EXPECT_LE(b, b);
+    STF_EXPECT_TRUE(a < b);
+    STF_EXPECT_FALSE(a > b);
+}
+
+STF_TEST(Expect, Floats)
+{
+    std::vector<double> values = {1.0, 2.0, 3.0};
+
+    STF_EXPECT_CLOSE(1.0, 1.0000001, 0.001);
+    STF_EXPECT_NEAR(1.0e6, 1.000001e6, 0.0, 1.0e-5);
+    STF_EXPECT_ULP_EQ(1.0f, 1.0f, 0);
+    STF_EXPECT_ARRAY_CLOSE(values.data(),
+                           values.data(),
+                           values.size(),
+                           0.0,
+                           0.0);
+}
+
+STF_TEST(Expect, Memory)
+{
+    const std::uint8_t a[] = {0x01, 0x02, 0x03};
+    const std::uint8_t b[] = {0x01, 0x02, 0x04};
+
+    STF_EXPECT_MEM_EQ(a, a, sizeof(a));
+    STF_EXPECT_MEM_NE(a, b, sizeof(a));
+}
+
+STF_TEST(Expect, Exceptions)
+{
+    STF_EXPECT_EXCEPTION([] { throw std::runtime_error("error"); });
+    STF_EXPECT_EXCEPTION_E([] { throw std::runtime_error("error"); },
+                           std::runtime_error);
+}
+
+STF_TEST(Expect, TableDriven)
+{
+    struct TestVector
+    {
+        unsigned input;
+        unsigned expected;
+    };
+    const TestVector vectors[] =
+    {
+        {0, 0}, {1, 1}, {2, 4}, {3, 9}, {4, 16}, {5, 25}
+    };
+
+    // Each entry is checked even if an earlier one fails
+    for (const auto &vector : vectors)
+    {
+        STF_EXPECT_EQ(vector.expected, vector.input * vector.input);
+    }
+}
+
+STF_TEST(Expect, ContinuesAfterFailure)
+{
+    bool finished = false;
+
+    auto captured = Terra::STF::CaptureOutput(
+        [&]
+        {
+            STF_EXPECT_EQ(1, 2);
+            STF_EXPECT_TRUE(false);
+            finished = true;
+        });
+
+    // Both failures are reported and the test ran to its end
+    STF_ASSERT_TRUE(finished);
+    STF_ASSERT_EQ(2, captured.failures);
+    STF_ASSERT_EQ(2, CountOccurrences(captured.output, "Assertion failed at"));
+}
+
+STF_TEST(Expect, ReportingLimit)
+{
+    constexpr std::size_t Extra = 5;
+    const std::size_t limit = Terra::STF::Expect_Report_Limit;
+
+    Terra::STF::TestContext context("Scratch");
+    std::size_t checked = 0;
+
+    Counted_Formatted = 0;
+
+    {
+        Terra::STF::ContextScope scope(&context);
+
+        for (std::size_t i = 0; i < limit + Extra; i++)
+        {
+            STF_EXPECT_EQ(Counted{1}, Counted{2});
+            checked++;
+        }
+    }
+
+    // Every failure is counted, but only those up to the limit are shown,
+    // and those beyond it are not formatted at all
+    STF_ASSERT_EQ(limit + Extra, checked);
+    STF_ASSERT_EQ(limit + Extra, context.Failures());
+
+    std::string output = context.TakeOutput();
+    STF_ASSERT_EQ(limit, CountOccurrences(output, "Assertion failed at"));
+    STF_ASSERT_EQ(1, CountOccurrences(output, "reporting limit of"));
+    STF_ASSERT_EQ(2 * limit, Counted_Formatted);
+
+    // The summary gives the number suppressed and the total failures
+    Terra::STF::Formatter summary;
+    context.Summarize(summary);
+    STF_ASSERT_EQ(1,
+                  CountOccurrences(summary.String(),
+                                   ": 5 additional failure(s) not shown"));
+    STF_ASSERT_NE(std::string::npos,
+                  summary.String().find("\"Scratch\" failed with " +
+                                        std::to_string(limit + Extra) +
+                                        " assertion failure(s)"));
+}
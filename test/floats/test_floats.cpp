@@ -16,6 +16,11 @@
  *      None.
  */
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
 #include <terra/stf/stf.h>
 
 STF_TEST(Floats, SingleEquality)
@@ -181,3 +186,249 @@ STF_TEST(floats, DoubleFalse)
 
     STF_ASSERT_FALSE(i == j);
 }
+
+STF_TEST(Floats, SingleNear)
+{
+    // Relative tolerance scales with the magnitude of the values
+    STF_ASSERT_NEAR(1.0e10f, 1.00001e10f, 0.0f, 1.0e-4f);
+    STF_ASSERT_NEAR(1.0e-10f, 1.00001e-10f, 0.0f, 1.0e-4f);
+
+    // Absolute tolerance is useful for values near zero
+    STF_ASSERT_NEAR(0.0f, 1.0e-7f, 1.0e-6f, 1.0e-4f);
+}
+
+STF_TEST(Floats, DoubleNear)
+{
+    STF_ASSERT_NEAR(1.0e100, 1.0000001e100, 0.0, 1.0e-6);
+    STF_ASSERT_NEAR(0.0, -1.0e-12, 1.0e-9, 0.0);
+
+    // Equal infinities are near one another
+    STF_ASSERT_NEAR(std::numeric_limits<double>::infinity(),
+                    std::numeric_limits<double>::infinity(),
+                    0.0,
+                    0.0);
+}
+
+STF_TEST(Floats, SingleUlpEqual)
+{
+    float f1 = 1.0f;
+    float f2 = std::nextafter(f1, 2.0f);
+
+    STF_ASSERT_ULP_EQ(f1, f1, 0);
+    STF_ASSERT_ULP_EQ(f1, f2, 1);
+
+    // Positive and negative zero are equal
+    STF_ASSERT_ULP_EQ(0.0f, -0.0f, 0);
+
+    // The smallest denormals either side of zero are two ULPs apart
+    STF_ASSERT_ULP_EQ(std::numeric_limits<float>::denorm_min(),
+                      -std::numeric_limits<float>::denorm_min(),
+                      2);
+}
+
+STF_TEST(Floats, DoubleUlpEqual)
+{
+    double d1 = 1.0;
+    double d2 = std::nextafter(std::nextafter(d1, 0.0), 0.0);
+
+    STF_ASSERT_ULP_EQ(d1, d2, 2);
+    STF_ASSERT_ULP_EQ(std::numeric_limits<double>::max(),
+                      std::numeric_limits<double>::infinity(),
+                      1);
+}
+
+STF_TEST(Floats, SingleArrayClose)
+{
+    std::vector<float> expected(1001);
+    std::vector<float> actual(1001);
+
+    for (std::size_t i = 0; i < expected.size(); i++)
+    {
+        expected[i] = static_cast<float>(i) * 0.25f;
+        actual[i] = expected[i] * (1.0f + 1.0e-7f);
+    }
+
+    STF_ASSERT_ARRAY_CLOSE(expected.data(),
+                           actual.data(),
+                           expected.size(),
+                           0.0f,
+                           1.0e-6f);
+}
+
+STF_TEST(Floats, DoubleArrayClose)
+{
+    std::vector<double> expected(999);
+    std::vector<double> actual(999);
+
+    for (std::size_t i = 0; i < expected.size(); i++)
+    {
+        expected[i] = std::sin(static_cast<double>(i));
+        actual[i] = expected[i] + 1.0e-12;
+    }
+
+    STF_ASSERT_ARRAY_CLOSE(expected.data(),
+                           actual.data(),
+                           expected.size(),
+                           1.0e-10,
+                           0.0);
+}
+
+STF_TEST(Floats, NotCloseReported)
+{
+    std::vector<float> expected(100);
+    for (std::size_t i = 0; i < expected.size(); i++)
+    {
+        expected[i] = static_cast<float>(i);
+    }
+    std::vector<float> actual = expected;
+    actual[10] += 0.5f;
+    actual[42] += 3.0f;
+
+    auto captured = Terra::STF::CaptureOutput(
+        [&]
+        {
+            STF_EXPECT_ARRAY_CLOSE(expected.data(),
+                                   actual.data(),
+                                   expected.size(),
+                                   0.0f,
+                                   1.0e-3f);
+            STF_EXPECT_ULP_EQ(1.0f,
+                              std::nextafter(std::nextafter(
+                                  std::nextafter(1.0f, 2.0f), 2.0f), 2.0f),
+                              2);
+            STF_EXPECT_NEAR(100.0, 100.5, 0.1, 1.0e-3);
+        });
+
+    const std::string &output = captured.output;
+    STF_ASSERT_EQ(3, captured.failures);
+
+    // The array failure gives the count, the largest errors, and the worst
+    // element with its values
+    STF_ASSERT_NE(std::string::npos,
+                  output.find("  elements not close: 2 of 100\n"));
+    STF_ASSERT_NE(std::string::npos,
+                  output.find("  max abs error: 3 (index 42)\n"));
+    STF_ASSERT_NE(std::string::npos,
+                  output.find("  max ulp error: 786432 (index 42)\n"));
+    STF_ASSERT_NE(std::string::npos,
+                  output.find("  worst element: index 42\n"));
+    STF_ASSERT_NE(std::string::npos, output.find("  expected: 42\n"));
+    STF_ASSERT_NE(std::string::npos, output.find("    actual: 45\n"));
+
+    // The ULP failure gives the distance and the limit
+    STF_ASSERT_NE(std::string::npos, output.find("  ulps: 3 (maximum 2)\n"));
+
+    // The relative tolerance failure gives both values
+    STF_ASSERT_NE(std::string::npos, output.find("100.5"));
+}
+
+STF_TEST(Floats, SingleTensorClose)
+{
+    constexpr std::size_t Rows = 7;
+    constexpr std::size_t Columns = 13;
+    constexpr std::ptrdiff_t Pitch = 16;
+
+    // Expected values have padded rows; actual values are tightly packed
+    std::vector<float> expected(Rows * Pitch, -1.0f);
+    std::vector<float> actual(Rows * Columns);
+
+    for (std::size_t row = 0; row < Rows; row++)
+    {
+        for (std::size_t column = 0; column < Columns; column++)
+        {
+            float value = static_cast<float>(row * Columns + column) / 8.0f;
+            expected[row * Pitch + column] = value;
+            actual[row * Columns + column] = value * (1.0f + 1.0e-7f);
+        }
+    }
+
+    Terra::STF::TensorView<float> expected_view(expected.data(),
+                                                Rows,
+                                                Columns,
+                                                Pitch);
+    Terra::STF::TensorView<float> actual_view(actual.data(),
+                                              Rows,
+                                              Columns,
+                                              Columns);
+
+    STF_ASSERT_TENSOR_CLOSE(expected_view, actual_view, 1.0e-6f, 1.0e-6f);
+}
+
+STF_TEST(Floats, LargeTensorNotClose)
+{
+    // Large enough to be compared over several threads
+    constexpr std::size_t Rows = 512;
+    constexpr std::size_t Columns = 512;
+    constexpr std::size_t Bad_Row = 300;
+    constexpr std::size_t Bad_Column = 77;
+
+    std::vector<float> expected(Rows * Columns);
+    for (std::size_t i = 0; i < expected.size(); i++)
+    {
+        expected[i] = static_cast<float>(i % 1000) / 4.0f;
+    }
+    std::vector<float> actual = expected;
+    actual[Bad_Row * Columns + Bad_Column] += 1.0f;
+
+    Terra::STF::TensorView<float> expected_view(expected.data(),
+                                                Rows,
+                                                Columns,
+                                                Columns);
+    Terra::STF::TensorView<float> actual_view(actual.data(),
+                                              Rows,
+                                              Columns,
+                                              Columns);
+
+    auto captured = Terra::STF::CaptureOutput(
+        [&]
+        {
+            STF_EXPECT_TENSOR_CLOSE(expected_view,
+                                    actual_view,
+                                    1.0e-6f,
+                                    1.0e-6f);
+        });
+
+    // The one element is found whichever thread compares its row
+    const std::string &output = captured.output;
+    STF_ASSERT_EQ(1, captured.failures);
+    STF_ASSERT_NE(std::string::npos,
+                  output.find("elements not close: 1 of 262144\n"));
+    STF_ASSERT_NE(std::string::npos, output.find("    [300, 77] expected "));
+    STF_ASSERT_EQ(1, std::count(output.begin(), output.end(), '['));
+}
+
+STF_TEST(Floats, DoubleTensorClose)
+{
+    constexpr std::size_t Planes = 3;
+    constexpr std::size_t Rows = 64;
+    constexpr std::size_t Columns = 48;
+
+    // Expected values are planar; actual values are interleaved channels
+    std::vector<double> expected(Planes * Rows * Columns);
+    std::vector<double> actual(Planes * Rows * Columns);
+
+    for (std::size_t plane = 0; plane < Planes; plane++)
+    {
+        for (std::size_t row = 0; row < Rows; row++)
+        {
+            for (std::size_t column = 0; column < Columns; column++)
+            {
+                double value = std::cos(static_cast<double>(
+                    plane * 1000 + row * Columns + column));
+                expected[(plane * Rows + row) * Columns + column] = value;
+                actual[(row * Columns + column) * Planes + plane] = value;
+            }
+        }
+    }
+
+    Terra::STF::TensorView<double> expected_view(
+        expected.data(),
+        {Planes, Rows, Columns},
+        {Rows * Columns, Columns, 1});
+    Terra::STF::TensorView<double> actual_view(
+        actual.data(),
+        {Planes, Rows, Columns},
+        {1, Columns * Planes, Planes});
+
+    STF_ASSERT_TENSOR_CLOSE(expected_view, actual_view, 0.0, 0.0);
+}
@@ -0,0 +1,118 @@
+/*
+ *  test_fuzz.cpp
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Module to exercise fuzz targets replaying a corpus.
+ *
+ *  Portability Issues:
+ *      None.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <terra/stf/fuzz.h>
+
+namespace
+{
+
+// Parse records, each an octet length followed by that many octets
+bool ParseRecords(const std::uint8_t *data,
+                  std::size_t size,
+                  std::vector<std::string> &records)
+{
+    std::size_t position = 0;
+
+    while (position < size)
+    {
+        std::size_t length = data[position++];
+        if (length > size - position) return false;
+
+        records.emplace_back(reinterpret_cast<const char *>(data + position),
+                             length);
+        position += length;
+    }
+
+    return true;
+}
+
+// Fuzz target function that fails for inputs containing a zero octet
+void RejectsZero(const std::uint8_t *data, std::size_t size)
+{
+    for (std::size_t i = 0; i < size; i++) STF_ASSERT_NE(0, data[i]);
+}
+
+// Create a corpus directory holding the given files
+std::filesystem::path WriteCorpus(const std::string &name,
+                                  const std::vector<std::string> &files)
+{
+    std::filesystem::path directory =
+        std::filesystem::temp_directory_path() / name;
+
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    for (std::size_t i = 0; i < files.size(); i++)
+    {
+        std::ofstream file(directory / ("input" + std::to_string(i)),
+                           std::ios::binary);
+        file << files[i];
+    }
+
+    return directory;
+}
+
+} // namespace
+
+// Replays the corpus in corpus/Fuzz/Records
+STF_FUZZ(Fuzz, Records)(const std::uint8_t *data, std::size_t size)
+{
+    std::vector<std::string> records;
+
+    if (!ParseRecords(data, size, records)) return;
+
+    std::size_t total = 0;
+    for (const auto &record : records) total += 1 + record.size();
+
+    STF_ASSERT_EQ(size, total);
+}
+
+STF_FUZZ_CORPUS(Fuzz, MissingCorpus, "no/such/corpus")(const std::uint8_t *,
+                                                         std::size_t)
+{
+    STF_ASSERT_TRUE(false);
+}
+
+STF_TEST(Fuzz, FailingFileReported)
+{
+    std::filesystem::path directory =
+        WriteCorpus("stf_test_fuzz",
+                    {"abc", "", std::string("a\0c", 3), "xyz"});
+    // Only the file containing a zero fails
+    auto captured = Terra::STF::CaptureOutput(
+        [&]
+        {
+            Terra::STF::ReplayCorpus(directory.string(), RejectsZero);
+        });
+
+    std::filesystem::remove_all(directory);
+
+    STF_ASSERT_EQ(1, captured.failures);
+
+    const std::string &output = captured.output;
+    STF_ASSERT_EQ(0, output.find(" [4 instances]"));
+    STF_ASSERT_NE(std::string::npos,
+                  output.find("corpus file: " +
+                              (directory / "input2").string()));
+    STF_ASSERT_NE(std::string::npos, output.find("1 of 4 instance(s) failed"));
+}
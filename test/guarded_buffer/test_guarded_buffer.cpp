@@ -0,0 +1,239 @@
+/*
+ *  test_guarded_buffer.cpp
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Module to exercise guarded buffers and alignment sweeps.
+ *
+ *  Portability Issues:
+ *      The tests that expect faults require guard pages (POSIX systems).
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <string>
+#include <vector>
+#include <terra/stf/guarded_buffer.h>
+
+namespace
+{
+
+// Sum octets one at a time
+std::uint64_t SumReference(const std::uint8_t *data, std::size_t length)
+{
+    std::uint64_t sum = 0;
+
+    for (std::size_t i = 0; i < length; i++) sum += data[i];
+
+    return sum;
+}
+
+// Sum octets eight at a time, then the remainder
+std::uint64_t SumBlocks(const std::uint8_t *data, std::size_t length)
+{
+    std::uint64_t sum = 0;
+    std::size_t i = 0;
+
+    for (; i + 8 <= length; i += 8)
+    {
+        std::uint8_t block[8];
+        std::memcpy(block, data + i, sizeof(block));
+        for (std::uint8_t octet : block) sum += octet;
+    }
+    for (; i < length; i++) sum += data[i];
+
+    return sum;
+}
+
+// Sum octets eight at a time, reading a whole block for the remainder
+std::uint64_t SumOverRead(const std::uint8_t *data, std::size_t length)
+{
+    std::uint64_t sum = 0;
+
+    for (std::size_t i = 0; i < length; i += 8)
+    {
+        std::uint8_t block[8];
+        std::memcpy(block, data + i, sizeof(block));
+        for (std::size_t j = 0; (j < 8) && (i + j < length); j++)
+        {
+            sum += block[j];
+        }
+    }
+
+    return sum;
+}
+
+// Complement octets one at a time
+void ComplementReference(const std::uint8_t *input,
+                         std::uint8_t *output,
+                         std::size_t length)
+{
+    for (std::size_t i = 0; i < length; i++) output[i] = ~input[i] & 0xff;
+}
+
+// Complement octets, writing one octet too many
+void ComplementOverWrite(const std::uint8_t *input,
+                         std::uint8_t *output,
+                         std::size_t length)
+{
+    ComplementReference(input, output, length);
+    if (length > 0) output[length] = 0;
+}
+
+// Return the output of a sweep run in a scratch context
+template<typename Sweep>
+std::string SweepOutput(Sweep sweep)
+{
+    return Terra::STF::CaptureOutput(sweep).output;
+}
+
+} // namespace
+
+STF_TEST(GuardedBuffer, Alignment)
+{
+    for (std::size_t alignment = 0; alignment < 64; alignment += 7)
+    {
+        for (std::size_t size : {0, 1, 63, 64, 65, 4096})
+        {
+            Terra::STF::GuardedBuffer after(size,
+                                            alignment,
+                                            Terra::STF::GuardSide::After);
+            Terra::STF::GuardedBuffer before(size,
+                                             alignment,
+                                             Terra::STF::GuardSide::Before);
+
+            auto offset = [](const std::uint8_t *data)
+            {
+                return reinterpret_cast<std::uintptr_t>(data) % 64;
+            };
+
+            STF_ASSERT_EQ(alignment, offset(after.Data()));
+            STF_ASSERT_EQ(alignment, offset(before.Data()));
+            STF_ASSERT_EQ(size, after.Size());
+            STF_ASSERT_TRUE(after.Intact());
+            STF_ASSERT_TRUE(before.Intact());
+        }
+    }
+}
+
+STF_TEST(GuardedBuffer, Canary)
+{
+    Terra::STF::GuardedBuffer buffer(10, 0);
+
+    buffer.Data()[9] = 1;
+    STF_ASSERT_TRUE(buffer.Intact());
+
+    buffer.Data()[10] = 1;
+    STF_ASSERT_FALSE(buffer.Intact());
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+
+STF_TEST(GuardedBuffer, FaultAfter)
+{
+    // An alignment of 48 puts the end of 16 octets against the guard page
+    Terra::STF::GuardedBuffer buffer(16, 48, Terra::STF::GuardSide::After);
+    volatile const std::uint8_t *data = buffer.Data();
+
+    auto fault = Terra::STF::RunGuarded([&] { (void) data[15]; });
+    STF_ASSERT_FALSE(fault.has_value());
+
+    fault = Terra::STF::RunGuarded([&] { (void) data[16]; });
+    STF_ASSERT_TRUE(fault.has_value());
+    STF_ASSERT_EQ(std::string("1 octet(s) past the end"),
+                  buffer.Locate(*fault));
+}
+
+STF_TEST(GuardedBuffer, FaultBefore)
+{
+    Terra::STF::GuardedBuffer buffer(16, 0, Terra::STF::GuardSide::Before);
+    volatile std::uint8_t *data = buffer.Data();
+
+    auto fault = Terra::STF::RunGuarded([&] { data[0] = 1; });
+    STF_ASSERT_FALSE(fault.has_value());
+
+    fault = Terra::STF::RunGuarded([&] { data[-3] = 1; });
+    STF_ASSERT_TRUE(fault.has_value());
+    STF_ASSERT_EQ(std::string("3 octet(s) before the start"),
+                  buffer.Locate(*fault));
+}
+
+STF_TEST(GuardedBuffer, OverReadReported)
+{
+    std::vector<std::uint8_t> source(80);
+    std::iota(source.begin(), source.end(), 1);
+
+    std::string output = SweepOutput(
+        [&]
+        {
+            Terra::STF::SweepAlignments(source, SumOverRead, SumReference);
+        });
+
+    // Faults occur where a partial block ends near the guard page
+    STF_ASSERT_NE(std::string::npos, output.find("10368 instances"));
+    STF_ASSERT_NE(std::string::npos,
+                  output.find("guard page: after, alignment: 1, length: 63"));
+    STF_ASSERT_NE(std::string::npos,
+                  output.find("Guard page touched 1 octet(s) past the end "
+                              "of the input"));
+}
+
+#endif
+
+STF_TEST(GuardedBuffer, OverWriteReported)
+{
+    std::vector<std::uint8_t> source(16);
+    std::iota(source.begin(), source.end(), 1);
+
+    std::string output = SweepOutput(
+        [&]
+        {
+            Terra::STF::SweepTransform(source,
+                                       ComplementOverWrite,
+                                       ComplementReference);
+        });
+
+    STF_ASSERT_NE(std::string::npos,
+                  output.find("guard page: after, alignment: 0, length: 1"));
+    STF_ASSERT_NE(std::string::npos,
+                  output.find("Octets next to the output were modified"));
+}
+
+STF_TEST(GuardedBuffer, Sweep)
+{
+    std::vector<std::uint8_t> source(256);
+    std::iota(source.begin(), source.end(), 0);
+
+    Terra::STF::SweepAlignments(source, SumBlocks, SumReference);
+}
+
+STF_TEST(GuardedBuffer, SweepTransform)
+{
+    std::vector<float> source(64);
+    std::iota(source.begin(), source.end(), 0.5f);
+
+    Terra::STF::SweepTransform(
+        source,
+        [](const float *input, float *output, std::size_t length)
+        {
+            for (std::size_t i = 0; i < length; i++)
+            {
+                output[i] = input[i] * 2.0f;
+            }
+        },
+        [](const float *input, float *output, std::size_t length)
+        {
+            for (std::size_t i = 0; i < length; i++)
+            {
+                output[i] = input[i] + input[i];
+            }
+        });
+}
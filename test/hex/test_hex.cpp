@@ -0,0 +1,91 @@
+/*
+ *  test_hex.cpp
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Module to exercise the conversion of hexadecimal strings into arrays
+ *      at compile time.
+ *
+ *  Portability Issues:
+ *      None.
+ */
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <terra/stf/adapters/integral_array.h>
+#include <terra/stf/hex.h>
+#include <terra/stf/stf.h>
+
+namespace
+{
+
+// Arrays converted at compile time
+constexpr auto Key = Terra::STF::HexArray("000102030405060708090a0b0c0d0e0f");
+constexpr auto Mixed = Terra::STF::HexArray("aBcDeF"
+                                            "7f80");
+constexpr auto Empty = Terra::STF::HexArray("");
+
+static_assert(Key.size() == 16);
+static_assert(Key[15] == 0x0f);
+static_assert(Mixed.size() == 5);
+static_assert((Mixed[0] == 0xab) && (Mixed[1] == 0xcd) && (Mixed[2] == 0xef) &&
+              (Mixed[3] == 0x7f) && (Mixed[4] == 0x80));
+static_assert(Empty.size() == 0);
+
+} // namespace
+
+STF_TEST(Hex, HexArray)
+{
+    const std::array<std::uint8_t, 16> expected =
+    {
+        0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+        0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+    };
+
+    STF_ASSERT_EQ(expected, Key);
+}
+
+STF_TEST(Hex, InvalidAtRunTime)
+{
+    // Not constexpr, so the invalid digit is found at run time
+    STF_ASSERT_EXCEPTION_E([]() { Terra::STF::HexArray("00zz"); },
+                           std::invalid_argument);
+}
+
+STF_TEST(Hex, PrintedAsHex)
+{
+    auto captured = Terra::STF::CaptureOutput(
+        [&]
+        {
+            STF_EXPECT_EQ(Terra::STF::HexArray("00ff10"),
+                          Terra::STF::HexArray("00ff11"));
+        });
+
+    const std::string &output = captured.output;
+    STF_ASSERT_NE(std::string::npos, output.find("0x00 ff 10"));
+    STF_ASSERT_NE(std::string::npos, output.find("0x00 ff 11"));
+}
+
+#if defined(__cpp_nontype_template_args) && \
+    (__cpp_nontype_template_args >= 201911L) && \
+    defined(__cpp_consteval) && (__cpp_consteval >= 201811L)
+
+STF_TEST(Hex, Literal)
+{
+    using namespace Terra::STF::Literals;
+
+    auto key = "000102030405060708090a0b0c0d0e0f"_hex;
+
+    STF_ASSERT_EQ(Key, key);
+    STF_ASSERT_EQ(3, "c0ffee"_hex.size());
+}
+
+#endif
@@ -17,7 +17,8 @@
  */
 
 #include <cstdint>
-#include <terra/stf/stf.h>
+#include <limits>
+#include <terra/stf/parameterized.h>
 
 STF_TEST(Integrals, Equal)
 {
@@ -371,3 +372,24 @@ STF_TEST(Integrals, VariousCharTypes)
         STF_ASSERT_EQ(i, j);
     }
 }
+
+STF_TEST_TYPED(Integrals,
+               Limits,
+               Terra::STF::Types<std::int8_t,
+                                 std::uint8_t,
+                                 std::int16_t,
+                                 std::uint16_t,
+                                 std::int32_t,
+                                 std::uint32_t,
+                                 std::int64_t,
+                                 std::uint64_t>)
+{
+    TypeParam lowest = std::numeric_limits<TypeParam>::min();
+    TypeParam highest = std::numeric_limits<TypeParam>::max();
+
+    STF_ASSERT_LT(lowest, highest);
+    STF_ASSERT_NE(lowest, highest);
+    STF_ASSERT_EQ(highest, highest);
+    STF_ASSERT_GE(TypeParam(0), lowest);
+    STF_ASSERT_LE(TypeParam(0), highest);
+}
@@ -0,0 +1,182 @@
+/*
+ *  test_isa.cpp
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Module to exercise tests replicated for each ISA level.
+ *
+ *  Portability Issues:
+ *      None.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <terra/stf/isa.h>
+
+namespace
+{
+
+// Sum kernels standing in for scalar and vectorized implementations
+std::uint64_t SumScalar(const std::uint32_t *data, std::size_t length)
+{
+    std::uint64_t sum = 0;
+
+    for (std::size_t i = 0; i < length; i++) sum += data[i];
+
+    return sum;
+}
+
+std::uint64_t SumUnrolled(const std::uint32_t *data, std::size_t length)
+{
+    std::uint64_t sums[4] = {};
+    std::size_t i = 0;
+
+    for (; i + 4 <= length; i += 4)
+    {
+        for (std::size_t j = 0; j < 4; j++) sums[j] += data[i + j];
+    }
+    for (; i < length; i++) sums[0] += data[i];
+
+    return sums[0] + sums[1] + sums[2] + sums[3];
+}
+
+// Dispatcher selecting a kernel by the permitted ISA level
+std::uint64_t Sum(const std::uint32_t *data, std::size_t length)
+{
+    if (Terra::STF::ISAEnabled(Terra::STF::ISALevel::SSE4))
+    {
+        return SumUnrolled(data, length);
+    }
+
+    return SumScalar(data, length);
+}
+
+} // namespace
+
+STF_TEST_ISA(ISA, Dispatch)
+{
+    std::vector<std::uint32_t> data(1000);
+
+    for (std::size_t i = 0; i < data.size(); i++)
+    {
+        data[i] = static_cast<std::uint32_t>(i);
+    }
+
+    STF_ASSERT_EQ(499500U, Sum(data.data(), data.size()));
+}
+
+STF_TEST_ISA_TIMED(ISA, DispatchTimed)
+{
+    std::vector<std::uint32_t> data(100000);
+
+    for (std::size_t i = 0; i < data.size(); i++)
+    {
+        data[i] = static_cast<std::uint32_t>(i);
+    }
+
+    STF_ASSERT_EQ(4999950000U, Sum(data.data(), data.size()));
+}
+
+STF_TEST(ISA, LevelsRun)
+{
+    const auto levels = static_cast<unsigned>(Terra::STF::HostISALevel()) + 1;
+    std::vector<Terra::STF::ISALevel> levels_run;
+
+    auto captured = Terra::STF::CaptureOutput(
+        [&]
+        {
+            Terra::STF::RunISALevels(
+                [&]() { levels_run.push_back(Terra::STF::ISALimit()); });
+        });
+
+    STF_ASSERT_FALSE(captured.failed);
+
+    // Each level is run once, in order
+    STF_ASSERT_EQ(levels, levels_run.size());
+    for (std::size_t i = 0; i < levels_run.size(); i++)
+    {
+        STF_ASSERT_EQ(i, static_cast<unsigned>(levels_run[i]));
+    }
+
+    // The limit returns to the host's level once the test completes
+    STF_ASSERT_TRUE(Terra::STF::ISALimit() == Terra::STF::HostISALevel());
+}
+
+STF_TEST(ISA, TimedLevelsRun)
+{
+    const auto levels = static_cast<unsigned>(Terra::STF::HostISALevel()) + 1;
+    std::vector<Terra::STF::ISALevel> levels_run;
+
+    auto captured = Terra::STF::CaptureOutput(
+        [&]
+        {
+            Terra::STF::RunISALevels(
+                [&]() { levels_run.push_back(Terra::STF::ISALimit()); },
+                Terra::STF::ISA_Timing_Runs);
+        });
+
+    STF_ASSERT_FALSE(captured.failed);
+
+    // Each level is run ISA_Timing_Runs times before the next
+    STF_ASSERT_EQ(levels * Terra::STF::ISA_Timing_Runs, levels_run.size());
+    for (std::size_t i = 0; i < levels_run.size(); i++)
+    {
+        STF_ASSERT_EQ(i / Terra::STF::ISA_Timing_Runs,
+                      static_cast<unsigned>(levels_run[i]));
+    }
+}
+
+STF_TEST(ISA, LimitScope)
+{
+    {
+        Terra::STF::ISALimitScope scope(Terra::STF::ISALevel::Scalar);
+
+        STF_ASSERT_TRUE(Terra::STF::ISAEnabled(Terra::STF::ISALevel::Scalar));
+        STF_ASSERT_FALSE(Terra::STF::ISAEnabled(Terra::STF::ISALevel::SSE4));
+    }
+
+    STF_ASSERT_TRUE(Terra::STF::ISALimit() == Terra::STF::HostISALevel());
+}
+
+STF_TEST(ISA, Names)
+{
+    STF_ASSERT_EQ(std::string("scalar"),
+                  Terra::STF::ISAName(Terra::STF::ISALevel::Scalar));
+    STF_ASSERT_EQ(std::string("sse4"),
+                  Terra::STF::ISAName(Terra::STF::ISALevel::SSE4));
+    STF_ASSERT_EQ(std::string("avx2"),
+                  Terra::STF::ISAName(Terra::STF::ISALevel::AVX2));
+    STF_ASSERT_EQ(std::string("avx512"),
+                  Terra::STF::ISAName(Terra::STF::ISALevel::AVX512));
+}
+
+STF_TEST(ISA, FailureReported)
+{
+    auto captured = Terra::STF::CaptureOutput(
+        [&]
+        {
+            // Fail only at the scalar level
+            Terra::STF::RunISALevels(
+                []()
+                {
+                    STF_ASSERT_FALSE(Terra::STF::ISALimit() ==
+                                     Terra::STF::ISALevel::Scalar);
+                });
+        });
+
+    STF_ASSERT_TRUE(captured.failed);
+
+    const std::string &output = captured.output;
+    STF_ASSERT_NE(std::string::npos, output.find(" [scalar: "));
+    STF_ASSERT_NE(std::string::npos, output.find("ISA level: scalar"));
+    STF_ASSERT_NE(std::string::npos, output.find("1 of "));
+    STF_ASSERT_NE(std::string::npos, output.find("ISA level(s) failed"));
+}
@@ -0,0 +1,166 @@
+/*
+ *  test_kat.cpp
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Module to exercise known-answer tests read from files.  The vectors
+ *      are found in the "vectors" directory named by STF_KAT_DIR.
+ *
+ *  Portability Issues:
+ *      None.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <terra/stf/kat.h>
+
+namespace
+{
+
+// A toy cipher that combines the key and the input with exclusive-or
+std::vector<std::uint8_t> Xor(const std::vector<std::uint8_t> &key,
+                              const std::vector<std::uint8_t> &input)
+{
+    std::vector<std::uint8_t> output(input.size());
+
+    for (std::size_t i = 0; i < input.size(); i++)
+    {
+        output[i] = key[i % key.size()] ^ input[i];
+    }
+
+    return output;
+}
+
+} // namespace
+
+STF_TEST_KAT(KAT, Xor, "xor.rsp")
+{
+    const std::vector<std::uint8_t> key = param.Hex("KEY");
+
+    if (param.HasHeader("ENCRYPT"))
+    {
+        STF_ASSERT_EQ(param.Hex("CIPHERTEXT"),
+                      Xor(key, param.Hex("PLAINTEXT")));
+    }
+    else
+    {
+        STF_ASSERT_EQ(param.Hex("PLAINTEXT"),
+                      Xor(key, param.Hex("ciphertext")));
+    }
+}
+
+STF_TEST_KAT(KAT, Checksum, "checksum.rsp")
+{
+    const std::size_t length = param.Number("Len") / 8;
+    const std::vector<std::uint8_t> &message = param.Hex("Msg");
+    std::uint8_t sum = 0;
+
+    STF_ASSERT_EQ(std::string("1"), std::string(param.Header("L")));
+
+    for (std::size_t i = 0; i < length; i++) sum += message[i];
+
+    STF_ASSERT_EQ(param.Hex("MD")[0], sum);
+}
+
+STF_TEST(KAT, Parsing)
+{
+    auto vectors = Terra::STF::LoadKnownAnswers("xor.rsp");
+
+    STF_ASSERT_EQ(6, vectors.size());
+
+    // Headers apply until replaced; lines and counts are as in the file
+    STF_ASSERT_TRUE(vectors[2].HasHeader("ENCRYPT"));
+    STF_ASSERT_FALSE(vectors[3].HasHeader("ENCRYPT"));
+    STF_ASSERT_TRUE(vectors[3].HasHeader("decrypt"));
+    STF_ASSERT_EQ(7, vectors[0].Line());
+    STF_ASSERT_EQ(0, vectors[0].Number("COUNT"));
+    STF_ASSERT_EQ(2, vectors[5].Number("count"));
+    STF_ASSERT_EQ(4, vectors[0].Fields().size());
+    STF_ASSERT_EQ(32, vectors[0].Text("KEY").size());
+    STF_ASSERT_FALSE(vectors[0].Has("MD"));
+}
+
+STF_TEST(KAT, Errors)
+{
+    auto vectors = Terra::STF::LoadKnownAnswers("checksum.rsp");
+
+    STF_ASSERT_EXCEPTION_E([&] { vectors[0].Hex("Key"); },
+                           std::invalid_argument);
+    STF_ASSERT_EXCEPTION_E([&] { vectors[0].Header("Mode"); },
+                           std::invalid_argument);
+    STF_ASSERT_EXCEPTION_E(
+        [&] { Terra::STF::LoadKnownAnswers("missing.rsp"); },
+        std::runtime_error);
+
+    try
+    {
+        vectors[1].Number("Msg");
+        STF_ASSERT_TRUE(false);
+    }
+    catch (const std::invalid_argument &e)
+    {
+        std::string message = e.what();
+        STF_ASSERT_NE(std::string::npos,
+                      message.find("checksum.rsp:10: Malformed number"));
+    }
+}
+
+STF_TEST(KAT, HexReferencesStable)
+{
+    auto vectors = Terra::STF::LoadKnownAnswers("xor.rsp");
+
+    // References to several fields and vectors are held at once
+    const auto &key = vectors[0].Hex("KEY");
+    const auto &plaintext = vectors[0].Hex("PLAINTEXT");
+    const auto &ciphertext = vectors[0].Hex("CIPHERTEXT");
+    const auto &other_key = vectors[1].Hex("KEY");
+
+    STF_ASSERT_EQ(16, key.size());
+    STF_ASSERT_EQ(ciphertext, Xor(key, plaintext));
+    STF_ASSERT_NE(&key, &other_key);
+    STF_ASSERT_NE(key, other_key);
+    STF_ASSERT_EQ(&key, &vectors[0].Hex("key"));
+}
+
+STF_TEST(KAT, DecodeHex)
+{
+    std::vector<std::uint8_t> octets;
+
+    STF_ASSERT_TRUE(Terra::STF::DecodeHex("00ff7Fa0", octets));
+    STF_ASSERT_EQ((std::vector<std::uint8_t>{0x00, 0xff, 0x7f, 0xa0}),
+                  octets);
+    STF_ASSERT_TRUE(Terra::STF::DecodeHex("", octets));
+    STF_ASSERT_TRUE(octets.empty());
+    STF_ASSERT_FALSE(Terra::STF::DecodeHex("abc", octets));
+    STF_ASSERT_FALSE(Terra::STF::DecodeHex("0g", octets));
+}
+
+STF_TEST(KAT, FailureReported)
+{
+    auto captured = Terra::STF::CaptureOutput(
+        [&]
+        {
+            Terra::STF::RunParameterized(
+                Terra::STF::LoadKnownAnswers("xor.rsp"),
+                [](const Terra::STF::KnownAnswer &vector)
+                {
+                    STF_ASSERT_NE(1, vector.Number("COUNT"));
+                });
+        });
+
+    const std::string &output = captured.output;
+    STF_ASSERT_NE(std::string::npos,
+                  output.find("xor.rsp:12 [ENCRYPT] COUNT = 1\n"));
+    STF_ASSERT_NE(std::string::npos,
+                  output.find("xor.rsp:29 [DECRYPT] COUNT = 1\n"));
+    STF_ASSERT_NE(std::string::npos, output.find("2 of 6 instance(s) failed"));
+}
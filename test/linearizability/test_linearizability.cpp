@@ -0,0 +1,453 @@
+/*
+ *  test_linearizability.cpp
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Module to exercise the linearizability checker using models of a
+ *      FIFO queue and of a map.
+ *
+ *  Portability Issues:
+ *      None.
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <terra/stf/linearizability.h>
+
+namespace
+{
+
+// Model of a FIFO queue of integers
+struct QueueModel
+{
+    using State = std::deque<int>;
+
+    struct Operation
+    {
+        bool push;
+        int value;
+    };
+
+    struct Result
+    {
+        std::optional<int> value;
+    };
+
+    static bool Step(State &state,
+                     const Operation &operation,
+                     const Result &result)
+    {
+        if (operation.push)
+        {
+            state.push_back(operation.value);
+            return true;
+        }
+
+        if (state.empty()) return !result.value.has_value();
+
+        if (result.value != state.front()) return false;
+
+        state.pop_front();
+
+        return true;
+    }
+
+    // Apply an operation that has not returned
+    static bool Step(State &state, const Operation &operation)
+    {
+        if (operation.push)
+        {
+            state.push_back(operation.value);
+        }
+        else if (!state.empty())
+        {
+            state.pop_front();
+        }
+
+        return true;
+    }
+};
+
+std::ostream &operator<<(std::ostream &o, const QueueModel::Operation &op)
+{
+    if (op.push) return o << "Push(" << op.value << ")";
+
+    return o << "Pop()";
+}
+
+std::ostream &operator<<(std::ostream &o, const QueueModel::Result &result)
+{
+    if (!result.value) return o << "empty";
+
+    return o << *result.value;
+}
+
+// Model of a map from integer keys to integer values, where operations on
+// different keys are independent
+struct MapModel
+{
+    using State = std::optional<int>;
+
+    struct Operation
+    {
+        int key;
+        std::optional<int> put;
+    };
+
+    using Result = std::optional<int>;
+
+    static int Partition(const Operation &operation) { return operation.key; }
+
+    static bool Step(State &state,
+                     const Operation &operation,
+                     const Result &result)
+    {
+        if (operation.put)
+        {
+            state = operation.put;
+            return true;
+        }
+
+        return result == state;
+    }
+};
+
+// A queue protected by a mutex, which is trivially linearizable
+class LockedQueue
+{
+    public:
+        void Push(int value)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(value);
+        }
+
+        std::optional<int> Pop()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (queue.empty()) return std::nullopt;
+
+            int value = queue.front();
+            queue.pop_front();
+
+            return value;
+        }
+
+    protected:
+        std::mutex mutex;
+        std::deque<int> queue;
+};
+
+// Record a complete operation on the given thread
+template<typename Model>
+void Record(Terra::STF::History<Model> &history,
+            std::size_t thread,
+            const typename Model::Operation &operation,
+            const typename Model::Result &result)
+{
+    history.Respond(thread, history.Invoke(thread, operation), result);
+}
+
+} // namespace
+
+STF_TEST(Linearizability, LockedQueue)
+{
+    constexpr std::size_t Thread_Count = 4;
+    constexpr std::size_t Operations = 200;
+
+    Terra::STF::History<QueueModel> history(Thread_Count, Operations);
+    LockedQueue queue;
+
+    {
+        std::vector<Terra::STF::Thread> threads;
+
+        for (std::size_t t = 0; t < Thread_Count; t++)
+        {
+            threads.emplace_back(
+                [&, t]
+                {
+                    for (std::size_t i = 0; i < Operations; i++)
+                    {
+                        int value = static_cast<int>(t * Operations + i);
+
+                        if ((i % 2) == 0)
+                        {
+                            history.Call(t,
+                                         {true, value},
+                                         [&]
+                                         {
+                                             queue.Push(value);
+                                             return QueueModel::Result{};
+                                         });
+                        }
+                        else
+                        {
+                            history.Call(t,
+                                         {false, 0},
+                                         [&]
+                                         {
+                                             return QueueModel::Result{
+                                                 queue.Pop()};
+                                         });
+                        }
+                    }
+                });
+        }
+    }
+
+    STF_ASSERT_FALSE(history.Overflowed());
+    STF_ASSERT_LINEARIZABLE(history);
+}
+
+STF_TEST(Linearizability, Overlapping)
+{
+    Terra::STF::History<QueueModel> history(2, 4);
+
+    // The pop returns a value pushed by an operation that has not yet
+    // returned, which is valid since the two operations overlap
+    auto push = history.Invoke(0, {true, 1});
+    auto pop = history.Invoke(1, {false, 0});
+    history.Respond(1, pop, {1});
+    history.Respond(0, push, {});
+
+    // An operation still pending need not have taken effect
+    history.Invoke(1, {false, 0});
+
+    STF_ASSERT_LINEARIZABLE(history);
+}
+
+STF_TEST(Linearizability, Pending)
+{
+    // A push that never returned, but whose value was popped, must be
+    // linearized before the pop
+    {
+        Terra::STF::History<QueueModel> history(2, 4);
+
+        history.Invoke(0, {true, 5});
+        Record(history, 1, {false, 0}, {5});
+
+        STF_ASSERT_LINEARIZABLE(history);
+    }
+
+    // A pop that never returned may have removed the only value
+    {
+        Terra::STF::History<QueueModel> history(2, 4);
+
+        Record(history, 0, {true, 1}, {});
+        history.Invoke(1, {false, 0});
+        Record(history, 0, {false, 0}, {});
+
+        STF_ASSERT_LINEARIZABLE(history);
+    }
+
+    // A pending push cannot take effect before it was invoked
+    {
+        Terra::STF::History<QueueModel> history(2, 4);
+
+        Record(history, 1, {false, 0}, {5});
+        history.Invoke(0, {true, 5});
+
+        Terra::STF::LinearizabilityChecker<QueueModel> checker(
+            history,
+            {},
+            Terra::STF::WorkDeadline());
+
+        STF_ASSERT_EQ(Terra::STF::Linearizability::NotLinearizable,
+                      checker.Check());
+        STF_ASSERT_EQ(1, checker.Violation().size());
+        STF_ASSERT_EQ(5, checker.Violation()[0].result->value.value_or(0));
+    }
+
+    // The pending pop removed the value, so it cannot also be popped later
+    {
+        Terra::STF::History<QueueModel> history(2, 4);
+
+        Record(history, 0, {true, 1}, {});
+        history.Invoke(1, {false, 0});
+        Record(history, 0, {false, 0}, {});
+        Record(history, 0, {false, 0}, {1});
+
+        auto captured = Terra::STF::CaptureOutput(
+            [&]
+            {
+                STF_EXPECT_LINEARIZABLE(history);
+            });
+
+        // Pending operations need never take effect, so they are never part
+        // of the minimal sub-history
+        STF_ASSERT_EQ(1, captured.failures);
+        STF_ASSERT_NE(std::string::npos,
+                      captured.output.find("sub-history of 1 operation(s)"));
+        STF_ASSERT_NE(std::string::npos, captured.output.find("result: 1"));
+    }
+
+    // Models unable to apply an operation without its result omit pending
+    // operations
+    {
+        Terra::STF::History<MapModel> history(2, 4);
+
+        history.Invoke(0, {1, 7});
+        Record(history, 1, {1, std::nullopt}, {});
+
+        STF_ASSERT_LINEARIZABLE(history);
+    }
+}
+
+STF_TEST(Linearizability, Violation)
+{
+    Terra::STF::History<QueueModel> history(2, 4);
+
+    // The pop starts after the push completed, yet finds the queue empty;
+    // the later operations do not contribute to the violation
+    Record(history, 0, {true, 1}, {});
+    Record(history, 1, {false, 0}, {});
+    Record(history, 1, {true, 7}, {});
+    Record(history, 0, {false, 0}, {1});
+    Record(history, 1, {true, 9}, {});
+
+    Terra::STF::LinearizabilityChecker<QueueModel> checker(
+        history,
+        {},
+        Terra::STF::WorkDeadline());
+
+    STF_ASSERT_EQ(Terra::STF::Linearizability::NotLinearizable,
+                  checker.Check());
+
+    const auto &violation = checker.Violation();
+    STF_ASSERT_EQ(2, violation.size());
+    STF_ASSERT_TRUE(violation[0].operation->push);
+    STF_ASSERT_EQ(1, violation[0].operation->value);
+    STF_ASSERT_FALSE(violation[1].operation->push);
+    STF_ASSERT_FALSE(violation[1].result->value.has_value());
+
+    // The assertion reports only the minimal sub-history
+    auto captured = Terra::STF::CaptureOutput(
+        [&]
+        {
+            STF_EXPECT_LINEARIZABLE(history);
+        });
+
+    STF_ASSERT_EQ(1, captured.failures);
+    const std::string &output = captured.output;
+    STF_ASSERT_NE(std::string::npos,
+                  output.find("sub-history of 2 operation(s)"));
+    STF_ASSERT_NE(std::string::npos, output.find("operation: Push(1)"));
+    STF_ASSERT_NE(std::string::npos, output.find("result: empty"));
+    STF_ASSERT_EQ(std::string::npos, output.find("Push(7)"));
+    STF_ASSERT_EQ(std::string::npos, output.find("Push(9)"));
+}
+
+STF_TEST(Linearizability, Partitioned)
+{
+    constexpr std::size_t Thread_Count = 4;
+    constexpr std::size_t Operations = 2000;
+    constexpr int Keys = 16;
+
+    Terra::STF::History<MapModel> history(Thread_Count, Operations + 1);
+    std::mutex mutex;
+    std::map<int, int> map;
+
+    {
+        std::vector<Terra::STF::Thread> threads;
+
+        for (std::size_t t = 0; t < Thread_Count; t++)
+        {
+            threads.emplace_back(
+                [&, t]
+                {
+                    for (std::size_t i = 0; i < Operations; i++)
+                    {
+                        int key = static_cast<int>((i * 7 + t) % Keys);
+                        std::optional<int> put;
+                        if ((i % 3) == 0) put = static_cast<int>(i);
+
+                        history.Call(
+                            t,
+                            {key, put},
+                            [&]() -> MapModel::Result
+                            {
+                                std::lock_guard<std::mutex> lock(mutex);
+                                if (put) map[key] = *put;
+                                auto it = map.find(key);
+                                if (it == map.end()) return std::nullopt;
+                                return it->second;
+                            });
+                    }
+                });
+        }
+    }
+
+    STF_ASSERT_LINEARIZABLE(history);
+
+    // A stale read of one key is found among all of the other operations
+    Record(history, 0, {3, 12345}, {12345});
+    Record(history, 1, {3, std::nullopt}, {-1});
+
+    Terra::STF::LinearizabilityChecker<MapModel> checker(
+        history,
+        {},
+        Terra::STF::WorkDeadline());
+
+    STF_ASSERT_EQ(Terra::STF::Linearizability::NotLinearizable,
+                  checker.Check());
+    STF_ASSERT_EQ(1, checker.Violation().size());
+    STF_ASSERT_EQ(3, checker.Violation()[0].operation->key);
+    STF_ASSERT_EQ(-1, checker.Violation()[0].result->value_or(0));
+}
+
+STF_TEST(Linearizability, TimedOut)
+{
+    constexpr std::size_t Operations = 4096;
+
+    Terra::STF::History<QueueModel> history(1, Operations);
+
+    for (std::size_t i = 0; i < Operations; i++)
+    {
+        Record(history, 0, {true, static_cast<int>(i)}, {});
+    }
+
+    Terra::STF::LinearizabilityChecker<QueueModel> checker(
+        history,
+        {},
+        std::chrono::steady_clock::now() - std::chrono::seconds(1));
+
+    STF_ASSERT_EQ(Terra::STF::Linearizability::TimedOut, checker.Check());
+}
+
+STF_TEST(Linearizability, Overflowed)
+{
+    Terra::STF::History<QueueModel> history(1, 2);
+
+    Record(history, 0, {true, 1}, {});
+    Record(history, 0, {true, 2}, {});
+
+    STF_ASSERT_FALSE(history.Overflowed());
+    STF_ASSERT_EQ(Terra::STF::History<QueueModel>::Not_Recorded,
+                  history.Invoke(0, {true, 3}));
+    STF_ASSERT_TRUE(history.Overflowed());
+    STF_ASSERT_EQ(2, history.Events(0).size());
+
+    auto captured = Terra::STF::CaptureOutput(
+        [&]
+        {
+            STF_EXPECT_LINEARIZABLE(history);
+        });
+
+    STF_ASSERT_EQ(1, captured.failures);
+    STF_ASSERT_NE(std::string::npos,
+                  captured.output.find("capacity exceeded"));
+}
@@ -10,13 +10,15 @@
  *
  *  Description:
  *      Module to exercise tests related to memory comparisons using the Simple
- *      Test Framework library.  It also does comparisons between pointers.
+ *      Test Framework library.  It also does comparisons between pointers,
+ *      including against the null pointer constants 0 and NULL.
  *
  *  Portability Issues:
  *      None.
  */
 
 #include <cstring>
+#include <cstddef>
 #include <cstdint>
 #include <terra/stf/stf.h>
 
@@ -84,3 +86,27 @@ STF_TEST(Memory, Test6)
 
     STF_ASSERT_EQ(p, q);
 }
+
+STF_TEST(Memory, NullPointerConstants)
+{
+    struct Record
+    {
+        int value;
+    };
+
+    int i = 0;
+    int *p = nullptr;
+    int *q = &i;
+    int Record::*member = nullptr;
+
+    STF_ASSERT_EQ(0, p);
+    STF_ASSERT_EQ(p, NULL);
+    STF_ASSERT_NE(NULL, q);
+    STF_ASSERT_NE(q, 0);
+    STF_ASSERT_EQ(0, member);
+
+    // A failed comparison reports both values
+    auto captured = Terra::STF::CaptureOutput([&]() { STF_EXPECT_EQ(0, q); });
+
+    STF_ASSERT_EQ(std::size_t(1), captured.failures);
+}
@@ -41,6 +41,14 @@ STF_TEST(Miscellaneous, SecondTestToExclude)
     STF_ASSERT_TRUE(false);
 }
 
+STF_TEST(Miscellaneous, YieldPointDisabled)
+{
+    // Without STF_ENABLE_YIELD_POINTS, a yield point does nothing
+    STF_YIELD_POINT();
+
+    STF_ASSERT_FALSE(Terra::STF::CurrentContext()->YieldPointsReached());
+}
+
 // Indicate tests to exclude
 STF_TEST_EXCLUDE(Miscellaneous, TestToExclude)
 STF_TEST_EXCLUDE(Miscellaneous, SecondTestToExclude)
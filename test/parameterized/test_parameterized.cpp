@@ -0,0 +1,188 @@
+/*
+ *  test_parameterized.cpp
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Module to exercise value-parameterized tests.
+ *
+ *  Portability Issues:
+ *      None.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <terra/stf/parameterized.h>
+
+namespace
+{
+
+// A known-answer vector for a simple function
+struct Vector
+{
+    std::uint32_t input;
+    std::uint32_t expected;
+};
+
+std::uint32_t RotateLeft8(std::uint32_t value)
+{
+    return (value << 8) | (value >> 24);
+}
+
+std::vector<Vector> Vectors()
+{
+    return {{0x00000000, 0x00000000},
+            {0x12345678, 0x34567812},
+            {0xff000000, 0x000000ff},
+            {0x000000ff, 0x0000ff00}};
+}
+
+} // namespace
+
+STF_TEST_P(Parameterized, Container, Vectors())
+{
+    STF_ASSERT_EQ(param.expected, RotateLeft8(param.input));
+}
+
+STF_TEST_P(Parameterized, Range, Terra::STF::Range(0, 1000, 3))
+{
+    STF_ASSERT_EQ(0, param % 3);
+    STF_ASSERT_LT(param, 1000);
+}
+
+STF_TEST_P(Parameterized,
+           Generate,
+           Terra::STF::Generate(256,
+                                [](std::size_t index)
+                                {
+                                    return std::to_string(index);
+                                }))
+{
+    STF_ASSERT_EQ(param, std::to_string(std::stoul(param)));
+}
+
+STF_TEST_P(Parameterized, List, std::list<int>{1, 2, 3})
+{
+    STF_ASSERT_GT(param, 0);
+}
+
+STF_TEST(Parameterized, RangeSizes)
+{
+    STF_ASSERT_EQ(10, Terra::STF::Range(0, 10).size());
+    STF_ASSERT_EQ(4, Terra::STF::Range(0, 10, 3).size());
+    STF_ASSERT_EQ(0, Terra::STF::Range(5, 5).size());
+    STF_ASSERT_EQ(0, Terra::STF::Range(5, 0).size());
+    STF_ASSERT_EQ(7, Terra::STF::Range(1, 10, 3)[2]);
+}
+
+STF_TEST(Parameterized, RangeWide)
+{
+    constexpr int Min = std::numeric_limits<int>::min();
+    constexpr int Max = std::numeric_limits<int>::max();
+
+    // The number of values exceeds the largest int
+    auto range = Terra::STF::Range(Min, Max);
+    STF_ASSERT_EQ(std::numeric_limits<unsigned>::max(), range.size());
+    STF_ASSERT_EQ(Min, range[0]);
+    STF_ASSERT_EQ(Max - 1, range[range.size() - 1]);
+
+    // Types narrower than int are not affected by promotion
+    auto narrow = Terra::STF::Range(std::int8_t(-128), std::int8_t(127),
+                                    std::int8_t(5));
+    STF_ASSERT_EQ(51, narrow.size());
+    STF_ASSERT_EQ(122, narrow[50]);
+}
+
+STF_TEST(Parameterized, RangeStep)
+{
+    STF_ASSERT_EXCEPTION_E([] { Terra::STF::Range(0, 10, 0); },
+                           std::invalid_argument);
+    STF_ASSERT_EXCEPTION_E([] { Terra::STF::Range(10, 0, -1); },
+                           std::invalid_argument);
+}
+
+STF_TEST(Parameterized, EachInstanceRunsOnce)
+{
+    constexpr std::size_t Count = 10000;
+    std::vector<std::atomic<std::size_t>> runs(Count);
+
+    Terra::STF::RunParameterized(
+        Terra::STF::Range(std::size_t(0), Count),
+        [&](std::size_t value) { runs[value]++; });
+
+    for (std::size_t i = 0; i < Count; i++) STF_ASSERT_EQ(1, runs[i]);
+}
+
+STF_TEST(Parameterized, FailuresReported)
+{
+    // Every instance runs even though some fail
+    auto captured = Terra::STF::CaptureOutput(
+        []
+        {
+            Terra::STF::RunParameterized(
+                Terra::STF::Range(0, 100),
+                [](int value)
+                {
+                    if (value == 3) throw std::runtime_error("three");
+                    STF_ASSERT_NE(0, value % 7);
+                });
+        });
+
+    // Failures at 0, 7, ..., 98, plus the exception
+    STF_ASSERT_EQ(16, captured.failures);
+
+    const std::string &output = captured.output;
+    STF_ASSERT_EQ(0, output.find(" [100 instances]"));
+    STF_ASSERT_NE(std::string::npos, output.find("\"Scratch/7\" failed"));
+    STF_ASSERT_NE(std::string::npos, output.find("parameter: 7"));
+    STF_ASSERT_NE(std::string::npos, output.find("thrown: three"));
+    STF_ASSERT_EQ(std::string::npos, output.find("\"Scratch/98\""));
+    STF_ASSERT_NE(std::string::npos,
+                  output.find("16 of 100 instance(s) failed; 6 not shown"));
+
+    // Failing instances are reported in order
+    STF_ASSERT_LT(output.find("\"Scratch/0\""), output.find("\"Scratch/3\""));
+    STF_ASSERT_LT(output.find("\"Scratch/3\""), output.find("\"Scratch/7\""));
+}
+
+STF_TEST_TYPED(Parameterized,
+               Typed,
+               Terra::STF::Types<std::uint8_t,
+                                 std::uint16_t,
+                                 std::uint32_t,
+                                 std::uint64_t>)
+{
+    TypeParam value = ~TypeParam(0);
+
+    STF_ASSERT_GT(value, TypeParam(0));
+    STF_ASSERT_EQ(TypeParam(0), TypeParam(value + 1));
+}
+
+STF_TEST(Parameterized, TypeName)
+{
+    STF_ASSERT_EQ(std::string("int"),
+                  std::string(Terra::STF::TypeName<int>()));
+    STF_ASSERT_EQ(std::string("unsigned char"),
+                  std::string(Terra::STF::TypeName<std::uint8_t>()));
+    STF_ASSERT_NE(std::string::npos,
+                  Terra::STF::TypeName<std::vector<int>>().find("vector"));
+}
+
+// Excluding a typed test excludes it for every type
+STF_TEST_TYPED(Parameterized, Excluded, Terra::STF::Types<int, long>)
+{
+    STF_ASSERT_TRUE(false);
+}
+
+STF_TEST_EXCLUDE(Parameterized, Excluded)
@@ -0,0 +1,301 @@
+/*
+ *  test_property.cpp
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Module to exercise property-based tests.
+ *
+ *  Portability Issues:
+ *      None.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <terra/stf/property.h>
+
+namespace
+{
+
+// Run a property in a scratch context, returning its output and failures
+template<typename Function, typename... Generators>
+Terra::STF::CapturedOutput CheckScratch(Function function,
+                                        const Generators &...generators)
+{
+    return Terra::STF::CaptureOutput(
+        [&]
+        { Terra::STF::CheckProperty(1000, 0, function, generators...); });
+}
+
+// Set an environment variable to the given value, or remove it if nullptr
+void SetEnvironment(const char *name, const char *value)
+{
+#if defined(_WIN32)
+    _putenv_s(name, (value != nullptr) ? value : "");
+#else
+    if (value == nullptr)
+    {
+        unsetenv(name);
+    }
+    else
+    {
+        setenv(name, value, 1);
+    }
+#endif
+}
+
+// A value that can be neither streamed nor iterated
+struct Point
+{
+    int x;
+    int y;
+};
+
+// Generator of points, used to check that any Value type is supported
+class PointGenerator
+{
+    public:
+        using Value = Point;
+
+        Point Generate(Terra::STF::PropertyRandom &random, std::size_t) const
+        {
+            return {static_cast<int>(random.Below(100)),
+                    static_cast<int>(random.Below(100))};
+        }
+
+        std::vector<Point> Shrink(const Point &value) const
+        {
+            std::vector<Point> candidates;
+
+            if (value.x > 0) candidates.push_back({value.x - 1, value.y});
+
+            return candidates;
+        }
+};
+
+} // namespace
+
+STF_PROPERTY(Property,
+             Addition,
+             Terra::STF::Integers<std::int32_t>(),
+             Terra::STF::Integers<std::int32_t>())
+{
+    const auto &[a, b] = args;
+    std::int64_t sum = std::int64_t(a) + b;
+
+    STF_ASSERT_EQ(sum, std::int64_t(b) + a);
+}
+
+STF_PROPERTY(Property, IntegerRange, Terra::STF::Integers<int>(-5, 300))
+{
+    const auto &[value] = args;
+
+    STF_ASSERT_GE(value, -5);
+    STF_ASSERT_LE(value, 300);
+}
+
+STF_PROPERTY(Property, FloatRange, Terra::STF::Floats<double>(1.0, 2.0))
+{
+    const auto &[value] = args;
+
+    STF_ASSERT_GE(value, 1.0);
+    STF_ASSERT_LE(value, 2.0);
+}
+
+STF_PROPERTY(Property, Floats, Terra::STF::Floats<float>())
+{
+    const auto &[value] = args;
+
+    STF_ASSERT_EQ(std::isnan(value), value != value);
+}
+
+STF_PROPERTY(Property, Reverse, Terra::STF::Bytes())
+{
+    const auto &[data] = args;
+    std::vector<std::uint8_t> copy(data.rbegin(), data.rend());
+
+    std::reverse(copy.begin(), copy.end());
+    STF_ASSERT_EQ(data, copy);
+    STF_ASSERT_LE(data.size(), 256);
+}
+
+STF_PROPERTY_N(Property,
+               Strings,
+               200,
+               0,
+               Terra::STF::Strings(10),
+               Terra::STF::VectorsOf(Terra::STF::Integers<int>(0, 9), 5))
+{
+    const auto &[text, digits] = args;
+
+    STF_ASSERT_LE(text.size(), 10);
+    STF_ASSERT_LE(digits.size(), 5);
+    for (char c : text) STF_ASSERT_TRUE((c >= ' ') && (c <= '~'));
+    for (int digit : digits) STF_ASSERT_TRUE((digit >= 0) && (digit <= 9));
+}
+
+STF_TEST(Property, StringCharacters)
+{
+    // Every printable character may be produced, not only those from "a"
+    auto generator = Terra::STF::Strings();
+    bool below = false;
+
+    for (std::uint64_t i = 0; i < 100; i++)
+    {
+        Terra::STF::PropertyRandom random(1234, i);
+
+        for (char c : generator.Generate(random, Terra::STF::Max_Property_Size))
+        {
+            STF_ASSERT_TRUE((c >= ' ') && (c <= '~'));
+            if (c < 'a') below = true;
+        }
+    }
+
+    STF_ASSERT_TRUE(below);
+}
+
+STF_TEST(Property, Replay)
+{
+    // The inputs of a case depend only on the seed and the case number
+    auto generator = Terra::STF::VectorsOf(Terra::STF::Integers<int>());
+
+    for (std::uint64_t i = 0; i < 100; i++)
+    {
+        Terra::STF::PropertyRandom first(1234, i);
+        Terra::STF::PropertyRandom second(1234, i);
+
+        STF_ASSERT_EQ(generator.Generate(first, i),
+                      generator.Generate(second, i));
+    }
+
+    // Setting STF_PROPERTY_SEED to the seed reported for a failing property
+    // reproduces the same failing case
+    auto property = [](const auto &args)
+    {
+        const auto &[value] = args;
+        STF_ASSERT_NE(3, value % 7);
+    };
+
+    auto original = CheckScratch(property,
+                                 Terra::STF::Integers<std::uint64_t>());
+    STF_ASSERT_EQ(1, original.failures);
+
+    const std::string marker = "STF_PROPERTY_SEED=";
+    std::size_t position = original.output.find(marker);
+    STF_ASSERT_NE(std::string::npos, position);
+    std::string seed = original.output.substr(
+        position + marker.size(),
+        original.output.find(' ', position) - position - marker.size());
+
+    SetEnvironment("STF_PROPERTY_SEED", seed.c_str());
+    auto repeated = CheckScratch(property,
+                                 Terra::STF::Integers<std::uint64_t>());
+    SetEnvironment("STF_PROPERTY_SEED", nullptr);
+
+    STF_ASSERT_EQ(1, repeated.failures);
+    STF_ASSERT_EQ(original.output, repeated.output);
+}
+
+STF_TEST(Property, ShrinkInteger)
+{
+    auto captured = CheckScratch(
+        [](const auto &args)
+        {
+            const auto &[value] = args;
+            STF_ASSERT_LT(value, 1000);
+        },
+        Terra::STF::Integers<std::uint32_t>());
+
+    STF_ASSERT_EQ(1, captured.failures);
+    STF_ASSERT_NE(std::string::npos,
+                  captured.output.find("args[0]: 1000 (0x000003e8)"));
+    STF_ASSERT_NE(std::string::npos,
+                  captured.output.find("STF_PROPERTY_SEED="));
+}
+
+STF_TEST(Property, ShrinkVector)
+{
+    auto captured = CheckScratch(
+        [](const auto &args)
+        {
+            const auto &[values] = args;
+            for (int value : values) STF_ASSERT_LE(value, 9);
+        },
+        Terra::STF::VectorsOf(Terra::STF::Integers<int>()));
+
+    STF_ASSERT_EQ(1, captured.failures);
+    STF_ASSERT_NE(std::string::npos, captured.output.find("args[0]: {10}"));
+}
+
+STF_TEST(Property, VectorOfStrings)
+{
+    auto captured = CheckScratch(
+        [](const auto &args)
+        {
+            const auto &[values] = args;
+            for (const std::string &value : values)
+            {
+                STF_ASSERT_TRUE(value.empty());
+            }
+        },
+        Terra::STF::VectorsOf(Terra::STF::Strings()));
+
+    STF_ASSERT_EQ(1, captured.failures);
+    STF_ASSERT_NE(std::string::npos, captured.output.find("args[0]: {a}"));
+}
+
+STF_TEST(Property, UnprintableValue)
+{
+    auto captured = CheckScratch(
+        [](const auto &args)
+        {
+            const auto &[point] = args;
+            STF_ASSERT_LT(point.x + point.y, 0);
+        },
+        PointGenerator());
+
+    STF_ASSERT_EQ(1, captured.failures);
+    STF_ASSERT_NE(std::string::npos,
+                  captured.output.find("args[0]: [Unprintable object"));
+}
+
+STF_TEST(Property, ShrinkBytes)
+{
+    // Exceptions are failures, and inputs shrink to the simplest that throw
+    auto captured = CheckScratch(
+        [](const auto &args)
+        {
+            const auto &[data, text] = args;
+            if ((data.size() > 2) && !text.empty())
+            {
+                throw std::runtime_error("too long");
+            }
+        },
+        Terra::STF::Bytes(),
+        Terra::STF::Strings());
+
+    STF_ASSERT_EQ(1, captured.failures);
+    STF_ASSERT_NE(std::string::npos, captured.output.find("thrown: too long"));
+    STF_ASSERT_NE(std::string::npos,
+                  captured.output.find("args[0]: 3 octet(s): 00 00 00"));
+    STF_ASSERT_NE(std::string::npos, captured.output.find("args[1]: a\n"));
+}
+
+STF_TEST(Property, CaseCount)
+{
+    auto captured = CheckScratch([](const auto &) {},
+                                 Terra::STF::Integers<int>());
+
+    STF_ASSERT_FALSE(captured.failed);
+    STF_ASSERT_EQ(std::string(" [1000 cases]"), captured.output);
+}
@@ -0,0 +1,177 @@
+/*
+ *  test_streaming.cpp
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Module to exercise the testing of incremental interfaces with input
+ *      split into chunks.
+ *
+ *  Portability Issues:
+ *      None.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <vector>
+#include <terra/stf/streaming.h>
+
+namespace
+{
+
+// Sums the input as 4-octet big-endian words, the last padded with zeros
+class WordSum
+{
+    public:
+        explicit WordSum(bool fast) : fast{fast}
+        {
+            // Nothing to do
+        }
+
+        void Update(const std::uint8_t *data, std::size_t size)
+        {
+            // The fast path wrongly ignores a partial word from an earlier
+            // chunk
+            if (fast)
+            {
+                while (size >= 4)
+                {
+                    sum += (std::uint32_t(data[0]) << 24) |
+                           (std::uint32_t(data[1]) << 16) |
+                           (std::uint32_t(data[2]) << 8) | data[3];
+                    data += 4;
+                    size -= 4;
+                }
+            }
+
+            for (std::size_t i = 0; i < size; i++) Add(data[i]);
+        }
+
+        std::uint32_t Final()
+        {
+            while (pending != 0) Add(0);
+            return sum;
+        }
+
+    protected:
+        void Add(std::uint8_t octet)
+        {
+            word = (word << 8) | octet;
+            if (++pending == 4)
+            {
+                sum += word;
+                word = 0;
+                pending = 0;
+            }
+        }
+
+        bool fast;
+        std::uint32_t sum = 0;
+        std::uint32_t word = 0;
+        std::size_t pending = 0;
+};
+
+// Return the sum of the chunks with either implementation
+std::uint32_t Sum(const Terra::STF::StreamChunks &chunks, bool fast)
+{
+    WordSum word_sum(fast);
+
+    for (const auto &chunk : chunks) word_sum.Update(chunk.data, chunk.size);
+
+    return word_sum.Final();
+}
+
+// Return a buffer of the given size with varied contents
+std::vector<std::uint8_t> Buffer(std::size_t size)
+{
+    std::vector<std::uint8_t> buffer(size);
+
+    std::iota(buffer.begin(), buffer.end(), std::uint8_t(7));
+
+    return buffer;
+}
+
+} // namespace
+
+STF_TEST(Streaming, Passes)
+{
+    Terra::STF::SweepChunks(Buffer(1000),
+                            [](const Terra::STF::StreamChunks &chunks)
+                            { return Sum(chunks, false); });
+}
+
+STF_TEST(Streaming, StringAndMaximum)
+{
+    std::string text = "The quick brown fox jumps over the lazy dog";
+
+    Terra::STF::SweepChunks(
+        text,
+        [](const Terra::STF::StreamChunks &chunks)
+        {
+            std::string joined;
+            for (const auto &chunk : chunks)
+            {
+                joined.append(reinterpret_cast<const char *>(chunk.data),
+                              chunk.size);
+            }
+            return joined;
+        },
+        5);
+}
+
+STF_TEST(Streaming, EmptyBuffer)
+{
+    Terra::STF::SweepChunks(std::vector<std::uint8_t>{},
+                            [](const Terra::STF::StreamChunks &chunks)
+                            { return Sum(chunks, true); });
+}
+
+STF_TEST(Streaming, ThroughputNoted)
+{
+    auto captured = Terra::STF::CaptureOutput(
+        [&]
+        {
+            Terra::STF::SweepChunks(Buffer(256),
+                                    [](const Terra::STF::StreamChunks &chunks)
+                                    { return Sum(chunks, false); },
+                                    20);
+        });
+
+    STF_ASSERT_FALSE(captured.failed);
+
+    const std::string &output = captured.output;
+    STF_ASSERT_NE(std::string::npos, output.find(" [one chunk: "));
+    STF_ASSERT_NE(std::string::npos, output.find(", 16: "));
+    STF_ASSERT_NE(std::string::npos, output.find(", 20: "));
+    STF_ASSERT_EQ(std::string::npos, output.find(", 32: "));
+}
+
+STF_TEST(Streaming, SplitReported)
+{
+    auto captured = Terra::STF::CaptureOutput(
+        [&]
+        {
+            Terra::STF::SweepChunks(Buffer(100),
+                                    [](const Terra::STF::StreamChunks &chunks)
+                                    { return Sum(chunks, true); });
+        });
+
+    STF_ASSERT_TRUE(captured.failed);
+
+    // Chunks of up to four octets never leave a partial word behind the
+    // fast path, but five do
+    const std::string &output = captured.output;
+    STF_ASSERT_EQ(std::string::npos, output.find("  chunk size: 4\n"));
+    STF_ASSERT_NE(std::string::npos, output.find("  chunk size: 5\n"));
+    STF_ASSERT_NE(std::string::npos,
+                  output.find("Result differs from that of one chunk"));
+    STF_ASSERT_NE(std::string::npos, output.find(" instance(s) failed"));
+    STF_ASSERT_EQ(std::string::npos, output.find(" [one chunk: "));
+}
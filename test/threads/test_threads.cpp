@@ -0,0 +1,277 @@
+/*
+ *  test_threads.cpp
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Module to exercise assertions made from threads started by a test and
+ *      the per-test context to which they are reported.
+ *
+ *  Portability Issues:
+ *      None.
+ */
+
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <terra/stf/stf.h>
+
+namespace
+{
+
+// Count the occurrences of the given text in a string
+std::size_t CountOccurrences(const std::string &text, std::string_view what)
+{
+    std::size_t count = 0;
+
+    for (std::size_t position = text.find(what);
+         position != std::string::npos;
+         position = text.find(what, position + what.size()))
+    {
+        count++;
+    }
+
+    return count;
+}
+
+// Fail a non-fatal assertion the given number of times
+void FailRepeatedly(std::size_t iterations)
+{
+    for (std::size_t i = 0; i < iterations; i++)
+    {
+        STF_EXPECT_EQ(i, i + 1);
+    }
+}
+
+// Fail a fatal assertion once
+void FailOnce()
+{
+    STF_ASSERT_TRUE(false);
+}
+
+// Fail a fatal assertion once, reporting the given text as expected
+void FailWith(const std::string &text)
+{
+    STF_ASSERT_EQ(text, std::string("none"));
+}
+
+} // namespace
+
+STF_TEST(Threads, SameContext)
+{
+    Terra::STF::TestContext *context = Terra::STF::CurrentContext();
+    Terra::STF::TestContext *thread_context = nullptr;
+    Terra::STF::TestContext *std_thread_context = nullptr;
+
+    STF_ASSERT_TRUE(context != nullptr);
+    STF_ASSERT_EQ(std::string("Threads::SameContext"), context->Name());
+
+    {
+        Terra::STF::Thread thread(
+            [&] { thread_context = Terra::STF::CurrentContext(); });
+    }
+
+    std::thread([&] { std_thread_context = Terra::STF::CurrentContext(); })
+        .join();
+
+    STF_ASSERT_EQ(context, thread_context);
+    STF_ASSERT_EQ(context, std_thread_context);
+}
+
+STF_TEST(Threads, Arguments)
+{
+    std::size_t sum = 0;
+
+    Terra::STF::Thread thread(
+        [](std::size_t a, std::size_t b, std::size_t &result)
+        {
+            result = a + b;
+        },
+        2,
+        3,
+        std::ref(sum));
+    thread.Join();
+
+    STF_ASSERT_FALSE(thread.Joinable());
+    STF_ASSERT_EQ(5, sum);
+}
+
+STF_TEST(Threads, InheritedContext)
+{
+    constexpr std::size_t Thread_Count = 8;
+    constexpr std::size_t Iterations = 1000;
+
+    Terra::STF::TestContext context("Scratch");
+    Terra::STF::TestContext *thread_context = nullptr;
+
+    // Fail assertions on many threads at once, reporting to the local context
+    {
+        Terra::STF::ContextScope scope(&context);
+        std::vector<Terra::STF::Thread> threads;
+
+        for (std::size_t i = 0; i < Thread_Count; i++)
+        {
+            threads.emplace_back(
+                []
+                {
+                    FailRepeatedly(Iterations);
+                    FailOnce();
+                });
+        }
+
+        threads.emplace_back(
+            [&] { thread_context = Terra::STF::CurrentContext(); });
+    }
+
+    // Threads inherit the context of the thread that created them
+    STF_ASSERT_EQ(&context, thread_context);
+    STF_ASSERT_NE(&context, Terra::STF::CurrentContext());
+
+    // Every failure is counted, but only the first few per site are shown
+    STF_ASSERT_TRUE(context.Failed());
+    STF_ASSERT_EQ(Thread_Count * (Iterations + 1), context.Failures());
+
+    std::string output = context.TakeOutput();
+    std::size_t reported = Terra::STF::Expect_Report_Limit + Thread_Count;
+    STF_ASSERT_EQ(reported, CountOccurrences(output, "Assertion failed at"));
+    STF_ASSERT_EQ(Terra::STF::Expect_Report_Limit,
+                  CountOccurrences(output, "  expected: "));
+    STF_ASSERT_EQ(1, CountOccurrences(output, "reporting limit of"));
+    STF_ASSERT_TRUE(context.TakeOutput().empty());
+
+    // Each failure message is committed whole, so the value lines always
+    // immediately follow the line identifying the failed assertion
+    for (std::size_t position = output.find("  expected: ");
+         position != std::string::npos;
+         position = output.find("  expected: ", position + 1))
+    {
+        std::size_t line_start = output.rfind('\n', position - 2) + 1;
+        STF_ASSERT_EQ(0,
+                      output.compare(line_start, 20, "Assertion failed at "));
+        STF_ASSERT_EQ(output.find("    actual: ", position),
+                      output.find('\n', position) + 1);
+    }
+
+    // The summary notes the failures that were not shown
+    Terra::STF::Formatter summary;
+    context.Summarize(summary);
+    STF_ASSERT_EQ(1, CountOccurrences(summary.String(), "not shown"));
+    STF_ASSERT_EQ(1, CountOccurrences(summary.String(), "\"Scratch\""));
+}
+
+STF_TEST(Threads, OutputKeptPerTest)
+{
+    constexpr std::size_t Thread_Count = 4;
+    constexpr std::size_t Iterations = 100;
+
+    Terra::STF::TestContext first("First");
+    Terra::STF::TestContext second("Second");
+
+    // Fail assertions on the threads of two tests running at once
+    {
+        std::vector<Terra::STF::Thread> threads;
+
+        for (auto [context, text] : {std::pair{&first, "first-test"},
+                                     std::pair{&second, "second-test"}})
+        {
+            Terra::STF::ContextScope scope(context);
+
+            for (std::size_t i = 0; i < Thread_Count; i++)
+            {
+                threads.emplace_back(
+                    [text = text]
+                    {
+                        for (std::size_t j = 0; j < Iterations; j++)
+                        {
+                            FailWith(text);
+                        }
+                    });
+            }
+        }
+    }
+
+    // Each test's report holds all of its own failures and none of the
+    // other's, each failure whole, followed by the test's summary
+    for (auto [context, own, other] :
+         {std::tuple{&first, "first-test", "second-test"},
+          std::tuple{&second, "second-test", "first-test"}})
+    {
+        Terra::STF::Formatter report;
+        report.Text(context->TakeOutput());
+        context->Summarize(report);
+        const std::string &output = report.String();
+
+        STF_ASSERT_EQ(Thread_Count * Iterations, context->Failures());
+        STF_ASSERT_EQ(Thread_Count * Iterations,
+                      CountOccurrences(output, "Assertion failed at"));
+        STF_ASSERT_EQ(Thread_Count * Iterations,
+                      CountOccurrences(output, own));
+        STF_ASSERT_EQ(0, CountOccurrences(output, other));
+
+        for (std::size_t position = output.find("  expected: ");
+             position != std::string::npos;
+             position = output.find("  expected: ", position + 1))
+        {
+            STF_ASSERT_EQ(position + 12, output.find(own, position));
+            STF_ASSERT_EQ(output.find("    actual: ", position),
+                          output.find('\n', position) + 1);
+        }
+
+        std::size_t summary = output.find("\nTest \"" + context->Name() +
+                                          "\" failed with ");
+        STF_ASSERT_NE(std::string::npos, summary);
+        STF_ASSERT_GT(summary, output.rfind(own));
+    }
+}
+
+STF_TEST(Threads, Exceptions)
+{
+    auto captured = Terra::STF::CaptureOutput(
+        []
+        {
+            Terra::STF::Thread thread(
+                [] { throw std::runtime_error("thread exception"); });
+        });
+
+    STF_ASSERT_EQ(1, captured.failures);
+    STF_ASSERT_EQ(1,
+                  CountOccurrences(captured.output,
+                                   "Unexpected exception thrown in thread: "
+                                   "thread exception"));
+}
+
+STF_TEST(Threads, CaptureOutput)
+{
+    Terra::STF::TestContext *context = Terra::STF::CurrentContext();
+    Terra::STF::TestContext *scratch = nullptr;
+
+    auto captured = Terra::STF::CaptureOutput(
+        [&]
+        {
+            scratch = Terra::STF::CurrentContext();
+            STF_EXPECT_EQ(1, 2);
+            STF_EXPECT_EQ(3, 4);
+        });
+
+    // The failures go to the scratch context, not to this test
+    STF_ASSERT_NE(context, scratch);
+    STF_ASSERT_EQ(context, Terra::STF::CurrentContext());
+    STF_ASSERT_TRUE(captured.failed);
+    STF_ASSERT_EQ(2, captured.failures);
+    STF_ASSERT_EQ(2, CountOccurrences(captured.output, "Assertion failed"));
+
+    captured = Terra::STF::CaptureOutput([] {});
+    STF_ASSERT_FALSE(captured.failed);
+    STF_ASSERT_TRUE(captured.output.empty());
+}
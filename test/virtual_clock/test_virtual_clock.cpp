@@ -0,0 +1,216 @@
+/*
+ *  test_virtual_clock.cpp
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Module to exercise the virtual clock and scheduler.
+ *
+ *  Portability Issues:
+ *      None.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include <terra/stf/virtual_clock.h>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+
+// A token bucket rate limiter written to accept any clock type, as code
+// intended to be tested with VirtualClock would be
+template<typename Clock = std::chrono::steady_clock>
+class RateLimiter
+{
+    public:
+        RateLimiter(std::size_t capacity, typename Clock::duration interval) :
+            capacity{capacity},
+            interval{interval},
+            tokens{capacity},
+            last{Clock::now()}
+        {
+            // Nothing to do
+        }
+
+        bool Acquire()
+        {
+            auto now = Clock::now();
+            auto refill = static_cast<std::size_t>((now - last) / interval);
+
+            if (refill > 0)
+            {
+                tokens = std::min(capacity, tokens + refill);
+                last += refill * interval;
+            }
+
+            if (tokens == 0) return false;
+
+            tokens--;
+
+            return true;
+        }
+
+    protected:
+        const std::size_t capacity;
+        const typename Clock::duration interval;
+        std::size_t tokens;
+        typename Clock::time_point last;
+};
+
+} // namespace
+
+STF_TEST(VirtualClock, SleepIsInstant)
+{
+    auto real_start = std::chrono::steady_clock::now();
+
+    Terra::STF::VirtualScheduler scheduler;
+
+    auto start = Terra::STF::VirtualClock::now();
+    Terra::STF::SleepFor(24h);
+    Terra::STF::SleepFor(500us);
+    STF_ASSERT_EQ(24h + 500us, Terra::STF::VirtualClock::now() - start);
+
+    // Sleeping until a time already passed does not move the clock back
+    Terra::STF::SleepUntil(start);
+    STF_ASSERT_EQ(24h + 500us, Terra::STF::VirtualClock::now() - start);
+
+    STF_ASSERT_LT(std::chrono::steady_clock::now() - real_start, 1s);
+}
+
+STF_TEST(VirtualClock, RealTimeWithoutScheduler)
+{
+    STF_ASSERT_TRUE(Terra::STF::CurrentScheduler() == nullptr);
+
+    auto start = Terra::STF::VirtualClock::now();
+    Terra::STF::SleepFor(2ms);
+
+    STF_ASSERT_GE(Terra::STF::VirtualClock::now() - start, 2ms);
+}
+
+STF_TEST(VirtualClock, Callbacks)
+{
+    Terra::STF::VirtualScheduler scheduler(
+        Terra::STF::VirtualClock::time_point{});
+    std::vector<int> order;
+    std::vector<Terra::STF::VirtualClock::duration> times;
+
+    auto record = [&](int value)
+    {
+        return [&, value]
+        {
+            order.push_back(value);
+            times.push_back(
+                Terra::STF::VirtualClock::now().time_since_epoch());
+        };
+    };
+
+    scheduler.ScheduleAfter(30ms, record(3));
+    scheduler.ScheduleAfter(10ms, record(1));
+    scheduler.ScheduleAfter(20ms, record(2));
+    auto cancelled = scheduler.ScheduleAfter(15ms, record(-1));
+    scheduler.ScheduleAfter(20ms, record(4));
+    STF_ASSERT_EQ(5, scheduler.Pending());
+
+    STF_ASSERT_TRUE(scheduler.Cancel(cancelled));
+    STF_ASSERT_FALSE(scheduler.Cancel(cancelled));
+
+    // Callbacks run in time order, then in the order scheduled, with the
+    // clock reading the time each was due
+    Terra::STF::SleepFor(25ms);
+    STF_ASSERT_EQ((std::vector<int>{1, 2, 4}), order);
+    STF_ASSERT_EQ(10ms, times[0]);
+    STF_ASSERT_EQ(20ms, times[1]);
+    STF_ASSERT_EQ(20ms, times[2]);
+    STF_ASSERT_EQ(25ms, Terra::STF::VirtualClock::now().time_since_epoch());
+
+    STF_ASSERT_TRUE(scheduler.RunNext());
+    STF_ASSERT_EQ((std::vector<int>{1, 2, 4, 3}), order);
+    STF_ASSERT_EQ(30ms, Terra::STF::VirtualClock::now().time_since_epoch());
+    STF_ASSERT_FALSE(scheduler.RunNext());
+}
+
+STF_TEST(VirtualClock, PeriodicCallback)
+{
+    Terra::STF::VirtualScheduler scheduler;
+    std::size_t ticks = 0;
+
+    // A callback may reschedule itself
+    std::function<void()> tick = [&]
+    {
+        ticks++;
+        scheduler.ScheduleAfter(1s, tick);
+    };
+    scheduler.ScheduleAfter(1s, tick);
+
+    Terra::STF::SleepFor(1h);
+
+    STF_ASSERT_EQ(3600, ticks);
+    STF_ASSERT_EQ(1, scheduler.Pending());
+}
+
+STF_TEST(VirtualClock, RateLimiter)
+{
+    Terra::STF::VirtualScheduler scheduler;
+    RateLimiter<Terra::STF::VirtualClock> limiter(2, 1min);
+
+    STF_ASSERT_TRUE(limiter.Acquire());
+    STF_ASSERT_TRUE(limiter.Acquire());
+    STF_ASSERT_FALSE(limiter.Acquire());
+
+    Terra::STF::SleepFor(59s);
+    STF_ASSERT_FALSE(limiter.Acquire());
+
+    Terra::STF::SleepFor(1s);
+    STF_ASSERT_TRUE(limiter.Acquire());
+    STF_ASSERT_FALSE(limiter.Acquire());
+
+    Terra::STF::SleepFor(10min);
+    STF_ASSERT_TRUE(limiter.Acquire());
+    STF_ASSERT_TRUE(limiter.Acquire());
+    STF_ASSERT_FALSE(limiter.Acquire());
+}
+
+STF_TEST(VirtualClock, Threads)
+{
+    Terra::STF::VirtualScheduler scheduler;
+    auto start = Terra::STF::VirtualClock::now();
+
+    // Threads created by the test share its virtual time
+    {
+        std::vector<Terra::STF::Thread> threads;
+
+        for (std::size_t i = 1; i <= 4; i++)
+        {
+            threads.emplace_back(
+                [&, i]
+                {
+                    STF_ASSERT_EQ(&scheduler, Terra::STF::CurrentScheduler());
+                    Terra::STF::SleepUntil(start + i * 1h);
+                });
+        }
+    }
+
+    STF_ASSERT_EQ(4h, Terra::STF::VirtualClock::now() - start);
+}
+
+STF_TEST(VirtualClock, Nested)
+{
+    Terra::STF::VirtualScheduler outer;
+
+    {
+        Terra::STF::VirtualScheduler inner;
+        STF_ASSERT_EQ(&inner, Terra::STF::CurrentScheduler());
+    }
+
+    STF_ASSERT_EQ(&outer, Terra::STF::CurrentScheduler());
+}
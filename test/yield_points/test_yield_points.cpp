@@ -0,0 +1,179 @@
+/*
+ *  test_yield_points.cpp
+ *
+ *  Copyright (C) 2024
+ *  Terrapane Corporation
+ *  All Rights Reserved
+ *
+ *  Author:
+ *      Paul E. Jones <paulej@packetizer.com>
+ *
+ *  Description:
+ *      Module to exercise STF_YIELD_POINT(), which is enabled for this test
+ *      by defining STF_ENABLE_YIELD_POINTS.
+ *
+ *  Portability Issues:
+ *      None.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <terra/stf/stf.h>
+
+namespace
+{
+
+// Increment a counter without atomicity, with a yield point in the window
+// in which another thread's increment would be lost
+void Increment(std::atomic<std::size_t> &counter)
+{
+    std::size_t value = counter.load(std::memory_order_relaxed);
+    STF_YIELD_POINT();
+    counter.store(value + 1, std::memory_order_relaxed);
+}
+
+// Return the number of increments lost when running with the given seed
+std::size_t LostIncrements(std::uint64_t seed)
+{
+    constexpr std::size_t Thread_Count = 4;
+    constexpr std::size_t Iterations = 50;
+
+    Terra::STF::TestContext context("Scratch");
+    std::atomic<std::size_t> counter{};
+
+    context.SetYieldSeed(seed);
+
+    {
+        Terra::STF::ContextScope scope(&context);
+        std::vector<Terra::STF::Thread> threads;
+
+        for (std::size_t i = 0; i < Thread_Count; i++)
+        {
+            threads.emplace_back(
+                [&]
+                {
+                    for (std::size_t j = 0; j < Iterations; j++)
+                    {
+                        Increment(counter);
+                    }
+                });
+        }
+    }
+
+    return Thread_Count * Iterations - counter.load();
+}
+
+// Return the actions taken at a yield point by threads run one after
+// another in a test with the given seed, each reaching it many times
+std::vector<std::vector<Terra::STF::YieldAction>> YieldActions(
+    std::uint64_t seed)
+{
+    constexpr std::size_t Thread_Count = 3;
+    constexpr std::size_t Visits = 32;
+
+    Terra::STF::TestContext context("Scratch");
+    std::vector<std::vector<Terra::STF::YieldAction>> actions(Thread_Count);
+
+    context.SetYieldSeed(seed);
+
+    Terra::STF::ContextScope scope(&context);
+
+    for (auto &thread_actions : actions)
+    {
+        Terra::STF::Thread thread(
+            [&]
+            {
+                for (std::size_t i = 0; i < Visits; i++)
+                {
+                    thread_actions.push_back(
+                        Terra::STF::YieldPoint("yield.cpp", 42));
+                }
+            });
+    }
+
+    return actions;
+}
+
+} // namespace
+
+STF_TEST(YieldPoints, Reached)
+{
+    Terra::STF::TestContext context("Scratch");
+
+    STF_ASSERT_FALSE(context.YieldPointsReached());
+
+    {
+        Terra::STF::ContextScope scope(&context);
+        STF_YIELD_POINT();
+    }
+
+    STF_ASSERT_TRUE(context.YieldPointsReached());
+}
+
+STF_TEST(YieldPoints, ExposesRace)
+{
+    // The yield point is active for about half of all seeds, so a lost
+    // increment is found after trying only a few seeds
+    bool found = false;
+
+    for (std::uint64_t seed = 1; (seed <= 32) && !found; seed++)
+    {
+        found = LostIncrements(seed) > 0;
+    }
+
+    STF_ASSERT_TRUE(found);
+}
+
+STF_TEST(YieldPoints, SeedReported)
+{
+    Terra::STF::TestContext context("Scratch");
+    Terra::STF::TestContext unperturbed("Unperturbed");
+
+    context.SetYieldSeed(12345);
+    unperturbed.SetYieldSeed(12345);
+
+    {
+        Terra::STF::ContextScope scope(&context);
+        STF_YIELD_POINT();
+        STF_EXPECT_TRUE(false);
+    }
+
+    {
+        Terra::STF::ContextScope scope(&unperturbed);
+        STF_EXPECT_TRUE(false);
+    }
+
+    // The seed is only reported if the failing test reached a yield point
+    Terra::STF::Formatter summary;
+    context.Summarize(summary);
+    STF_ASSERT_NE(std::string::npos,
+                  summary.String().find("STF_YIELD_SEED=12345"));
+
+    summary.Clear();
+    unperturbed.Summarize(summary);
+    STF_ASSERT_EQ(std::string::npos, summary.String().find("STF_YIELD_SEED"));
+}
+
+STF_TEST(YieldPoints, SeedRepeatsDecisions)
+{
+    // Find a seed for which the yield point is active
+    std::uint64_t seed = 1;
+    auto actions = YieldActions(seed);
+    while (actions[0] == std::vector<Terra::STF::YieldAction>(
+                             actions[0].size(),
+                             Terra::STF::YieldAction::None))
+    {
+        STF_ASSERT_LT(seed, 64U);
+        actions = YieldActions(++seed);
+    }
+
+    // The same seed gives the same decisions in a new test
+    STF_ASSERT_TRUE(actions == YieldActions(seed));
+
+    // Each thread makes decisions of its own
+    STF_ASSERT_TRUE(actions[0] != actions[1]);
+    STF_ASSERT_TRUE(actions[1] != actions[2]);
+}